@@ -52,6 +52,8 @@
 #define OS_MAX_COUNT_SEMAPHORES     20
 #define OS_MAX_BIN_SEMAPHORES       20
 #define OS_MAX_MUTEXES              20
+#define OS_MAX_EVENT_FLAGS          20
+#define OS_MAX_RWLOCKS              20
 
 /*
 ** Maximum length for an absolute path name
@@ -136,6 +138,61 @@
 */
 /* #define OSAL_SOCKET_QUEUE */
 
+/*
+** This define sets the queue implementation of the Linux port to use an in-process
+** ring buffer. Each queue keeps queue_depth fixed size message slots in memory owned
+** by the queue table, so a put or get only enters the kernel when a task has to
+** block on an empty queue. Queues are only visible inside the running process.
+** Only one of OSAL_SOCKET_QUEUE and OSAL_RING_QUEUE may be defined.
+*/
+/* #define OSAL_RING_QUEUE */
+
+/*
+** These defines size the buffer pool used by the zero copy queue API.
+** OS_QUEUE_POOL_BLOCK_SIZE is the largest message that can be loaned with
+** OS_QueueLoan and OS_QUEUE_POOL_BLOCKS is how many can be on loan at once
+** ( at most 65534 ).
+*/
+#define OS_QUEUE_POOL_BLOCKS      32
+#define OS_QUEUE_POOL_BLOCK_SIZE  4096
+
+/*
+** The scheduling policy of the tasks created without an OS_TASK_SCHED_ flag. Without it
+** they run under OS_TASK_SCHED_OTHER. A task that asks for a real time policy without
+** the permission for it (CAP_SYS_NICE or RLIMIT_RTPRIO on Linux) is created under
+** OS_TASK_SCHED_OTHER instead, and OS_TaskGetInfo reports the policy it got.
+*/
+/* #define OS_TASK_SCHED_DEFAULT  OS_TASK_SCHED_FIFO */
+
+/*
+** The Linux BSPs keep the cores in OS_BSP_ISOLATED_CPUS (bit n for core n) for the tasks
+** with an OSAL priority up to OS_BSP_ISOLATED_PRIORITY, and run every other task on the
+** remaining cores. Boot with isolcpus= set to the same cores so nothing else runs there.
+*/
+/* #define OS_BSP_ISOLATED_CPUS      0x2 */
+#define OS_BSP_ISOLATED_PRIORITY  50
+
+/*
+** This define turns on the lock statistics of the mutexes, semaphores and reader-writer
+** locks: how often they are taken, how often a take has to wait, and histograms of the
+** wait and hold times. They are read with OS_MutSemGetStats, OS_BinSemGetStats,
+** OS_CountSemGetStats, OS_RwLockGetStats and OS_LockStatsDump. Without it those calls
+** return OS_ERR_NOT_IMPLEMENTED and the take and give calls carry no extra code.
+*/
+/* #define OS_INCLUDE_LOCK_STATS */
+
+/*
+** This define makes OS_TaskCreate take the stacks of tasks that are not given one
+** from a single arena of this many bytes, mapped by OS_API_Init (Linux only). Each
+** stack is rounded up to whole pages and has OS_STACK_GUARD_PAGES inaccessible pages
+** below it, 0 for none, so an overflow faults at once. With OS_STACK_ARENA_LOCKED
+** the arena is locked into RAM. Stacks from the arena and stacks given by the caller
+** are painted, so OS_TaskGetInfo can report how much of them was ever used.
+*/
+/* #define OS_STACK_ARENA_SIZE       (64 * 65536) */
+/* #define OS_STACK_ARENA_LOCKED */
+#define OS_STACK_GUARD_PAGES      1
+
 /*
 ** Module loader/symbol table is optional
 */
@@ -166,8 +223,56 @@
 
 
 /*
-** This define sets the maximum number of timers available
+** This define sets the maximum number of timers available. The timers share one
+** timing wheel and one service task, so a timer only costs its table entry.
+*/
+#define OS_MAX_TIMERS         1024
+
+/*
+** These defines set up the timer service: the OSAL priority and stack size of the
+** task that runs the timing wheel, and the length of one wheel tick in microseconds.
+** Timers expire at their exact deadline, the tick only sets how the wheel groups
+** them. The service should have a higher priority than any timer dispatch task.
+*/
+#define OS_TIMER_SERVICE_PRIORITY    10
+#define OS_TIMER_SERVICE_STACK_SIZE  16384
+#define OS_TIMER_WHEEL_TICK_USECS    1000
+
+/*
+** These defines set up the timer dispatch tasks that run the timer callbacks, one
+** for each callback priority in use: the most priorities that can be in use, the
+** priority of the callbacks of timers made with OS_TimerCreate, and the stack size
+** of a dispatch task.
+*/
+#define OS_MAX_TIMER_DISPATCHERS     4
+#define OS_TIMER_DISPATCH_PRIORITY   20
+#define OS_TIMER_DISPATCH_STACK_SIZE 65536
+
+/*
+** These defines size the work pools of the Work Pool API: the number of pools,
+** the number of worker tasks in one pool and the number of jobs each worker
+** can queue in each of its two priority lanes. Every worker is an OSAL task,
+** so the workers of all pools count against OS_MAX_TASKS.
+*/
+#define OS_MAX_WORK_POOLS          4
+#define OS_MAX_WORK_POOL_WORKERS   8
+#define OS_WORK_QUEUE_DEPTH        256
+
+/*
+** These defines size OS_WaitMultiple: the most objects one call can wait on,
+** and the most tasks that can be blocked in it at the same time.
+*/
+#define OS_MAX_WAIT_OBJECTS        64
+#define OS_MAX_WAITERS             16
+
+/*
+** These defines size the Published Data API: the number of sequence locks and the
+** largest record one can hold, and the number of publications and how many old
+** versions of one can wait for their readers before OS_PublishUpdate blocks.
 */
-#define OS_MAX_TIMERS         5
+#define OS_MAX_SEQLOCKS            20
+#define OS_SEQLOCK_MAX_SIZE        256
+#define OS_MAX_PUBLICATIONS        20
+#define OS_PUBLISH_RETIRE_DEPTH    8
 
 #endif
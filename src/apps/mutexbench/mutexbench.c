@@ -0,0 +1,159 @@
+/*
+** mutexbench.c
+**
+** This program is an OSAL sample that compares the mutex semaphore options
+** of OS_MutSemCreate under contention. For each option, a set of tasks takes
+** the same mutex, increments a shared counter and gives the mutex back, and
+** the average time of one take/give pair is printed. The tasks are held on a
+** start semaphore until they have all been created, so task creation is not
+** part of the time.
+**
+*/
+
+#include <stdio.h>
+
+#include "osapi.h"
+
+#define NUMBER_OF_TASKS    4
+#define NUMBER_OF_OPTIONS  5
+#define ITERATIONS         200000
+#define TASK_STACK_SIZE    4096
+#define TASK_PRIORITY      100
+
+uint32 mutex_id;
+uint32 ready_sem_id;
+uint32 start_sem_id;
+uint32 done_sem_id;
+uint32 shared_counter;
+
+uint32 MutexOptions[NUMBER_OF_OPTIONS] = { 0,
+                                           OS_MUTEX_PRIO_INHERIT,
+                                           OS_MUTEX_ROBUST,
+                                           OS_MUTEX_ADAPTIVE,
+                                           OS_MUTEX_LIGHTWEIGHT };
+
+char   OptionNames[NUMBER_OF_OPTIONS][20] = { "default",
+                                              "prio inherit",
+                                              "robust",
+                                              "adaptive",
+                                              "lightweight" };
+
+/*
+** Each task waits for the start, hammers the mutex and reports back on the
+** done semaphore
+*/
+void bench_task(void)
+{
+   int i;
+
+   OS_CountSemGive(ready_sem_id);
+   OS_CountSemTake(start_sem_id);
+
+   for ( i = 0; i < ITERATIONS; i++ )
+   {
+      OS_MutSemTake(mutex_id);
+      shared_counter++;
+      OS_MutSemGive(mutex_id);
+   }
+
+   OS_CountSemGive(done_sem_id);
+   OS_TaskExit();
+}
+
+/* ********************** MAIN **************************** */
+
+void OS_Application_Startup(void)
+{
+   int              i;
+   int              j;
+   int32            status;
+   uint32           task_id;
+   char             name[OS_MAX_API_NAME];
+   OS_time_t        start_time;
+   OS_time_t        end_time;
+   uint32           elapsed;
+
+   status = OS_CountSemCreate(&done_sem_id, "DONE", 0, 0);
+   if ( status == OS_SUCCESS )
+   {
+      status = OS_CountSemCreate(&ready_sem_id, "READY", 0, 0);
+   }
+   if ( status == OS_SUCCESS )
+   {
+      status = OS_CountSemCreate(&start_sem_id, "START", 0, 0);
+   }
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error creating the semaphores: %d\n", (int)status);
+      return;
+   }
+
+   printf("%d tasks, %d take/give pairs each\n", NUMBER_OF_TASKS, ITERATIONS);
+
+   for ( i = 0; i < NUMBER_OF_OPTIONS; i++ )
+   {
+      sprintf(name, "MUTEX%d", i);
+      status = OS_MutSemCreate(&mutex_id, name, MutexOptions[i]);
+      if ( status != OS_SUCCESS )
+      {
+         printf("%-14s not available: %d\n", OptionNames[i], (int)status);
+         continue;
+      }
+
+      shared_counter = 0;
+
+      for ( j = 0; j < NUMBER_OF_TASKS; j++ )
+      {
+         sprintf(name, "BENCH%d_%d", i, j);
+         status = OS_TaskCreate(&task_id, name, bench_task, NULL, TASK_STACK_SIZE,
+                                TASK_PRIORITY, 0);
+         if ( status != OS_SUCCESS )
+         {
+            printf("Error creating task %s: %d\n", name, (int)status);
+            OS_CountSemGive(ready_sem_id);
+            OS_CountSemGive(done_sem_id);
+         }
+      }
+
+      /*
+      ** Wait for every task to be ready, then start the clock and let them go
+      */
+      for ( j = 0; j < NUMBER_OF_TASKS; j++ )
+      {
+         OS_CountSemTake(ready_sem_id);
+      }
+
+      OS_GetMonotonicTime(&start_time);
+
+      for ( j = 0; j < NUMBER_OF_TASKS; j++ )
+      {
+         OS_CountSemGive(start_sem_id);
+      }
+
+      for ( j = 0; j < NUMBER_OF_TASKS; j++ )
+      {
+         OS_CountSemTake(done_sem_id);
+      }
+
+      OS_GetMonotonicTime(&end_time);
+      elapsed = ((end_time.seconds - start_time.seconds) * 1000000) +
+                end_time.microsecs - start_time.microsecs;
+
+      printf("%-14s %8d us %6d ns per take/give, counter %s\n", OptionNames[i],
+             (int)elapsed,
+             (int)((elapsed * 1000.0) / (NUMBER_OF_TASKS * (double)ITERATIONS)),
+             shared_counter == NUMBER_OF_TASKS * ITERATIONS ? "OK" : "WRONG");
+
+      status = OS_MutSemDelete(mutex_id);
+      if ( status != OS_SUCCESS )
+      {
+         printf("Error deleting mutex %s: %d\n", OptionNames[i], (int)status);
+      }
+   }
+
+   OS_CountSemDelete(done_sem_id);
+   OS_CountSemDelete(ready_sem_id);
+   OS_CountSemDelete(start_sem_id);
+
+   printf("Hit control-c to end test on a desktop system.\n");
+}
@@ -65,6 +65,7 @@ void OS_Application_Startup(void)
 /* ********************************************** TASKS******************************* */
 int TestTasks(void)
 {
+    uint32 found_id;
     int status;
     int failTaskCreatecount = 0;
     int failTaskDeletecount = 0;
@@ -403,10 +404,10 @@ int TestTasks(void)
     if (status != PASS)
         failTaskCreatecount++;
 
-    status = OS_TaskGetIdByName(&task_0_id, "Task 0");
+    status = OS_TaskGetIdByName(&found_id, "Task 0");
     /* printf("Satus after Getting the id of \"Task 0\":%d,%d \n\n",status,task_0_id); */
-    /*first newly created task should have id == 0*/
-    if (status != PASS || task_0_id != 0)    
+    /* the id found should be the one the task was created with */
+    if (status != PASS || found_id != task_0_id)    
         failGetIdcount++;
     
     status = OS_TaskGetIdByName(&task_1_id, "Task 1");
@@ -414,14 +415,14 @@ int TestTasks(void)
     if (status == PASS)
         failGetIdcount++;
 
-    status = OS_TaskGetIdByName(&task_2_id, "Task 2");
+    status = OS_TaskGetIdByName(&found_id, "Task 2");
     /* printf("Satus after Getting the id of \"Task 2\":%d,%d \n\n",status,task_2_id);*/
-    if (status != PASS || task_2_id != 1)   
+    if (status != PASS || found_id != task_2_id)   
         failGetIdcount++;
     
-    status = OS_TaskGetIdByName(&task_3_id, "Task 3");
+    status = OS_TaskGetIdByName(&found_id, "Task 3");
     /* printf("Satus after Getting the id of \"Task 3\":%d,%d \n\n",status,task_3_id); */
-    if (status != PASS || task_3_id != 2)    
+    if (status != PASS || found_id != task_3_id)    
         failGetIdcount++;
 
     if (OS_TaskDelete(task_0_id) != PASS)
@@ -457,6 +458,7 @@ int TestTasks(void)
 
 int TestQueues(void)
 {
+    uint32 found_id;
     int status;
     int failQCreatecount = 0;
     int failQDeletecount = 0;
@@ -608,20 +610,20 @@ int TestQueues(void)
 * Now that the Queues are created, its time to see if we can find
 * the propper ID by the name of the queue;
 */
-    status = OS_QueueGetIdByName(&msgq_0,"q 0");
-    if (status != PASS || msgq_0 != 0)
+    status = OS_QueueGetIdByName(&found_id,"q 0");
+    if (status != PASS || found_id != msgq_0)
         failQGetIdcount++;
 
     status = OS_QueueGetIdByName(&msgq_1,"q 1");
     if (status == PASS)
         failQGetIdcount++;
 
-    status = OS_QueueGetIdByName(&msgq_2,"q 2");
-    if (status != PASS || msgq_2 != 1)
+    status = OS_QueueGetIdByName(&found_id,"q 2");
+    if (status != PASS || found_id != msgq_2)
         failQGetIdcount++;
 
-    status = OS_QueueGetIdByName(&msgq_3,"q 3");
-    if (status != PASS || msgq_3 != 2)
+    status = OS_QueueGetIdByName(&found_id,"q 3");
+    if (status != PASS || found_id != msgq_3)
         failQGetIdcount++;
 
     /* Time to Delete the Queues we just created */
@@ -661,6 +663,7 @@ int TestQueues(void)
 /* *************************************************************************** */
 int TestBinaries(void)
 {
+    uint32 found_id;
     int failBinCreatecount = 0;
     int failBinDeletecount = 0;
     int failBinGetIdcount = 0;
@@ -806,9 +809,9 @@ int TestBinaries(void)
 
 
     
-    status = OS_BinSemGetIdByName(&bin_0,"Bin 0");
+    status = OS_BinSemGetIdByName(&found_id,"Bin 0");
       /* printf("Status after GETID: %d,%d\n",status,bin_0); */
-    if (status != OS_SUCCESS || bin_0 != 0)
+    if (status != OS_SUCCESS || found_id != bin_0)
         failBinGetIdcount++;
     
     status = OS_BinSemGetIdByName(&bin_1,"Bin 1");
@@ -817,15 +820,15 @@ int TestBinaries(void)
     if (status == OS_SUCCESS)
         failBinGetIdcount++;
     
-    status = OS_BinSemGetIdByName(&bin_2,"Bin 2");
+    status = OS_BinSemGetIdByName(&found_id,"Bin 2");
     /* printf("Status after GETID: %d,%d\n",status,bin_2); */ 
 
-    if (status != OS_SUCCESS || bin_2 != 1)
+    if (status != OS_SUCCESS || found_id != bin_2)
         failBinGetIdcount++;
     
-    status = OS_BinSemGetIdByName(&bin_3,"Bin 3");
+    status = OS_BinSemGetIdByName(&found_id,"Bin 3");
      /* printf("Status after GETID: %d,%d\n",status,bin_3); */
-    if (status != OS_SUCCESS || bin_3 != 2)
+    if (status != OS_SUCCESS || found_id != bin_3)
         failBinGetIdcount++;
      
     status = OS_BinSemDelete(bin_0);
@@ -859,6 +862,7 @@ int TestBinaries(void)
 /* ************************************************************************************ */
 int TestMutexes(void)
 {
+    uint32 found_id;
     int failMutCreatecount = 0;
     int failMutDeletecount = 0;
     int failMutGetIdcount = 0;
@@ -1001,20 +1005,20 @@ int TestMutexes(void)
     if (status != OS_SUCCESS)
         failMutCreatecount++;
 
-    status = OS_MutSemGetIdByName(&mut_0,"Mut 0");
-    if (status != OS_SUCCESS || mut_0 != 0)
+    status = OS_MutSemGetIdByName(&found_id,"Mut 0");
+    if (status != OS_SUCCESS || found_id != mut_0)
         failMutGetIdcount++;
     
     status = OS_MutSemGetIdByName(&mut_1,"Mut 1");
     if (status == OS_SUCCESS)
         failMutGetIdcount++;
     
-    status = OS_MutSemGetIdByName(&mut_2,"Mut 2");
-    if (status != OS_SUCCESS || mut_2 != 1)
+    status = OS_MutSemGetIdByName(&found_id,"Mut 2");
+    if (status != OS_SUCCESS || found_id != mut_2)
         failMutGetIdcount++;
     
-    status = OS_MutSemGetIdByName(&mut_3,"Mut 3");
-    if (status != OS_SUCCESS || mut_3 != 2)
+    status = OS_MutSemGetIdByName(&found_id,"Mut 3");
+    if (status != OS_SUCCESS || found_id != mut_3)
         failMutGetIdcount++;
     
     status = OS_MutSemDelete(mut_0);
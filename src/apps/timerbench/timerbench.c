@@ -0,0 +1,452 @@
+/*
+** timerbench.c
+**
+** This program is an OSAL sample that measures the jitter of the OSAL timers.
+** For each timer period and load, a periodic timer records the CLOCK_MONOTONIC
+** time each of its callbacks starts at, and the lateness against the ideal
+** expiration time is reported as min, mean, 99th and 99.9th percentile and max
+** jitter, along with the expirations that got no callback of their own.
+**
+** The runs are set up with environment variables, since the BSP passes no
+** command line to the application:
+**
+**   TIMERBENCH_PERIODS    timer periods in microseconds, comma separated
+**                         (default 1000,10000,100000)
+**   TIMERBENCH_LOADS      loads to run each period under, comma separated, from
+**                         none, cpu, queue and file (default all of them)
+**   TIMERBENCH_SECONDS    length of one run (default 5)
+**   TIMERBENCH_PRIORITY   priority of the timer callbacks (default 20)
+**   TIMERBENCH_CPU_TASKS  number of busy tasks of the cpu load (default 4)
+**   TIMERBENCH_LABEL      a name for the timer backend or kernel config under
+**                         test, copied to every result line (default osal)
+**
+** Each run prints one comma separated line after the header line, so the
+** output can be collected and compared across backends and kernel configs.
+** The program exits when the last run is done.
+**
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "osapi.h"
+
+#define MAX_PERIODS        16
+#define MAX_SAMPLES        200000
+#define MAX_CPU_TASKS      16
+#define QUEUE_TASKS        2
+#define QUEUE_DEPTH        10     /* the default mqueue msg_max on Linux */
+#define QUEUE_MSG_SIZE     64
+#define FILE_CHUNK_SIZE    65536
+#define FILE_CHUNKS        16
+#define LOAD_STACK_SIZE    16384
+#define LOAD_PRIORITY      100
+
+#define LOAD_NONE          0
+#define LOAD_CPU           1
+#define LOAD_QUEUE         2
+#define LOAD_FILE          3
+#define NUMBER_OF_LOADS    4
+
+char   LoadNames[NUMBER_OF_LOADS][8] = { "none", "cpu", "queue", "file" };
+
+/*
+** The samples of the current run, written by the timer callback
+*/
+long long samples[MAX_SAMPLES];
+uint32    sample_count;
+uint32    missed_count;
+uint64    next_index;
+volatile uint64 start_ns;
+uint64    period_ns;
+
+/*
+** The load tasks run while load_running is set, and give the done semaphore
+** when they stop
+*/
+volatile int load_running;
+uint32       load_tasks;
+uint32       done_sem_id;
+uint32       queue_id;
+char         file_chunk[FILE_CHUNK_SIZE];
+
+uint32 cpu_tasks = 4;
+
+uint64 now_ns(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return((uint64) now.tv_sec * 1000000000ULL + (uint64) now.tv_nsec);
+}
+
+/*
+** The timer callback. Expiration n of the timer is due at start_ns plus
+** (n + 1) periods, and the overruns say how many expirations this callback
+** stands for beyond its own. An expiration before start_ns is set gives no
+** sample.
+*/
+void bench_callback(uint32 timer_id, uint32 overruns, void *arg)
+{
+   uint64 now = now_ns();
+
+   next_index   += overruns;
+   missed_count += overruns;
+
+   if ( start_ns != 0 && sample_count < MAX_SAMPLES )
+   {
+      samples[sample_count++] = (long long) (now - (start_ns + (next_index + 1) * period_ns));
+   }
+
+   next_index++;
+}
+
+/*
+** The cpu load: spin until the run is over
+*/
+void cpu_load_task(void)
+{
+   volatile uint32 spin = 0;
+
+   while ( load_running )
+   {
+      spin++;
+   }
+
+   OS_CountSemGive(done_sem_id);
+   OS_TaskExit();
+}
+
+/*
+** The queue load: producers and consumers passing messages through one
+** queue as fast as they can
+*/
+void queue_producer_task(void)
+{
+   char   message[QUEUE_MSG_SIZE];
+
+   memset(message, 0x5A, sizeof(message));
+
+   while ( load_running )
+   {
+      if ( OS_QueuePut(queue_id, message, sizeof(message), 0) == OS_QUEUE_FULL )
+      {
+         OS_TaskDelay(1);
+      }
+   }
+
+   OS_CountSemGive(done_sem_id);
+   OS_TaskExit();
+}
+
+void queue_consumer_task(void)
+{
+   char   message[QUEUE_MSG_SIZE];
+   uint32 size_copied;
+
+   while ( load_running )
+   {
+      OS_QueueGet(queue_id, message, sizeof(message), &size_copied, 100);
+   }
+
+   OS_CountSemGive(done_sem_id);
+   OS_TaskExit();
+}
+
+/*
+** The file load: write, close and remove a file over and over
+*/
+void file_load_task(void)
+{
+   int32  fd;
+   uint32 i;
+
+   memset(file_chunk, 0xA5, sizeof(file_chunk));
+
+   while ( load_running )
+   {
+      fd = OS_creat("/drive0/timerbench.dat", OS_READ_WRITE);
+      if ( fd < 0 )
+      {
+         printf("Error creating the load file: %d\n", (int)fd);
+         break;
+      }
+
+      for ( i = 0; i < FILE_CHUNKS && load_running; i++ )
+      {
+         OS_write(fd, file_chunk, sizeof(file_chunk));
+      }
+
+      OS_close(fd);
+      OS_remove("/drive0/timerbench.dat");
+   }
+
+   OS_CountSemGive(done_sem_id);
+   OS_TaskExit();
+}
+
+/*
+** Start the tasks of a load
+*/
+void start_load_task(const char *kind, uint32 index, void (*entry)(void))
+{
+   char   name[OS_MAX_API_NAME];
+   uint32 task_id;
+   int32  status;
+
+   sprintf(name, "%s%d", kind, (int)index);
+   status = OS_TaskCreate(&task_id, name, entry, NULL, LOAD_STACK_SIZE, LOAD_PRIORITY, 0);
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error creating load task %s: %d\n", name, (int)status);
+      return;
+   }
+
+   load_tasks++;
+}
+
+void start_load(int load)
+{
+   uint32 i;
+   int32  status;
+
+   load_tasks   = 0;
+   load_running = TRUE;
+
+   switch ( load )
+   {
+      case LOAD_CPU:
+         for ( i = 0; i < cpu_tasks; i++ )
+         {
+            start_load_task("CPULOAD", i, cpu_load_task);
+         }
+         break;
+
+      case LOAD_QUEUE:
+         status = OS_QueueCreate(&queue_id, "BENCHQ", QUEUE_DEPTH, QUEUE_MSG_SIZE, 0);
+         if ( status != OS_SUCCESS )
+         {
+            printf("Error creating the load queue: %d\n", (int)status);
+            return;
+         }
+         for ( i = 0; i < QUEUE_TASKS; i++ )
+         {
+            start_load_task("QPUT", i, queue_producer_task);
+            start_load_task("QGET", i, queue_consumer_task);
+         }
+         break;
+
+      case LOAD_FILE:
+         start_load_task("FILELOAD", 0, file_load_task);
+         break;
+
+      default:
+         break;
+   }
+}
+
+void stop_load(int load)
+{
+   uint32 i;
+
+   load_running = FALSE;
+
+   for ( i = 0; i < load_tasks; i++ )
+   {
+      OS_CountSemTake(done_sem_id);
+   }
+
+   if ( load == LOAD_QUEUE )
+   {
+      OS_QueueDelete(queue_id);
+   }
+}
+
+int compare_samples(const void *a, const void *b)
+{
+   long long x = *(const long long *) a;
+   long long y = *(const long long *) b;
+
+   return (x > y) - (x < y);
+}
+
+/*
+** Returns the usecs of the sample at a fraction of the sorted samples
+*/
+double percentile(double fraction)
+{
+   uint32 index = (uint32) (fraction * (sample_count - 1) + 0.5);
+
+   return samples[index] / 1000.0;
+}
+
+/*
+** Run one timer period under one load and print its result line
+*/
+void run_bench(uint32 period_usecs, int load, uint32 seconds, uint32 priority,
+               const char *label)
+{
+   uint32           timer_id;
+   uint32           accuracy;
+   OS_timer_stats_t stats;
+   int32            status;
+   long long        sum = 0;
+   uint32           i;
+
+   sample_count = 0;
+   missed_count = 0;
+   next_index   = 0;
+   period_ns    = (uint64) period_usecs * 1000;
+
+   start_load(load);
+
+   status = OS_TimerCreateEx(&timer_id, "BENCHTIMER", &accuracy, bench_callback, NULL, priority);
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error creating the bench timer: %d\n", (int)status);
+      stop_load(load);
+      return;
+   }
+
+   /*
+   ** OS_TimerSet arms the timer from its own clock read, so the reference is
+   ** taken right after it returns rather than before the arming overhead
+   */
+   start_ns = 0;
+   status = OS_TimerSet(timer_id, period_usecs, period_usecs);
+   start_ns = now_ns();
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error setting the bench timer: %d\n", (int)status);
+      OS_TimerDelete(timer_id);
+      stop_load(load);
+      return;
+   }
+
+   OS_TaskDelay(seconds * 1000);
+
+   OS_TimerSet(timer_id, 0, 0);
+   OS_TimerGetStats(timer_id, &stats);
+   OS_TimerDelete(timer_id);
+
+   stop_load(load);
+
+   if ( sample_count == 0 )
+   {
+      printf("%s,%s,%d,%d,0,%d,,,,,,\n", label, LoadNames[load], (int)period_usecs,
+             (int)priority, (int)missed_count);
+      return;
+   }
+
+   qsort(samples, sample_count, sizeof(samples[0]), compare_samples);
+   for ( i = 0; i < sample_count; i++ )
+   {
+      sum += samples[i];
+   }
+
+   printf("%s,%s,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%d\n", label, LoadNames[load],
+          (int)period_usecs, (int)priority, (int)sample_count, (int)missed_count,
+          samples[0] / 1000.0, (double) sum / sample_count / 1000.0,
+          percentile(0.99), percentile(0.999), samples[sample_count - 1] / 1000.0,
+          (int)stats.max_runtime_usecs);
+}
+
+/*
+** Returns the value of an environment variable, or a default
+*/
+const char *bench_setting(const char *name, const char *default_value)
+{
+   const char *value = getenv(name);
+
+   return (value != NULL && value[0] != '\0') ? value : default_value;
+}
+
+/* ********************** MAIN **************************** */
+
+void OS_Application_Startup(void)
+{
+   uint32      periods[MAX_PERIODS];
+   uint32      number_of_periods = 0;
+   int         loads[NUMBER_OF_LOADS];
+   int         number_of_loads = 0;
+   uint32      seconds;
+   uint32      priority;
+   const char *label;
+   char        list[256];
+   char       *item;
+   int32       status;
+   uint32      i;
+   int         j;
+
+   strncpy(list, bench_setting("TIMERBENCH_PERIODS", "1000,10000,100000"), sizeof(list) - 1);
+   list[sizeof(list) - 1] = '\0';
+   for ( item = strtok(list, ","); item != NULL && number_of_periods < MAX_PERIODS;
+         item = strtok(NULL, ",") )
+   {
+      if ( atol(item) > 0 )
+      {
+         periods[number_of_periods++] = (uint32) atol(item);
+      }
+   }
+
+   strncpy(list, bench_setting("TIMERBENCH_LOADS", "none,cpu,queue,file"), sizeof(list) - 1);
+   list[sizeof(list) - 1] = '\0';
+   for ( item = strtok(list, ","); item != NULL && number_of_loads < NUMBER_OF_LOADS;
+         item = strtok(NULL, ",") )
+   {
+      for ( j = 0; j < NUMBER_OF_LOADS; j++ )
+      {
+         if ( strcmp(item, LoadNames[j]) == 0 )
+         {
+            loads[number_of_loads++] = j;
+         }
+      }
+   }
+
+   seconds   = (uint32) atol(bench_setting("TIMERBENCH_SECONDS", "5"));
+   priority  = (uint32) atol(bench_setting("TIMERBENCH_PRIORITY", "20"));
+   cpu_tasks = (uint32) atol(bench_setting("TIMERBENCH_CPU_TASKS", "4"));
+   label     = bench_setting("TIMERBENCH_LABEL", "osal");
+
+   if ( cpu_tasks > MAX_CPU_TASKS )
+   {
+      cpu_tasks = MAX_CPU_TASKS;
+   }
+
+   status = OS_CountSemCreate(&done_sem_id, "DONE", 0, 0);
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error creating the done semaphore: %d\n", (int)status);
+      return;
+   }
+
+   /*
+   ** The file load writes to a RAM disk of its own
+   */
+   status = OS_mkfs(0, "/ramdev0", "RAM", 512, 200);
+   if ( status == OS_SUCCESS )
+   {
+      status = OS_mount("/ramdev0", "/drive0");
+   }
+   if ( status != OS_SUCCESS )
+   {
+      printf("Error setting up the file load disk: %d\n", (int)status);
+   }
+
+   printf("label,load,period_us,priority,samples,missed,min_us,mean_us,p99_us,p999_us,max_us,max_runtime_us\n");
+
+   for ( i = 0; i < number_of_periods; i++ )
+   {
+      for ( j = 0; j < number_of_loads; j++ )
+      {
+         run_bench(periods[i], loads[j], seconds, priority, label);
+      }
+   }
+
+   OS_CountSemDelete(done_sem_id);
+
+   exit(0);
+}
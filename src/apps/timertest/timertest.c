@@ -68,14 +68,12 @@ void OS_Application_Startup(void)
    /*
    ** Let the main thread sleep 
    */     
-   printf("Starting Delay loop. Linux/OSX/Cygwin will be faster, because sleep call is interrupted by timer\n");
+   printf("Starting Delay loop.\n");
    for (i = 0 ; i < 15; i++ )
    {
       /* 
-      ** Even though this sleep call is for 1 second,
-      ** the sigalarm timer for the 1hz will keep waking
-      ** it up. Keep that in mind when setting the timer down
-      ** to something very small.
+      ** The timer callbacks run in the timer dispatch tasks,
+      ** so this sleep is not cut short by the timers.
       */
       sleep(1);
    }
@@ -43,10 +43,52 @@
 **  External Declarations
 */
 void OS_Application_Startup(void);
+void OS_BSPTimebaseInit(void);
                                                                            
 /*
 ** Global variables
 */
+
+#ifdef OS_BSP_ISOLATED_CPUS
+/******************************************************************************
+**  Function:  BSP_SetAffinityPolicy()
+**
+**  Purpose:
+**    Keeps the isolated cores for the tasks with an OSAL priority up to
+**    OS_BSP_ISOLATED_PRIORITY, and runs every other task on the other cores.
+**
+**  Arguments:
+**    (none)
+**
+**  Return:
+**    (none)
+*/
+static void BSP_SetAffinityPolicy(void)
+{
+   OS_task_affinity_band_t bands[2];
+   long                    cpus;
+   uint32                  all_cpus;
+   int32                   status;
+
+   cpus = sysconf(_SC_NPROCESSORS_CONF);
+   all_cpus = (cpus >= 32) ? 0xFFFFFFFF : (uint32) ((1UL << cpus) - 1);
+
+   bands[0].min_priority = 0;
+   bands[0].max_priority = OS_BSP_ISOLATED_PRIORITY;
+   bands[0].cpu_mask     = OS_BSP_ISOLATED_CPUS;
+
+   bands[1].min_priority = OS_BSP_ISOLATED_PRIORITY + 1;
+   bands[1].max_priority = 255;
+   bands[1].cpu_mask     = all_cpus & ~(uint32) OS_BSP_ISOLATED_CPUS;
+
+   status = OS_TaskSetAffinityPolicy(bands, 2);
+   if ( status != OS_SUCCESS )
+   {
+      printf("Task affinity policy not set, isolated cores 0x%lx: %d\n",
+             (unsigned long) OS_BSP_ISOLATED_CPUS, (int) status);
+   }
+}
+#endif
                                                                                                                                                                
                                                                                                                                                 
 /******************************************************************************
@@ -83,6 +125,18 @@ int main(void)
    ** Initialize the OS API data structures
    */
    OS_API_Init();
+
+   /*
+   ** Calibrate the timebase
+   */
+   OS_BSPTimebaseInit();
+
+#ifdef OS_BSP_ISOLATED_CPUS
+   /*
+   ** Set the cores the tasks run on before any task is created
+   */
+   BSP_SetAffinityPolicy();
+#endif
      
    /*
    ** Call application specific entry point.
@@ -14,6 +14,12 @@
 **   The functions here allow the app to interface functions that are board and OS specific
 **   and usually dont fit well in the OS abstraction layer.
 **
+**   The timebase is the CPU counter that user space can read directly: the TSC on x86,
+**   and the generic timer virtual counter on ARMv7 and ARMv8. Its rate is calibrated
+**   against CLOCK_MONOTONIC_RAW when the BSP starts. A TSC that does not run at a
+**   constant rate, or a counter the kernel does not let user space read, is not used,
+**   and the timebase falls back to the monotonic time in nanoseconds.
+**
 ** History:
 **
 *************************************************************************************************/
@@ -34,6 +40,15 @@
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <time.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 /*
 ** Types and prototypes for this module
@@ -42,15 +57,259 @@
 
 /******************* Macro Definitions ***********************/
 
-#define OS_BSP_TIMER_TICKS_PER_SECOND       1000000     /* Resolution of the least significant 32 bits of the 64 bit
-                                                           time stamp returned by OS_BSPGet_Timebase in timer ticks per second.
-                                                           The timer resolution for accuracy should not be any slower than 1000000
-                                                           ticks per second or 1 us per tick */
-#define OS_BSP_TIMER_LOW32_ROLLOVER         1000000     /* The number that the least significant 32 bits of the 64 bit
+#define OS_BSP_TIMER_FALLBACK_TICKS         1000000000  /* Ticks per second of the fallback timebase, the
+                                                           monotonic time in nanoseconds */
+#define OS_BSP_TIMER_LOW32_ROLLOVER         0           /* The number that the least significant 32 bits of the 64 bit
                                                            time stamp returned by OS_BSPGet_Timebase rolls over.  If the lower 32
                                                            bits rolls at 1 second, then the OS_BSP_TIMER_LOW32_ROLLOVER will be 1000000.
                                                            if the lower 32 bits rolls at its maximum value (2^32) then
                                                            OS_BSP_TIMER_LOW32_ROLLOVER will be 0. */
+#define OS_BSP_TIMER_CALIBRATE_NSECS        50000000    /* How long the counter is calibrated for */
+
+#if defined(__i386__) || defined(__x86_64__) || defined(__aarch64__) || \
+    (defined(__arm__) && defined(__ARM_ARCH_7A__))
+#define OS_BSP_TIMER_HAVE_COUNTER
+#endif
+
+/******************* Global Data ***********************/
+
+/*
+** The timebase reads the counter while OS_BSP_timer_counter is set. The counter
+** is shifted right by OS_BSP_timer_shift, so its ticks per second fit in 32 bits.
+*/
+static uint32           OS_BSP_timer_ticks_per_second = OS_BSP_TIMER_FALLBACK_TICKS;
+
+#ifdef OS_BSP_TIMER_HAVE_COUNTER
+static int              OS_BSP_timer_counter = FALSE;
+static uint32           OS_BSP_timer_shift   = 0;
+static sigjmp_buf       OS_BSP_timer_probe_env;
+#endif
+
+#ifdef OS_BSP_TIMER_HAVE_COUNTER
+/******************************************************************************
+**  Function:  OS_BSPTimerRawNs()
+**
+**  Purpose:
+**    Returns CLOCK_MONOTONIC_RAW in nanoseconds, for the calibration
+*/
+static uint64 OS_BSPTimerRawNs(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC_RAW, &now);
+
+   return((uint64) now.tv_sec * 1000000000ULL + (uint64) now.tv_nsec);
+}
+
+/******************************************************************************
+**  Function:  OS_BSPTimerReadCounter()
+**
+**  Purpose:
+**    Reads the CPU counter. The reads are ordered after the instructions
+**    before them, so a time stamp does not move ahead of the code it marks.
+*/
+static inline uint64 OS_BSPTimerReadCounter(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+   uint32 low;
+   uint32 high;
+
+   __asm__ __volatile__ ("lfence\n\trdtsc" : "=a" (low), "=d" (high) : : "memory");
+
+   return(((uint64) high << 32) | low);
+#elif defined(__aarch64__)
+   uint64 count;
+
+   __asm__ __volatile__ ("isb\n\tmrs %0, cntvct_el0" : "=r" (count) : : "memory");
+
+   return(count);
+#else
+   uint64 count;
+
+   __asm__ __volatile__ ("isb\n\tmrrc p15, 1, %Q0, %R0, c14" : "=r" (count) : : "memory");
+
+   return(count);
+#endif
+}
+
+/******************************************************************************
+**  Function:  OS_BSPTimerCounterRate()
+**
+**  Purpose:
+**    Returns the rate the architecture gives for the counter in ticks per
+**    second, 0 if the counter cannot be used. x86 gives no rate for the TSC,
+**    so there it returns 1 if the TSC runs at a constant rate in every power
+**    state and 0 if not.
+*/
+static uint64 OS_BSPTimerCounterRate(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+   unsigned int eax, ebx, ecx, edx;
+
+   /* the invariant TSC bit */
+   if ( __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 || (edx & (1 << 8)) == 0 )
+   {
+      return(0);
+   }
+
+   return(1);
+#elif defined(__aarch64__)
+   uint64 frequency;
+
+   __asm__ __volatile__ ("mrs %0, cntfrq_el0" : "=r" (frequency));
+
+   return(frequency);
+#else
+   uint32 frequency;
+
+   __asm__ __volatile__ ("mrc p15, 0, %0, c14, c0, 0" : "=r" (frequency));
+
+   return(frequency);
+#endif
+}
+
+/******************************************************************************
+**  Function:  OS_BSPTimerProbeHandler()
+**
+**  Purpose:
+**    Catches the fault of a counter read the kernel does not allow
+*/
+static void OS_BSPTimerProbeHandler(int signal)
+{
+   siglongjmp(OS_BSP_timer_probe_env, 1);
+}
+
+/******************************************************************************
+**  Function:  OS_BSPTimerProbe()
+**
+**  Purpose:
+**    Checks that the counter can be read from user space and returns the rate
+**    the architecture gives for it, 0 if it cannot be used
+*/
+static uint64 OS_BSPTimerProbe(void)
+{
+   struct sigaction          probe;
+   struct sigaction          old_ill;
+   struct sigaction          old_segv;
+   volatile uint64           rate = 0;
+
+   memset(&probe, 0, sizeof(probe));
+   probe.sa_handler = OS_BSPTimerProbeHandler;
+   sigemptyset(&probe.sa_mask);
+
+   sigaction(SIGILL, &probe, &old_ill);
+   sigaction(SIGSEGV, &probe, &old_segv);
+
+   if ( sigsetjmp(OS_BSP_timer_probe_env, 1) == 0 )
+   {
+      rate = OS_BSPTimerCounterRate();
+      if ( rate != 0 )
+      {
+         OS_BSPTimerReadCounter();
+      }
+   }
+   else
+   {
+      rate = 0;
+   }
+
+   sigaction(SIGILL, &old_ill, NULL);
+   sigaction(SIGSEGV, &old_segv, NULL);
+
+   return(rate);
+}
+
+/******************************************************************************
+**  Function:  OS_BSPTimerCalibrate()
+**
+**  Purpose:
+**    Measures the counter rate in ticks per second against CLOCK_MONOTONIC_RAW,
+**    which is not slewed by NTP. Each counter read is taken between two clock
+**    reads and matched with their midpoint.
+*/
+static uint64 OS_BSPTimerCalibrate(void)
+{
+   struct timespec pause;
+   uint64          start_ns;
+   uint64          end_ns;
+   uint64          start_count;
+   uint64          end_count;
+   uint64          before;
+
+   before      = OS_BSPTimerRawNs();
+   start_count = OS_BSPTimerReadCounter();
+   start_ns    = OS_BSPTimerRawNs();
+   start_ns    = before + (start_ns - before) / 2;
+
+   pause.tv_sec  = 0;
+   pause.tv_nsec = OS_BSP_TIMER_CALIBRATE_NSECS;
+   while ( nanosleep(&pause, &pause) != 0 )
+   {
+   }
+
+   before    = OS_BSPTimerRawNs();
+   end_count = OS_BSPTimerReadCounter();
+   end_ns    = OS_BSPTimerRawNs();
+   end_ns    = before + (end_ns - before) / 2;
+
+   if ( end_count <= start_count || end_ns <= start_ns )
+   {
+      return(0);
+   }
+
+   return((uint64) ((double) (end_count - start_count) * 1e9 / (double) (end_ns - start_ns) + 0.5));
+}
+#endif
+
+/******************************************************************************
+**  Function:  OS_BSPTimebaseInit()
+**
+**  Purpose:
+**    Picks the timebase and calibrates it. Called by main before the
+**    application starts. Until then the timebase is the fallback.
+**
+**  Arguments:
+**
+**  Return:
+*/
+void OS_BSPTimebaseInit(void)
+{
+#ifdef OS_BSP_TIMER_HAVE_COUNTER
+   uint64 rate;
+   uint64 measured;
+   uint32 shift = 0;
+
+   rate = OS_BSPTimerProbe();
+   if ( rate != 0 )
+   {
+      measured = OS_BSPTimerCalibrate();
+
+      /*
+      ** The TSC has no architectural rate. The generic timer has one in
+      ** CNTFRQ, which is kept unless firmware set it wrong by more than 1%.
+      */
+      if ( rate == 1 || measured / 100 < (rate > measured ? rate - measured : measured - rate) )
+      {
+         rate = measured;
+      }
+
+      if ( rate != 0 )
+      {
+         while ( (rate >> shift) > 0xFFFFFFFFULL )
+         {
+            shift++;
+         }
+
+         OS_BSP_timer_shift            = shift;
+         OS_BSP_timer_ticks_per_second = (uint32) (rate >> shift);
+         OS_BSP_timer_counter          = TRUE;
+         return;
+      }
+   }
+#endif
+
+   printf("Timebase: no usable CPU counter, using CLOCK_MONOTONIC\n");
+}
 
 /******************************************************************************
 **  Function:  OS_BSPGetTime()
@@ -87,8 +346,7 @@ void OS_BSPGetTime( OS_time_t *LocalTime)
 */
 uint32 OS_BSPGet_Timer_Tick(void)
 {
-   /* SUB -add function call code*/
-   return (0);
+   return ((uint32) sysconf(_SC_CLK_TCK));
 }
 
 /******************************************************************************
@@ -108,7 +366,7 @@ uint32 OS_BSPGet_Timer_Tick(void)
 */
 uint32 OS_BSPGetTimerTicksPerSecond(void)
 {
-    return(OS_BSP_TIMER_TICKS_PER_SECOND);
+    return(OS_BSP_timer_ticks_per_second);
 }
 
 /******************************************************************************
@@ -138,7 +396,9 @@ uint32 OS_BSPGetTimerLow32Rollover(void)
 **  Purpose:
 **    Provides a common interface to system timebase. This routine
 **    is in the BSP because it is sometimes implemented in hardware and
-**    sometimes taken care of by the RTOS.
+**    sometimes taken care of by the RTOS. Here the timebase is the CPU
+**    counter, or the OS_GetMonotonicTimeNs time if there is no usable
+**    counter, split into its upper and lower 32 bits.
 **
 **  Arguments:
 **
@@ -147,11 +407,21 @@ uint32 OS_BSPGetTimerLow32Rollover(void)
 */
 void OS_BSPGet_Timebase(uint32 *Tbu, uint32* Tbl)
 {
-   OS_time_t        time;
-
-   OS_GetLocalTime(&time);
-   *Tbu = time.seconds;
-   *Tbl = time.microsecs;
+   uint64           ticks;
+
+#ifdef OS_BSP_TIMER_HAVE_COUNTER
+   if ( OS_BSP_timer_counter )
+   {
+      ticks = OS_BSPTimerReadCounter() >> OS_BSP_timer_shift;
+   }
+   else
+#endif
+   {
+      OS_GetMonotonicTimeNs(&ticks);
+   }
+
+   *Tbu = (uint32) (ticks >> 32);
+   *Tbl = (uint32) (ticks & 0xFFFFFFFF);
 }
 
 /******************************************************************************
@@ -160,18 +430,23 @@ void OS_BSPGet_Timebase(uint32 *Tbu, uint32* Tbl)
 **  Purpose:
 **    Provides a common interface to decrementer counter. This routine
 **    is in the BSP because it is sometimes implemented in hardware and
-**    sometimes taken care of by the RTOS.
+**    sometimes taken care of by the RTOS. There is no decrementer here, so
+**    it counts down from 2^32 - 1 at the timebase rate and wraps.
 **
 **  Arguments:
 **
 **  Return:
-**  Timebase register value
+**  Decrementer value
 */
 
 uint32 OS_BSPGet_Dec(void)
 {
-   /* SUB -add function call code*/
-   return(0);
+   uint32 upper;
+   uint32 lower;
+
+   OS_BSPGet_Timebase(&upper, &lower);
+
+   return(0xFFFFFFFF - lower);
 }
 
 /**  Function:  OS_BSPWatchdogInit()
@@ -44,6 +44,54 @@
 /* #define for enabling floating point operations on a task*/
 #define OS_FP_ENABLED 1
 
+/*
+** #defines for the flags of OS_TaskCreate, selecting the scheduling policy of the task.
+** The OSAL priority only takes effect under OS_TASK_SCHED_FIFO or OS_TASK_SCHED_RR.
+*/
+#define OS_TASK_SCHED_OTHER  0x0010  /* time sharing, the priority is only recorded */
+#define OS_TASK_SCHED_FIFO   0x0020  /* real time, runs until it blocks or is preempted */
+#define OS_TASK_SCHED_RR     0x0040  /* real time, round robin among equal priorities */
+#define OS_TASK_SCHED_MASK   (OS_TASK_SCHED_OTHER | OS_TASK_SCHED_FIFO | OS_TASK_SCHED_RR)
+
+/*
+** OS_TaskCreate flag that pins the task to a set of cores, bit n of cpu_mask standing
+** for core n. Only cores 0 to 15 can be given this way, OS_TaskSetAffinity takes all 32.
+*/
+#define OS_TASK_AFFINITY(cpu_mask)   (((uint32)(cpu_mask) & 0xFFFF) << 16)
+#define OS_TASK_AFFINITY_MASK        0xFFFF0000
+
+/* #define for OS_QueueCreate, the queue carries loaned buffers by reference */
+#define OS_QUEUE_ZERO_COPY 0x0001
+
+/* #defines for the options of OS_MutSemCreate */
+#define OS_MUTEX_PRIO_INHERIT  0x0001  /* the owner inherits the priority of a waiting task */
+#define OS_MUTEX_ROBUST        0x0002  /* the next taker recovers a mutex left by a dead task */
+#define OS_MUTEX_ADAPTIVE      0x0004  /* spin briefly before blocking on a held mutex */
+#define OS_MUTEX_LIGHTWEIGHT   0x0008  /* OSAL mutex with a short spin, no other option allowed */
+
+/* #define for OS_RwLockCreate, readers wait while a writer waits */
+#define OS_RWLOCK_WRITER_PREFERENCE 0x0001
+
+/*
+** #defines for OS_EventFlagsWait. An event flag group holds 31 flags, bits 0 to 30.
+** A wait returns when any of the flags waited for is set, or with OS_EVENT_WAIT_ALL
+** when all of them are. OS_EVENT_WAIT_CLEAR clears the flags waited for as the wait
+** returns, so only one task sees each event.
+*/
+#define OS_EVENT_FLAGS_ALL     0x7FFFFFFF
+#define OS_EVENT_WAIT_ANY      0x0000
+#define OS_EVENT_WAIT_ALL      0x0001
+#define OS_EVENT_WAIT_CLEAR    0x0002
+
+/*
+** #defines for the object_type of an OS_wait_object_t
+*/
+#define OS_WAIT_QUEUE          1
+#define OS_WAIT_BINSEM         2
+#define OS_WAIT_COUNTSEM       3
+#define OS_WAIT_EVENTFLAGS     4
+#define OS_WAIT_TIMER          5
+
 /*  tables for the properties of objects */
 
 /*tasks */
@@ -52,9 +100,30 @@ typedef struct
     char name [OS_MAX_API_NAME];
     uint32 creator;
     uint32 stack_size;
+    uint32 stack_used;      /* most bytes of the stack ever used, 0 if not measured */
     uint32 priority;
     uint32 OStask_id;
+    uint32 sched_policy;    /* the OS_TASK_SCHED_ policy the task actually runs under */
+    uint32 affinity;        /* the cores the task may run on, 0 if it is not pinned */
+    uint32 period_usecs;    /* period set with OS_TaskSetPeriod, 0 if the task is not periodic */
+    uint32 deadline_usecs;  /* deadline from the start of each period */
+    uint32 periods;         /* periods completed */
+    uint32 overruns;        /* periods that ended after their deadline or were skipped */
+    uint32 max_jitter_usecs;/* latest wakeup after the start of a period */
+    uint32 avg_jitter_usecs;
 }OS_task_prop_t;
+
+/*
+** One priority band of the task affinity policy set with OS_TaskSetAffinityPolicy.
+** Tasks with a priority from min_priority to max_priority that were not pinned
+** explicitly run on the cores in cpu_mask.
+*/
+typedef struct
+{
+    uint32 min_priority;
+    uint32 max_priority;
+    uint32 cpu_mask;
+}OS_task_affinity_band_t;
     
 /* queues */
 typedef struct
@@ -86,6 +155,134 @@ typedef struct
     uint32 creator;
 }OS_mut_sem_prop_t;
 
+/* Reader-writer locks */
+typedef struct
+{
+    char name [OS_MAX_API_NAME];
+    uint32 creator;
+    uint32 options;
+    uint32 readers;         /* read takes held */
+    uint32 writer;          /* TRUE if a task holds it for writing */
+    uint32 read_waiters;
+    uint32 write_waiters;
+}OS_rwlock_prop_t;
+
+/* Event flag groups */
+typedef struct
+{
+    char name [OS_MAX_API_NAME];
+    uint32 creator;
+    uint32 flags;
+    uint32 waiters;     /* tasks blocked in OS_EventFlagsWait */
+    uint32 waits;       /* calls to OS_EventFlagsWait */
+    uint32 blocked;     /* waits that had to block */
+    uint32 timeouts;
+    uint32 wakeups;     /* sets that woke blocked tasks */
+}OS_event_flags_prop_t;
+
+/* Sequence locks */
+typedef struct
+{
+    char name [OS_MAX_API_NAME];
+    uint32 creator;
+    uint32 size;        /* size of the record */
+    uint32 version;     /* writes since the lock was created */
+}OS_seqlock_prop_t;
+
+/*
+** Publications. The release function of a publication is called with each
+** version of the data once no task can be reading it any more.
+*/
+typedef void (*OS_publish_release_t)(void *data);
+
+typedef struct
+{
+    char name [OS_MAX_API_NAME];
+    uint32 creator;
+    uint32 version;     /* updates since the publication was created */
+    uint32 retired;     /* old versions still waiting for their readers */
+}OS_publish_prop_t;
+
+/*
+** An object for OS_WaitMultiple. The wait takes one event from the object that
+** fires: a message from a queue, copied to data, a token from a semaphore, the
+** flags of an event flag group, with options as for OS_EventFlagsWait, or the
+** expirations of a timer since they were last taken. result is the size of the
+** message, the flags that were set when the wait was met, or the number of
+** timer expirations after the first one, its overruns.
+*/
+typedef struct
+{
+    uint32 object_type;
+    uint32 object_id;
+    uint32 flags;       /* event flags to wait for */
+    uint32 options;     /* OS_EVENT_WAIT_* options */
+    void  *data;        /* buffer for a queue message */
+    uint32 size;        /* size of data */
+    uint32 result;
+}OS_wait_object_t;
+
+
+/*
+** Lock statistics, returned by OS_MutSemGetStats, OS_BinSemGetStats,
+** OS_CountSemGetStats and OS_RwLockGetStats when OS_INCLUDE_LOCK_STATS is
+** defined in osconfig.h. Times are in microseconds. Bucket 0 of a histogram
+** counts times under 1 microsecond, bucket n counts times from 2^(n-1) up to
+** 2^n microseconds and the last bucket also counts everything longer. Hold
+** times are only kept for mutexes, binary semaphores and the writers of
+** reader-writer locks.
+*/
+#define OS_LOCK_STATS_BUCKETS 16
+
+typedef struct
+{
+    uint32 acquisitions;
+    uint32 contended;
+    uint32 owner;
+    uint32 last_waiter;
+    uint32 max_wait_usecs;
+    uint32 max_hold_usecs;
+    uint32 wait_histogram [OS_LOCK_STATS_BUCKETS];
+    uint32 hold_histogram [OS_LOCK_STATS_BUCKETS];
+}OS_lock_stats_t;
+
+/*
+** Task statistics, returned by OS_TaskGetStats. cpu_usecs is the CPU time the
+** task has used. A wakeup is the end of a sleep in OS_TaskDelay,
+** OS_TaskDelayUntil or OS_TaskWaitPeriod, or of a wait for a binary or
+** counting semaphore. Its latency is the time from the end of the sleep, or
+** from the give that released the task, until the task ran. The histogram
+** buckets are those of the lock statistics. last_cpu is the core the task
+** ran on last.
+*/
+#define OS_TASK_STATS_BUCKETS 16
+
+typedef struct
+{
+    uint64 cpu_usecs;
+    uint32 voluntary_switches;
+    uint32 involuntary_switches;
+    uint32 last_cpu;
+    uint32 wakeups;
+    uint32 max_wakeup_usecs;
+    uint32 wakeup_histogram [OS_TASK_STATS_BUCKETS];
+}OS_task_stats_t;
+
+/*
+** System load, returned by OS_GetSystemLoad. The busy percentages are for the
+** time since the previous call, or since boot on the first call. Only the
+** first OS_SYSTEM_LOAD_CPUS cores are reported one by one. load_average holds
+** the 1, 5 and 15 minute load averages times 100.
+*/
+#define OS_SYSTEM_LOAD_CPUS 16
+
+typedef struct
+{
+    uint32 num_cpus;
+    uint32 busy_percent;
+    uint32 cpu_busy_percent [OS_SYSTEM_LOAD_CPUS];
+    uint32 load_average [3];
+}OS_system_load_t;
 
 /* struct for OS_GetLocalTime() */
 
@@ -139,11 +336,18 @@ int32 OS_TaskDelete            (uint32 task_id);
 void OS_TaskExit               (void);
 int32 OS_TaskInstallDeleteHandler(void *function_pointer);
 int32 OS_TaskDelay             (uint32 millisecond);
+int32 OS_TaskDelayUntil        (const OS_time_t *wakeup_time);
+int32 OS_TaskSetPeriod         (uint32 period_usecs, uint32 deadline_usecs);
+int32 OS_TaskWaitPeriod        (void);
 int32 OS_TaskSetPriority       (uint32 task_id, uint32 new_priority);
 int32 OS_TaskRegister          (void);
 uint32 OS_TaskGetId            (void);
 int32 OS_TaskGetIdByName       (uint32 *task_id, const char *task_name);
 int32 OS_TaskGetInfo           (uint32 task_id, OS_task_prop_t *task_prop);          
+int32 OS_TaskGetStats          (uint32 task_id, OS_task_stats_t *task_stats);
+int32 OS_TaskSetAffinity       (uint32 task_id, uint32 cpu_mask);
+int32 OS_TaskGetAffinity       (uint32 task_id, uint32 *cpu_mask);
+int32 OS_TaskSetAffinityPolicy (const OS_task_affinity_band_t *bands, uint32 num_bands);
 
 /*
 ** Message Queue API
@@ -159,9 +363,25 @@ int32 OS_QueueGet              (uint32 queue_id, void *data, uint32 size,
                                 uint32 *size_copied, int32 timeout);
 int32 OS_QueuePut              (uint32 queue_id, void *data, uint32 size, 
                                 uint32 flags);
+int32 OS_QueueGetBatch         (uint32 queue_id, void *data, uint32 size,
+                                uint32 count, uint32 *count_copied, int32 timeout);
+int32 OS_QueuePutBatch         (uint32 queue_id, void *data, uint32 size,
+                                uint32 count, uint32 *count_put, uint32 flags);
 int32 OS_QueueGetIdByName      (uint32 *queue_id, const char *queue_name);
 int32 OS_QueueGetInfo          (uint32 queue_id, OS_queue_prop_t *queue_prop);
 
+/*
+** Zero copy queue API
+** Buffers are loaned from a shared pool and passed between queues created
+** with OS_QUEUE_ZERO_COPY by reference.
+*/
+int32 OS_QueueLoan             (void **buffer, uint32 size);
+int32 OS_QueueSend             (uint32 queue_id, void *buffer, uint32 size,
+                                uint32 flags);
+int32 OS_QueueReceiveRef       (uint32 queue_id, void **buffer, uint32 *size_copied,
+                                int32 timeout);
+int32 OS_QueueRelease          (void *buffer);
+
 /*
 ** Semaphore API
 */
@@ -196,6 +416,77 @@ int32 OS_MutSemDelete           (uint32 sem_id);
 int32 OS_MutSemGetIdByName      (uint32 *sem_id, const char *sem_name); 
 int32 OS_MutSemGetInfo          (uint32 sem_id, OS_mut_sem_prop_t *mut_prop);
 
+/*
+** Reader-writer lock API
+*/
+
+int32 OS_RwLockCreate           (uint32 *rw_id, const char *rw_name, uint32 options);
+int32 OS_RwLockDelete           (uint32 rw_id);
+int32 OS_RwLockReadTake         (uint32 rw_id);
+int32 OS_RwLockReadTimedWait    (uint32 rw_id, uint32 msecs);
+int32 OS_RwLockWriteTake        (uint32 rw_id);
+int32 OS_RwLockWriteTimedWait   (uint32 rw_id, uint32 msecs);
+int32 OS_RwLockGive             (uint32 rw_id);
+int32 OS_RwLockGetIdByName      (uint32 *rw_id, const char *rw_name);
+int32 OS_RwLockGetInfo          (uint32 rw_id, OS_rwlock_prop_t *rw_prop);
+
+/*
+** Event flags API
+*/
+
+int32 OS_EventFlagsAPIInit      (void);
+int32 OS_EventFlagsCreate       (uint32 *flags_id, const char *flags_name,
+                                 uint32 initial_flags, uint32 options);
+int32 OS_EventFlagsDelete       (uint32 flags_id);
+int32 OS_EventFlagsSet          (uint32 flags_id, uint32 flags);
+int32 OS_EventFlagsClear        (uint32 flags_id, uint32 flags);
+int32 OS_EventFlagsGet          (uint32 flags_id, uint32 *flags);
+int32 OS_EventFlagsWait         (uint32 flags_id, uint32 flags, uint32 options,
+                                 int32 timeout, uint32 *flags_seen);
+int32 OS_EventFlagsGetIdByName  (uint32 *flags_id, const char *flags_name);
+int32 OS_EventFlagsGetInfo      (uint32 flags_id, OS_event_flags_prop_t *flags_prop);
+
+/*
+** Published data API
+** A sequence lock holds a small record that readers copy out, retrying if a
+** write overlapped the copy. A publication holds a pointer to a larger record
+** that readers use in place, between OS_PublishReadBegin and OS_PublishReadEnd.
+*/
+
+int32 OS_PublishAPIInit         (void);
+int32 OS_SeqLockCreate          (uint32 *seq_id, const char *seq_name, uint32 size);
+int32 OS_SeqLockDelete          (uint32 seq_id);
+int32 OS_SeqLockWrite           (uint32 seq_id, const void *data, uint32 size);
+int32 OS_SeqLockRead            (uint32 seq_id, void *data, uint32 size, uint32 *version);
+int32 OS_SeqLockGetIdByName     (uint32 *seq_id, const char *seq_name);
+int32 OS_SeqLockGetInfo         (uint32 seq_id, OS_seqlock_prop_t *seq_prop);
+
+int32 OS_PublishCreate          (uint32 *pub_id, const char *pub_name, void *data,
+                                 OS_publish_release_t release);
+int32 OS_PublishDelete          (uint32 pub_id);
+int32 OS_PublishUpdate          (uint32 pub_id, void *data);
+int32 OS_PublishReadBegin       (uint32 pub_id, void **data);
+int32 OS_PublishReadEnd         (uint32 pub_id);
+int32 OS_PublishSynchronize     (uint32 pub_id);
+int32 OS_PublishGetIdByName     (uint32 *pub_id, const char *pub_name);
+int32 OS_PublishGetInfo         (uint32 pub_id, OS_publish_prop_t *pub_prop);
+
+/*
+** Multiple object wait API
+*/
+
+int32 OS_WaitMultiple           (OS_wait_object_t *objects, uint32 count, int32 timeout,
+                                 uint32 *fired);
+
+/*
+** Lock statistics API
+*/
+int32 OS_BinSemGetStats         (uint32 sem_id, OS_lock_stats_t *stats);
+int32 OS_CountSemGetStats       (uint32 sem_id, OS_lock_stats_t *stats);
+int32 OS_MutSemGetStats         (uint32 sem_id, OS_lock_stats_t *stats);
+int32 OS_RwLockGetStats         (uint32 rw_id, OS_lock_stats_t *stats);
+int32 OS_LockStatsDump          (const char *filename);
+
 /*
 ** OS Time/Tick related API
 */
@@ -204,6 +495,9 @@ int32 OS_Milli2Ticks           (uint32 milli_seconds);
 int32 OS_Tick2Micros           (void);
 int32  OS_GetLocalTime         (OS_time_t *time_struct);
 int32  OS_SetLocalTime         (OS_time_t *time_struct);  
+int32  OS_GetMonotonicTime     (OS_time_t *time_struct);
+int32  OS_GetMonotonicTimeNs   (uint64 *nsecs);
+int32  OS_GetRealTimeNs        (uint64 *nsecs);
 
 /*
 ** Exception API
@@ -254,6 +548,7 @@ int32 OS_ShMemGetIdByName   (uint32 *ShMemId, const char *SegName );
 ** Heap API
 */
 int32 OS_HeapGetInfo       (OS_heap_prop_t *heap_prop);
+int32 OS_GetSystemLoad     (OS_system_load_t *system_load);
 
 /*
 ** API for useful debugging function
@@ -37,11 +37,23 @@
 
 #include "osapi.h"
 
+/*
+** The longest start and interval time of OS_TimerSetNs, about 146 years
+*/
+#define OS_TIMER_MAX_NSECS   (1ULL << 62)
+
 /*
 ** Typedefs
 */
 typedef void (*OS_TimerCallback_t)(uint32 timer_id);
 
+/*
+** The callback of a timer made with OS_TimerCreateEx. overruns is the number
+** of expirations since the last callback that did not get one of their own,
+** because the dispatch task was still busy or the timer service ran late.
+*/
+typedef void (*OS_TimerCallbackEx_t)(uint32 timer_id, uint32 overruns, void *arg);
+
 typedef struct 
 {
    char                name[OS_MAX_API_NAME];
@@ -49,9 +61,29 @@ typedef struct
    uint32              start_time;
    uint32              interval_time;
    uint32              accuracy;
+   uint64              start_nsecs;
+   uint64              interval_nsecs;
 
 } OS_timer_prop_t;
 
+/*
+** Callback statistics of a timer, kept from the time it was created. The
+** latency is the time from the deadline of an expiration to the start of
+** its callback, the runtime is how long the callback ran.
+*/
+typedef struct
+{
+   uint32              dispatch_priority;  /* priority of the task the callbacks run in */
+   uint32              expirations;
+   uint32              callbacks;
+   uint32              overruns;           /* expirations that got no callback of their own */
+   uint32              max_latency_usecs;
+   uint32              avg_latency_usecs;
+   uint32              max_runtime_usecs;
+   uint32              avg_runtime_usecs;
+
+} OS_timer_stats_t;
+
 
 /*
 ** Timer API
@@ -59,10 +91,14 @@ typedef struct
 int32  OS_TimerAPIInit     (void);
 
 int32 OS_TimerCreate      (uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy, OS_TimerCallback_t callback_ptr);
+int32 OS_TimerCreateEx    (uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy,
+                           OS_TimerCallbackEx_t callback_ptr, void *callback_arg, uint32 priority);
 int32 OS_TimerSet         (uint32 timer_id, uint32 start_msec, uint32 interval_msec);
+int32 OS_TimerSetNs       (uint32 timer_id, uint64 start_nsecs, uint64 interval_nsecs);
 int32 OS_TimerDelete      (uint32 timer_id);
 
 int32 OS_TimerGetIdByName (uint32 *timer_id, const char *timer_name);
 int32 OS_TimerGetInfo     (uint32  timer_id, OS_timer_prop_t *timer_prop);
+int32 OS_TimerGetStats    (uint32  timer_id, OS_timer_stats_t *timer_stats);
 
 #endif
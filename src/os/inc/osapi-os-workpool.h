@@ -0,0 +1,78 @@
+/*
+** File: osapi-os-workpool.h
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: Contains functions prototype definitions and variable declarations
+**          for the OS Abstraction Layer, Work Pool API
+**
+**          A work pool is a fixed set of OSAL tasks that run short jobs handed
+**          to them with OS_WorkSubmit, so an application can spread work over
+**          the cores without creating a task per job. Each worker keeps its own
+**          queue of jobs and takes jobs from the other workers when it runs out.
+*/
+
+#ifndef _osapi_workpool_
+#define _osapi_workpool_
+
+#include "osapi.h"
+
+/*
+** Defines
+*/
+
+/* #define for the flags of OS_WorkSubmit, the job goes ahead of the normal jobs */
+#define OS_WORK_HIGH_PRIORITY  0x0001
+
+/*
+** Typedefs
+*/
+typedef void (*OS_WorkFunction_t)(void *arg);
+
+/*
+** A wait group counts the jobs submitted with it that have not finished yet.
+** It belongs to the application, set it up with OS_WorkGroupInit. Its fields
+** are only used by OSAL.
+*/
+typedef struct
+{
+   volatile unsigned int pending;
+} OS_work_group_t;
+
+typedef struct
+{
+   char                name[OS_MAX_API_NAME];
+   uint32              creator;
+   uint32              num_workers;
+   uint32              worker_ids[OS_MAX_WORK_POOL_WORKERS];
+   uint32              queued;      /* jobs waiting to run */
+   uint32              executed;    /* jobs run so far */
+   uint32              stolen;      /* jobs a worker took from another worker's queue */
+
+} OS_work_pool_prop_t;
+
+
+/*
+** Work Pool API
+*/
+int32 OS_WorkPoolAPIInit    (void);
+
+int32 OS_WorkPoolCreate     (uint32 *pool_id, const char *pool_name, uint32 num_workers,
+                             uint32 stack_size, uint32 priority, uint32 flags);
+int32 OS_WorkPoolDelete     (uint32 pool_id);
+int32 OS_WorkSubmit         (uint32 pool_id, OS_WorkFunction_t function, void *arg,
+                             OS_work_group_t *group, uint32 flags);
+
+int32 OS_WorkGroupInit      (OS_work_group_t *group);
+int32 OS_WorkGroupWait      (OS_work_group_t *group, int32 timeout);
+
+int32 OS_WorkPoolGetIdByName (uint32 *pool_id, const char *pool_name);
+int32 OS_WorkPoolGetInfo    (uint32 pool_id, OS_work_pool_prop_t *pool_prop);
+
+#endif
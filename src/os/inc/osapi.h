@@ -105,6 +105,13 @@
 #define OS_TIMER_ERR_TIMER_ID          (-30)
 #define OS_TIMER_ERR_UNAVAILABLE       (-31)
 #define OS_TIMER_ERR_INTERNAL          (-32)
+#define OS_QUEUE_INVALID_DEPTH         (-33)
+#define OS_QUEUE_NO_BUFFERS            (-34)
+#define OS_SEM_INVALID_OPTIONS         (-35)
+#define OS_TASK_INVALID_AFFINITY       (-36)
+#define OS_TASK_INVALID_PERIOD         (-37)
+#define OS_TASK_PERIOD_OVERRUN         (-38)
+#define OS_ERR_INVALID_TIMEOUT         (-39)
 
 /*
 ** Defines for Queue Timeout parameters
@@ -127,6 +134,7 @@
 #include "osapi-os-net.h"
 #include "osapi-os-loader.h"
 #include "osapi-os-timer.h"
+#include "osapi-os-workpool.h"
 
 #endif
 
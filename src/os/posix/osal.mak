@@ -16,7 +16,7 @@ TARGET = osal.o
 #==============================================================================
 # Object files required to build subsystem.
 
-OBJS=osapi.o osfileapi.o  osfilesys.o  osnetwork.o osloader.o ostimer.o
+OBJS=osapi.o osfileapi.o  osfilesys.o  osnetwork.o osloader.o ostimer.o osfutex.o osregistry.o ossem.o oslockstats.o osworkpool.o osstack.o osevent.o oswait.o ospublish.o
 
 #==============================================================================
 # Source files required to build subsystem; used to generate dependencies.
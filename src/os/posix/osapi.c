@@ -63,6 +63,14 @@
 /****************************************************************************************
                                     INCLUDE FILES
 ****************************************************************************************/
+
+/*
+** sendmmsg and recvmmsg are GNU extensions
+*/
+#ifdef _LINUX_OS_
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <sys/types.h>
 #include <ctype.h>
@@ -77,23 +85,34 @@
 #include <netinet/in.h>
 #include <string.h>     
 #include <sys/select.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <fcntl.h>
 #include <errno.h>
 
 #include <limits.h>
+#include <stdlib.h>
+#ifdef _LINUX_OS_
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 /*
 ** User defined include files
 */
 #include "common_types.h"
 #include "osapi.h"
+#include "osprivate.h"
 
 /*
 ** This include must be put below the osapi.h
 ** include so it can pick up the define
 */
-#ifndef OSAL_SOCKET_QUEUE
+#if defined(OSAL_SOCKET_QUEUE) && defined(OSAL_RING_QUEUE)
+#error "Only one of OSAL_SOCKET_QUEUE and OSAL_RING_QUEUE can be defined"
+#endif
+
+#if !defined(OSAL_SOCKET_QUEUE) && !defined(OSAL_RING_QUEUE)
 #include <mqueue.h>
 #endif
 
@@ -101,8 +120,19 @@
 ** Defines
 */
 #define OS_BASE_PORT 43000
+#define OS_QUEUE_BATCH_CHUNK 32
 #define UNINITIALIZED 0
 #define MAX_PRIORITY 255
+
+/*
+** States of the start gate a new task waits on until OS_TaskCreate has
+** published its ID. The task moves it to READY once it has recorded its
+** thread, OS_TaskCreate then moves it to GO or ABORT.
+*/
+#define OS_TASK_START_WAIT   0
+#define OS_TASK_START_READY  1
+#define OS_TASK_START_GO     2
+#define OS_TASK_START_ABORT  3
 #ifndef PTHREAD_STACK_MIN
    #define PTHREAD_STACK_MIN 8092
 #endif
@@ -123,8 +153,28 @@ typedef struct
     char      name [OS_MAX_API_NAME];
     int       creator;
     uint32    stack_size;
+    char     *stack_base;
+    uint32    stack_alloc;
+    uint32    stack_block;
     uint32    priority;
+    int       policy;
+    uint32    affinity;
+    int       affinity_pinned;
+    uint64    period_ns;
+    uint64    deadline_ns;
+    uint64    next_release;
+    uint32    periods;
+    uint32    overruns;
+    uint32    max_jitter_usecs;
+    uint64    total_jitter_ns;
+    pid_t     tid;
+    uint32    wakeups;
+    uint32    max_wakeup_usecs;
+    uint32    wakeup_histogram [OS_TASK_STATS_BUCKETS];
     void     *delete_hook_pointer;
+    osal_task_entry entry_point;
+    volatile OS_futex_t start_gate;
+    volatile OS_futex_t epoch OS_ALIGN(OS_CACHE_LINE_SIZE);
 }OS_task_record_t;
     
 #ifdef OSAL_SOCKET_QUEUE
@@ -135,46 +185,93 @@ typedef struct
     int id;
     char name [OS_MAX_API_NAME];
     int creator;
+    uint32 flags;
+    OS_wait_source_t wait;
+}OS_queue_record_t;
+#elif defined(OSAL_RING_QUEUE)
+/* 
+** ring queue message slot header, the message data follows it 
+*/
+typedef struct
+{
+    volatile OS_futex_t seq;
+    uint32              size;
+}OS_ring_slot_t;
+
+/* 
+** queues 
+** The producer cursor, the consumer cursor and the wakeup word are each
+** written by different tasks, so they are kept on separate cache lines.
+** users counts the calls working on the ring, a delete waits for it to
+** drop to zero before the ring is freed. It is only zeroed by OS_API_Init,
+** since a call with a stale ID may still be counted in when the slot is
+** created again.
+*/
+typedef struct
+{
+    volatile OS_futex_t head OS_ALIGN(OS_CACHE_LINE_SIZE);
+    volatile OS_futex_t tail OS_ALIGN(OS_CACHE_LINE_SIZE);
+    volatile OS_futex_t put_seq OS_ALIGN(OS_CACHE_LINE_SIZE);
+    volatile OS_futex_t waiters;
+    volatile OS_futex_t users;
+    int                 free OS_ALIGN(OS_CACHE_LINE_SIZE);
+    char               *ring;
+    uint32              depth;
+    uint32              mask;
+    uint32              data_size;
+    uint32              slot_size;
+    char                name [OS_MAX_API_NAME];
+    int                 creator;
+    uint32              flags;
+    OS_wait_source_t    wait;
 }OS_queue_record_t;
 #else
 /* queues */
 typedef struct
 {
-    int   free;
-    mqd_t id;
-    char  name [OS_MAX_API_NAME];
-    int   creator;
+    int    free;
+    mqd_t  id;
+    char   name [OS_MAX_API_NAME];
+    int    creator;
+    uint32 flags;
+    OS_wait_source_t wait;
 }OS_queue_record_t;
 #endif
 
+/*
+** message carried by a zero copy queue: the loaned pool block and the
+** number of bytes of it that are in use
+*/
+typedef struct
+{
+    uint32 block;
+    uint32 size;
+}OS_queue_ref_t;
+
 /* Binary Semaphores */
 typedef struct
 {
     int free;
-#ifdef _MAC_OS_
-    sem_t *id;
-#else
-    sem_t id;
-#endif
+    OS_sem_t sem;
+    OS_wait_source_t wait;
     char name [OS_MAX_API_NAME];
     int creator;
-    int max_value;
-    int current_value;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_lock_stats_rec_t stats;
+#endif
 }OS_bin_sem_record_t;
 
 /*Counting Semaphores */
 typedef struct
 {
     int free;
-#ifdef _MAC_OS_
-    sem_t *id;
-#else
-    sem_t id;
-#endif
+    OS_sem_t sem;
+    OS_wait_source_t wait;
     char name [OS_MAX_API_NAME];
     int creator;
-    int max_value;
-    int current_value;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_lock_stats_rec_t stats;
+#endif
 }OS_count_sem_record_t;
 
 /* Mutexes */
@@ -182,11 +279,29 @@ typedef struct
 {
     int free;
     pthread_mutex_t id;
+    OS_lwmutex_t lw;
+    uint32 options;
     char name [OS_MAX_API_NAME];
     int creator;
     int nested_value; 
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_lock_stats_rec_t stats;
+#endif
 }OS_mut_sem_record_t;
 
+/* Reader-writer locks */
+typedef struct
+{
+    int free;
+    OS_rwlock_t rw;
+    uint32 options;
+    char name [OS_MAX_API_NAME];
+    int creator;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_lock_stats_rec_t stats;
+#endif
+}OS_rwlock_record_t;
+
 /* function pointer type */
 typedef void (*FuncPtr_t)(void);
 
@@ -196,21 +311,86 @@ OS_queue_record_t   OS_queue_table         [OS_MAX_QUEUES];
 OS_bin_sem_record_t OS_bin_sem_table       [OS_MAX_BIN_SEMAPHORES];
 OS_count_sem_record_t OS_count_sem_table   [OS_MAX_COUNT_SEMAPHORES];
 OS_mut_sem_record_t OS_mut_sem_table       [OS_MAX_MUTEXES];
+OS_rwlock_record_t  OS_rwlock_table        [OS_MAX_RWLOCKS];
+
+/* Registries that hand out the table slots and index the object names */
+static OS_registry_t OS_task_registry;
+static OS_registry_t OS_queue_registry;
+static OS_registry_t OS_bin_sem_registry;
+static OS_registry_t OS_count_sem_registry;
+static OS_registry_t OS_mut_sem_registry;
+static OS_registry_t OS_rwlock_registry;
+
+/*
+** Zero copy queue buffer pool. OS_QUEUE_POOL_EMPTY is both the "no block"
+** index and the mask of the index bits in the free stack head.
+*/
+#define OS_QUEUE_POOL_EMPTY 0xFFFF
+
+#if OS_QUEUE_POOL_BLOCKS < 1 || OS_QUEUE_POOL_BLOCKS >= OS_QUEUE_POOL_EMPTY
+#error "OS_QUEUE_POOL_BLOCKS must be between 1 and 65534"
+#endif
+
+static char OS_queue_pool_data [OS_QUEUE_POOL_BLOCKS][OS_QUEUE_POOL_BLOCK_SIZE]
+                               OS_ALIGN(OS_CACHE_LINE_SIZE);
+static volatile OS_futex_t OS_queue_pool_refs [OS_QUEUE_POOL_BLOCKS];
+static volatile OS_futex_t OS_queue_pool_next [OS_QUEUE_POOL_BLOCKS];
+static volatile OS_futex_t OS_queue_pool_head;
+
+/*
+** The ID of the task running on this thread, 0 if the thread is not an OSAL task.
+** It is set by OS_TaskEntryPoint before the task's entry point runs.
+*/
+static __thread uint32 OS_task_self_id;
+
+/*
+** Set once OS_TaskCreate has reported that real time scheduling is not permitted
+*/
+static int OS_task_sched_warned = FALSE;
 
-pthread_key_t    thread_key;
+/*
+** The task affinity policy, see OS_TaskSetAffinityPolicy. It is not reset by
+** OS_API_Init, since applications may call that again after the BSP set it.
+*/
+#define OS_MAX_AFFINITY_BANDS 8
+
+static OS_task_affinity_band_t OS_task_affinity_policy[OS_MAX_AFFINITY_BANDS];
+static uint32                  OS_task_affinity_bands = 0;
 
 pthread_mutex_t OS_task_table_mut;
 pthread_mutex_t OS_queue_table_mut;
 pthread_mutex_t OS_bin_sem_table_mut;
 pthread_mutex_t OS_mut_sem_table_mut;
 pthread_mutex_t OS_count_sem_table_mut;
+pthread_mutex_t OS_rwlock_table_mut;
+
+/*
+** The CPU times read by the previous OS_GetSystemLoad, the total and the busy
+** time of the whole system and then of each core, with the mutex guarding them
+*/
+static uint64 OS_system_load_total [OS_SYSTEM_LOAD_CPUS + 1];
+static uint64 OS_system_load_busy [OS_SYSTEM_LOAD_CPUS + 1];
+pthread_mutex_t OS_system_load_mut;
 /*
 ** Local Function Prototypes
 */
-uint32  OS_CompAbsDelayTime( uint32 milli_second , struct timespec * tm);
 void    OS_ThreadKillHandler(int sig );
 uint32  OS_FindCreator(void);
 int32   OS_PriorityRemap(uint32 InputPri);
+static void *OS_TaskEntryPoint(void *arg);
+static void OS_TaskStartGate(uint32 local_id, OS_futex_t state);
+static int32 OS_QueueReceiveLocal(uint32 local_id, void *data, uint32 size);
+static void OS_QueueDrainRefs(uint32 local_id);
+static int32 OS_MutSemInitPthread(uint32 local_id, uint32 options);
+static int   OS_TaskSchedPolicy(uint32 flags);
+static int32 OS_TaskCheckAffinity(uint32 cpu_mask);
+static uint32 OS_TaskPolicyAffinity(uint32 priority);
+static int32 OS_TaskApplyAffinity(uint32 local_id, uint32 cpu_mask);
+#ifdef _LINUX_OS_
+static void  OS_TaskCpuSet(uint32 cpu_mask, cpu_set_t *cpu_set);
+static void  OS_TaskReadProcStats(pid_t tid, OS_task_stats_t *task_stats);
+#endif
+static int32 OS_TaskSleepUntil(const struct timespec *deadline);
 
 /*---------------------------------------------------------------------------------------
    Name: OS_API_Init
@@ -233,6 +413,14 @@ int32 OS_API_Init(void)
         OS_task_table[i].free                = TRUE;
         OS_task_table[i].creator             = UNINITIALIZED;
         OS_task_table[i].delete_hook_pointer = NULL;
+        OS_task_table[i].entry_point         = NULL;
+        OS_task_table[i].policy              = SCHED_OTHER;
+        OS_task_table[i].affinity            = 0;
+        OS_task_table[i].affinity_pinned     = FALSE;
+        OS_task_table[i].period_ns           = 0;
+        OS_task_table[i].stack_base          = NULL;
+        OS_task_table[i].stack_block         = OS_STACK_NO_BLOCK;
+        OS_task_table[i].epoch               = 0;
         strcpy(OS_task_table[i].name,"");    
     }
 
@@ -241,10 +429,26 @@ int32 OS_API_Init(void)
     for(i = 0; i < OS_MAX_QUEUES; i++)
     {
         OS_queue_table[i].free        = TRUE;
+#ifdef OSAL_RING_QUEUE
+        OS_queue_table[i].ring        = NULL;
+        OS_queue_table[i].users       = 0;
+#else
         OS_queue_table[i].id          = UNINITIALIZED;
+#endif
         OS_queue_table[i].creator     = UNINITIALIZED;
+        OS_queue_table[i].flags       = 0;
         strcpy(OS_queue_table[i].name,""); 
+        OS_WaitSourceInit(&OS_queue_table[i].wait);
+    }
+
+    /* Initialize the zero copy buffer pool, every block free */
+
+    for(i = 0; i < OS_QUEUE_POOL_BLOCKS; i++)
+    {
+        OS_queue_pool_refs[i] = 0;
+        OS_queue_pool_next[i] = (i + 1 < OS_QUEUE_POOL_BLOCKS) ? (i + 1) : OS_QUEUE_POOL_EMPTY;
     }
+    OS_queue_pool_head = 0;
 
     /* Initialize Binary Semaphore Table */
 
@@ -253,14 +457,16 @@ int32 OS_API_Init(void)
         OS_bin_sem_table[i].free        = TRUE;
         OS_bin_sem_table[i].creator     = UNINITIALIZED;
         strcpy(OS_bin_sem_table[i].name,"");
+        OS_WaitSourceInit(&OS_bin_sem_table[i].wait);
     }
 
     /* Initialize Counting Semaphores */
-    for(i = 0; i < OS_MAX_BIN_SEMAPHORES; i++)
+    for(i = 0; i < OS_MAX_COUNT_SEMAPHORES; i++)
     {
         OS_count_sem_table[i].free        = TRUE;
         OS_count_sem_table[i].creator     = UNINITIALIZED;
         strcpy(OS_count_sem_table[i].name,"");
+        OS_WaitSourceInit(&OS_count_sem_table[i].wait);
     }
     /* Initialize Mutex Semaphore Table */
 
@@ -272,6 +478,34 @@ int32 OS_API_Init(void)
         strcpy(OS_mut_sem_table[i].name,"");
     }
 
+    /* Initialize Reader-Writer Lock Table */
+
+    for(i = 0; i < OS_MAX_RWLOCKS; i++)
+    {
+        OS_rwlock_table[i].free        = TRUE;
+        OS_rwlock_table[i].creator     = UNINITIALIZED;
+        strcpy(OS_rwlock_table[i].name,"");
+    }
+
+    /* Initialize the registries, every slot free */
+
+    if ( OS_RegistryInit(&OS_task_registry, OS_OBJECT_TYPE_TASK,
+                         OS_MAX_TASKS, OS_MAX_API_NAME) != OS_SUCCESS ||
+         OS_RegistryInit(&OS_queue_registry, OS_OBJECT_TYPE_QUEUE,
+                         OS_MAX_QUEUES, OS_MAX_API_NAME) != OS_SUCCESS ||
+         OS_RegistryInit(&OS_bin_sem_registry, OS_OBJECT_TYPE_BINSEM,
+                         OS_MAX_BIN_SEMAPHORES, OS_MAX_API_NAME) != OS_SUCCESS ||
+         OS_RegistryInit(&OS_count_sem_registry, OS_OBJECT_TYPE_COUNTSEM,
+                         OS_MAX_COUNT_SEMAPHORES, OS_MAX_API_NAME) != OS_SUCCESS ||
+         OS_RegistryInit(&OS_mut_sem_registry, OS_OBJECT_TYPE_MUTEX,
+                         OS_MAX_MUTEXES, OS_MAX_API_NAME) != OS_SUCCESS ||
+         OS_RegistryInit(&OS_rwlock_registry, OS_OBJECT_TYPE_RWLOCK,
+                         OS_MAX_RWLOCKS, OS_MAX_API_NAME) != OS_SUCCESS )
+    {
+        printf("Error allocating the OS API object registries\n");
+        return(OS_ERROR);
+    }
+
    /*
    ** Initialize the module loader
    */
@@ -283,6 +517,15 @@ int32 OS_API_Init(void)
       }
    #endif
 
+   /*
+   ** Map the task stack arena, if there is one
+   */
+   return_code = OS_StackArenaInit();
+   if ( return_code == OS_ERROR )
+   {
+      return(return_code);
+   }
+
    /*
    ** Initialize the Timer API
    */
@@ -292,11 +535,30 @@ int32 OS_API_Init(void)
       return(return_code);
    }
 
-   ret = pthread_key_create(&thread_key, NULL );
-   if ( ret != 0 )
+   /*
+   ** Initialize the Work Pool API
+   */
+   return_code = OS_WorkPoolAPIInit();
+   if ( return_code == OS_ERROR )
+   {
+      return(return_code);
+   }
+
+   /*
+   ** Initialize the Event Flags API
+   */
+   return_code = OS_EventFlagsAPIInit();
+   if ( return_code == OS_ERROR )
+   {
+      return(return_code);
+   }
+
+   /*
+   ** Initialize the Published Data API
+   */
+   return_code = OS_PublishAPIInit();
+   if ( return_code == OS_ERROR )
    {
-      printf("Error creating thread key\n");
-      return_code = OS_ERROR;
       return(return_code);
    }
 
@@ -335,6 +597,18 @@ int32 OS_API_Init(void)
       return_code = OS_ERROR;
       return(return_code);
    }
+   ret = pthread_mutex_init((pthread_mutex_t *) & OS_rwlock_table_mut,NULL); 
+   if ( ret != 0 )
+   {
+      return_code = OS_ERROR;
+      return(return_code);
+   }
+   ret = pthread_mutex_init((pthread_mutex_t *) & OS_system_load_mut,NULL); 
+   if ( ret != 0 )
+   {
+      return_code = OS_ERROR;
+      return(return_code);
+   }
 
    /*
    ** File system init
@@ -361,11 +635,19 @@ int32 OS_API_Init(void)
             OS_ERR_INVALID_PRIORITY if the priority is bad
             OS_ERR_NO_FREE_IDS if there can be no more tasks created
             OS_ERR_NAME_TAKEN if the name specified is already used by a task
+            OS_TASK_INVALID_AFFINITY if OS_TASK_AFFINITY names a core that is missing
+            OS_ERR_NOT_IMPLEMENTED if OS_TASK_AFFINITY is used where it is not supported
             OS_ERROR if the operating system calls fail
             OS_SUCCESS if success
             
     NOTES: task_id is passed back to the user as the ID. stack_pointer is usually null.
-           Flags are unused at this point.
+           A stack_pointer to stack_size bytes is used as the stack of the task when
+           stack_size is at least PTHREAD_STACK_MIN, smaller stacks are ignored. Other
+           tasks take their stack from the stack arena when there is one, and fail with
+           OS_ERROR when it is full.
+           The OS_TASK_SCHED_ flags select the scheduling policy. A task that may not
+           use a real time policy is created under SCHED_OTHER. OS_TASK_AFFINITY pins
+           the task to a set of cores, otherwise the affinity policy picks them.
 
 ---------------------------------------------------------------------------------------*/
 int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry function_pointer,
@@ -375,11 +657,20 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
     int                return_code = 0;
     pthread_attr_t     custom_attr ;
     struct sched_param priority_holder ;
-    int                possible_taskid;
-    int                i;
+    uint32             possible_taskid;
     uint32             local_stack_size;
     int                ret;  
     int                os_priority;
+    int                policy;
+    uint32             cpu_mask;
+    int                pinned;
+    void              *stack_base = NULL;
+    uint32             stack_alloc = 0;
+    uint32             stack_block = OS_STACK_NO_BLOCK;
+    OS_futex_t         start_state;
+#ifdef _LINUX_OS_
+    cpu_set_t          cpu_set;
+#endif
 
     
     /* Check for NULL pointers */    
@@ -403,34 +694,34 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
 
     /* Change OSAL priority into a priority that will work for this OS */
     os_priority = OS_PriorityRemap(priority);
-    
-    /* Check Parameters */
-    pthread_mutex_lock(&OS_task_table_mut); 
+    policy = OS_TaskSchedPolicy(flags);
 
-    for(possible_taskid = 0; possible_taskid < OS_MAX_TASKS; possible_taskid++)
+    /* Check the cores the task is pinned to */
+    cpu_mask = (flags & OS_TASK_AFFINITY_MASK) >> 16;
+    pinned = (cpu_mask != 0);
+    if ( pinned )
     {
-        if (OS_task_table[possible_taskid].free == TRUE)
+        return_code = OS_TaskCheckAffinity(cpu_mask);
+        if ( return_code != OS_SUCCESS )
         {
-            break;
+            return return_code;
         }
     }
+    
+    /* Check Parameters */
+    pthread_mutex_lock(&OS_task_table_mut); 
 
-    /* Check to see if the id is out of bounds */
-    if( possible_taskid >= OS_MAX_TASKS || OS_task_table[possible_taskid].free != TRUE)
+    return_code = OS_RegistryAlloc(&OS_task_registry, task_name, &possible_taskid);
+    if (return_code != OS_SUCCESS)
     {
         pthread_mutex_unlock(&OS_task_table_mut);
-        return OS_ERR_NO_FREE_IDS;
+        return return_code;
     }
 
-    /* Check to see if the name is already taken */ 
-    for (i = 0; i < OS_MAX_TASKS; i++)
+    /* A task that is not pinned gets the cores of its priority band */
+    if ( !pinned )
     {
-        if ((OS_task_table[i].free == FALSE) &&
-           ( strcmp((char*) task_name, OS_task_table[i].name) == 0)) 
-        {       
-            pthread_mutex_unlock(&OS_task_table_mut);
-            return OS_ERR_NAME_TAKEN;
-        }
+        cpu_mask = OS_TaskPolicyAffinity(priority);
     }
     
     /* 
@@ -438,6 +729,14 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
     ** no other task can try to use it 
     */
     OS_task_table[possible_taskid].free = FALSE;
+    OS_task_table[possible_taskid].entry_point = function_pointer;
+    OS_task_table[possible_taskid].start_gate = OS_TASK_START_WAIT;
+    OS_task_table[possible_taskid].period_ns = 0;
+    OS_task_table[possible_taskid].tid = 0;
+    OS_task_table[possible_taskid].wakeups = 0;
+    OS_task_table[possible_taskid].max_wakeup_usecs = 0;
+    memset(OS_task_table[possible_taskid].wakeup_histogram, 0,
+           sizeof(OS_task_table[possible_taskid].wakeup_histogram));
     
     pthread_mutex_unlock(&OS_task_table_mut);
 
@@ -450,6 +749,38 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
         local_stack_size = stack_size;
     }
 
+    /*
+    ** Use the stack of the caller, or take one from the stack arena
+    */
+    if ( stack_pointer != NULL && stack_size >= PTHREAD_STACK_MIN )
+    {
+        stack_base  = (void *) stack_pointer;
+        stack_alloc = stack_size;
+    }
+    else
+    {
+        return_code = OS_StackAlloc(local_stack_size, &stack_base, &stack_alloc, &stack_block);
+        if ( return_code == OS_ERROR )
+        {
+            pthread_mutex_lock(&OS_task_table_mut); 
+            OS_task_table[possible_taskid].free = TRUE;
+            OS_RegistryFree(&OS_task_registry, possible_taskid);
+            pthread_mutex_unlock(&OS_task_table_mut); 
+            printf("OS_TaskCreate: no room in the stack arena for a stack of %lu bytes\n",
+                   local_stack_size);
+            return(OS_ERROR);
+        }
+    }
+
+    /*
+    ** Paint the stack, so OS_TaskGetInfo can tell how much of it was used
+    */
+    OS_task_table[possible_taskid].stack_block = stack_block;
+    if ( stack_base != NULL )
+    {
+        OS_StackPaint(stack_base, stack_alloc);
+    }
+
    /*
    ** Initialize the pthread_attr structure. 
    ** The structure is used to set the stack and priority
@@ -459,44 +790,107 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
     {  
         pthread_mutex_lock(&OS_task_table_mut); 
         OS_task_table[possible_taskid].free = TRUE;
+        OS_RegistryFree(&OS_task_registry, possible_taskid);
+        OS_task_table[possible_taskid].stack_block = OS_STACK_NO_BLOCK;
         pthread_mutex_unlock(&OS_task_table_mut); 
-        printf("pthread_attr_init error in OS_TaskCreate, Task ID = %d\n",possible_taskid);
+        OS_StackFree(stack_block);
+        printf("pthread_attr_init error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
 		  perror("pthread_attr_init");
-        /* return(OS_ERROR); */
+        return(OS_ERROR);
     }
 
     /*
-    ** Set the Stack Size
+    ** Set the Stack, or the Stack Size when the thread library picks the stack
     */
-    if (pthread_attr_setstacksize(&custom_attr, (size_t)local_stack_size ))
+    if ( stack_base != NULL )
+    {
+        if (pthread_attr_setstack(&custom_attr, stack_base, (size_t)stack_alloc ))
+        {
+            printf("pthread_attr_setstack error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
+        }
+    }
+    else if (pthread_attr_setstacksize(&custom_attr, (size_t)local_stack_size ))
     {
-        printf("pthread_attr_setstacksize error in OS_TaskCreate, Task ID = %d\n",possible_taskid);
+        printf("pthread_attr_setstacksize error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
         /* return(OS_ERROR); Disabled for older versions of linux */
     }
         
     /* 
-    ** Set priority 
+    ** Set the policy and priority. Without PTHREAD_EXPLICIT_SCHED the thread
+    ** inherits the policy of its creator and the priority is ignored.
+    */
+    if ( policy != SCHED_OTHER )
+    {
+       priority_holder.sched_priority = os_priority;
+       ret = pthread_attr_setinheritsched(&custom_attr, PTHREAD_EXPLICIT_SCHED);
+       if ( ret == 0 )
+       {
+          ret = pthread_attr_setschedpolicy(&custom_attr, policy);
+       }
+       if ( ret == 0 )
+       {
+          ret = pthread_attr_setschedparam(&custom_attr, &priority_holder);
+       }
+       if ( ret != 0 )
+       {
+          printf("pthread_attr_setschedpolicy error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
+          policy = SCHED_OTHER;
+       }
+    }
+
+#ifdef _LINUX_OS_
+    /*
+    ** Set the cores, so the task never runs anywhere else
     */
-    priority_holder.sched_priority = os_priority;
-    ret = pthread_attr_setschedparam(&custom_attr,&priority_holder);
-    if(ret !=0)
+    if ( cpu_mask != 0 )
     {
-       /*return(OS_ERROR); Disabled for older versions of linux */
+       OS_TaskCpuSet(cpu_mask, &cpu_set);
+       if ( pthread_attr_setaffinity_np(&custom_attr, sizeof(cpu_set), &cpu_set) != 0 )
+       {
+          printf("pthread_attr_setaffinity_np error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
+          cpu_mask = 0;
+       }
     }
+#endif
 
     /*
-    ** Create thread
+    ** Create thread, the new thread learns its task ID from the argument
     */
     return_code = pthread_create(&(OS_task_table[possible_taskid].id),
                                  &custom_attr,
-                                 function_pointer,
-                                 0);
+                                 OS_TaskEntryPoint,
+                                 (void *) (unsigned long)
+                                 OS_RegistryGetId(&OS_task_registry, possible_taskid));
+    if ( return_code == EPERM && policy != SCHED_OTHER )
+    {
+        /*
+        ** The process may not use a real time policy. Rather than fail the
+        ** task, run it under time sharing and let OS_TaskGetInfo report it.
+        */
+        if ( !OS_task_sched_warned )
+        {
+            OS_task_sched_warned = TRUE;
+            printf("OS_TaskCreate: no permission for real time scheduling, task %s"
+                   " runs under SCHED_OTHER\n", task_name);
+        }
+
+        policy = SCHED_OTHER;
+        pthread_attr_setinheritsched(&custom_attr, PTHREAD_INHERIT_SCHED);
+        return_code = pthread_create(&(OS_task_table[possible_taskid].id),
+                                     &custom_attr,
+                                     OS_TaskEntryPoint,
+                                     (void *) (unsigned long)
+                                     OS_RegistryGetId(&OS_task_registry, possible_taskid));
+    }
     if (return_code != 0)
     {
         pthread_mutex_lock(&OS_task_table_mut); 
         OS_task_table[possible_taskid].free = TRUE;
+        OS_RegistryFree(&OS_task_registry, possible_taskid);
+        OS_task_table[possible_taskid].stack_block = OS_STACK_NO_BLOCK;
         pthread_mutex_unlock(&OS_task_table_mut); 
-        printf("pthread_create error in OS_TaskCreate, Task ID = %d\n",possible_taskid);
+        OS_StackFree(stack_block);
+        printf("pthread_create error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
         return(OS_ERROR);
     }
 
@@ -506,1302 +900,4635 @@ int32 OS_TaskCreate (uint32 *task_id, const char *task_name, osal_task_entry fun
     return_code = pthread_detach(OS_task_table[possible_taskid].id);
     if (return_code !=0)
     {
+       /*
+       ** The thread exits at its start gate. Once it is joined its stack and
+       ** its slot can be reused.
+       */
+       OS_TaskStartGate(possible_taskid, OS_TASK_START_ABORT);
+       pthread_join(OS_task_table[possible_taskid].id, NULL);
        pthread_mutex_lock(&OS_task_table_mut);
        OS_task_table[possible_taskid].free = TRUE;
+       OS_RegistryFree(&OS_task_registry, possible_taskid);
+       OS_task_table[possible_taskid].stack_block = OS_STACK_NO_BLOCK;
        pthread_mutex_unlock(&OS_task_table_mut);
-       printf("pthread_detach error in OS_TaskCreate, Task ID = %d\n",possible_taskid);
+       OS_StackFree(stack_block);
+       printf("pthread_detach error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
        return(OS_ERROR);
     }
 
+    /*
+    ** The thread is already running, detached, so a failure here is reported
+    ** but does not fail the task
+    */
     return_code = pthread_attr_destroy(&custom_attr);
     if (return_code !=0)
     {
-       pthread_mutex_lock(&OS_task_table_mut);
-       OS_task_table[possible_taskid].free = TRUE;
-       pthread_mutex_unlock(&OS_task_table_mut);
-       printf("pthread_attr_destroy error in OS_TaskCreate, Task ID = %d\n",possible_taskid);
-       return(OS_ERROR);
+       printf("pthread_attr_destroy error in OS_TaskCreate, Task ID = %lu\n",possible_taskid);
     }
 
     /*
-    ** Assign the task ID
+    ** Wait for the thread to record itself on its stack block while the slot
+    ** is still private. Once the ID is published the task can be deleted at
+    ** any time, and its block is only reused after a thread it knows of exits.
     */
-    *task_id = possible_taskid;
+    while ( (start_state = OS_AtomicLoad(&OS_task_table[possible_taskid].start_gate)) ==
+            OS_TASK_START_WAIT )
+    {
+        OS_FutexWait(&OS_task_table[possible_taskid].start_gate, start_state, NULL);
+    }
 
-    /* 
-    ** This Id no longer free 
+    /*
+    ** Assign the task ID
     */
-    OS_task_table[possible_taskid].free = FALSE;
+    *task_id = OS_RegistryGetId(&OS_task_registry, possible_taskid);
 
     pthread_mutex_lock(&OS_task_table_mut); 
 
-    strcpy(OS_task_table[*task_id].name, (char*) task_name);
+    strcpy(OS_task_table[possible_taskid].name, (char*) task_name);
 
     OS_task_table[possible_taskid].creator = OS_FindCreator();
     OS_task_table[possible_taskid].stack_size = stack_size;
+    OS_task_table[possible_taskid].stack_base = stack_base;
+    OS_task_table[possible_taskid].stack_alloc = stack_alloc;
     /* Use the abstracted priority, not the OS one */
     OS_task_table[possible_taskid].priority = priority;
+    OS_task_table[possible_taskid].policy = policy;
+    OS_task_table[possible_taskid].affinity = cpu_mask;
+    OS_task_table[possible_taskid].affinity_pinned = pinned;
+
+    /*
+    ** The task ID is valid from here on
+    */
+    OS_RegistryPublish(&OS_task_registry, possible_taskid);
+
+    /*
+    ** Only now may the new task run and call the API with its own ID. The gate
+    ** is opened before the mutex is given back, so a delete cannot free the
+    ** slot first.
+    */
+    OS_TaskStartGate(possible_taskid, OS_TASK_START_GO);
 
     pthread_mutex_unlock(&OS_task_table_mut);
 
     return OS_SUCCESS;
 }/* end OS_TaskCreate */
 
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskStartGate
+
+    Purpose: Opens the start gate of the new task in slot local_id. OS_TASK_START_GO
+             lets it run its entry point, OS_TASK_START_ABORT makes it exit without
+             running it.
+---------------------------------------------------------------------------------------*/
+static void OS_TaskStartGate(uint32 local_id, OS_futex_t state)
+{
+    OS_AtomicStore(&OS_task_table[local_id].start_gate, state);
+    OS_FutexWake(&OS_task_table[local_id].start_gate, 1);
+}/* end OS_TaskStartGate */
 
 /*--------------------------------------------------------------------------------------
-     Name: OS_TaskDelete
+     Name: OS_TaskEntryPoint
 
-    Purpose: Deletes the specified Task and removes it from the OS_task_table.
+    Purpose: Starts every task created by OS_TaskCreate. It stores the task ID in the
+             thread local OS_task_self_id, records the thread on its stack block,
+             waits for OS_TaskCreate to publish the ID and then runs the task's
+             entry point.
 
-    returns: OS_ERR_INVALID_ID if the ID given to it is invalid
-             OS_ERROR if the OS delete call fails
-             OS_SUCCESS if success
+    returns: NULL
 ---------------------------------------------------------------------------------------*/
-int32 OS_TaskDelete (uint32 task_id)
-{    
-    int       ret;
-    FuncPtr_t FunctionPointer;
-    
-    /* 
-    ** Check to see if the task_id given is valid 
+static void *OS_TaskEntryPoint(void *arg)
+{
+    osal_task_entry     entry_point;
+    volatile OS_futex_t *start_gate;
+    OS_futex_t          state;
+
+    OS_task_self_id = (uint32) (unsigned long) arg;
+
+#ifdef _LINUX_OS_
+    /* OS_TaskGetStats reads the switch counts of other tasks from /proc by thread ID */
+    OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK].tid = (pid_t) syscall(SYS_gettid);
+    OS_StackSetThread(OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK].stack_block,
+                      (int) OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK].tid);
+#endif
+
+    entry_point = OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK].entry_point;
+
+    /*
+    ** The thread can be scheduled before OS_TaskCreate returns, and the entry
+    ** point may call the API with its ID straight away. OS_TaskCreate waits
+    ** for READY before it publishes the ID, so the record is read above while
+    ** the slot is still private. The task can be deleted as soon as the gate
+    ** opens and its slot given to a new task, so a task that finds the gate
+    ** closed again checks for its cancellation.
     */
-    if (task_id >= OS_MAX_TASKS || OS_task_table[task_id].free == TRUE)
+    start_gate = &OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK].start_gate;
+    state      = OS_TASK_START_WAIT;
+    if ( OS_AtomicCas(start_gate, &state, OS_TASK_START_READY) )
     {
-        return OS_ERR_INVALID_ID;
+        OS_FutexWake(start_gate, 1);
     }
 
-    /*
-    ** Call the thread Delete hook if there is one.
-    */
-    if ( OS_task_table[task_id].delete_hook_pointer != NULL)
+    while ( (state = OS_AtomicLoad(start_gate)) == OS_TASK_START_READY ||
+            state == OS_TASK_START_WAIT )
     {
-       FunctionPointer = (FuncPtr_t)(OS_task_table[task_id].delete_hook_pointer);
-       (*FunctionPointer)();
+        pthread_testcancel();
+        OS_FutexWait(start_gate, state, NULL);
     }
 
-    /* 
-    ** Try to delete the task 
-    */
-#ifdef _MAC_OS_
-    /*
-    ** Here, pthread_kill with a Signal handler is used, because pthread_cancel does not seem to
-    ** kill the thread on OS X. 
-    ** In addition, the OS Task Delete hook API can use this signal handler to call
-    ** the users clean up function. 
-    ** The use of the pthread_cleanup_push and pthread_cleanup_pop functions were investigated, 
-    ** but these functions only work in the same logical function block.
-    */    
-    ret = pthread_kill(OS_task_table[task_id].id, SIGUSR2); 
-#else
-    ret = pthread_cancel(OS_task_table[task_id].id);
-#endif
-    if (ret != 0)
+    if ( state != OS_TASK_START_GO )
     {
-        /*debugging statement only*/
-        /*printf("FAILED PTHREAD CANCEL %d, %d \n",ret, ESRCH); */
-        return OS_ERROR;
-    }    
-    
-    /*
-    ** Now that the task is deleted, remove its 
-    ** "presence" in OS_task_table
-    */
-    pthread_mutex_lock(&OS_task_table_mut); 
+        return NULL;
+    }
 
-    OS_task_table[task_id].free = TRUE;
-    strcpy(OS_task_table[task_id].name, "");
-    OS_task_table[task_id].creator = UNINITIALIZED;
-    OS_task_table[task_id].stack_size = UNINITIALIZED;
-    OS_task_table[task_id].priority = UNINITIALIZED;    
-    OS_task_table[task_id].id = UNINITIALIZED;
-    OS_task_table[task_id].delete_hook_pointer = NULL;
-    
-    pthread_mutex_unlock(&OS_task_table_mut);
+    (*entry_point)();
 
-    return OS_SUCCESS;
-    
-}/* end OS_TaskDelete */
+    return NULL;
+}/* end OS_TaskEntryPoint */
 
 /*--------------------------------------------------------------------------------------
-     Name: OS_TaskExit
-
-    Purpose: Exits the calling task and removes it from the OS_task_table.
+     Name: OS_TaskEpochSlot
 
-    returns: Nothing 
+    Purpose: Returns the read section epoch word of the task in slot index of the
+             task table, or of the calling task for OS_TASK_EPOCH_SELF. Each word
+             has a cache line of its own, written only by its task. NULL is
+             returned for OS_TASK_EPOCH_SELF when the caller is not an OSAL task.
 ---------------------------------------------------------------------------------------*/
-
-void OS_TaskExit()
+volatile OS_futex_t *OS_TaskEpochSlot(uint32 index)
 {
-    uint32 task_id;
+    if ( index == OS_TASK_EPOCH_SELF )
+    {
+        if ( OS_task_self_id == 0 )
+        {
+            return NULL;
+        }
 
-    task_id = OS_TaskGetId();
+        index = OS_task_self_id & OS_OBJECT_INDEX_MASK;
+    }
 
-    pthread_mutex_lock(&OS_task_table_mut); 
+    return &OS_task_table[index].epoch;
+}/* end OS_TaskEpochSlot */
 
-    OS_task_table[task_id].free = TRUE;
-    strcpy(OS_task_table[task_id].name, "");
-    OS_task_table[task_id].creator = UNINITIALIZED;
-    OS_task_table[task_id].stack_size = UNINITIALIZED;
-    OS_task_table[task_id].priority = UNINITIALIZED;
-    OS_task_table[task_id].id = UNINITIALIZED;
-    OS_task_table[task_id].delete_hook_pointer = NULL;
-    
-    pthread_mutex_unlock(&OS_task_table_mut);
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskRecordWakeup
 
-    pthread_exit(NULL);
+    Purpose: Adds a wakeup latency to the statistics of the calling task. Only the
+             task itself writes its statistics, so no lock is taken.
+---------------------------------------------------------------------------------------*/
+void OS_TaskRecordWakeup(uint64 latency_ns)
+{
+    OS_task_record_t *task;
+    uint64            usecs = latency_ns / 1000;
+    uint32            bucket = 0;
 
-}/*end OS_TaskExit */
-/*---------------------------------------------------------------------------------------
-   Name: OS_TaskDelay
+    if ( OS_task_self_id == 0 )
+    {
+        return;
+    }
 
-   Purpose: Delay a task for specified amount of milliseconds
+    task = &OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK];
 
-   returns: OS_ERROR if sleep fails or millisecond = 0
-            OS_SUCCESS if success
----------------------------------------------------------------------------------------*/
-int32 OS_TaskDelay(uint32 millisecond )
-{
-    if (usleep(millisecond * 1000 ) != 0)
+    if ( usecs > task->max_wakeup_usecs )
     {
-        return OS_ERROR;
+        task->max_wakeup_usecs = usecs > 0xFFFFFFFFUL ? 0xFFFFFFFFUL : (uint32) usecs;
     }
-    else
+
+    while ( usecs != 0 && bucket < OS_TASK_STATS_BUCKETS - 1 )
     {
-        return OS_SUCCESS;
+        usecs >>= 1;
+        bucket++;
     }
-    
-}/* end OS_TaskDelay */
 
-/*---------------------------------------------------------------------------------------
-   Name: OS_TaskSetPriority
+    task->wakeup_histogram[bucket]++;
+    task->wakeups++;
 
-   Purpose: Sets the given task to a new priority
+}/* end OS_TaskRecordWakeup */
 
-    returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
-             OS_ERR_INVALID_PRIORITY if the priority is greater than the max 
-             allowed
-             OS_ERROR if the OS call to change the priority fails
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskSleepUntil
+
+    Purpose: OS_SleepUntil for the task delays, recording how late the task woke up.
+             A time that has already passed returns at once and records nothing.
+
+    returns: OS_ERROR if the sleep fails
              OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-int32 OS_TaskSetPriority (uint32 task_id, uint32 new_priority)
+static int32 OS_TaskSleepUntil(const struct timespec *deadline)
 {
-    pthread_attr_t     custom_attr ;
-    struct sched_param priority_holder ;
-    int                os_priority;
-
-    if(task_id >= OS_MAX_TASKS || OS_task_table[task_id].free == TRUE)
-    {
-        return OS_ERR_INVALID_ID;
-    }
+    uint64 wakeup_time;
+    uint64 now;
 
-    if (new_priority > MAX_PRIORITY)
+    wakeup_time = OS_TimespecToNs(deadline);
+    if ( OS_MonotonicNow() >= wakeup_time )
     {
-        return OS_ERR_INVALID_PRIORITY;
+        return OS_SUCCESS;
     }
-   
-    /* Change OSAL priority into a priority that will work for this OS */
-    os_priority = OS_PriorityRemap(new_priority);
 
-    /* 
-    ** Set priority -- This is currently incomplete ..
-    */
-    priority_holder.sched_priority = os_priority ;
-    if(pthread_attr_setschedparam(&custom_attr,&priority_holder))
+    if ( OS_SleepUntil(deadline) != OS_SUCCESS )
     {
-       printf("pthread_attr_setschedparam error in OS_TaskSetPriority, Task ID = %lu\n",task_id);
-       return(OS_ERROR);
+        return OS_ERROR;
     }
 
-    /* Use the abstracted priority, not the OS one */
-    /* Change the priority in the table as well */
-    OS_task_table[task_id].priority = new_priority;
+    now = OS_MonotonicNow();
+    OS_TaskRecordWakeup(now > wakeup_time ? now - wakeup_time : 0);
 
-   return OS_SUCCESS;
-} /* end OS_TaskSetPriority */
+    return OS_SUCCESS;
+}/* end OS_TaskSleepUntil */
 
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskSchedPolicy
 
-/*---------------------------------------------------------------------------------------
-   Name: OS_TaskRegister
-  
-   Purpose: Registers the calling task id with the task by adding the var to the tcb
-            It searches the OS_task_table to find the task_id corresponding to the tcb_id
-            
-   Returns: OS_ERR_INVALID_ID if there the specified ID could not be found
-            OS_ERROR if the OS call fails
-            OS_SUCCESS if success
+    Purpose: Returns the pthread scheduling policy selected by the OS_TASK_SCHED_ flags
+             of OS_TaskCreate, or by OS_TASK_SCHED_DEFAULT when no policy flag is set.
 ---------------------------------------------------------------------------------------*/
-int32 OS_TaskRegister (void)
+static int OS_TaskSchedPolicy(uint32 flags)
 {
-    int          i;
-    int          ret;
-    uint32       task_id;
-    pthread_t    pthread_id;
-
-#ifdef _MAC_OS_
-    /* set up a signal handler to be able to cancel this task if needed */
-    signal(SIGUSR2, OS_ThreadKillHandler);
+#ifdef OS_TASK_SCHED_DEFAULT
+    if ( (flags & OS_TASK_SCHED_MASK) == 0 )
+    {
+        flags |= OS_TASK_SCHED_DEFAULT;
+    }
 #endif
 
-    /* 
-    ** Get PTHREAD Id
-    */
-    pthread_id = pthread_self();
-
-    /*
-    ** Look our task ID in table 
-    */
-    for(i = 0; i < OS_MAX_TASKS; i++)
+    if ( flags & OS_TASK_SCHED_FIFO )
     {
-       if(OS_task_table[i].id == pthread_id)
-       {
-          break;
-       }
+        return SCHED_FIFO;
     }
-    task_id = i;
-
-    if(task_id == OS_MAX_TASKS)
+    else if ( flags & OS_TASK_SCHED_RR )
     {
-        return OS_ERR_INVALID_ID;
+        return SCHED_RR;
     }
-
-    /*
-    ** Add pthread variable
-    */
-    ret = pthread_setspecific(thread_key, (void *)task_id);
-    if ( ret != 0 )
+    else
     {
-       printf("OS_TaskRegister Failed during pthread_setspecific function\n");
-       return(OS_ERROR);
+        return SCHED_OTHER;
     }
+}/* end OS_TaskSchedPolicy */
 
-    return OS_SUCCESS;
-}/* end OS_TaskRegister */
-
-/*---------------------------------------------------------------------------------------
-   Name: OS_TaskGetId
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskCheckAffinity
 
-   Purpose: This function returns the #defined task id of the calling task
+    Purpose: Checks that a core mask is not empty and only holds cores this host has
 
-   Notes: The OS_task_key is initialized by the task switch if AND ONLY IF the 
-          OS_task_key has been registered via OS_TaskRegister(..).  If this is not 
-          called prior to this call, the value will be old and wrong.
+    returns: OS_TASK_INVALID_AFFINITY if the mask is empty or names a missing core
+             OS_ERR_NOT_IMPLEMENTED if tasks cannot be pinned on this host
+             OS_SUCCESS if the mask can be used
 ---------------------------------------------------------------------------------------*/
-uint32 OS_TaskGetId (void)
-{ 
-   void*   task_id;
-   int     task_id_int;
-   uint32   task_key;
-   task_key = 0;
-   
-   task_id = (void *)pthread_getspecific(thread_key);
+static int32 OS_TaskCheckAffinity(uint32 cpu_mask)
+{
+#ifdef _LINUX_OS_
+    long   cpus;
+    uint32 all_cpus;
 
-   memcpy(& task_id_int,&task_id, sizeof(uint32));
-   task_key = task_id_int & 0xFFFF;
-   
-   return(task_key);
-}/* end OS_TaskGetId */
+    cpus = sysconf(_SC_NPROCESSORS_CONF);
+    all_cpus = (cpus >= 32) ? 0xFFFFFFFF : (uint32) ((1UL << cpus) - 1);
 
-/*--------------------------------------------------------------------------------------
-    Name: OS_TaskGetIdByName
+    if ( cpu_mask == 0 || (cpu_mask & ~all_cpus) != 0 )
+    {
+        return OS_TASK_INVALID_AFFINITY;
+    }
 
-    Purpose: This function tries to find a task Id given the name of a task
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_TaskCheckAffinity */
 
-    Returns: OS_INVALID_POINTER if the pointers passed in are NULL
-             OS_ERR_NAME_TOO_LONG if th ename to found is too long to begin with
-             OS_ERR_NAME_NOT_FOUND if the name wasn't found in the table
-             OS_SUCCESS if SUCCESS
----------------------------------------------------------------------------------------*/
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskPolicyAffinity
 
-int32 OS_TaskGetIdByName (uint32 *task_id, const char *task_name)
+    Purpose: Returns the core mask the affinity policy gives a task of this priority,
+             0 if no band covers it. Called with the task table mutex held.
+---------------------------------------------------------------------------------------*/
+static uint32 OS_TaskPolicyAffinity(uint32 priority)
 {
     uint32 i;
 
-    if (task_id == NULL || task_name == NULL)
-    {
-       return OS_INVALID_POINTER;
-    }
-    
-    /* 
-    ** we don't want to allow names too long because they won't be found at all 
-    */
-    if (strlen(task_name) >= OS_MAX_API_NAME)
+    for ( i = 0; i < OS_task_affinity_bands; i++ )
     {
-       return OS_ERR_NAME_TOO_LONG;
+        if ( priority >= OS_task_affinity_policy[i].min_priority &&
+             priority <= OS_task_affinity_policy[i].max_priority )
+        {
+            return OS_task_affinity_policy[i].cpu_mask;
+        }
     }
 
-    for (i = 0; i < OS_MAX_TASKS; i++)
+    return 0;
+}/* end OS_TaskPolicyAffinity */
+
+#ifdef _LINUX_OS_
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskCpuSet
+
+    Purpose: Converts a core mask into a cpu_set_t. A mask of 0 gives every core.
+---------------------------------------------------------------------------------------*/
+static void OS_TaskCpuSet(uint32 cpu_mask, cpu_set_t *cpu_set)
+{
+    int cpu;
+
+    CPU_ZERO(cpu_set);
+
+    for ( cpu = 0; cpu < 32 && cpu < CPU_SETSIZE; cpu++ )
     {
-        if((OS_task_table[i].free != TRUE) &&
-                (strcmp(OS_task_table[i].name,(char*) task_name) == 0 ))
+        if ( cpu_mask == 0 || (cpu_mask & (1UL << cpu)) != 0 )
         {
-            *task_id = i;
-            return OS_SUCCESS;
+            CPU_SET(cpu, cpu_set);
         }
     }
-    /* The name was not found in the table,
-    **  or it was, and the task_id isn't valid anymore 
-    */
-    return OS_ERR_NAME_NOT_FOUND;
-
-}/* end OS_TaskGetIdByName */            
+}/* end OS_TaskCpuSet */
+#endif
 
-/*---------------------------------------------------------------------------------------
-    Name: OS_TaskGetInfo
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskApplyAffinity
 
-    Purpose: This function will pass back a pointer to structure that contains 
-             all of the relevant info (creator, stack size, priority, name) about the 
-             specified task. 
+    Purpose: Moves a running task onto the cores of cpu_mask, or lets it run on every
+             core when the mask is 0, and records the mask. Called with the task table
+             mutex held.
 
-    Returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
-             OS_INVALID_POINTER if the task_prop pointer is NULL
-             OS_SUCCESS if it copied all of the relevant info over
- 
+    returns: OS_ERROR if the OS call fails
+             OS_ERR_NOT_IMPLEMENTED if tasks cannot be pinned on this host
+             OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-int32 OS_TaskGetInfo (uint32 task_id, OS_task_prop_t *task_prop)  
+static int32 OS_TaskApplyAffinity(uint32 local_id, uint32 cpu_mask)
 {
+#ifdef _LINUX_OS_
+    cpu_set_t cpu_set;
+    int       ret;
+
+    OS_TaskCpuSet(cpu_mask, &cpu_set);
+
+    ret = pthread_setaffinity_np(OS_task_table[local_id].id, sizeof(cpu_set), &cpu_set);
+    if ( ret != 0 )
+    {
+        printf("pthread_setaffinity_np error in OS_TaskSetAffinity, Task ID = %lu: %s\n",
+               local_id, strerror(ret));
+        return OS_ERROR;
+    }
+
+    OS_task_table[local_id].affinity = cpu_mask;
+
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_TaskApplyAffinity */
+
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskDelete
+
+    Purpose: Deletes the specified Task and removes it from the OS_task_table.
+
+    returns: OS_ERR_INVALID_ID if the ID given to it is invalid
+             OS_ERROR if the OS delete call fails
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskDelete (uint32 task_id)
+{    
+    uint32    local_id;
+    int       ret;
+    FuncPtr_t FunctionPointer;
+    
     /* 
-    ** Check to see that the id given is valid 
+    ** Check to see if the task_id given is valid, and retire it so that
+    ** no other call can use it while the task is being deleted
     */
-    if (task_id >= OS_MAX_TASKS || OS_task_table[task_id].free == TRUE)
+    if (OS_RegistryRetire(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
     {
-       return OS_ERR_INVALID_ID;
+        return OS_ERR_INVALID_ID;
     }
 
-    if( task_prop == NULL)
+    /*
+    ** Call the thread Delete hook if there is one.
+    */
+    if ( OS_task_table[local_id].delete_hook_pointer != NULL)
     {
-       return OS_INVALID_POINTER;
+       FunctionPointer = (FuncPtr_t)(OS_task_table[local_id].delete_hook_pointer);
+       (*FunctionPointer)();
     }
 
-    /* put the info into the stucture */
+    /* 
+    ** Try to delete the task 
+    */
+#ifdef _MAC_OS_
+    /*
+    ** Here, pthread_kill with a Signal handler is used, because pthread_cancel does not seem to
+    ** kill the thread on OS X. 
+    ** In addition, the OS Task Delete hook API can use this signal handler to call
+    ** the users clean up function. 
+    ** The use of the pthread_cleanup_push and pthread_cleanup_pop functions were investigated, 
+    ** but these functions only work in the same logical function block.
+    */    
+    ret = pthread_kill(OS_task_table[local_id].id, SIGUSR2); 
+#else
+    ret = pthread_cancel(OS_task_table[local_id].id);
+#endif
+    if (ret != 0)
+    {
+        /*debugging statement only*/
+        /*printf("FAILED PTHREAD CANCEL %d, %d \n",ret, ESRCH); */
+        OS_RegistryPublish(&OS_task_registry, local_id);
+        return OS_ERROR;
+    }    
+    
+    /*
+    ** Now that the task is deleted, remove its 
+    ** "presence" in OS_task_table
+    */
     pthread_mutex_lock(&OS_task_table_mut); 
 
-    task_prop -> creator =    OS_task_table[task_id].creator;
-    task_prop -> stack_size = OS_task_table[task_id].stack_size;
-    task_prop -> priority =   OS_task_table[task_id].priority;
-    task_prop -> OStask_id =  (uint32) OS_task_table[task_id].id;
+    OS_task_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_task_registry, local_id);
+    strcpy(OS_task_table[local_id].name, "");
+    OS_task_table[local_id].creator = UNINITIALIZED;
+    OS_task_table[local_id].stack_size = UNINITIALIZED;
+    OS_StackRelease(OS_task_table[local_id].stack_block);
+    OS_task_table[local_id].stack_block = OS_STACK_NO_BLOCK;
+    OS_task_table[local_id].stack_base = NULL;
+    OS_task_table[local_id].priority = UNINITIALIZED;    
+    OS_task_table[local_id].id = UNINITIALIZED;
+    OS_task_table[local_id].delete_hook_pointer = NULL;
+    /* a task deleted inside a read section must not hold up the grace periods */
+    OS_AtomicStore(&OS_task_table[local_id].epoch, 0);
     
-    strcpy(task_prop-> name, OS_task_table[task_id].name);
-
     pthread_mutex_unlock(&OS_task_table_mut);
-    
+
     return OS_SUCCESS;
     
-} /* end OS_TaskGetInfo */
+}/* end OS_TaskDelete */
 
 /*--------------------------------------------------------------------------------------
-     Name: OS_TaskInstallDeleteHandler
+     Name: OS_TaskExit
 
-    Purpose: Installs a handler for when the task is deleted.
+    Purpose: Exits the calling task and removes it from the OS_task_table.
 
-    returns: status
+    returns: Nothing 
 ---------------------------------------------------------------------------------------*/
 
-int32 OS_TaskInstallDeleteHandler(void *function_pointer)
+void OS_TaskExit()
 {
-    uint32 task_id;
-
-    task_id = OS_TaskGetId();
+    uint32 local_id;
 
-    if ( task_id >= OS_MAX_TASKS )
+    if (OS_RegistryRetire(&OS_task_registry, OS_TaskGetId(), &local_id) == OS_SUCCESS)
     {
-       return(OS_ERR_INVALID_ID);
+        pthread_mutex_lock(&OS_task_table_mut); 
+
+        OS_task_table[local_id].free = TRUE;
+        OS_RegistryFree(&OS_task_registry, local_id);
+        strcpy(OS_task_table[local_id].name, "");
+        OS_task_table[local_id].creator = UNINITIALIZED;
+        OS_task_table[local_id].stack_size = UNINITIALIZED;
+        OS_StackRelease(OS_task_table[local_id].stack_block);
+        OS_task_table[local_id].stack_block = OS_STACK_NO_BLOCK;
+        OS_task_table[local_id].stack_base = NULL;
+        OS_task_table[local_id].priority = UNINITIALIZED;
+        OS_task_table[local_id].id = UNINITIALIZED;
+        OS_task_table[local_id].delete_hook_pointer = NULL;
+        OS_AtomicStore(&OS_task_table[local_id].epoch, 0);
+    
+        pthread_mutex_unlock(&OS_task_table_mut);
     }
 
-    pthread_mutex_lock(&OS_task_table_mut); 
+    pthread_exit(NULL);
 
-    if ( OS_task_table[task_id].free != FALSE )
-    {
-       /* 
-       ** Somehow the calling task is not registered 
-       */
-       pthread_mutex_unlock(&OS_task_table_mut);
-       return(OS_ERR_INVALID_ID);
-    }
+}/*end OS_TaskExit */
+/*---------------------------------------------------------------------------------------
+   Name: OS_TaskDelay
+
+   Purpose: Delay a task for specified amount of milliseconds
+
+   returns: OS_ERROR if sleep fails or millisecond = 0
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskDelay(uint32 millisecond )
+{
+    struct timespec deadline;
 
     /*
-    ** Install the pointer
+    ** Sleep until an absolute CLOCK_MONOTONIC time, so a sleep that is
+    ** interrupted by a signal picks up where it left off
     */
-    OS_task_table[task_id].delete_hook_pointer = function_pointer;    
-    
-    pthread_mutex_unlock(&OS_task_table_mut);
+    OS_CompMonotonicDeadline(millisecond, &deadline);
 
-    return(OS_SUCCESS);
+    return OS_TaskSleepUntil(&deadline);
     
-}/*end OS_TaskInstallDeleteHandler */
+}/* end OS_TaskDelay */
 
-/****************************************************************************************
-                                MESSAGE QUEUE API
-****************************************************************************************/
-#ifdef OSAL_SOCKET_QUEUE
 /*---------------------------------------------------------------------------------------
-   Name: OS_QueueCreate
-
-   Purpose: Create a message queue which can be refered to by name or ID
+   Name: OS_TaskDelayUntil
 
-   Returns: OS_INVALID_POINTER if a pointer passed in is NULL
-            OS_ERR_NAME_TOO_LONG if the name passed in is too long
-            OS_ERR_NO_FREE_IDS if there are already the max queues created
-            OS_ERR_NAME_TAKEN if the name is already being used on another queue
-            OS_ERROR if the OS create call fails
-            OS_SUCCESS if success
+   Purpose: Delays the calling task until an absolute time on the clock read by
+            OS_GetMonotonicTime. A loop that adds its period to the wakeup time
+            each time around runs at an exact rate, however long each pass takes.
 
-   Notes: the flahs parameter is unused.
+   returns: OS_INVALID_POINTER if wakeup_time is NULL
+            OS_ERROR if microsecs is out of range or the sleep fails
+            OS_SUCCESS if success, also when the time has already passed
 ---------------------------------------------------------------------------------------*/
-int32 OS_QueueCreate (uint32 *queue_id, const char *queue_name, uint32 queue_depth,
-                       uint32 data_size, uint32 flags)
+int32 OS_TaskDelayUntil(const OS_time_t *wakeup_time)
 {
-   int                     tmpSkt;
-   int                     returnStat;
-   struct sockaddr_in      servaddr;
-   int                     i;
-   uint32                  possible_qid;
+    struct timespec deadline;
 
-    if ( queue_id == NULL || queue_name == NULL)
+    if ( wakeup_time == NULL )
     {
         return OS_INVALID_POINTER;
     }
 
-    /* we don't want to allow names too long*/
-    /* if truncated, two names might be the same */
-
-    if (strlen(queue_name) >= OS_MAX_API_NAME)
+    if ( wakeup_time->microsecs >= 1000000 )
     {
-       return OS_ERR_NAME_TOO_LONG;
+        return OS_ERROR;
     }
 
-   /* Check Parameters */
+    deadline.tv_sec  = (time_t) wakeup_time->seconds;
+    deadline.tv_nsec = (long) wakeup_time->microsecs * 1000;
 
-    pthread_mutex_lock(&OS_queue_table_mut);    
-    
-    for(possible_qid = 0; possible_qid < OS_MAX_QUEUES; possible_qid++)
+    return OS_TaskSleepUntil(&deadline);
+
+}/* end OS_TaskDelayUntil */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_TaskSetPeriod
+
+   Purpose: Makes the calling task periodic. The first period starts now, and each
+            call to OS_TaskWaitPeriod waits for the start of the next one. The work
+            of each period must be done deadline_usecs after the period starts, a
+            deadline of 0 is the end of the period. A period of 0 makes the task
+            stop being periodic. The statistics start over.
+
+   returns: OS_ERR_INVALID_ID if the caller is not an OSAL task
+            OS_TASK_INVALID_PERIOD if the deadline is longer than the period
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskSetPeriod(uint32 period_usecs, uint32 deadline_usecs)
+{
+    OS_task_record_t *task;
+
+    if ( OS_task_self_id == 0 )
     {
-        if (OS_queue_table[possible_qid].free == TRUE)
-            break;
+        return OS_ERR_INVALID_ID;
     }
-        
-    if( possible_qid >= OS_MAX_QUEUES || OS_queue_table[possible_qid].free != TRUE)
+
+    if ( deadline_usecs > period_usecs )
     {
-        pthread_mutex_unlock(&OS_queue_table_mut);
-        return OS_ERR_NO_FREE_IDS;
+        return OS_TASK_INVALID_PERIOD;
     }
 
-    /* Check to see if the name is already taken */
-    for (i = 0; i < OS_MAX_QUEUES; i++)
+    if ( deadline_usecs == 0 )
     {
-        if ((OS_queue_table[i].free == FALSE) &&
-                strcmp ((char*) queue_name, OS_queue_table[i].name) == 0)
-        {
-            pthread_mutex_unlock(&OS_queue_table_mut);
-            return OS_ERR_NAME_TAKEN;
-        }
-    } 
+        deadline_usecs = period_usecs;
+    }
 
-    /* Set the possible task Id to not free so that
-     * no other task can try to use it */
+    task = &OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK];
 
-    OS_queue_table[possible_qid].free = FALSE;
-    
-    pthread_mutex_unlock(&OS_queue_table_mut);
-    
-    tmpSkt = socket(AF_INET, SOCK_DGRAM, 0);
-    if ( tmpSkt == -1 )
-    {
-        pthread_mutex_lock(&OS_queue_table_mut);
-        OS_queue_table[possible_qid].free = TRUE;
-        pthread_mutex_unlock(&OS_queue_table_mut);
+    task->period_ns        = (uint64) period_usecs * 1000;
+    task->deadline_ns      = (uint64) deadline_usecs * 1000;
+    task->next_release     = OS_MonotonicNow() + task->period_ns;
+    task->periods          = 0;
+    task->overruns         = 0;
+    task->max_jitter_usecs = 0;
+    task->total_jitter_ns  = 0;
 
-        printf("Failed to create a socket on OS_QueueCreate. errno = %d\n",errno);
-        return OS_ERROR;
+    return OS_SUCCESS;
+
+}/* end OS_TaskSetPeriod */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_TaskWaitPeriod
+
+   Purpose: Ends the work of the current period of the calling task and waits for
+            the start of the next one. The periods are fixed on the clock from
+            OS_TaskSetPeriod on, so a late wakeup is not carried into the next
+            period. If the next period has already started the task goes on at
+            once. Whole periods that went by without the task are skipped and
+            counted as overruns.
+
+   returns: OS_ERR_INVALID_ID if the caller is not an OSAL task
+            OS_TASK_INVALID_PERIOD if the task is not periodic
+            OS_TASK_PERIOD_OVERRUN if the period ended after its deadline
+            OS_ERROR if the sleep fails
+            OS_SUCCESS if success
+
+   Notes: The statistics are kept by the task without a lock, so a periodic
+          task never waits for the task table. OS_TaskGetInfo may see them
+          one period apart.
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskWaitPeriod(void)
+{
+    OS_task_record_t *task;
+    struct timespec   release;
+    uint64            now;
+    uint64            skipped;
+    uint64            jitter;
+    int32             status = OS_SUCCESS;
+
+    if ( OS_task_self_id == 0 )
+    {
+        return OS_ERR_INVALID_ID;
     }
 
-    memset(&servaddr, 0, sizeof(servaddr));
-    servaddr.sin_family      = AF_INET;
-    servaddr.sin_port        = htons(OS_BASE_PORT + possible_qid);
-    servaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); 
+    task = &OS_task_table[OS_task_self_id & OS_OBJECT_INDEX_MASK];
+    if ( task->period_ns == 0 )
+    {
+        return OS_TASK_INVALID_PERIOD;
+    }
 
-   /* 
-   ** bind the input socket to a pipe
-   ** port numbers are OS_BASE_PORT + queue_id
-   */
-   returnStat = bind(tmpSkt,(struct sockaddr *)&servaddr, sizeof(servaddr));
-   
-   if ( returnStat == -1 )
-   {
-        pthread_mutex_lock(&OS_queue_table_mut);
-        OS_queue_table[possible_qid].free = TRUE;
-        pthread_mutex_unlock(&OS_queue_table_mut);
+    /*
+    ** The period that ends here started one period before the next release
+    */
+    now = OS_MonotonicNow();
+    if ( now > task->next_release - task->period_ns + task->deadline_ns )
+    {
+        task->overruns++;
+        status = OS_TASK_PERIOD_OVERRUN;
+    }
 
-        printf("bind failed on OS_QueueCreate. errno = %d\n",errno);
-        return OS_ERROR;
-   }
-   
-   /*
-   ** store socket handle
-   */
-   *queue_id = possible_qid;
-   
-    pthread_mutex_lock(&OS_queue_table_mut);    
+    if ( now >= task->next_release )
+    {
+        skipped = (now - task->next_release) / task->period_ns;
+        task->next_release += skipped * task->period_ns;
+        task->overruns     += (uint32) skipped;
+    }
+    else
+    {
+        release.tv_sec  = (time_t) (task->next_release / 1000000000ULL);
+        release.tv_nsec = (long) (task->next_release % 1000000000ULL);
+        if ( OS_SleepUntil(&release) != OS_SUCCESS )
+        {
+            return OS_ERROR;
+        }
+        now = OS_MonotonicNow();
+        OS_TaskRecordWakeup(now - task->next_release);
+    }
 
-   OS_queue_table[*queue_id].id = tmpSkt;
-   OS_queue_table[*queue_id].free = FALSE;
-   strcpy( OS_queue_table[*queue_id].name, (char*) queue_name);
-   OS_queue_table[*queue_id].creator = OS_FindCreator();
+    /*
+    ** The jitter is how late the task woke up for the period that starts now
+    */
+    jitter = now - task->next_release;
+    if ( jitter / 1000 > task->max_jitter_usecs )
+    {
+        task->max_jitter_usecs = (uint32) (jitter / 1000);
+    }
+    task->total_jitter_ns += jitter;
+    task->periods++;
 
-    pthread_mutex_unlock(&OS_queue_table_mut);
+    task->next_release += task->period_ns;
 
-   return OS_SUCCESS;
-    
-}/* end OS_QueueCreate */
+    return status;
 
+}/* end OS_TaskWaitPeriod */
 
-/*--------------------------------------------------------------------------------------
-    Name: OS_QueueDelete
+/*---------------------------------------------------------------------------------------
+   Name: OS_TaskSetPriority
 
-    Purpose: Deletes the specified message queue.
+   Purpose: Sets the given task to a new priority
 
-    Returns: OS_ERR_INVALID_ID if the id passed in does not exist
-             OS_ERROR if the OS call to delete the queue fails 
+    returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
+             OS_ERR_INVALID_PRIORITY if the priority is greater than the max 
+             allowed
+             OS_ERROR if the OS call to change the priority fails
              OS_SUCCESS if success
-
-    Notes: If There are messages on the queue, they will be lost and any subsequent
-           calls to QueueGet or QueuePut to this queue will result in errors
 ---------------------------------------------------------------------------------------*/
-int32 OS_QueueDelete (uint32 queue_id)
+int32 OS_TaskSetPriority (uint32 task_id, uint32 new_priority)
 {
-    /* Check to see if the queue_id given is valid */
-    
-    if (queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
+    uint32             local_id;
+    struct sched_param priority_holder ;
+    int                os_priority;
+    int                ret;
+
+    if (OS_RegistryCheckId(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
 
-    /* Try to delete the queue */
-
-    if(close(OS_queue_table[queue_id].id) !=0)   
+    if (new_priority > MAX_PRIORITY)
     {
-        return OS_ERROR;
+        return OS_ERR_INVALID_PRIORITY;
     }
-        
+   
+    /* Change OSAL priority into a priority that will work for this OS */
+    os_priority = OS_PriorityRemap(new_priority);
+
     /* 
-     * Now that the queue is deleted, remove its "presence"
-     * in OS_message_q_table and OS_message_q_name_table 
+    ** Change the priority of the running thread. A task under SCHED_OTHER
+    ** has no real time priority, there it is only recorded.
     */
-        
-    pthread_mutex_lock(&OS_queue_table_mut);    
+    if ( OS_task_table[local_id].policy != SCHED_OTHER )
+    {
+       priority_holder.sched_priority = os_priority ;
+       ret = pthread_setschedparam(OS_task_table[local_id].id,
+                                   OS_task_table[local_id].policy, &priority_holder);
+       if ( ret != 0 )
+       {
+          printf("pthread_setschedparam error in OS_TaskSetPriority, Task ID = %lu: %s\n",
+                 task_id, strerror(ret));
+          return(OS_ERROR);
+       }
+    }
+
+    /* Use the abstracted priority, not the OS one */
+    /* Change the priority in the table as well */
+    pthread_mutex_lock(&OS_task_table_mut);
 
-    OS_queue_table[queue_id].free = TRUE;
-    strcpy(OS_queue_table[queue_id].name, "");
-    OS_queue_table[queue_id].creator = UNINITIALIZED;
-    OS_queue_table[queue_id].id = UNINITIALIZED;
+    OS_task_table[local_id].priority = new_priority;
+
+    /* A task that is not pinned moves to the cores of its new priority band */
+    if ( !OS_task_table[local_id].affinity_pinned &&
+         OS_TaskPolicyAffinity(new_priority) != OS_task_table[local_id].affinity )
+    {
+        OS_TaskApplyAffinity(local_id, OS_TaskPolicyAffinity(new_priority));
+    }
+
+    pthread_mutex_unlock(&OS_task_table_mut);
 
-    pthread_mutex_unlock(&OS_queue_table_mut);
- 
    return OS_SUCCESS;
+} /* end OS_TaskSetPriority */
 
-} /* end OS_QueueDelete */
 
 /*---------------------------------------------------------------------------------------
-   Name: OS_QueueGet
-
-   Purpose: Receive a message on a message queue.  Will pend or timeout on the receive.
-   Returns: OS_ERR_INVALID_ID if the given ID does not exist
-            OS_INVALID_POINTER if a pointer passed in is NULL
-            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
-            OS_QUEUE_TIMEOUT if the timeout was OS_PEND and the time expired
-            OS_QUEUE_INVALID_SIZE if the size copied from the queue was not correct
-            OS_ERROR if there was an error waiting for the timeout
+   Name: OS_TaskRegister
+  
+   Purpose: Registers the calling task with the OS API. The task ID is now set up by
+            OS_TaskCreate before the task's entry point runs, so this only checks that
+            the caller is an OSAL task.
+            
+   Returns: OS_ERR_INVALID_ID if the calling thread is not an OSAL task
             OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-int32 OS_QueueGet (uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+int32 OS_TaskRegister (void)
 {
-   int sizeCopied;
-   int flags;
+#ifdef _MAC_OS_
+    /* set up a signal handler to be able to cancel this task if needed */
+    signal(SIGUSR2, OS_ThreadKillHandler);
+#endif
 
-   /*
-   ** Check Parameters 
-   */
-   if(queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
-   {
-       return OS_ERR_INVALID_ID;
-   }
-   else if( (data == NULL) || (size_copied == NULL) )
-   {
-       return OS_INVALID_POINTER;
-   }
-    
-   /*
-   ** Read the socket for data
-   */
-   if (timeout == OS_PEND) 
-   {      
-      fcntl(OS_queue_table[queue_id].id,F_SETFL,0);
-      /*
-      ** A signal can interrupt the recvfrom call, so the call has to be done with 
-      ** a loop
-      */
-      do 
-      {
-         sizeCopied = recvfrom(OS_queue_table[queue_id].id, data, size, 0, NULL, NULL);
-      } while ( sizeCopied == -1 && errno == EINTR );
-      
-      if(sizeCopied != size )
-      {
-         *size_copied = 0;
-         return(OS_QUEUE_INVALID_SIZE);
-      }
-   }
-   else if (timeout == OS_CHECK)
-   {      
-      flags = fcntl(OS_queue_table[queue_id].id, F_GETFL, 0);
-      fcntl(OS_queue_table[queue_id].id,F_SETFL,flags|O_NONBLOCK);
-      
-      sizeCopied = recvfrom(OS_queue_table[queue_id].id, data, size, 0, NULL, NULL);
+    if ( OS_task_self_id == 0 )
+    {
+        return OS_ERR_INVALID_ID;
+    }
 
-      fcntl(OS_queue_table[queue_id].id,F_SETFL,flags);
-      
-      if (sizeCopied == -1 && errno == EWOULDBLOCK )
-      {
-         *size_copied = 0;
-         return(OS_QUEUE_EMPTY);
-      }
-      else if(sizeCopied != size )
-      {
-         *size_copied = 0;
-         return(OS_QUEUE_INVALID_SIZE);
-      }
+    return OS_SUCCESS;
+}/* end OS_TaskRegister */
 
-   }
-   else /* timeout */ 
-   {
-      int    rv;
-      int    sock = OS_queue_table[queue_id].id;
-      struct timeval tv_timeout;
-      fd_set fdset;
+/*---------------------------------------------------------------------------------------
+   Name: OS_TaskGetId
 
-      FD_ZERO( &fdset );
-      FD_SET( sock, &fdset );
+   Purpose: This function returns the #defined task id of the calling task
 
-      /*
-      ** Translate the timeout value from milliseconds into 
-      ** seconds and nanoseconds.
-      */
-      tv_timeout.tv_usec = (timeout % 1000) * 1000;
-      tv_timeout.tv_sec = timeout / 1000;
-      
-      /*
-      ** Use select to wait for data to come in on the socket
-      ** TODO: If the select call is interrupted, the timeout should be 
-      ** re-computed to avoid having to delay for the full time.
-      **       
-      */
-      do 
-      {
-         FD_ZERO( &fdset );
-         FD_SET( sock, &fdset );
-         rv = select( sock+1, &fdset, NULL, NULL, &tv_timeout );
-      } while ( rv == -1 && errno == EINTR );
-      
-      if( rv > 0 )
-      {
-         /* got a packet within the timeout */
-         sizeCopied = recvfrom(OS_queue_table[queue_id].id, data, size, 0, NULL, NULL);
+   Notes: The ID is kept in a thread local variable set when the task starts, so
+          this does not search the task table. A thread that was not created with
+          OS_TaskCreate gets 0, which is never a valid task id.
+---------------------------------------------------------------------------------------*/
+uint32 OS_TaskGetId (void)
+{ 
+   return(OS_task_self_id);
+}/* end OS_TaskGetId */
 
-         if ( sizeCopied == size )
-         {
-            *size_copied = sizeCopied;
-            return OS_SUCCESS;
-         }
-         else
-         {
-            *size_copied = 0;
-            return OS_QUEUE_INVALID_SIZE;
-         }
-      }
-      else if ( rv < 0 )
-      {
-         /* 
-         ** Need to handle Select error codes here 
-         ** This might need a new error code: OS_QUEUE_TIMEOUT_ERROR
-         */
-         printf("Bad return value from select: %d, sock = %d\n", rv, sock);
-         return OS_ERROR;
-      }
-      
-      /*
-      ** If rv == 0, then the select timed out with no data
-      */
-      return(OS_QUEUE_TIMEOUT);
-     
-   } /* END timeout */
+/*--------------------------------------------------------------------------------------
+    Name: OS_TaskGetIdByName
 
-   /*
-   ** Should never really get here.
-   */
-   return OS_SUCCESS;
+    Purpose: This function tries to find a task Id given the name of a task
 
-} /* end OS_QueueGet */
+    Returns: OS_INVALID_POINTER if the pointers passed in are NULL
+             OS_ERR_NAME_TOO_LONG if th ename to found is too long to begin with
+             OS_ERR_NAME_NOT_FOUND if the name wasn't found in the table
+             OS_SUCCESS if SUCCESS
+---------------------------------------------------------------------------------------*/
+
+int32 OS_TaskGetIdByName (uint32 *task_id, const char *task_name)
+{
+    int32 status;
+
+    if (task_id == NULL || task_name == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
+    
+    /* 
+    ** we don't want to allow names too long because they won't be found at all 
+    */
+    if (strlen(task_name) >= OS_MAX_API_NAME)
+    {
+       return OS_ERR_NAME_TOO_LONG;
+    }
+
+    pthread_mutex_lock(&OS_task_table_mut);
+    status = OS_RegistryFindId(&OS_task_registry, task_name, task_id);
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return status;
+
+}/* end OS_TaskGetIdByName */            
 
 /*---------------------------------------------------------------------------------------
-   Name: OS_QueuePut
+    Name: OS_TaskGetInfo
 
-   Purpose: Put a message on a message queue.
+    Purpose: This function will pass back a pointer to structure that contains 
+             all of the relevant info (creator, stack size, priority, name) about the 
+             specified task. 
 
-   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
-            OS_INVALID_POINTER if the data pointer is NULL
-            OS_QUEUE_FULL if the queue cannot accept another message
-            OS_ERROR if the OS call returns an error
-            OS_SUCCESS if SUCCESS            
-   
-   Notes: The flags parameter is not used.  The message put is always configured to
-            immediately return an error if the receiving message queue is full.
+    Returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
+             OS_INVALID_POINTER if the task_prop pointer is NULL
+             OS_SUCCESS if it copied all of the relevant info over
+ 
 ---------------------------------------------------------------------------------------*/
-int32 OS_QueuePut (uint32 queue_id, void *data, uint32 size, uint32 flags)
+int32 OS_TaskGetInfo (uint32 task_id, OS_task_prop_t *task_prop)  
 {
+    uint32 local_id;
 
-   struct sockaddr_in serva;
-   static int socketFlags = 0;
-   int bytesSent    = 0;
-   int tempSkt      = 0;
-
-   /*
-   ** Check Parameters 
-   */
-   if(queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
-   {
+    /* 
+    ** Check to see that the id given is valid 
+    */
+    if (OS_RegistryCheckId(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
+    {
        return OS_ERR_INVALID_ID;
-   }
-   if (data == NULL)
-   {
+    }
+
+    if( task_prop == NULL)
+    {
        return OS_INVALID_POINTER;
-   }
+    }
 
-   /* 
-   ** specify the IP addres and port number of destination
-   */
-   memset(&serva, 0, sizeof(serva));
-   serva.sin_family      = AF_INET;
-   serva.sin_port        = htons(OS_BASE_PORT + queue_id);
-   serva.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    /* put the info into the stucture */
+    pthread_mutex_lock(&OS_task_table_mut); 
 
-   /*
-   ** open a temporary socket to transfer the packet to MR
-   */
-   tempSkt = socket(AF_INET, SOCK_DGRAM, 0);
+    task_prop -> creator =    OS_task_table[local_id].creator;
+    task_prop -> stack_size = OS_task_table[local_id].stack_size;
+    task_prop -> stack_used = OS_task_table[local_id].stack_base == NULL ? 0 :
+        OS_StackUsed(OS_task_table[local_id].stack_base, OS_task_table[local_id].stack_alloc);
+    task_prop -> priority =   OS_task_table[local_id].priority;
+    task_prop -> OStask_id =  (uint32) OS_task_table[local_id].id;
+    task_prop -> sched_policy = OS_task_table[local_id].policy == SCHED_FIFO ? OS_TASK_SCHED_FIFO :
+                                OS_task_table[local_id].policy == SCHED_RR   ? OS_TASK_SCHED_RR :
+                                                                               OS_TASK_SCHED_OTHER;
+    task_prop -> affinity = OS_task_table[local_id].affinity;
+    task_prop -> period_usecs = (uint32) (OS_task_table[local_id].period_ns / 1000);
+    task_prop -> deadline_usecs = (uint32) (OS_task_table[local_id].deadline_ns / 1000);
+    task_prop -> periods = OS_task_table[local_id].periods;
+    task_prop -> overruns = OS_task_table[local_id].overruns;
+    task_prop -> max_jitter_usecs = OS_task_table[local_id].max_jitter_usecs;
+    task_prop -> avg_jitter_usecs = OS_task_table[local_id].periods == 0 ? 0 :
+        (uint32) (OS_task_table[local_id].total_jitter_ns / OS_task_table[local_id].periods / 1000);
+    
+    strcpy(task_prop-> name, OS_task_table[local_id].name);
 
-   /* 
-   ** send the packet to the message router task (MR)
-   */
-   bytesSent = sendto(tempSkt,(char *)data, size, socketFlags,
-                    (struct sockaddr *)&serva, sizeof(serva));
-   if( bytesSent != size )
-   {
-      return(OS_QUEUE_FULL);
-   }
+    pthread_mutex_unlock(&OS_task_table_mut);
+    
+    return OS_SUCCESS;
+    
+} /* end OS_TaskGetInfo */
 
-   /* 
-   ** close socket
-   */
-   close(tempSkt);
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskGetStats
 
-   return OS_SUCCESS;
-} /* end OS_QueuePut */
+    Purpose: Passes back the CPU time, context switches, last core and wakeup latencies
+             of the specified task, to find the tasks that use up the CPU or are kept
+             waiting for it.
 
-#else
+    returns: OS_INVALID_POINTER if the task_stats pointer is NULL
+             OS_ERR_INVALID_ID if the ID passed to it is invalid
+             OS_SUCCESS if success
 
-/* ---------------------- POSIX MESSAGE QUEUE IMPLEMENTATION ------------------------- */
-/*---------------------------------------------------------------------------------------
- Name: OS_QueueCreate
- 
- Purpose: Create a message queue which can be refered to by name or ID
- 
- Returns: OS_INVALID_POINTER if a pointer passed in is NULL
- OS_ERR_NAME_TOO_LONG if the name passed in is too long
- OS_ERR_NO_FREE_IDS if there are already the max queues created
- OS_ERR_NAME_TAKEN if the name is already being used on another queue
- OS_ERROR if the OS create call fails
- OS_SUCCESS if success
- 
- Notes: the flahs parameter is unused.
- ---------------------------------------------------------------------------------------*/
-int32 OS_QueueCreate (uint32 *queue_id, const char *queue_name, uint32 queue_depth,
-                      uint32 data_size, uint32 flags)
+    Notes: The CPU time, switch counts and core are read from the host OS and are
+           only filled in on Linux. The counts of another task come from /proc,
+           those of the calling task from getrusage.
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskGetStats (uint32 task_id, OS_task_stats_t *task_stats)
 {
-    int                     i;
-    pid_t                   process_id;
-    mqd_t                   queueDesc;
-    struct mq_attr          queueAttr;   
-    uint32                  possible_qid;
-    char                    name[OS_MAX_API_NAME * 2];
-    char                    process_id_string[OS_MAX_API_NAME+1];
-    
-    
-    if ( queue_id == NULL || queue_name == NULL)
+    OS_task_record_t *task;
+    uint32            local_id;
+    uint32            i;
+#ifdef _LINUX_OS_
+    clockid_t         cpu_clock;
+    struct timespec   cpu_time;
+    struct rusage     usage;
+#endif
+
+    if( task_stats == NULL)
     {
-        return OS_INVALID_POINTER;
+       return OS_INVALID_POINTER;
     }
-    
-    /* we don't want to allow names too long*/
-    /* if truncated, two names might be the same */
-    
-    if (strlen(queue_name) >= OS_MAX_API_NAME)
+
+    if (OS_RegistryCheckId(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
     {
-        return OS_ERR_NAME_TOO_LONG;
+       return OS_ERR_INVALID_ID;
     }
-    
-    /* Check Parameters */
-    
-    pthread_mutex_lock(&OS_queue_table_mut);    
-    
-    for(possible_qid = 0; possible_qid < OS_MAX_QUEUES; possible_qid++)
+
+    task = &OS_task_table[local_id];
+    memset(task_stats, 0, sizeof(OS_task_stats_t));
+
+    pthread_mutex_lock(&OS_task_table_mut); 
+
+    /* The task keeps its wakeup statistics without a lock, they may be one wakeup apart */
+    task_stats -> wakeups = task -> wakeups;
+    task_stats -> max_wakeup_usecs = task -> max_wakeup_usecs;
+    for ( i = 0; i < OS_TASK_STATS_BUCKETS; i++ )
     {
-        if (OS_queue_table[possible_qid].free == TRUE)
-            break;
+        task_stats -> wakeup_histogram[i] = task -> wakeup_histogram[i];
     }
-    
-    if( possible_qid >= OS_MAX_QUEUES || OS_queue_table[possible_qid].free != TRUE)
+
+#ifdef _LINUX_OS_
+    if ( pthread_getcpuclockid(task -> id, &cpu_clock) == 0 &&
+         clock_gettime(cpu_clock, &cpu_time) == 0 )
     {
-        pthread_mutex_unlock(&OS_queue_table_mut);
-        return OS_ERR_NO_FREE_IDS;
+        task_stats -> cpu_usecs = (uint64) cpu_time.tv_sec * 1000000 + cpu_time.tv_nsec / 1000;
     }
-    
-    /* Check to see if the name is already taken */
 
-    for (i = 0; i < OS_MAX_QUEUES; i++)
+    if ( task_id == OS_task_self_id )
     {
-        if ((OS_queue_table[i].free == FALSE) &&
-            strcmp ((char*) queue_name, OS_queue_table[i].name) == 0)
+        if ( getrusage(RUSAGE_THREAD, &usage) == 0 )
         {
-            pthread_mutex_unlock(&OS_queue_table_mut);
-            return OS_ERR_NAME_TAKEN;
+            task_stats -> voluntary_switches = (uint32) usage.ru_nvcsw;
+            task_stats -> involuntary_switches = (uint32) usage.ru_nivcsw;
         }
-    } 
-    
-    /* Set the possible task Id to not free so that
-     * no other task can try to use it */
-    
-    OS_queue_table[possible_qid].free = FALSE;
-    
-    pthread_mutex_unlock(&OS_queue_table_mut);
-    
-    /* set queue attributes */
-    queueAttr.mq_maxmsg  = 20;
-    queueAttr.mq_msgsize = data_size;
-   
-    /*
-    ** Construct the queue name:
-    ** The name will consist of "/<process_id>.queue_name"
-    */
- 
-    /* pre-pend / to queue name */
-    strcpy(name, "/");
+        task_stats -> last_cpu = (uint32) sched_getcpu();
+    }
+    else if ( task -> tid != 0 )
+    {
+        OS_TaskReadProcStats(task -> tid, task_stats);
+    }
+#endif
+
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return OS_SUCCESS;
+
+} /* end OS_TaskGetStats */
+
+#ifdef _LINUX_OS_
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskReadProcStats
+
+    Purpose: Reads the context switch counts and the last core of a thread of this
+             process from /proc. Counts that cannot be read are left at 0.
+---------------------------------------------------------------------------------------*/
+static void OS_TaskReadProcStats(pid_t tid, OS_task_stats_t *task_stats)
+{
+    char           path[64];
+    char           line[512];
+    char          *field;
+    FILE          *fp;
+    unsigned long  count;
+    int            i;
+
+    sprintf(path, "/proc/self/task/%d/status", (int) tid);
+    fp = fopen(path, "r");
+    if ( fp != NULL )
+    {
+        while ( fgets(line, sizeof(line), fp) != NULL )
+        {
+            if ( sscanf(line, "voluntary_ctxt_switches: %lu", &count) == 1 )
+            {
+                task_stats -> voluntary_switches = (uint32) count;
+            }
+            else if ( sscanf(line, "nonvoluntary_ctxt_switches: %lu", &count) == 1 )
+            {
+                task_stats -> involuntary_switches = (uint32) count;
+            }
+        }
+        fclose(fp);
+    }
 
     /*
-    ** Get the process ID 
-    */
-    process_id = getpid();
-    sprintf(process_id_string, "%d", process_id);
-    strcat(name, process_id_string);
-    strcat(name,"."); 
-    
-    /*
-    ** Add the name that was passed in
+    ** The core is field 39 of the stat line. The fields are counted from the
+    ** end of the thread name, since the name may hold spaces.
     */
-    strcat(name, queue_name);
-    
-    /* 
-    ** create message queue 
-    */
-    queueDesc = mq_open(name, O_CREAT | O_RDWR, 0666, &queueAttr);
-    
-    if ( queueDesc == -1 )
+    sprintf(path, "/proc/self/task/%d/stat", (int) tid);
+    fp = fopen(path, "r");
+    if ( fp != NULL )
     {
-        pthread_mutex_lock(&OS_queue_table_mut);
-        OS_queue_table[possible_qid].free = TRUE;
-        pthread_mutex_unlock(&OS_queue_table_mut);
-        
-        printf("OS_QueueCreate Error. errno = %d\n",errno);
-        if( errno ==EINVAL)
+        if ( fgets(line, sizeof(line), fp) != NULL && (field = strrchr(line, ')')) != NULL )
         {
-            printf("Your queue depth may be too large for the\n");
-            printf("OS to handle. Please check the msg_max\n");
-            printf("parameter located in /proc/sys/fs/mqueue/msg_max\n");
-            printf("on your Linux file system and raise it if you\n");
-            printf(" need to or run as root\n");
+            for ( i = 2; i < 39 && field != NULL; i++ )
+            {
+                field = strchr(field + 1, ' ');
+            }
+            if ( field != NULL )
+            {
+                task_stats -> last_cpu = (uint32) strtoul(field + 1, NULL, 10);
+            }
         }
-        return OS_ERROR;
+        fclose(fp);
     }
 
-    /*
-    ** store queue_descriptor
+} /* end OS_TaskReadProcStats */
+#endif
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskSetAffinity
+
+    Purpose: Pins a task to the cores in cpu_mask, bit n standing for core n. A mask
+             of 0 unpins the task, it then runs on the cores the affinity policy gives
+             its priority, or on every core.
+
+    returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
+             OS_TASK_INVALID_AFFINITY if the mask names a core this host does not have
+             OS_ERR_NOT_IMPLEMENTED if tasks cannot be pinned on this host
+             OS_ERROR if the OS call fails
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskSetAffinity (uint32 task_id, uint32 cpu_mask)
+{
+    uint32 local_id;
+    int32  status;
+
+    if (OS_RegistryCheckId(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    if ( cpu_mask != 0 )
+    {
+        status = OS_TaskCheckAffinity(cpu_mask);
+        if ( status != OS_SUCCESS )
+        {
+            return status;
+        }
+    }
+
+    pthread_mutex_lock(&OS_task_table_mut);
+
+    if ( cpu_mask != 0 )
+    {
+        status = OS_TaskApplyAffinity(local_id, cpu_mask);
+        OS_task_table[local_id].affinity_pinned = (status == OS_SUCCESS);
+    }
+    else
+    {
+        status = OS_TaskApplyAffinity(local_id,
+                                      OS_TaskPolicyAffinity(OS_task_table[local_id].priority));
+        OS_task_table[local_id].affinity_pinned = FALSE;
+    }
+
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return status;
+}/* end OS_TaskSetAffinity */
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskGetAffinity
+
+    Purpose: Returns the cores a task may run on in cpu_mask, 0 if it may run on all
+
+    returns: OS_ERR_INVALID_ID if the ID passed to it is invalid
+             OS_INVALID_POINTER if cpu_mask is NULL
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskGetAffinity (uint32 task_id, uint32 *cpu_mask)
+{
+    uint32 local_id;
+
+    if (OS_RegistryCheckId(&OS_task_registry, task_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    if (cpu_mask == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    pthread_mutex_lock(&OS_task_table_mut);
+    *cpu_mask = OS_task_table[local_id].affinity;
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return OS_SUCCESS;
+}/* end OS_TaskGetAffinity */
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskSetAffinityPolicy
+
+    Purpose: Sets the cores the tasks of each priority band run on, so that for
+             example the highest priority tasks keep isolated cores to themselves and
+             the housekeeping tasks share the others. Tasks that were pinned with
+             OS_TASK_AFFINITY or OS_TaskSetAffinity keep their cores. The policy
+             applies to the running tasks at once and to the tasks created later. The
+             first band that covers a priority is used, and num_bands of 0 removes
+             the policy.
+
+    returns: OS_INVALID_POINTER if bands is NULL
+             OS_TASK_INVALID_AFFINITY if there are too many bands, or a band has its
+             priorities reversed or names a core this host does not have
+             OS_ERR_NOT_IMPLEMENTED if tasks cannot be pinned on this host
+             OS_SUCCESS if success
+
+    Notes: The BSP sets the policy before it starts the application. It is kept
+           across OS_API_Init.
+---------------------------------------------------------------------------------------*/
+int32 OS_TaskSetAffinityPolicy (const OS_task_affinity_band_t *bands, uint32 num_bands)
+{
+    uint32 i;
+    uint32 cpu_mask;
+    int32  status;
+
+    if ( bands == NULL && num_bands > 0 )
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    if ( num_bands > OS_MAX_AFFINITY_BANDS )
+    {
+        return OS_TASK_INVALID_AFFINITY;
+    }
+
+    for ( i = 0; i < num_bands; i++ )
+    {
+        if ( bands[i].min_priority > bands[i].max_priority )
+        {
+            return OS_TASK_INVALID_AFFINITY;
+        }
+
+        status = OS_TaskCheckAffinity(bands[i].cpu_mask);
+        if ( status != OS_SUCCESS )
+        {
+            return status;
+        }
+    }
+
+    pthread_mutex_lock(&OS_task_table_mut);
+
+    memcpy(OS_task_affinity_policy, bands, num_bands * sizeof(OS_task_affinity_band_t));
+    OS_task_affinity_bands = num_bands;
+
+    status = OS_SUCCESS;
+    for ( i = 0; i < OS_MAX_TASKS; i++ )
+    {
+        /* only tasks that are fully created, and not pinned by the application */
+        if ( OS_AtomicLoad(&OS_task_registry.active_id[i]) == 0 ||
+             OS_task_table[i].affinity_pinned )
+        {
+            continue;
+        }
+
+        cpu_mask = OS_TaskPolicyAffinity(OS_task_table[i].priority);
+        if ( cpu_mask != OS_task_table[i].affinity &&
+             OS_TaskApplyAffinity(i, cpu_mask) != OS_SUCCESS )
+        {
+            status = OS_ERROR;
+        }
+    }
+
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return status;
+}/* end OS_TaskSetAffinityPolicy */
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_TaskInstallDeleteHandler
+
+    Purpose: Installs a handler for when the task is deleted.
+
+    returns: status
+---------------------------------------------------------------------------------------*/
+
+int32 OS_TaskInstallDeleteHandler(void *function_pointer)
+{
+    uint32 local_id;
+
+    if ( OS_RegistryCheckId(&OS_task_registry, OS_TaskGetId(), &local_id) != OS_SUCCESS )
+    {
+       /* 
+       ** Somehow the calling task is not registered 
+       */
+       return(OS_ERR_INVALID_ID);
+    }
+
+    pthread_mutex_lock(&OS_task_table_mut); 
+
+    /*
+    ** Install the pointer
     */
-    *queue_id = possible_qid;
+    OS_task_table[local_id].delete_hook_pointer = function_pointer;    
+    
+    pthread_mutex_unlock(&OS_task_table_mut);
+
+    return(OS_SUCCESS);
     
+}/*end OS_TaskInstallDeleteHandler */
+
+/****************************************************************************************
+                                MESSAGE QUEUE API
+****************************************************************************************/
+#ifdef OSAL_SOCKET_QUEUE
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueCreate
+
+   Purpose: Create a message queue which can be refered to by name or ID
+
+   Returns: OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_ERR_NAME_TOO_LONG if the name passed in is too long
+            OS_ERR_NO_FREE_IDS if there are already the max queues created
+            OS_ERR_NAME_TAKEN if the name is already being used on another queue
+            OS_ERROR if the OS create call fails
+            OS_SUCCESS if success
+
+   Notes: flags may be OS_QUEUE_ZERO_COPY to make a queue for OS_QueueSend and
+          OS_QueueReceiveRef, data_size is ignored in that case.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueCreate (uint32 *queue_id, const char *queue_name, uint32 queue_depth,
+                       uint32 data_size, uint32 flags)
+{
+   int                     tmpSkt;
+   int                     returnStat;
+   struct sockaddr_in      servaddr;
+   int32                   status;
+   uint32                  possible_qid;
+
+    if ( queue_id == NULL || queue_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    /* we don't want to allow names too long*/
+    /* if truncated, two names might be the same */
+
+    if (strlen(queue_name) >= OS_MAX_API_NAME)
+    {
+       return OS_ERR_NAME_TOO_LONG;
+    }
+
+    /* a zero copy queue only carries references to loaned buffers */
+    if (flags & OS_QUEUE_ZERO_COPY)
+    {
+        data_size = sizeof(OS_queue_ref_t);
+    }
+
+   /* Check Parameters */
+
     pthread_mutex_lock(&OS_queue_table_mut);    
     
-    OS_queue_table[*queue_id].id = queueDesc;
-    OS_queue_table[*queue_id].free = FALSE;
-    strcpy( OS_queue_table[*queue_id].name, (char*) queue_name);
-    OS_queue_table[*queue_id].creator = OS_FindCreator();
+    status = OS_RegistryAlloc(&OS_queue_registry, queue_name, &possible_qid);
+    if (status != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_queue_table_mut);
+        return status;
+    }
+
+    /* Set the possible task Id to not free so that
+     * no other task can try to use it */
+
+    OS_queue_table[possible_qid].free = FALSE;
     
     pthread_mutex_unlock(&OS_queue_table_mut);
     
-    return OS_SUCCESS;
+    tmpSkt = socket(AF_INET, SOCK_DGRAM, 0);
+    if ( tmpSkt == -1 )
+    {
+        pthread_mutex_lock(&OS_queue_table_mut);
+        OS_queue_table[possible_qid].free = TRUE;
+        OS_RegistryFree(&OS_queue_registry, possible_qid);
+        pthread_mutex_unlock(&OS_queue_table_mut);
+
+        printf("Failed to create a socket on OS_QueueCreate. errno = %d\n",errno);
+        return OS_ERROR;
+    }
+
+    memset(&servaddr, 0, sizeof(servaddr));
+    servaddr.sin_family      = AF_INET;
+    servaddr.sin_port        = htons(OS_BASE_PORT + possible_qid);
+    servaddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); 
+
+   /* 
+   ** bind the input socket to a pipe
+   ** port numbers are OS_BASE_PORT + queue_id
+   */
+   returnStat = bind(tmpSkt,(struct sockaddr *)&servaddr, sizeof(servaddr));
+   
+   if ( returnStat == -1 )
+   {
+        close(tmpSkt);
+
+        pthread_mutex_lock(&OS_queue_table_mut);
+        OS_queue_table[possible_qid].free = TRUE;
+        OS_RegistryFree(&OS_queue_registry, possible_qid);
+        pthread_mutex_unlock(&OS_queue_table_mut);
+
+        printf("bind failed on OS_QueueCreate. errno = %d\n",errno);
+        return OS_ERROR;
+   }
+   
+   /*
+   ** store socket handle
+   */
+    pthread_mutex_lock(&OS_queue_table_mut);    
+
+   OS_queue_table[possible_qid].id = tmpSkt;
+   strcpy( OS_queue_table[possible_qid].name, (char*) queue_name);
+   OS_queue_table[possible_qid].creator = OS_FindCreator();
+   OS_queue_table[possible_qid].flags = flags;
+
+   OS_RegistryPublish(&OS_queue_registry, possible_qid);
+   *queue_id = OS_RegistryGetId(&OS_queue_registry, possible_qid);
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+   return OS_SUCCESS;
     
 }/* end OS_QueueCreate */
 
+
 /*--------------------------------------------------------------------------------------
- Name: OS_QueueDelete
- 
- Purpose: Deletes the specified message queue.
- 
- Returns: OS_ERR_INVALID_ID if the id passed in does not exist
- OS_ERROR if the OS call to delete the queue fails 
- OS_SUCCESS if success
- 
- Notes: If There are messages on the queue, they will be lost and any subsequent
- calls to QueueGet or QueuePut to this queue will result in errors
- ---------------------------------------------------------------------------------------*/
+    Name: OS_QueueDelete
+
+    Purpose: Deletes the specified message queue.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in does not exist
+             OS_ERROR if the OS call to delete the queue fails 
+             OS_SUCCESS if success
+
+    Notes: If There are messages on the queue, they will be lost and any subsequent
+           calls to QueueGet or QueuePut to this queue will result in errors
+---------------------------------------------------------------------------------------*/
 int32 OS_QueueDelete (uint32 queue_id)
 {
-    pid_t   process_id;
-    char    name[OS_MAX_API_NAME+1];
-    char    process_id_string[OS_MAX_API_NAME+1];
+    uint32 local_id;
+
+    /* Check to see if the queue_id given is valid */
+    
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Retire the ID so that no other call can use the queue while it is being
+    ** deleted. This fails if another task deleted it first.
+    */
+    if (OS_RegistryRetire(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /* tasks in OS_WaitMultiple on the queue see that it is gone */
+    OS_WaitNotify(&OS_queue_table[local_id].wait);
+
+    /* give back the buffers of any references still queued */
+    if (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY)
+    {
+        OS_QueueDrainRefs(local_id);
+    }
+
+    /* Try to delete the queue */
+
+    if(close(OS_queue_table[local_id].id) !=0)   
+    {
+        OS_RegistryPublish(&OS_queue_registry, local_id);
+        return OS_ERROR;
+    }
+        
+    /* 
+     * Now that the queue is deleted, remove its "presence"
+     * in OS_message_q_table and OS_message_q_name_table 
+    */
+        
+    pthread_mutex_lock(&OS_queue_table_mut);    
+
+    OS_queue_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_queue_registry, local_id);
+    strcpy(OS_queue_table[local_id].name, "");
+    OS_queue_table[local_id].creator = UNINITIALIZED;
+    OS_queue_table[local_id].flags = 0;
+    OS_queue_table[local_id].id = UNINITIALIZED;
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+ 
+   return OS_SUCCESS;
+
+} /* end OS_QueueDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueGet
+
+   Purpose: Receive a message on a message queue.  Will pend or timeout on the receive.
+   Returns: OS_ERR_INVALID_ID if the given ID does not exist
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+            OS_QUEUE_TIMEOUT if the timeout was OS_PEND and the time expired
+            OS_QUEUE_INVALID_SIZE if the size copied from the queue was not correct
+            OS_ERROR if there was an error waiting for the timeout
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueGet (uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+{
+   uint32 local_id;
+   int sizeCopied;
+
+   /*
+   ** Check Parameters 
+   */
+   if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+   {
+       return OS_ERR_INVALID_ID;
+   }
+   else if( (data == NULL) || (size_copied == NULL) )
+   {
+       return OS_INVALID_POINTER;
+   }
+    
+   /*
+   ** Read the socket for data
+   */
+   if (timeout == OS_PEND) 
+   {      
+      /*
+      ** A signal can interrupt the recvfrom call, so the call has to be done with 
+      ** a loop
+      */
+      do 
+      {
+         sizeCopied = recvfrom(OS_queue_table[local_id].id, data, size, 0, NULL, NULL);
+      } while ( sizeCopied == -1 && errno == EINTR );
+      
+      if(sizeCopied != size )
+      {
+         *size_copied = 0;
+         return(OS_QUEUE_INVALID_SIZE);
+      }
+   }
+   else if (timeout == OS_CHECK)
+   {      
+      /*
+      ** The socket itself stays blocking, the poll is done per call
+      */
+      sizeCopied = recvfrom(OS_queue_table[local_id].id, data, size, MSG_DONTWAIT, NULL, NULL);
+
+      if (sizeCopied == -1 && errno == EWOULDBLOCK )
+      {
+         *size_copied = 0;
+         return(OS_QUEUE_EMPTY);
+      }
+      else if(sizeCopied != size )
+      {
+         *size_copied = 0;
+         return(OS_QUEUE_INVALID_SIZE);
+      }
+
+   }
+   else /* timeout */ 
+   {
+      int    rv;
+      int    sock = OS_queue_table[local_id].id;
+      struct timeval  tv_timeout;
+      struct timespec deadline;
+      struct timespec remaining;
+      fd_set fdset;
+
+      OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+
+      /*
+      ** Use select to wait for data to come in on the socket.
+      ** If the select call is interrupted, it is restarted with the time
+      ** left until the deadline rather than the full timeout.
+      */
+      do 
+      {
+         if ( OS_CompMonotonicRemaining(&deadline, &remaining) != OS_SUCCESS )
+         {
+            rv = 0;
+            break;
+         }
+         tv_timeout.tv_sec  = remaining.tv_sec;
+         tv_timeout.tv_usec = remaining.tv_nsec / 1000;
+
+         FD_ZERO( &fdset );
+         FD_SET( sock, &fdset );
+         rv = select( sock+1, &fdset, NULL, NULL, &tv_timeout );
+      } while ( rv == -1 && errno == EINTR );
+      
+      if( rv > 0 )
+      {
+         /* got a packet within the timeout */
+         sizeCopied = recvfrom(OS_queue_table[local_id].id, data, size, 0, NULL, NULL);
+
+         if ( sizeCopied == size )
+         {
+            *size_copied = sizeCopied;
+            return OS_SUCCESS;
+         }
+         else
+         {
+            *size_copied = 0;
+            return OS_QUEUE_INVALID_SIZE;
+         }
+      }
+      else if ( rv < 0 )
+      {
+         /* 
+         ** Need to handle Select error codes here 
+         ** This might need a new error code: OS_QUEUE_TIMEOUT_ERROR
+         */
+         printf("Bad return value from select: %d, sock = %d\n", rv, sock);
+         return OS_ERROR;
+      }
+      
+      /*
+      ** If rv == 0, then the select timed out with no data
+      */
+      return(OS_QUEUE_TIMEOUT);
+     
+   } /* END timeout */
+
+   /*
+   ** The OS_PEND and OS_CHECK cases get here with a full sized message
+   */
+   *size_copied = sizeCopied;
+   return OS_SUCCESS;
+
+} /* end OS_QueueGet */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueReceiveLocal
+
+   Purpose: Takes a message off the queue in slot local_id without blocking and
+            without checking the ID, for a delete that has already retired it
+
+   Returns: OS_QUEUE_EMPTY if there is no message on the queue
+            OS_QUEUE_INVALID_SIZE if the message size does not match size
+            OS_ERROR if the OS call returns an error
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_QueueReceiveLocal (uint32 local_id, void *data, uint32 size)
+{
+   int sizeCopied;
+
+   sizeCopied = recvfrom(OS_queue_table[local_id].id, data, size, MSG_DONTWAIT, NULL, NULL);
+   if ( sizeCopied == -1 )
+   {
+      return (errno == EWOULDBLOCK) ? OS_QUEUE_EMPTY : OS_ERROR;
+   }
+
+   return (sizeCopied == size) ? OS_SUCCESS : OS_QUEUE_INVALID_SIZE;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePut
+
+   Purpose: Put a message on a message queue.
+
+   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+            OS_INVALID_POINTER if the data pointer is NULL
+            OS_QUEUE_FULL if the queue cannot accept another message
+            OS_ERROR if the OS call returns an error
+            OS_SUCCESS if SUCCESS            
+   
+   Notes: The flags parameter is not used.  The message put is always configured to
+            immediately return an error if the receiving message queue is full.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueuePut (uint32 queue_id, void *data, uint32 size, uint32 flags)
+{
+   uint32 local_id;
+
+   struct sockaddr_in serva;
+   static int socketFlags = 0;
+   int bytesSent    = 0;
+   int tempSkt      = 0;
+
+   /*
+   ** Check Parameters 
+   */
+   if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+   {
+       return OS_ERR_INVALID_ID;
+   }
+   if (data == NULL)
+   {
+       return OS_INVALID_POINTER;
+   }
+
+   /* 
+   ** specify the IP addres and port number of destination
+   */
+   memset(&serva, 0, sizeof(serva));
+   serva.sin_family      = AF_INET;
+   serva.sin_port        = htons(OS_BASE_PORT + queue_id);
+   serva.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   /*
+   ** open a temporary socket to transfer the packet to MR
+   */
+   tempSkt = socket(AF_INET, SOCK_DGRAM, 0);
+   if ( tempSkt == -1 )
+   {
+      return(OS_ERROR);
+   }
+
+   /* 
+   ** send the packet to the message router task (MR)
+   */
+   bytesSent = sendto(tempSkt,(char *)data, size, socketFlags,
+                    (struct sockaddr *)&serva, sizeof(serva));
+   if( bytesSent != size )
+   {
+      close(tempSkt);
+      return(OS_QUEUE_FULL);
+   }
+
+   /* 
+   ** close socket
+   */
+   close(tempSkt);
+
+   OS_WaitNotify(&OS_queue_table[local_id].wait);
+
+   return OS_SUCCESS;
+} /* end OS_QueuePut */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueGetBatch
+
+   Purpose: Receive up to count messages of size bytes each into the data array.
+            Only the first message waits, as OS_QueueGet does for timeout. The rest
+            are whatever is already on the queue.
+
+   Returns: OS_ERR_INVALID_ID if the given ID does not exist
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+            OS_QUEUE_TIMEOUT if the timeout expired before the first message arrived
+            OS_QUEUE_INVALID_SIZE if a message of the wrong size was received and dropped
+            OS_ERROR if the socket call returns an error
+            OS_SUCCESS if success
+
+   Notes: count_copied is the number of messages stored in data, even on error.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueGetBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_copied, int32 timeout)
+{
+   uint32 local_id;
+   char   *msg;
+   uint32  size_copied;
+   int32   status;
+#ifdef _LINUX_OS_
+   struct mmsghdr msgs[OS_QUEUE_BATCH_CHUNK];
+   struct iovec   iovs[OS_QUEUE_BATCH_CHUNK];
+   int            chunk;
+   int            received;
+   int            i;
+#else
+   int            sizeCopied;
+#endif
+
+   if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+   {
+       return OS_ERR_INVALID_ID;
+   }
+   else if( (data == NULL) || (count_copied == NULL) )
+   {
+       return OS_INVALID_POINTER;
+   }
+
+   *count_copied = 0;
+   if ( count == 0 )
+   {
+      return OS_SUCCESS;
+   }
+
+   msg = (char *) data;
+
+   status = OS_QueueGet(queue_id, msg, size, &size_copied, timeout);
+   if ( status == OS_SUCCESS )
+   {
+      (*count_copied)++;
+      msg += size;
+   }
+   else if ( status != OS_QUEUE_INVALID_SIZE )
+   {
+      return status;
+   }
+
+   /*
+   ** Drain what is already queued without waiting
+   */
+#ifdef _LINUX_OS_
+   while ( *count_copied < count )
+   {
+      chunk = count - *count_copied;
+      if ( chunk > OS_QUEUE_BATCH_CHUNK )
+      {
+         chunk = OS_QUEUE_BATCH_CHUNK;
+      }
+
+      memset(msgs, 0, sizeof(msgs));
+      for ( i = 0; i < chunk; i++ )
+      {
+         iovs[i].iov_base = msg + (i * size);
+         iovs[i].iov_len  = size;
+         msgs[i].msg_hdr.msg_iov    = &iovs[i];
+         msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      received = recvmmsg(OS_queue_table[local_id].id, msgs, chunk, MSG_DONTWAIT, NULL);
+      if ( received <= 0 )
+      {
+         break;
+      }
+
+      /*
+      ** Keep the good messages packed at the front, dropping any of the wrong size
+      */
+      for ( i = 0; i < received; i++ )
+      {
+         if ( msgs[i].msg_len != size || (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0 )
+         {
+            status = OS_QUEUE_INVALID_SIZE;
+            continue;
+         }
+
+         if ( (char *) iovs[i].iov_base != msg )
+         {
+            memmove(msg, iovs[i].iov_base, size);
+         }
+         (*count_copied)++;
+         msg += size;
+      }
+
+      if ( received < chunk )
+      {
+         break;
+      }
+   }
+#else
+   while ( *count_copied < count )
+   {
+      sizeCopied = recvfrom(OS_queue_table[local_id].id, msg, size, MSG_DONTWAIT, NULL, NULL);
+      if ( sizeCopied == -1 )
+      {
+         break;
+      }
+      else if ( sizeCopied != size )
+      {
+         status = OS_QUEUE_INVALID_SIZE;
+         continue;
+      }
+
+      (*count_copied)++;
+      msg += size;
+   }
+#endif
+
+   return status;
+
+} /* end OS_QueueGetBatch */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePutBatch
+
+   Purpose: Put count messages of size bytes each from the data array on a message
+            queue, in order, through a single temporary socket.
+
+   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_FULL if the queue filled up before all the messages were put
+            OS_ERROR if the socket could not be created
+            OS_SUCCESS if all the messages were put
+
+   Notes: count_put is the number of messages put, even on error. The flags parameter
+          is not used.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueuePutBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_put, uint32 flags)
+{
+   uint32             local_id;
+   struct sockaddr_in serva;
+   char              *msg;
+   int                tempSkt;
+#ifdef _LINUX_OS_
+   struct mmsghdr     msgs[OS_QUEUE_BATCH_CHUNK];
+   struct iovec       iovs[OS_QUEUE_BATCH_CHUNK];
+   int                chunk;
+   int                sent;
+   int                i;
+#endif
+
+   if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+   {
+       return OS_ERR_INVALID_ID;
+   }
+   if (data == NULL || count_put == NULL)
+   {
+       return OS_INVALID_POINTER;
+   }
+
+   *count_put = 0;
+   if ( count == 0 )
+   {
+      return OS_SUCCESS;
+   }
+
+   memset(&serva, 0, sizeof(serva));
+   serva.sin_family      = AF_INET;
+   serva.sin_port        = htons(OS_BASE_PORT + queue_id);
+   serva.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+   tempSkt = socket(AF_INET, SOCK_DGRAM, 0);
+   if ( tempSkt == -1 )
+   {
+      return(OS_ERROR);
+   }
+
+   msg = (char *) data;
+
+#ifdef _LINUX_OS_
+   while ( *count_put < count )
+   {
+      chunk = count - *count_put;
+      if ( chunk > OS_QUEUE_BATCH_CHUNK )
+      {
+         chunk = OS_QUEUE_BATCH_CHUNK;
+      }
+
+      memset(msgs, 0, sizeof(msgs));
+      for ( i = 0; i < chunk; i++ )
+      {
+         iovs[i].iov_base = msg + (i * size);
+         iovs[i].iov_len  = size;
+         msgs[i].msg_hdr.msg_name    = &serva;
+         msgs[i].msg_hdr.msg_namelen = sizeof(serva);
+         msgs[i].msg_hdr.msg_iov     = &iovs[i];
+         msgs[i].msg_hdr.msg_iovlen  = 1;
+      }
+
+      sent = sendmmsg(tempSkt, msgs, chunk, 0);
+      if ( sent <= 0 )
+      {
+         break;
+      }
+
+      *count_put += sent;
+      msg        += sent * size;
+
+      if ( sent < chunk )
+      {
+         break;
+      }
+   }
+#else
+   while ( *count_put < count )
+   {
+      if ( sendto(tempSkt, msg, size, 0, (struct sockaddr *)&serva, sizeof(serva)) != size )
+      {
+         break;
+      }
+
+      (*count_put)++;
+      msg += size;
+   }
+#endif
+
+   close(tempSkt);
+
+   if ( *count_put != 0 )
+   {
+      OS_WaitNotify(&OS_queue_table[local_id].wait);
+   }
+
+   if ( *count_put != count )
+   {
+      return(OS_QUEUE_FULL);
+   }
+
+   return OS_SUCCESS;
+
+} /* end OS_QueuePutBatch */
+
+#elif defined(OSAL_RING_QUEUE)
+
+/* ---------------------- IN-PROCESS RING BUFFER IMPLEMENTATION ---------------------- */
+
+/*
+** Each queue is a bounded multi-producer/multi-consumer ring of fixed size slots.
+** Every slot carries a sequence number that says whose turn it is:
+**     seq == pos        the slot is free for the producer that claims position pos
+**     seq == pos + 1    the slot holds the message that was put at position pos
+** Producers and consumers claim positions with a compare and swap on head and tail,
+** so a put or a get that does not have to wait never takes a lock or enters the
+** kernel. A task that pends on an empty queue sleeps on put_seq, which producers
+** only bump when the waiters count says someone is asleep.
+*/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueLeave
+
+   Purpose: Ends a use of the ring started by OS_QueueEnter, waking a delete that
+            waits for the last user to leave
+---------------------------------------------------------------------------------------*/
+static void OS_QueueLeave (OS_queue_record_t *queue)
+{
+    if ( OS_AtomicSub(&queue->users, 1) == 0 )
+    {
+        OS_FutexWake(&queue->users, INT_MAX);
+    }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueEnter
+
+   Purpose: Validates a queue ID and counts the caller as a user of the ring, so
+            the ring is not freed under it. OS_QueueLeave ends the use.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid queue
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_QueueEnter (uint32 queue_id, uint32 *local_id)
+{
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    OS_AtomicAdd(&OS_queue_table[*local_id].users, 1);
+
+    /*
+    ** A delete that retired the ID before the count went up does not wait
+    ** for this call, so check the ID again now that it is counted
+    */
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, local_id) != OS_SUCCESS)
+    {
+        OS_QueueLeave(&OS_queue_table[*local_id]);
+        return OS_ERR_INVALID_ID;
+    }
+
+    return OS_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RingSlot
+
+   Purpose: Returns the slot that backs ring position pos
+---------------------------------------------------------------------------------------*/
+static OS_ring_slot_t *OS_RingSlot (OS_queue_record_t *queue, OS_futex_t pos)
+{
+    return (OS_ring_slot_t *) (queue->ring + ((pos & queue->mask) * queue->slot_size));
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RingPut
+
+   Purpose: Copies a message into the next free slot of the ring without blocking.
+            The caller wakes any pending task with OS_RingWake afterwards.
+
+   Returns: OS_QUEUE_FULL if queue_depth messages are already queued
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_RingPut (OS_queue_record_t *queue, const void *data, uint32 size)
+{
+    OS_ring_slot_t *slot;
+    OS_futex_t      pos;
+    OS_futex_t      seq;
+    int             diff;
+
+    pos = OS_AtomicLoadRelaxed(&queue->head);
+
+    for ( ;; )
+    {
+        slot = OS_RingSlot(queue, pos);
+        seq  = OS_AtomicLoad(&slot->seq);
+        diff = (int) (seq - pos);
+
+        if ( diff == 0 )
+        {
+            /*
+            ** The ring is rounded up to a power of two, so a free slot alone
+            ** does not mean the queue is below its depth. A stale pos gives a
+            ** negative count here and is caught by the compare and swap.
+            */
+            if ( (int) (pos - OS_AtomicLoad(&queue->tail)) >= (int) queue->depth )
+            {
+                return OS_QUEUE_FULL;
+            }
+
+            if ( OS_AtomicCas(&queue->head, &pos, pos + 1) )
+            {
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            return OS_QUEUE_FULL;
+        }
+        else
+        {
+            pos = OS_AtomicLoadRelaxed(&queue->head);
+        }
+    }
+
+    memcpy((char *) slot + sizeof(OS_ring_slot_t), data, size);
+    slot->size = size;
+    OS_AtomicStore(&slot->seq, pos + 1);
+
+    return OS_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RingWake
+
+   Purpose: Wakes up to count tasks pending on the ring after messages were put.
+---------------------------------------------------------------------------------------*/
+static void OS_RingWake (OS_queue_record_t *queue, uint32 count)
+{
+    /*
+    ** Pairs with the fence in OS_QueueGet: either the waiter sees the message
+    ** before it sleeps, or we see the waiter and wake it.
+    */
+    OS_AtomicFence();
+    if ( OS_AtomicLoadRelaxed(&queue->waiters) != 0 )
+    {
+        OS_AtomicAdd(&queue->put_seq, 1);
+        OS_FutexWake(&queue->put_seq, (count > INT_MAX) ? INT_MAX : (int) count);
+    }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RingGet
+
+   Purpose: Takes the oldest message off the ring without blocking.
+
+   Returns: OS_QUEUE_EMPTY if there is no message on the ring
+            OS_QUEUE_INVALID_SIZE if the message size does not match size. The
+                                  message is still removed from the queue.
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_RingGet (OS_queue_record_t *queue, void *data, uint32 size, uint32 *size_copied)
+{
+    OS_ring_slot_t *slot;
+    OS_futex_t      pos;
+    OS_futex_t      seq;
+    uint32          msg_size;
+    int             diff;
+
+    pos = OS_AtomicLoadRelaxed(&queue->tail);
+
+    for ( ;; )
+    {
+        slot = OS_RingSlot(queue, pos);
+        seq  = OS_AtomicLoad(&slot->seq);
+        diff = (int) (seq - (pos + 1));
+
+        if ( diff == 0 )
+        {
+            if ( OS_AtomicCas(&queue->tail, &pos, pos + 1) )
+            {
+                break;
+            }
+        }
+        else if ( diff < 0 )
+        {
+            *size_copied = 0;
+            return OS_QUEUE_EMPTY;
+        }
+        else
+        {
+            pos = OS_AtomicLoadRelaxed(&queue->tail);
+        }
+    }
+
+    msg_size = slot->size;
+    memcpy(data, (char *) slot + sizeof(OS_ring_slot_t), (msg_size < size) ? msg_size : size);
+
+    /*
+    ** Hand the slot back to the producer that will claim it one lap from now
+    */
+    OS_AtomicStore(&slot->seq, pos + queue->mask + 1);
+
+    if ( msg_size != size )
+    {
+        *size_copied = 0;
+        return OS_QUEUE_INVALID_SIZE;
+    }
+
+    *size_copied = msg_size;
+    return OS_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueCreate
+
+   Purpose: Create a message queue which can be refered to by name or ID
+
+   Returns: OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_ERR_NAME_TOO_LONG if the name passed in is too long
+            OS_ERR_NO_FREE_IDS if there are already the max queues created
+            OS_ERR_NAME_TAKEN if the name is already being used on another queue
+            OS_QUEUE_INVALID_DEPTH if the depth is 0 or too large
+            OS_ERROR if the data size is 0 or the ring cannot be allocated
+            OS_SUCCESS if success
+
+   Notes: flags may be OS_QUEUE_ZERO_COPY to make a queue for OS_QueueSend and
+          OS_QueueReceiveRef, data_size is ignored in that case.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueCreate (uint32 *queue_id, const char *queue_name, uint32 queue_depth,
+                      uint32 data_size, uint32 flags)
+{
+    int             i;
+    int32           status;
+    uint32          possible_qid;
+    uint32          slots;
+    uint32          slot_size;
+    void           *ring;
+    OS_ring_slot_t *slot;
+
+    if ( queue_id == NULL || queue_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    /* we don't want to allow names too long*/
+    /* if truncated, two names might be the same */
+
+    if (strlen(queue_name) >= OS_MAX_API_NAME)
+    {
+        return OS_ERR_NAME_TOO_LONG;
+    }
+
+    /*
+    ** Ring positions are 32 bit counters, so the ring has to stay well below
+    ** half of their range for the sequence compares to work.
+    */
+    if ( queue_depth == 0 || queue_depth > 0x40000000 )
+    {
+        return OS_QUEUE_INVALID_DEPTH;
+    }
+
+    /* a zero copy queue only carries references to loaned buffers */
+    if ( flags & OS_QUEUE_ZERO_COPY )
+    {
+        data_size = sizeof(OS_queue_ref_t);
+    }
+
+    if ( data_size == 0 )
+    {
+        return OS_ERROR;
+    }
+
+    /* Check Parameters */
+
+    pthread_mutex_lock(&OS_queue_table_mut);
+
+    status = OS_RegistryAlloc(&OS_queue_registry, queue_name, &possible_qid);
+    if (status != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_queue_table_mut);
+        return status;
+    }
+
+    /* Set the possible queue Id to not free so that
+     * no other task can try to use it */
+
+    OS_queue_table[possible_qid].free = FALSE;
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+    /*
+    ** Round the ring up to a power of two so positions map onto slots with a
+    ** mask, and each slot up to a whole number of cache lines so tasks working
+    ** on neighbouring messages do not share a line.
+    */
+    for ( slots = 1; slots < queue_depth; slots <<= 1 )
+    {
+        ;
+    }
+
+    slot_size = sizeof(OS_ring_slot_t) + data_size;
+    slot_size = (slot_size + OS_CACHE_LINE_SIZE - 1) & ~((uint32) OS_CACHE_LINE_SIZE - 1);
+
+    if ( posix_memalign(&ring, OS_CACHE_LINE_SIZE, slots * slot_size) != 0 )
+    {
+        pthread_mutex_lock(&OS_queue_table_mut);
+        OS_queue_table[possible_qid].free = TRUE;
+        OS_RegistryFree(&OS_queue_registry, possible_qid);
+        pthread_mutex_unlock(&OS_queue_table_mut);
+
+        return OS_ERROR;
+    }
+
+    OS_queue_table[possible_qid].ring      = ring;
+    OS_queue_table[possible_qid].depth     = queue_depth;
+    OS_queue_table[possible_qid].mask      = slots - 1;
+    OS_queue_table[possible_qid].data_size = data_size;
+    OS_queue_table[possible_qid].slot_size = slot_size;
+    OS_queue_table[possible_qid].head      = 0;
+    OS_queue_table[possible_qid].tail      = 0;
+    OS_queue_table[possible_qid].put_seq   = 0;
+    OS_queue_table[possible_qid].waiters   = 0;
+
+    for ( i = 0; i < slots; i++ )
+    {
+        slot = OS_RingSlot(&OS_queue_table[possible_qid], i);
+        slot->seq  = i;
+        slot->size = 0;
+    }
+
+    pthread_mutex_lock(&OS_queue_table_mut);
+
+    strcpy( OS_queue_table[possible_qid].name, (char*) queue_name);
+    OS_queue_table[possible_qid].creator = OS_FindCreator();
+    OS_queue_table[possible_qid].flags = flags;
+
+    OS_RegistryPublish(&OS_queue_registry, possible_qid);
+    *queue_id = OS_RegistryGetId(&OS_queue_registry, possible_qid);
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+    return OS_SUCCESS;
+
+}/* end OS_QueueCreate */
+
+/*--------------------------------------------------------------------------------------
+   Name: OS_QueueDelete
+
+   Purpose: Deletes the specified message queue.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in does not exist
+            OS_SUCCESS if success
+
+   Notes: If There are messages on the queue, they will be lost and any subsequent
+          calls to QueueGet or QueuePut to this queue will result in errors
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueDelete (uint32 queue_id)
+{
+    uint32             local_id;
+    OS_queue_record_t *queue;
+    OS_futex_t         users;
+    void              *ring;
+
+    /* Check to see if the queue_id given is valid */
+
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Retire the ID so that no other call can use the queue while it is being
+    ** deleted. This fails if another task deleted it first.
+    */
+    if (OS_RegistryRetire(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Wake the tasks pending in OS_QueueGet so they see the ID is gone, and
+    ** tasks in OS_WaitMultiple on the queue as well
+    */
+    queue = &OS_queue_table[local_id];
+    OS_AtomicAdd(&queue->put_seq, 1);
+    OS_FutexWake(&queue->put_seq, INT_MAX);
+    OS_WaitNotify(&queue->wait);
+
+    /*
+    ** Calls that got past the ID check before it was retired may still be
+    ** working on the ring, it is only freed once the last one has left
+    */
+    while ( (users = OS_AtomicLoad(&queue->users)) != 0 )
+    {
+        OS_FutexWait(&queue->users, users, NULL);
+    }
+
+    /* give back the buffers of any references still queued */
+    if (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY)
+    {
+        OS_QueueDrainRefs(local_id);
+    }
+
+    pthread_mutex_lock(&OS_queue_table_mut);
+
+    ring = OS_queue_table[local_id].ring;
+
+    OS_queue_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_queue_registry, local_id);
+    strcpy(OS_queue_table[local_id].name, "");
+    OS_queue_table[local_id].creator = UNINITIALIZED;
+    OS_queue_table[local_id].flags = 0;
+    OS_queue_table[local_id].ring = NULL;
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+    free(ring);
+
+    return OS_SUCCESS;
+
+} /* end OS_QueueDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueGet
+
+   Purpose: Receive a message on a message queue.  Will pend or timeout on the receive.
+
+   Returns: OS_ERR_INVALID_ID if the given ID does not exist
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+            OS_QUEUE_TIMEOUT if the timeout was OS_PEND and the time expired
+            OS_QUEUE_INVALID_SIZE if the size copied from the queue was not correct
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueGet (uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+{
+    uint32             local_id;
+    OS_queue_record_t *queue;
+    struct timespec    deadline;
+    struct timespec   *deadline_ptr;
+    OS_futex_t         put_seq;
+    int32              status;
+
+    /*
+    ** Check Parameters
+    */
+    if (OS_QueueEnter(queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    queue = &OS_queue_table[local_id];
+
+    if( (data == NULL) || (size_copied == NULL) )
+    {
+        OS_QueueLeave(queue);
+        return OS_INVALID_POINTER;
+    }
+
+    status = OS_RingGet(queue, data, size, size_copied);
+    if ( status != OS_QUEUE_EMPTY || timeout == OS_CHECK )
+    {
+        OS_QueueLeave(queue);
+        return status;
+    }
+
+    if ( timeout == OS_PEND )
+    {
+        deadline_ptr = NULL;
+    }
+    else
+    {
+        OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+        deadline_ptr = &deadline;
+    }
+
+    /*
+    ** Announce ourselves before looking at the ring again, so a producer that
+    ** puts a message after our last look is guaranteed to bump put_seq.
+    */
+    OS_AtomicAdd(&queue->waiters, 1);
+    OS_AtomicFence();
+
+    for ( ;; )
+    {
+        put_seq = OS_AtomicLoad(&queue->put_seq);
+
+        /* a delete bumps put_seq after it retires the ID */
+        if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+        {
+            status = OS_ERR_INVALID_ID;
+            break;
+        }
+
+        status = OS_RingGet(queue, data, size, size_copied);
+        if ( status != OS_QUEUE_EMPTY )
+        {
+            break;
+        }
+
+        if ( OS_FutexWait(&queue->put_seq, put_seq, deadline_ptr) == OS_ERROR_TIMEOUT )
+        {
+            status = OS_QUEUE_TIMEOUT;
+            break;
+        }
+    }
+
+    OS_AtomicSub(&queue->waiters, 1);
+    OS_QueueLeave(queue);
+
+    return status;
+
+} /* end OS_QueueGet */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueReceiveLocal
+
+   Purpose: Takes a message off the queue in slot local_id without blocking and
+            without checking the ID, for a delete that has already retired it
+
+   Returns: OS_QUEUE_EMPTY if there is no message on the queue
+            OS_QUEUE_INVALID_SIZE if the message size does not match size
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_QueueReceiveLocal (uint32 local_id, void *data, uint32 size)
+{
+    uint32 size_copied;
+
+    return OS_RingGet(&OS_queue_table[local_id], data, size, &size_copied);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePut
+
+   Purpose: Put a message on a message queue.
+
+   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+            OS_INVALID_POINTER if the data pointer is NULL
+            OS_QUEUE_INVALID_SIZE if the message is larger than the queue data size
+            OS_QUEUE_FULL if the queue cannot accept another message
+            OS_SUCCESS if SUCCESS
+
+   Notes: The flags parameter is not used.  The message put is always configured to
+          immediately return an error if the receiving message queue is full.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueuePut (uint32 queue_id, void *data, uint32 size, uint32 flags)
+{
+    uint32 local_id;
+    int32 status;
+
+    /*
+    ** Check Parameters
+    */
+    if (OS_QueueEnter(queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    if (data == NULL)
+    {
+       OS_QueueLeave(&OS_queue_table[local_id]);
+       return OS_INVALID_POINTER;
+    }
+
+    if (size > OS_queue_table[local_id].data_size)
+    {
+       OS_QueueLeave(&OS_queue_table[local_id]);
+       return OS_QUEUE_INVALID_SIZE;
+    }
+
+    status = OS_RingPut(&OS_queue_table[local_id], data, size);
+    if ( status == OS_SUCCESS )
+    {
+        OS_RingWake(&OS_queue_table[local_id], 1);
+        OS_WaitNotify(&OS_queue_table[local_id].wait);
+    }
+
+    OS_QueueLeave(&OS_queue_table[local_id]);
+
+    return status;
+
+} /* end OS_QueuePut */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueGetBatch
+
+   Purpose: Receive up to count messages of size bytes each into the data array.
+            Only the first message waits, as OS_QueueGet does for timeout. The rest
+            are whatever is already on the queue.
+
+   Returns: OS_ERR_INVALID_ID if the given ID does not exist
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+            OS_QUEUE_TIMEOUT if the timeout expired before the first message arrived
+            OS_QUEUE_INVALID_SIZE if a message of the wrong size was received and dropped
+            OS_SUCCESS if success
+
+   Notes: count_copied is the number of messages stored in data, even on error.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueGetBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_copied, int32 timeout)
+{
+    uint32 local_id;
+    char   *msg;
+    uint32  size_copied;
+    int32   status;
+    int32   drain_status;
+
+    if (OS_QueueEnter(queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    else if( (data == NULL) || (count_copied == NULL) )
+    {
+        OS_QueueLeave(&OS_queue_table[local_id]);
+        return OS_INVALID_POINTER;
+    }
+
+    *count_copied = 0;
+    if ( count == 0 )
+    {
+        OS_QueueLeave(&OS_queue_table[local_id]);
+        return OS_SUCCESS;
+    }
+
+    msg = (char *) data;
+
+    status = OS_QueueGet(queue_id, msg, size, &size_copied, timeout);
+    if ( status == OS_SUCCESS )
+    {
+        (*count_copied)++;
+        msg += size;
+    }
+    else if ( status != OS_QUEUE_INVALID_SIZE )
+    {
+        OS_QueueLeave(&OS_queue_table[local_id]);
+        return status;
+    }
+
+    /*
+    ** Drain what is already queued without waiting
+    */
+    while ( *count_copied < count )
+    {
+        drain_status = OS_RingGet(&OS_queue_table[local_id], msg, size, &size_copied);
+        if ( drain_status == OS_QUEUE_EMPTY )
+        {
+            break;
+        }
+        else if ( drain_status != OS_SUCCESS )
+        {
+            status = drain_status;
+            continue;
+        }
+
+        (*count_copied)++;
+        msg += size;
+    }
+
+    OS_QueueLeave(&OS_queue_table[local_id]);
+
+    return status;
+
+} /* end OS_QueueGetBatch */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePutBatch
+
+   Purpose: Put count messages of size bytes each from the data array on a message
+            queue, in order. Pending tasks are woken once for the whole batch.
+
+   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_INVALID_SIZE if the messages are larger than the queue data size
+            OS_QUEUE_FULL if the queue filled up before all the messages were put
+            OS_SUCCESS if all the messages were put
+
+   Notes: count_put is the number of messages put, even on error. The flags parameter
+          is not used.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueuePutBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_put, uint32 flags)
+{
+    uint32             local_id;
+    OS_queue_record_t *queue;
+    char              *msg;
+    int32              status = OS_SUCCESS;
+
+    if (OS_QueueEnter(queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    if (data == NULL || count_put == NULL)
+    {
+       OS_QueueLeave(&OS_queue_table[local_id]);
+       return OS_INVALID_POINTER;
+    }
+
+    *count_put = 0;
+
+    if (size > OS_queue_table[local_id].data_size)
+    {
+       OS_QueueLeave(&OS_queue_table[local_id]);
+       return OS_QUEUE_INVALID_SIZE;
+    }
+
+    queue = &OS_queue_table[local_id];
+    msg   = (char *) data;
+
+    while ( *count_put < count )
+    {
+        status = OS_RingPut(queue, msg, size);
+        if ( status != OS_SUCCESS )
+        {
+            break;
+        }
+
+        (*count_put)++;
+        msg += size;
+    }
+
+    if ( *count_put != 0 )
+    {
+        OS_RingWake(queue, *count_put);
+        OS_WaitNotify(&queue->wait);
+    }
+
+    OS_QueueLeave(queue);
+
+    return status;
+
+} /* end OS_QueuePutBatch */
+
+/* -------------------- END IN-PROCESS RING BUFFER IMPLEMENTATION -------------------- */
+
+#else
+
+/* ---------------------- POSIX MESSAGE QUEUE IMPLEMENTATION ------------------------- */
+
+/*
+** An absolute deadline that has always passed. It turns the timed send and
+** receive calls into non-blocking ones on a queue that is opened blocking.
+*/
+static const struct timespec OS_queue_zero_time = { 0, 0 };
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueueReadLimit
+ 
+ Purpose: Reads one of the numeric limits in /proc/sys/fs/mqueue
+ 
+ Returns: the limit, or 0 if it cannot be read
+ ---------------------------------------------------------------------------------------*/
+static long OS_QueueReadLimit (const char *path)
+{
+    FILE *fp;
+    long  limit = 0;
+    
+    fp = fopen(path, "r");
+    if (fp != NULL)
+    {
+        if (fscanf(fp, "%ld", &limit) != 1)
+        {
+            limit = 0;
+        }
+        fclose(fp);
+    }
+    
+    return limit;
+}
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueueCreate
+ 
+ Purpose: Create a message queue which can be refered to by name or ID
+ 
+ Returns: OS_INVALID_POINTER if a pointer passed in is NULL
+ OS_ERR_NAME_TOO_LONG if the name passed in is too long
+ OS_QUEUE_INVALID_DEPTH if the depth is 0 or above /proc/sys/fs/mqueue/msg_max
+ OS_QUEUE_INVALID_SIZE if the data size is above /proc/sys/fs/mqueue/msgsize_max
+ OS_ERR_NO_FREE_IDS if there are already the max queues created
+ OS_ERR_NAME_TAKEN if the name is already being used on another queue
+ OS_ERROR if the OS create call fails
+ OS_SUCCESS if success
+ 
+ Notes: flags may be OS_QUEUE_ZERO_COPY to make a queue for OS_QueueSend and
+ OS_QueueReceiveRef, data_size is ignored in that case.
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueueCreate (uint32 *queue_id, const char *queue_name, uint32 queue_depth,
+                      uint32 data_size, uint32 flags)
+{
+    int32                   status;
+    pid_t                   process_id;
+    mqd_t                   queueDesc;
+    struct mq_attr          queueAttr;   
+    uint32                  possible_qid;
+    long                    limit;
+    char                    name[OS_MAX_API_NAME * 2];
+    char                    process_id_string[OS_MAX_API_NAME+1];
+    
+    
+    if ( queue_id == NULL || queue_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+    
+    /* we don't want to allow names too long*/
+    /* if truncated, two names might be the same */
+    
+    if (strlen(queue_name) >= OS_MAX_API_NAME)
+    {
+        return OS_ERR_NAME_TOO_LONG;
+    }
+
+    if (queue_depth == 0)
+    {
+        return OS_QUEUE_INVALID_DEPTH;
+    }
+
+    /* a zero copy queue only carries references to loaned buffers */
+    if (flags & OS_QUEUE_ZERO_COPY)
+    {
+        data_size = sizeof(OS_queue_ref_t);
+    }
+    
+    /* Check Parameters */
+    
+    pthread_mutex_lock(&OS_queue_table_mut);    
+    
+    status = OS_RegistryAlloc(&OS_queue_registry, queue_name, &possible_qid);
+    if (status != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_queue_table_mut);
+        return status;
+    }
+    
+    /* Set the possible task Id to not free so that
+     * no other task can try to use it */
+    
+    OS_queue_table[possible_qid].free = FALSE;
+    
+    pthread_mutex_unlock(&OS_queue_table_mut);
+    
+    /* set queue attributes */
+    queueAttr.mq_maxmsg  = queue_depth;
+    queueAttr.mq_msgsize = data_size;
+   
+    /*
+    ** Construct the queue name:
+    ** The name will consist of "/<process_id>.queue_name"
+    */
+ 
+    /* pre-pend / to queue name */
+    strcpy(name, "/");
+
+    /*
+    ** Get the process ID 
+    */
+    process_id = getpid();
+    sprintf(process_id_string, "%d", process_id);
+    strcat(name, process_id_string);
+    strcat(name,"."); 
+    
+    /*
+    ** Add the name that was passed in
+    */
+    strcat(name, queue_name);
+    
+    /* 
+    ** create message queue 
+    */
+    queueDesc = mq_open(name, O_CREAT | O_RDWR, 0666, &queueAttr);
+    
+    if ( queueDesc == -1 )
+    {
+        pthread_mutex_lock(&OS_queue_table_mut);
+        OS_queue_table[possible_qid].free = TRUE;
+        OS_RegistryFree(&OS_queue_registry, possible_qid);
+        pthread_mutex_unlock(&OS_queue_table_mut);
+        
+        printf("OS_QueueCreate Error. errno = %d\n",errno);
+        if( errno ==EINVAL)
+        {
+            /*
+            ** Unprivileged tasks are held to the limits in /proc/sys/fs/mqueue,
+            ** so find out which one was exceeded
+            */
+            limit = OS_QueueReadLimit("/proc/sys/fs/mqueue/msg_max");
+            if ( limit > 0 && queue_depth > limit )
+            {
+                printf("Queue depth %lu is larger than the msg_max limit of %ld\n",
+                       (unsigned long) queue_depth, limit);
+                printf("located in /proc/sys/fs/mqueue/msg_max. Raise it\n");
+                printf("if you need to or run as root\n");
+                return OS_QUEUE_INVALID_DEPTH;
+            }
+
+            limit = OS_QueueReadLimit("/proc/sys/fs/mqueue/msgsize_max");
+            if ( limit > 0 && data_size > limit )
+            {
+                printf("Queue data size %lu is larger than the msgsize_max limit of %ld\n",
+                       (unsigned long) data_size, limit);
+                printf("located in /proc/sys/fs/mqueue/msgsize_max. Raise it\n");
+                printf("if you need to or run as root\n");
+                return OS_QUEUE_INVALID_SIZE;
+            }
+        }
+        return OS_ERROR;
+    }
+
+    /*
+    ** store queue_descriptor
+    */
+    pthread_mutex_lock(&OS_queue_table_mut);    
+    
+    OS_queue_table[possible_qid].id = queueDesc;
+    strcpy( OS_queue_table[possible_qid].name, (char*) queue_name);
+    OS_queue_table[possible_qid].creator = OS_FindCreator();
+    OS_queue_table[possible_qid].flags = flags;
+
+    OS_RegistryPublish(&OS_queue_registry, possible_qid);
+    *queue_id = OS_RegistryGetId(&OS_queue_registry, possible_qid);
+    
+    pthread_mutex_unlock(&OS_queue_table_mut);
+    
+    return OS_SUCCESS;
+    
+}/* end OS_QueueCreate */
+
+/*--------------------------------------------------------------------------------------
+ Name: OS_QueueDelete
+ 
+ Purpose: Deletes the specified message queue.
+ 
+ Returns: OS_ERR_INVALID_ID if the id passed in does not exist
+ OS_ERROR if the OS call to delete the queue fails 
+ OS_SUCCESS if success
+ 
+ Notes: If There are messages on the queue, they will be lost and any subsequent
+ calls to QueueGet or QueuePut to this queue will result in errors
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueueDelete (uint32 queue_id)
+{
+    uint32  local_id;
+    pid_t   process_id;
+    char    name[OS_MAX_API_NAME+1];
+    char    process_id_string[OS_MAX_API_NAME+1];
+
+    /* Check to see if the queue_id given is valid */
+    
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Retire the ID so that no other call can use the queue while it is being
+    ** deleted. This fails if another task deleted it first.
+    */
+    if (OS_RegistryRetire(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /* tasks in OS_WaitMultiple on the queue see that it is gone */
+    OS_WaitNotify(&OS_queue_table[local_id].wait);
+
+    /* give back the buffers of any references still queued */
+    if (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY)
+    {
+        OS_QueueDrainRefs(local_id);
+    }
+
+    /*
+    ** Construct the queue name:
+    ** The name will consist of "/<process_id>.queue_name"
+    */
+
+    /* pre-pend / to queue name */
+    strcpy(name, "/");
+
+    /*
+    ** Get the process ID
+    */
+    process_id = getpid();
+    sprintf(process_id_string, "%d", process_id);
+    strcat(name, process_id_string);
+    strcat(name,".");
+    
+    strcat(name, OS_queue_table[local_id].name);
+    
+    /* Try to delete and unlink the queue */
+    if((mq_close(OS_queue_table[local_id].id) == -1) || (mq_unlink(name) == -1))
+    {
+        OS_RegistryPublish(&OS_queue_registry, local_id);
+        return OS_ERROR;
+    }
+    
+    /* 
+     * Now that the queue is deleted, remove its "presence"
+     * in OS_message_q_table and OS_message_q_name_table 
+     */
+    pthread_mutex_lock(&OS_queue_table_mut);    
+    
+    OS_queue_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_queue_registry, local_id);
+    strcpy(OS_queue_table[local_id].name, "");
+    OS_queue_table[local_id].creator = UNINITIALIZED;
+    OS_queue_table[local_id].flags = 0;
+    OS_queue_table[local_id].id = UNINITIALIZED;
+    
+    pthread_mutex_unlock(&OS_queue_table_mut);
+    
+    return OS_SUCCESS;
+    
+} /* end OS_QueueDelete */
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueueGet
+ 
+ Purpose: Receive a message on a message queue.  Will pend or timeout on the receive.
+ Returns: OS_ERR_INVALID_ID if the given ID does not exist
+ OS_ERR_INVALID_POINTER if a pointer passed in is NULL
+ OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+ OS_QUEUE_TIMEOUT if the timeout was OS_PEND and the time expired
+ OS_QUEUE_INVALID_SIZE if the size copied from the queue was not correct
+ OS_SUCCESS if success
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueueGet (uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+{
+    uint32          local_id;
+    int             sizeCopied = -1;
+    struct timespec deadline;
+    struct timespec remaining;
+    struct pollfd   queue_poll;
+    
+    /*
+    ** Check Parameters 
+    */
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    else if( (data == NULL) || (size_copied == NULL) )
+    {
+        return OS_INVALID_POINTER;
+    }
+    
+    /*
+    ** Read the message queue for data
+    */
+    if (timeout == OS_PEND) 
+    {      
+        /*
+        ** A signal can interrupt the mq_receive call, so the call has to be done with 
+        ** a loop
+        */
+        do 
+        {
+           sizeCopied = mq_receive(OS_queue_table[local_id].id, data, size, NULL);
+        } while ( sizeCopied == -1 && errno == EINTR );
+
+        if(sizeCopied != size )
+        {
+            *size_copied = 0;
+            return(OS_QUEUE_INVALID_SIZE);
+        }
+    }
+    else if (timeout == OS_CHECK)
+    {      
+        /*
+        ** A deadline that has already passed turns the receive into a poll.
+        ** The timer signals can still interrupt it.
+        */
+        do
+        {
+           sizeCopied = mq_timedreceive(OS_queue_table[local_id].id, data, size, NULL, &OS_queue_zero_time);
+        } while ( sizeCopied == -1 && errno == EINTR );
+        
+        if (sizeCopied == -1 && errno == ETIMEDOUT)
+        {
+            *size_copied = 0;
+            return OS_QUEUE_EMPTY;
+        }
+        else if(sizeCopied != size )
+        {
+            *size_copied = 0;
+            return(OS_QUEUE_INVALID_SIZE);
+        }
+    }
+    else /* timeout */ 
+    {
+        /*
+        ** mq_timedreceive only takes a CLOCK_REALTIME deadline, which moves when
+        ** the time of day is set. The wait is done with poll on the queue
+        ** descriptor against a CLOCK_MONOTONIC deadline instead, and the message
+        ** is then received without blocking. Another task may get the message
+        ** first, in which case the wait goes on with the time that is left.
+        */
+        OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+        queue_poll.fd     = (int) OS_queue_table[local_id].id;
+        queue_poll.events = POLLIN;
+
+        for ( ;; )
+        {
+            sizeCopied = mq_timedreceive(OS_queue_table[local_id].id, data, size, NULL, &OS_queue_zero_time);
+            if ( sizeCopied != -1 || (errno != ETIMEDOUT && errno != EINTR) )
+            {
+                break;
+            }
+
+            if ( OS_CompMonotonicRemaining(&deadline, &remaining) != OS_SUCCESS )
+            {
+                return(OS_QUEUE_TIMEOUT);
+            }
+
+            /* round up so the poll does not return just short of the deadline */
+            if ( poll(&queue_poll, 1, (remaining.tv_sec * 1000) +
+                      ((remaining.tv_nsec + 999999) / 1000000)) == -1 && errno != EINTR )
+            {
+                return(OS_ERROR);
+            }
+        }
+        
+        if( sizeCopied == size )
+        {
+            *size_copied = sizeCopied;
+            return OS_SUCCESS;
+        }
+        else
+        {
+            *size_copied = 0;
+            return OS_QUEUE_INVALID_SIZE;
+        }
+        
+    } /* END timeout */
+    
+    /*
+    ** The OS_PEND and OS_CHECK cases get here with a full sized message
+    */
+    *size_copied = sizeCopied;
+    return OS_SUCCESS;
+    
+} /* end OS_QueueGet */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueReceiveLocal
+
+   Purpose: Takes a message off the queue in slot local_id without blocking and
+            without checking the ID, for a delete that has already retired it
+
+   Returns: OS_QUEUE_EMPTY if there is no message on the queue
+            OS_QUEUE_INVALID_SIZE if the message size does not match size
+            OS_ERROR if the OS call returns an error
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_QueueReceiveLocal (uint32 local_id, void *data, uint32 size)
+{
+    int sizeCopied;
+
+    do
+    {
+       sizeCopied = mq_timedreceive(OS_queue_table[local_id].id, data, size, NULL, &OS_queue_zero_time);
+    } while ( sizeCopied == -1 && errno == EINTR );
+
+    if ( sizeCopied == -1 )
+    {
+        return (errno == ETIMEDOUT) ? OS_QUEUE_EMPTY : OS_ERROR;
+    }
+
+    return (sizeCopied == size) ? OS_SUCCESS : OS_QUEUE_INVALID_SIZE;
+}
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueuePut
+ 
+ Purpose: Put a message on a message queue.
+ 
+ Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+ OS_INVALID_POINTER if the data pointer is NULL
+ OS_QUEUE_FULL if the queue cannot accept another message
+ OS_ERROR if the OS call returns an error
+ OS_SUCCESS if SUCCESS            
+ 
+ Notes: The flags parameter is not used.  The message put is always configured to
+ immediately return an error if the receiving message queue is full.
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueuePut (uint32 queue_id, void *data, uint32 size, uint32 flags)
+{
+    uint32 local_id;
+
+    /*
+    ** Check Parameters 
+    */
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+    
+    if (data == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
+    
+    /* 
+    ** send message, a deadline that has already passed makes a full queue
+    ** fail right away instead of blocking
+    */
+    if(mq_timedsend(OS_queue_table[local_id].id, data, size, 1, &OS_queue_zero_time) == -1) 
+    {
+        if (errno == ETIMEDOUT)
+        {
+            return(OS_QUEUE_FULL);
+        }
+        return(OS_ERROR);
+    }
+    
+    OS_WaitNotify(&OS_queue_table[local_id].wait);
+
+    return OS_SUCCESS;
+
+} /* end OS_QueuePut */
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueueGetBatch
+ 
+ Purpose: Receive up to count messages of size bytes each into the data array.
+          Only the first message waits, as OS_QueueGet does for timeout. The rest
+          are whatever is already on the queue.
+ 
+ Returns: OS_ERR_INVALID_ID if the given ID does not exist
+ OS_INVALID_POINTER if a pointer passed in is NULL
+ OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+ OS_QUEUE_TIMEOUT if the timeout expired before the first message arrived
+ OS_QUEUE_INVALID_SIZE if a message of the wrong size was received and dropped
+ OS_SUCCESS if success
+ 
+ Notes: count_copied is the number of messages stored in data, even on error.
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueueGetBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_copied, int32 timeout)
+{
+    uint32 local_id;
+    char   *msg;
+    uint32  size_copied;
+    int     sizeCopied;
+    int32   status;
+    
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    else if( (data == NULL) || (count_copied == NULL) )
+    {
+        return OS_INVALID_POINTER;
+    }
+    
+    *count_copied = 0;
+    if (count == 0)
+    {
+        return OS_SUCCESS;
+    }
+    
+    msg = (char *) data;
+    
+    status = OS_QueueGet(queue_id, msg, size, &size_copied, timeout);
+    if (status == OS_SUCCESS)
+    {
+        (*count_copied)++;
+        msg += size;
+    }
+    else if (status != OS_QUEUE_INVALID_SIZE)
+    {
+        return status;
+    }
+    
+    /*
+    ** Drain what is already queued without waiting
+    */
+    while (*count_copied < count)
+    {
+        sizeCopied = mq_timedreceive(OS_queue_table[local_id].id, msg, size, NULL, &OS_queue_zero_time);
+        if (sizeCopied == -1)
+        {
+            break;
+        }
+        else if (sizeCopied != size)
+        {
+            status = OS_QUEUE_INVALID_SIZE;
+            continue;
+        }
+        
+        (*count_copied)++;
+        msg += size;
+    }
+    
+    return status;
+    
+} /* end OS_QueueGetBatch */
+
+/*---------------------------------------------------------------------------------------
+ Name: OS_QueuePutBatch
+ 
+ Purpose: Put count messages of size bytes each from the data array on a message
+          queue, in order.
+ 
+ Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
+ OS_INVALID_POINTER if a pointer passed in is NULL
+ OS_QUEUE_FULL if the queue filled up before all the messages were put
+ OS_ERROR if the OS call returns an error
+ OS_SUCCESS if all the messages were put
+ 
+ Notes: count_put is the number of messages put, even on error. The flags parameter
+ is not used.
+ ---------------------------------------------------------------------------------------*/
+int32 OS_QueuePutBatch (uint32 queue_id, void *data, uint32 size, uint32 count,
+                        uint32 *count_put, uint32 flags)
+{
+    uint32 local_id;
+    char  *msg;
+    int32  status = OS_SUCCESS;
+    
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+    
+    if (data == NULL || count_put == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
+    
+    msg = (char *) data;
+    
+    for (*count_put = 0; *count_put < count; (*count_put)++)
+    {
+        if(mq_timedsend(OS_queue_table[local_id].id, msg, size, 1, &OS_queue_zero_time) == -1) 
+        {
+            status = (errno == ETIMEDOUT) ? OS_QUEUE_FULL : OS_ERROR;
+            break;
+        }
+        msg += size;
+    }
+    
+    if (*count_put != 0)
+    {
+        OS_WaitNotify(&OS_queue_table[local_id].wait);
+    }
+
+    return status;
+
+} /* end OS_QueuePutBatch */
+
+
+/* --------------------- END POSIX MESSAGE QUEUE IMPLEMENTATION ---------------------- */
+#endif
+
+/*--------------------------------------------------------------------------------------
+    Name: OS_QueueGetIdByName
+
+    Purpose: This function tries to find a queue Id given the name of the queue. The
+             id of the queue is passed back in queue_id
+
+    Returns: OS_INVALID_POINTER if the name or id pointers are NULL
+             OS_ERR_NAME_TOO_LONG the name passed in is too long
+             OS_ERR_NAME_NOT_FOUND the name was not found in the table
+             OS_SUCCESS if success
+             
+---------------------------------------------------------------------------------------*/
+
+int32 OS_QueueGetIdByName (uint32 *queue_id, const char *queue_name)
+{
+    int32 status;
+
+    if(queue_id == NULL || queue_name == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
+    
+    /* a name too long wouldn't have been allowed in the first place
+     * so we definitely won't find a name too long*/
+ 
+    if (strlen(queue_name) >= OS_MAX_API_NAME)
+    {
+       return OS_ERR_NAME_TOO_LONG;
+    }
+
+    pthread_mutex_lock(&OS_queue_table_mut);
+    status = OS_RegistryFindId(&OS_queue_registry, queue_name, queue_id);
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+    return status;
+
+}/* end OS_QueueGetIdByName */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_QueueGetInfo
+
+    Purpose: This function will pass back a pointer to structure that contains 
+             all of the relevant info (name and creator) about the specified queue. 
+
+    Returns: OS_INVALID_POINTER if queue_prop is NULL
+             OS_ERR_INVALID_ID if the ID given is not  a valid queue
+             OS_SUCCESS if the info was copied over correctly
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueGetInfo (uint32 queue_id, OS_queue_prop_t *queue_prop)  
+{
+    uint32 local_id;
+
+    /* Check to see that the id given is valid */
+    
+    if (queue_prop == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+    
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /* put the info into the stucture */
+    pthread_mutex_lock(&OS_queue_table_mut);    
+
+    queue_prop -> creator =   OS_queue_table[local_id].creator;
+    strcpy(queue_prop -> name, OS_queue_table[local_id].name);
+
+    pthread_mutex_unlock(&OS_queue_table_mut);
+
+    return OS_SUCCESS;
+    
+} /* end OS_QueueGetInfo */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_QueueWaitPoll
+
+    Purpose: Takes a message off a queue for OS_WaitMultiple, into the data buffer
+             of the wait object, without blocking
+
+    Returns: OS_ERR_INVALID_ID if the ID given is not a valid queue
+             OS_ERROR if the queue is a zero copy queue
+             OS_ERROR_TIMEOUT if the queue is empty
+             any other status of OS_QueueGet
+             OS_SUCCESS if a message was taken
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
+{
+    uint32 local_id;
+    int32  status;
+
+    if (OS_RegistryCheckId(&OS_queue_registry, object->object_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    *source = &OS_queue_table[local_id].wait;
+
+    /* a reference taken from a zero copy queue would leak its buffer */
+    if (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY)
+    {
+        return OS_ERROR;
+    }
+
+    status = OS_QueueGet(object->object_id, object->data, object->size,
+                         &object->result, OS_CHECK);
+
+    return (status == OS_QUEUE_EMPTY) ? OS_ERROR_TIMEOUT : status;
+
+} /* end OS_QueueWaitPoll */
+
+/****************************************************************************************
+                                ZERO COPY QUEUE API
+****************************************************************************************/
+
+/*
+** Loaned buffers are blocks of a pool shared by every zero copy queue. A zero copy
+** queue only carries an OS_queue_ref_t naming the block, so the payload is written
+** once by the producer and read in place by every consumer it is sent to.
+**
+** Each block has a reference count. OS_QueueLoan hands out a block holding one
+** reference for the producer, every OS_QueueSend adds one for the message on the
+** queue, and OS_QueueRelease drops one. The block goes back to the pool when the
+** count reaches zero.
+**
+** Free blocks are kept on a lock-free stack. The head word holds the index of the
+** top block in its low 16 bits and a tag in the high 16 bits that changes on every
+** update, so a pop that raced with a pop and push of the same block fails its
+** compare and swap instead of corrupting the list.
+*/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePoolIndex
+
+   Purpose: Maps a loaned buffer pointer back to its block index
+
+   Returns: the block index, or OS_QUEUE_POOL_EMPTY if buffer is not a pool block
+---------------------------------------------------------------------------------------*/
+static uint32 OS_QueuePoolIndex (void *buffer)
+{
+    unsigned long offset;
+
+    if ( (char *) buffer < &OS_queue_pool_data[0][0] )
+    {
+        return OS_QUEUE_POOL_EMPTY;
+    }
+
+    offset = (char *) buffer - &OS_queue_pool_data[0][0];
+    if ( (offset % OS_QUEUE_POOL_BLOCK_SIZE) != 0 ||
+         (offset / OS_QUEUE_POOL_BLOCK_SIZE) >= OS_QUEUE_POOL_BLOCKS )
+    {
+        return OS_QUEUE_POOL_EMPTY;
+    }
+
+    return (uint32) (offset / OS_QUEUE_POOL_BLOCK_SIZE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePoolPush
+
+   Purpose: Puts a block whose last reference was dropped back on the free stack
+---------------------------------------------------------------------------------------*/
+static void OS_QueuePoolPush (uint32 block)
+{
+    OS_futex_t head;
+    OS_futex_t new_head;
+
+    head = OS_AtomicLoad(&OS_queue_pool_head);
+    do
+    {
+        OS_AtomicStore(&OS_queue_pool_next[block], head & OS_QUEUE_POOL_EMPTY);
+        new_head = ((head + 0x10000) & ~OS_QUEUE_POOL_EMPTY) | block;
+    } while ( !OS_AtomicCas(&OS_queue_pool_head, &head, new_head) );
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePoolPop
+
+   Purpose: Takes a block off the free stack
+
+   Returns: the block index, or OS_QUEUE_POOL_EMPTY if every block is loaned out
+---------------------------------------------------------------------------------------*/
+static uint32 OS_QueuePoolPop (void)
+{
+    OS_futex_t head;
+    OS_futex_t new_head;
+    uint32     block;
+
+    head = OS_AtomicLoad(&OS_queue_pool_head);
+    do
+    {
+        block = head & OS_QUEUE_POOL_EMPTY;
+        if ( block == OS_QUEUE_POOL_EMPTY )
+        {
+            return OS_QUEUE_POOL_EMPTY;
+        }
+
+        /*
+        ** next may be stale if the block was popped under us, in which case
+        ** the tag has moved on and the compare and swap fails
+        */
+        new_head = ((head + 0x10000) & ~OS_QUEUE_POOL_EMPTY) |
+                   OS_AtomicLoad(&OS_queue_pool_next[block]);
+    } while ( !OS_AtomicCas(&OS_queue_pool_head, &head, new_head) );
+
+    return block;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueuePoolPut
+
+   Purpose: Drops one reference to a block, freeing it on the last one
+---------------------------------------------------------------------------------------*/
+static void OS_QueuePoolPut (uint32 block)
+{
+    if ( OS_AtomicSub(&OS_queue_pool_refs[block], 1) == 0 )
+    {
+        OS_QueuePoolPush(block);
+    }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueDrainRefs
+
+   Purpose: Releases the blocks still referenced by messages on a zero copy queue
+            that is being deleted. The caller has already retired its ID.
+---------------------------------------------------------------------------------------*/
+static void OS_QueueDrainRefs (uint32 local_id)
+{
+    OS_queue_ref_t ref;
+    int32          status;
+
+    for ( ;; )
+    {
+        status = OS_QueueReceiveLocal(local_id, &ref, sizeof(ref));
+        if ( status != OS_SUCCESS && status != OS_QUEUE_INVALID_SIZE )
+        {
+            break;
+        }
+
+        if ( status == OS_SUCCESS && ref.block < OS_QUEUE_POOL_BLOCKS )
+        {
+            OS_QueuePoolPut(ref.block);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueLoan
+
+   Purpose: Loans a buffer of at least size bytes from the zero copy pool. The caller
+            owns one reference to it and writes the message straight into it.
+
+   Returns: OS_INVALID_POINTER if buffer is NULL
+            OS_QUEUE_INVALID_SIZE if size is larger than OS_QUEUE_POOL_BLOCK_SIZE
+            OS_QUEUE_NO_BUFFERS if every buffer in the pool is loaned out
+            OS_SUCCESS if success
+
+   Notes: The buffer must be given back with OS_QueueRelease once the caller is done
+          sending it, whether or not it was sent.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueLoan (void **buffer, uint32 size)
+{
+    uint32 block;
+
+    if ( buffer == NULL )
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    if ( size > OS_QUEUE_POOL_BLOCK_SIZE )
+    {
+        return OS_QUEUE_INVALID_SIZE;
+    }
+
+    block = OS_QueuePoolPop();
+    if ( block == OS_QUEUE_POOL_EMPTY )
+    {
+        *buffer = NULL;
+        return OS_QUEUE_NO_BUFFERS;
+    }
+
+    OS_AtomicStore(&OS_queue_pool_refs[block], 1);
+    *buffer = OS_queue_pool_data[block];
+
+    return OS_SUCCESS;
+
+} /* end OS_QueueLoan */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueSend
+
+   Purpose: Puts a reference to a loaned buffer holding size bytes on a zero copy
+            queue. The same buffer may be sent to several queues, the caller keeps
+            its own reference.
+
+   Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid zero copy queue
+            OS_INVALID_POINTER if buffer is not a loaned buffer
+            OS_QUEUE_INVALID_SIZE if size is larger than the buffer
+            OS_QUEUE_FULL if the queue cannot accept another message
+            OS_ERROR if the OS call returns an error
+            OS_SUCCESS if success
+
+   Notes: The buffer must not be written once it has been sent. The flags parameter
+          is not used.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueSend (uint32 queue_id, void *buffer, uint32 size, uint32 flags)
+{
+    uint32         local_id;
+    OS_queue_ref_t ref;
+    int32          status;
+
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS ||
+         (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY) == 0 )
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    ref.block = OS_QueuePoolIndex(buffer);
+    if ( ref.block == OS_QUEUE_POOL_EMPTY )
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    if ( size > OS_QUEUE_POOL_BLOCK_SIZE )
+    {
+        return OS_QUEUE_INVALID_SIZE;
+    }
+    ref.size = size;
+
+    /*
+    ** Take the message's reference before it becomes visible to a receiver
+    */
+    OS_AtomicAdd(&OS_queue_pool_refs[ref.block], 1);
+
+    status = OS_QueuePut(queue_id, &ref, sizeof(ref), 0);
+    if ( status != OS_SUCCESS )
+    {
+        OS_QueuePoolPut(ref.block);
+    }
+
+    return status;
+
+} /* end OS_QueueSend */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueReceiveRef
+
+   Purpose: Receives a message from a zero copy queue without copying it. buffer is
+            set to the loaned buffer holding the message and the caller owns the
+            reference that came with it. Pends or times out like OS_QueueGet.
+
+   Returns: OS_ERR_INVALID_ID if the given ID is not a valid zero copy queue
+            OS_INVALID_POINTER if a pointer passed in is NULL
+            OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
+            OS_QUEUE_TIMEOUT if the timeout expired
+            OS_ERROR if the OS call returns an error
+            OS_SUCCESS if success
+
+   Notes: The buffer is read only, and must be given back with OS_QueueRelease.
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueReceiveRef (uint32 queue_id, void **buffer, uint32 *size_copied, int32 timeout)
+{
+    uint32         local_id;
+    OS_queue_ref_t ref;
+    uint32         ref_size;
+    int32          status;
+
+    if (OS_RegistryCheckId(&OS_queue_registry, queue_id, &local_id) != OS_SUCCESS ||
+         (OS_queue_table[local_id].flags & OS_QUEUE_ZERO_COPY) == 0 )
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    else if ( buffer == NULL || size_copied == NULL )
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    *buffer      = NULL;
+    *size_copied = 0;
+
+    status = OS_QueueGet(queue_id, &ref, sizeof(ref), &ref_size, timeout);
+    if ( status == OS_QUEUE_INVALID_SIZE )
+    {
+        /* only OS_QueueSend puts on a zero copy queue, so this is not expected */
+        return OS_ERROR;
+    }
+    else if ( status != OS_SUCCESS )
+    {
+        return status;
+    }
+
+    *buffer      = OS_queue_pool_data[ref.block];
+    *size_copied = ref.size;
+
+    return OS_SUCCESS;
+
+} /* end OS_QueueReceiveRef */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_QueueRelease
+
+   Purpose: Gives back one reference to a loaned buffer, either the one from
+            OS_QueueLoan or one from OS_QueueReceiveRef
+
+   Returns: OS_INVALID_POINTER if buffer is not a loaned buffer
+            OS_ERROR if the buffer is not on loan
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_QueueRelease (void *buffer)
+{
+    uint32 block;
+
+    block = OS_QueuePoolIndex(buffer);
+    if ( block == OS_QUEUE_POOL_EMPTY )
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    if ( OS_AtomicLoad(&OS_queue_pool_refs[block]) == 0 )
+    {
+        return OS_ERROR;
+    }
+
+    OS_QueuePoolPut(block);
+
+    return OS_SUCCESS;
+
+} /* end OS_QueueRelease */
+
+/****************************************************************************************
+                                  SEMAPHORE API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_BinSemCreate
+
+   Purpose: Creates a binary semaphore with initial value specified by
+            sem_initial_value and name specified by sem_name. sem_id will be 
+            returned to the caller
+            
+   Returns: OS_INVALID_POINTER if sen name or sem_id are NULL
+            OS_ERR_NAME_TOO_LONG if the name given is too long
+            OS_ERR_NO_FREE_IDS if all of the semaphore ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of a binary semaphore
+            OS_SEM_FAILURE if the OS call failed
+            OS_SUCCESS if success
+            
+
+   Notes: options is an unused parameter 
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemCreate (uint32 *sem_id, const char *sem_name, uint32 sem_initial_value,
+                        uint32 options)
+{
+    uint32 possible_semid;
+    int32  status;
+
+    if (sem_id == NULL || sem_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+    
+    /* we don't want to allow names too long*/
+    /* if truncated, two names might be the same */
+    
+    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    {
+        return OS_ERR_NAME_TOO_LONG;
+    }
+
+    /* Check Parameters */
+
+    pthread_mutex_lock(&OS_bin_sem_table_mut);  
+
+    status = OS_RegistryAlloc(&OS_bin_sem_registry, sem_name, &possible_semid);
+    if (status != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_bin_sem_table_mut);
+        return status;
+    }
+
+    /* Set the ID to be taken so another task doesn't try to grab it */
+    OS_bin_sem_table[possible_semid].free = FALSE;
+
+    /* Check to make sure the sem value is going to be either 0 or 1 */
+    if (sem_initial_value > 1)
+    {
+        sem_initial_value = 1;
+    }
+
+    /*
+    ** Create semaphore
+    */
+    OS_SemInit(&OS_bin_sem_table[possible_semid].sem, sem_initial_value, 1);
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_LockStatsClear(&OS_bin_sem_table[possible_semid].stats);
+#endif
+
+    strcpy(OS_bin_sem_table[possible_semid].name , (char*) sem_name);
+    OS_bin_sem_table[possible_semid].creator = OS_FindCreator();
+
+    OS_RegistryPublish(&OS_bin_sem_registry, possible_semid);
+    *sem_id = OS_RegistryGetId(&OS_bin_sem_registry, possible_semid);
+    
+    pthread_mutex_unlock(&OS_bin_sem_table_mut);
+
+    return OS_SUCCESS;
+}/* end OS_BinSemCreate */
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_BinSemDelete
+
+    Purpose: Deletes the specified Binary Semaphore.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid binary semaphore
+             OS_SUCCESS if success
+    
+    Notes: Since we can't delete a semaphore which is currently locked by some task 
+           (as it may ber crucial to completing the task), the semaphore must be full to
+           allow deletion.
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemDelete (uint32 sem_id)
+{
+    uint32 local_id;
+
+    /* Check to see if this sem_id is valid, and retire it while it is deleted */
+    if (OS_RegistryRetire(&OS_bin_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /* Tasks still blocked on it return OS_SEM_FAILURE */
+    OS_SemDestroy(&OS_bin_sem_table[local_id].sem);
+    OS_WaitNotify(&OS_bin_sem_table[local_id].wait);
+
+    /* Remove the Id from the table, and its name, so that it cannot be found again */
+    pthread_mutex_lock(&OS_bin_sem_table_mut);  
+   
+    OS_bin_sem_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_bin_sem_registry, local_id);
+    strcpy(OS_bin_sem_table[local_id].name , "");
+    OS_bin_sem_table[local_id].creator = UNINITIALIZED;
+
+    pthread_mutex_unlock(&OS_bin_sem_table_mut);
+   
+    return OS_SUCCESS;
+
+}/* end OS_BinSemDelete */
+
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemGive
+
+    Purpose: The function  unlocks the semaphore referenced by sem_id by performing
+             a semaphore unlock operation on that semaphore.If the semaphore value 
+             resulting from this operation is positive, then no threads were blocked             
+             waiting for the semaphore to become unlocked; the semaphore value is
+             simply incremented for this semaphore.
+
+    
+    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
+             in the array of semaphores defined by the system
+             OS_ERR_INVALID_ID if the id passed in is not a binary semaphore
+             OS_SUCCESS if success
+                
+---------------------------------------------------------------------------------------*/
+
+int32 OS_BinSemGive ( uint32 sem_id )
+{
+    uint32 local_id;
+   
+    /* Check Parameters */
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_LockStatsReleased(&OS_bin_sem_table[local_id].stats);
+#endif
+
+    /* A give to a full semaphore is dropped */
+    OS_SemGive(&OS_bin_sem_table[local_id].sem);
+    OS_WaitNotify(&OS_bin_sem_table[local_id].wait);
+    
+    return OS_SUCCESS;
+}/* end OS_BinSemGive */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemFlush
+
+    Purpose: The function unblocks all tasks pending on the specified semaphore. However,
+             this function does not change the state of the semaphore.
+
+    
+    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
+             in the array of semaphores defined by the system
+             OS_ERR_INVALID_ID if the id passed in is not a binary semaphore
+             OS_SUCCESS if success
+
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemFlush (uint32 sem_id)
+{
+    uint32 local_id;
+
+    /* Check Parameters */
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    
+    OS_SemFlush(&OS_bin_sem_table[local_id].sem);
+    
+    return OS_SUCCESS;
+
+}/* end OS_BinSemFlush */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemEnter
+
+    Purpose: Validates a binary semaphore ID and counts the caller as a user of the
+             semaphore, so a delete waits for it. OS_SemLeave ends the use.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid binary semaphore
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_BinSemEnter (uint32 sem_id, uint32 *local_id)
+{
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    OS_SemEnter(&OS_bin_sem_table[*local_id].sem);
+
+    /*
+    ** A delete that retired the ID before the count went up does not wait
+    ** for this call, and the slot may already hold a new semaphore, so
+    ** check the ID again now that it is counted
+    */
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, local_id) != OS_SUCCESS)
+    {
+        OS_SemLeave(&OS_bin_sem_table[*local_id].sem);
+        return OS_ERR_INVALID_ID;
+    }
+
+    return OS_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------------------
+    Name:    OS_BinSemTake
+
+    Purpose: The locks the semaphore referenced by sem_id by performing a 
+             semaphore lock operation on that semaphore.If the semaphore value 
+             is currently zero, then the calling thread shall not return from 
+             the call until it either locks the semaphore or the semaphore
+             is flushed.
+
+    Return:  OS_ERR_INVALID_ID the Id passed in is not a valid binary semaphore
+             OS_SEM_FAILURE if the semaphore was deleted while waiting
+             OS_SUCCESS if success
+             
+----------------------------------------------------------------------------------------*/
+
+int32 OS_BinSemTake ( uint32 sem_id )
+{
+    uint32 local_id;
+    int32  status;
+    
+    if (OS_BinSemEnter(sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    
+#ifdef OS_INCLUDE_LOCK_STATS
+    status = OS_LockStatsSemTake(&OS_bin_sem_table[local_id].sem,
+                                 &OS_bin_sem_table[local_id].stats, NULL, TRUE);
+#else
+    status = OS_SemTake(&OS_bin_sem_table[local_id].sem, NULL);
+#endif
+
+    OS_SemLeave(&OS_bin_sem_table[local_id].sem);
+
+    return status;
+}/* end OS_BinSemTake */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemTimedWait
+    
+    Purpose: The function locks the semaphore referenced by sem_id . However,
+             if the semaphore cannot be locked without waiting for another process
+             or thread to unlock the semaphore , this wait shall be terminated when 
+             the specified timeout ,msecs, expires.
+
+    Returns: OS_SEM_TIMEOUT if semaphore was not relinquished in time
+             OS_SUCCESS if success
+             OS_SEM_FAILURE if the semaphore was deleted while waiting
+             OS_ERR_INVALID_ID if the ID passed in is not a valid semaphore ID
+
+    Notes:
+             Fix provided by Joshua M. Eliser 
+----------------------------------------------------------------------------------------*/
+
+int32 OS_BinSemTimedWait ( uint32 sem_id, uint32 msecs )
+{
+    uint32           local_id;
+    struct timespec  deadline;
+    int32            status;
+
+    if (OS_BinSemEnter(sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Compute an absolute time for the delay
+    */
+    OS_CompMonotonicDeadline(msecs, &deadline);
+
+#ifdef OS_INCLUDE_LOCK_STATS
+    status = OS_LockStatsSemTake(&OS_bin_sem_table[local_id].sem,
+                                 &OS_bin_sem_table[local_id].stats, &deadline, TRUE);
+#else
+    status = OS_SemTake(&OS_bin_sem_table[local_id].sem, &deadline);
+#endif
+
+    OS_SemLeave(&OS_bin_sem_table[local_id].sem);
+
+    return status;
+}/* end OS_BinSemTimedWait */
+
+/*--------------------------------------------------------------------------------------
+    Name: OS_BinSemGetIdByName
+
+    Purpose: This function tries to find a binary sem Id given the name of a bin_sem
+             The id is returned through sem_id
+
+    Returns: OS_INVALID_POINTER is semid or sem_name are NULL pointers
+             OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
+             OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+             OS_SUCCESS if success
+             
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemGetIdByName (uint32 *sem_id, const char *sem_name)
+{
+    int32 status;
+
+    if (sem_id == NULL || sem_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    /* a name too long wouldn't have been allowed in the first place
+     * so we definitely won't find a name too long*/
+    
+    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    {
+       return OS_ERR_NAME_TOO_LONG;
+    }
+
+    pthread_mutex_lock(&OS_bin_sem_table_mut);
+    status = OS_RegistryFindId(&OS_bin_sem_registry, sem_name, sem_id);
+    pthread_mutex_unlock(&OS_bin_sem_table_mut);
+
+    return status;
+    
+}/* end OS_BinSemGetIdByName */
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemGetInfo
+
+    Purpose: This function will pass back a pointer to structure that contains 
+             all of the relevant info( name and creator) about the specified binary
+             semaphore.
+             
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore 
+             OS_INVALID_POINTER if the bin_prop pointer is null
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+
+int32 OS_BinSemGetInfo (uint32 sem_id, OS_bin_sem_prop_t *bin_prop)  
+{
+    uint32 local_id;
+
+    /* Check to see that the id given is valid */
+    
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    if (bin_prop == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    /* put the info into the stucture */
+    pthread_mutex_lock(&OS_bin_sem_table_mut);  
+
+    bin_prop ->creator =    OS_bin_sem_table[local_id].creator;
+    bin_prop -> value = OS_SemGetValue(&OS_bin_sem_table[local_id].sem);
+    strcpy(bin_prop-> name, OS_bin_sem_table[local_id].name);
+    
+    pthread_mutex_unlock(&OS_bin_sem_table_mut);
+
+    return OS_SUCCESS;
+    
+} /* end OS_BinSemGetInfo */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemWaitPoll
+
+    Purpose: Takes the semaphore for OS_WaitMultiple without blocking
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid binary semaphore
+             OS_ERROR_TIMEOUT if the semaphore is not available
+             OS_SUCCESS if the semaphore was taken
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
+{
+    uint32 local_id;
+    int32  status = OS_ERROR_TIMEOUT;
+
+    if (OS_BinSemEnter(object->object_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    *source = &OS_bin_sem_table[local_id].wait;
+
+    if (OS_SemTryTake(&OS_bin_sem_table[local_id].sem))
+    {
+#ifdef OS_INCLUDE_LOCK_STATS
+        OS_LockStatsAcquired(&OS_bin_sem_table[local_id].stats, TRUE);
+#endif
+        status = OS_SUCCESS;
+    }
+
+    OS_SemLeave(&OS_bin_sem_table[local_id].sem);
+
+    return status;
+
+} /* end OS_BinSemWaitPoll */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_CountSemCreate
+
+   Purpose: Creates a counting semaphore with initial value specified by
+            sem_initial_value and name specified by sem_name. sem_id will be 
+            returned to the caller
+            
+   Returns: OS_INVALID_POINTER if sen name or sem_id are NULL
+            OS_ERR_NAME_TOO_LONG if the name given is too long
+            OS_ERR_NO_FREE_IDS if all of the semaphore ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of a counting semaphore
+            OS_SEM_FAILURE if the OS call failed
+            OS_INVALID_SEM_VALUE if the semaphore value is too high
+            OS_SUCCESS if success
+            
+
+   Notes: options is an unused parameter 
+---------------------------------------------------------------------------------------*/
+int32 OS_CountSemCreate (uint32 *sem_id, const char *sem_name, uint32 sem_initial_value,
+                        uint32 options)
+{
+    uint32 possible_semid;
+    int32  status;
+
+    if (sem_id == NULL || sem_name == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+   
+    /*
+    ** Verify that the semaphore maximum value is not too high
+    */
+    if ( sem_initial_value > SEM_VALUE_MAX )
+    {
+        return OS_INVALID_SEM_VALUE;
+    }
+ 
+    /* 
+    ** we don't want to allow names too long
+    ** if truncated, two names might be the same 
+    */
+    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    {
+        return OS_ERR_NAME_TOO_LONG;
+    }
+
+    /*
+    ** Lock
+    */
+    pthread_mutex_lock(&OS_count_sem_table_mut);  
+
+    status = OS_RegistryAlloc(&OS_count_sem_registry, sem_name, &possible_semid);
+    if (status != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_count_sem_table_mut);
+        return status;
+    }
+
+    /* 
+    ** set the ID to taken so no other task can grab it 
+    */
+    OS_count_sem_table[possible_semid].free = FALSE;
+
+    /*
+    ** Create semaphore
+    */
+    OS_SemInit(&OS_count_sem_table[possible_semid].sem, sem_initial_value, SEM_VALUE_MAX);
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_LockStatsClear(&OS_count_sem_table[possible_semid].stats);
+#endif
+
+    strcpy(OS_count_sem_table[possible_semid].name , (char*) sem_name);
+    OS_count_sem_table[possible_semid].creator = OS_FindCreator();
+
+    OS_RegistryPublish(&OS_count_sem_registry, possible_semid);
+    *sem_id = OS_RegistryGetId(&OS_count_sem_registry, possible_semid);
+    
+    /*
+    ** Unlock
+    */
+    pthread_mutex_unlock(&OS_count_sem_table_mut);
+
+    return OS_SUCCESS;
+
+}/* end OS_CountSemCreate */
+
+/*--------------------------------------------------------------------------------------
+     Name: OS_CountSemDelete
+
+    Purpose: Deletes the specified Countary Semaphore.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid counting semaphore
+             OS_SUCCESS if success
+    
+    Notes: Since we can't delete a semaphore which is currently locked by some task 
+           (as it may ber crucial to completing the task), the semaphore must be full to
+           allow deletion.
+---------------------------------------------------------------------------------------*/
+
+int32 OS_CountSemDelete (uint32 sem_id)
+{
+    uint32 local_id;
+
+    /* 
+    ** Check to see if this sem_id is valid, and retire it while it is deleted
+    */
+    if (OS_RegistryRetire(&OS_count_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }   
+
+    /* 
+    ** Tasks still blocked on it return OS_SEM_FAILURE 
+    */
+    OS_SemDestroy(&OS_count_sem_table[local_id].sem);
+    OS_WaitNotify(&OS_count_sem_table[local_id].wait);
+
+    /* 
+    ** Remove the Id from the table, and its name, so that it cannot be found again 
+    */
+
+    /*
+    ** Lock
+    */
+    pthread_mutex_lock(&OS_count_sem_table_mut);  
+   
+    OS_count_sem_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_count_sem_registry, local_id);
+    strcpy(OS_count_sem_table[local_id].name , "");
+    OS_count_sem_table[local_id].creator = UNINITIALIZED;
+
+    /* 
+    ** Unlock
+    */
+    pthread_mutex_unlock(&OS_count_sem_table_mut);
+   
+    return OS_SUCCESS;
+
+}/* end OS_CountSemDelete */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_CountSemGive
+
+    Purpose: The function  unlocks the semaphore referenced by sem_id by performing
+             a semaphore unlock operation on that semaphore.If the semaphore value 
+             resulting from this operation is positive, then no threads were blocked             
+             waiting for the semaphore to become unlocked; the semaphore value is
+             simply incremented for this semaphore.
+
+    
+    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
+             in the array of semaphores defined by the system
+             OS_ERR_INVALID_ID if the id passed in is not a counting semaphore
+             OS_SUCCESS if success
+                
+---------------------------------------------------------------------------------------*/
+
+int32 OS_CountSemGive ( uint32 sem_id )
+{
+    uint32 local_id;
+    
+    /* 
+    ** Check Parameters 
+    */
+    if (OS_RegistryCheckId(&OS_count_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /* 
+    ** A give to a full semaphore is dropped 
+    */
+    OS_SemGive(&OS_count_sem_table[local_id].sem);
+    OS_WaitNotify(&OS_count_sem_table[local_id].wait);
+
+    return(OS_SUCCESS);
+
+}/* end OS_CountSemGive */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_CountSemEnter
+
+    Purpose: Validates a counting semaphore ID and counts the caller as a user of the
+             semaphore, so a delete waits for it. OS_SemLeave ends the use.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid counting semaphore
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_CountSemEnter (uint32 sem_id, uint32 *local_id)
+{
+    if (OS_RegistryCheckId(&OS_count_sem_registry, sem_id, local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    OS_SemEnter(&OS_count_sem_table[*local_id].sem);
+
+    /*
+    ** A delete that retired the ID before the count went up does not wait
+    ** for this call, and the slot may already hold a new semaphore, so
+    ** check the ID again now that it is counted
+    */
+    if (OS_RegistryCheckId(&OS_count_sem_registry, sem_id, local_id) != OS_SUCCESS)
+    {
+        OS_SemLeave(&OS_count_sem_table[*local_id].sem);
+        return OS_ERR_INVALID_ID;
+    }
+
+    return OS_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------------------
+    Name:    OS_CountSemTake
+
+    Purpose: The locks the semaphore referenced by sem_id by performing a 
+             semaphore lock operation on that semaphore.If the semaphore value 
+             is currently zero, then the calling thread shall not return from 
+             the call until it either locks the semaphore or the semaphore
+             is flushed.
+
+    Return:  OS_ERR_INVALID_ID the Id passed in is not a valid counting semaphore
+             OS_SEM_FAILURE if the semaphore was deleted while waiting
+             OS_SUCCESS if success
+             
+----------------------------------------------------------------------------------------*/
+
+int32 OS_CountSemTake ( uint32 sem_id )
+{
+    uint32 local_id;
+    int32  status;
+    
+    if (OS_CountSemEnter(sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+    
+#ifdef OS_INCLUDE_LOCK_STATS
+    status = OS_LockStatsSemTake(&OS_count_sem_table[local_id].sem,
+                                 &OS_count_sem_table[local_id].stats, NULL, FALSE);
+#else
+    status = OS_SemTake(&OS_count_sem_table[local_id].sem, NULL);
+#endif
+
+    OS_SemLeave(&OS_count_sem_table[local_id].sem);
+
+    return status;
+
+}/* end OS_CountSemTake */
+
+/*---------------------------------------------------------------------------------------
+    Name: OS_CountSemTimedWait
+    
+    Purpose: The function locks the semaphore referenced by sem_id . However,
+             if the semaphore cannot be locked without waiting for another process
+             or thread to unlock the semaphore , this wait shall be terminated when 
+             the specified timeout ,msecs, expires.
+
+    Returns: OS_SEM_TIMEOUT if semaphore was not relinquished in time
+             OS_SUCCESS if success
+             OS_SEM_FAILURE if the semaphore was deleted while waiting
+             OS_ERR_INVALID_ID if the ID passed in is not a valid semaphore ID
+
+----------------------------------------------------------------------------------------*/
+
+int32 OS_CountSemTimedWait ( uint32 sem_id, uint32 msecs )
+{
+    uint32          local_id;
+    struct timespec deadline;
+    int32           status;
+
+    /* 
+    ** Check Parameters 
+    */
+    if (OS_CountSemEnter(sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+
+    /*
+    ** Compute an absolute time for the delay
+    */
+    OS_CompMonotonicDeadline(msecs, &deadline);
+
+#ifdef OS_INCLUDE_LOCK_STATS
+    status = OS_LockStatsSemTake(&OS_count_sem_table[local_id].sem,
+                                 &OS_count_sem_table[local_id].stats, &deadline, FALSE);
+#else
+    status = OS_SemTake(&OS_count_sem_table[local_id].sem, &deadline);
+#endif
+
+    OS_SemLeave(&OS_count_sem_table[local_id].sem);
+
+    return status;
+}/* end OS_CountSemTimedWait */
+
+/*--------------------------------------------------------------------------------------
+    Name: OS_CountSemGetIdByName
+
+    Purpose: This function tries to find a counting sem Id given the name of a count_sem
+             The id is returned through sem_id
+
+    Returns: OS_INVALID_POINTER is semid or sem_name are NULL pointers
+             OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
+             OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+             OS_SUCCESS if success
+             
+---------------------------------------------------------------------------------------*/
+int32 OS_CountSemGetIdByName (uint32 *sem_id, const char *sem_name)
+{
+    int32 status;
 
-    /* Check to see if the queue_id given is valid */
-    
-    if (queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
+    if (sem_id == NULL || sem_name == NULL)
     {
-       return OS_ERR_INVALID_ID;
+        return OS_INVALID_POINTER;
     }
-    
-    /*
-    ** Construct the queue name:
-    ** The name will consist of "/<process_id>.queue_name"
-    */
-
-    /* pre-pend / to queue name */
-    strcpy(name, "/");
 
-    /*
-    ** Get the process ID
-    */
-    process_id = getpid();
-    sprintf(process_id_string, "%d", process_id);
-    strcat(name, process_id_string);
-    strcat(name,".");
-    
-    strcat(name, OS_queue_table[queue_id].name);
-    
-    /* Try to delete and unlink the queue */
-    if((mq_close(OS_queue_table[queue_id].id) == -1) || (mq_unlink(name) == -1))
+    /* 
+    ** a name too long wouldn't have been allowed in the first place
+    ** so we definitely won't find a name too long
+    */    
+    if (strlen(sem_name) >= OS_MAX_API_NAME)
     {
-        return OS_ERROR;
+        return OS_ERR_NAME_TOO_LONG;
     }
-    
-    /* 
-     * Now that the queue is deleted, remove its "presence"
-     * in OS_message_q_table and OS_message_q_name_table 
-     */
-    pthread_mutex_lock(&OS_queue_table_mut);    
-    
-    OS_queue_table[queue_id].free = TRUE;
-    strcpy(OS_queue_table[queue_id].name, "");
-    OS_queue_table[queue_id].creator = UNINITIALIZED;
-    OS_queue_table[queue_id].id = UNINITIALIZED;
-    
-    pthread_mutex_unlock(&OS_queue_table_mut);
-    
-    return OS_SUCCESS;
-    
-} /* end OS_QueueDelete */
 
+    pthread_mutex_lock(&OS_count_sem_table_mut);
+    status = OS_RegistryFindId(&OS_count_sem_registry, sem_name, sem_id);
+    pthread_mutex_unlock(&OS_count_sem_table_mut);
+
+    return status;
+    
+}/* end OS_CountSemGetIdByName */
 /*---------------------------------------------------------------------------------------
- Name: OS_QueueGet
- 
- Purpose: Receive a message on a message queue.  Will pend or timeout on the receive.
- Returns: OS_ERR_INVALID_ID if the given ID does not exist
- OS_ERR_INVALID_POINTER if a pointer passed in is NULL
- OS_QUEUE_EMPTY if the Queue has no messages on it to be recieved
- OS_QUEUE_TIMEOUT if the timeout was OS_PEND and the time expired
- OS_QUEUE_INVALID_SIZE if the size copied from the queue was not correct
- OS_SUCCESS if success
- ---------------------------------------------------------------------------------------*/
-int32 OS_QueueGet (uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+    Name: OS_CountSemGetInfo
+
+    Purpose: This function will pass back a pointer to structure that contains 
+             all of the relevant info( name and creator) about the specified counting
+             semaphore.
+             
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore 
+             OS_INVALID_POINTER if the count_prop pointer is null
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+
+int32 OS_CountSemGetInfo (uint32 sem_id, OS_count_sem_prop_t *count_prop)  
 {
-    struct mq_attr  queueAttr;
-    int             sizeCopied = -1;
-    int             ret_val;
-    struct timespec ts;
-    
-    /*
-    ** Check Parameters 
+    uint32 local_id;
+
+    /* 
+    ** Check to see that the id given is valid 
     */
-    if(queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
+    if (OS_RegistryCheckId(&OS_count_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
-    else if( (data == NULL) || (size_copied == NULL) )
+
+    if (count_prop == NULL)
     {
         return OS_INVALID_POINTER;
     }
-    
+
     /*
-    ** Read the message queue for data
+    ** Lock
     */
-    if (timeout == OS_PEND) 
-    {      
-        /*
-        ** A signal can interrupt the mq_receive call, so the call has to be done with 
-        ** a loop
-        */
-        do 
-        {
-           sizeCopied = mq_receive(OS_queue_table[queue_id].id, data, size, NULL);
-        } while ( sizeCopied == -1 && errno == EINTR );
-
-        if(sizeCopied != size )
-        {
-            *size_copied = 0;
-            return(OS_QUEUE_INVALID_SIZE);
-        }
-    }
-    else if (timeout == OS_CHECK)
-    {      
-        /* get queue attributes */
-        if(mq_getattr(OS_queue_table[queue_id].id, &queueAttr))
-        {
-            return (OS_ERROR);
-        }
-        
-        /* check how many messages in queue */
-        if(queueAttr.mq_curmsgs) 
-        {
-            sizeCopied  = mq_receive(OS_queue_table[queue_id].id, data, size, NULL);
-        } 
-        else 
-        {
-            sizeCopied = -1;
-        }
-        
-        if (sizeCopied == -1)
-        {
-            *size_copied = 0;
-            return OS_QUEUE_EMPTY;
-        }
-        else if(sizeCopied != size )
-        {
-            *size_copied = 0;
-            return(OS_QUEUE_INVALID_SIZE);
-        }
-    }
-    else /* timeout */ 
-    {
-        ret_val = OS_CompAbsDelayTime( timeout , &ts) ;
-
-        /*
-        ** If the mq_timedreceive call is interrupted by a system call or signal,
-        ** call it again.
-        */
-        do
-        {
-           sizeCopied = mq_timedreceive(OS_queue_table[queue_id].id, data, size, NULL, &ts);
-        } while ( sizeCopied == -1 && errno == EINTR );
-        
-        if((sizeCopied == -1) && (errno == ETIMEDOUT))
-        {
-            return(OS_QUEUE_TIMEOUT);
-        }
-        else if( sizeCopied == size )
-        {
-            *size_copied = sizeCopied;
-            return OS_SUCCESS;
-        }
-        else
-        {
-            *size_copied = 0;
-            return OS_QUEUE_INVALID_SIZE;
-        }
-        
-    } /* END timeout */
+    pthread_mutex_lock(&OS_count_sem_table_mut);  
+    
+    /* put the info into the stucture */
+    count_prop -> value = OS_SemGetValue(&OS_count_sem_table[local_id].sem);
     
+    count_prop -> creator =    OS_count_sem_table[local_id].creator;
+    strcpy(count_prop-> name, OS_count_sem_table[local_id].name);
+   
     /*
-    ** Should never really get here.
-    */
+    ** Unlock
+    */ 
+    pthread_mutex_unlock(&OS_count_sem_table_mut);
+
     return OS_SUCCESS;
     
-} /* end OS_QueueGet */
+} /* end OS_CountSemGetInfo */
 
 /*---------------------------------------------------------------------------------------
- Name: OS_QueuePut
- 
- Purpose: Put a message on a message queue.
- 
- Returns: OS_ERR_INVALID_ID if the queue id passed in is not a valid queue
- OS_INVALID_POINTER if the data pointer is NULL
- OS_QUEUE_FULL if the queue cannot accept another message
- OS_ERROR if the OS call returns an error
- OS_SUCCESS if SUCCESS            
- 
- Notes: The flags parameter is not used.  The message put is always configured to
- immediately return an error if the receiving message queue is full.
- ---------------------------------------------------------------------------------------*/
-int32 OS_QueuePut (uint32 queue_id, void *data, uint32 size, uint32 flags)
+    Name: OS_CountSemWaitPoll
+
+    Purpose: Takes a count of the semaphore for OS_WaitMultiple without blocking
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid counting semaphore
+             OS_ERROR_TIMEOUT if the count is zero
+             OS_SUCCESS if a count was taken
+---------------------------------------------------------------------------------------*/
+int32 OS_CountSemWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
 {
-    struct mq_attr  queueAttr;
-    
-    /*
-    ** Check Parameters 
-    */
-    if(queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
-    {
-       return OS_ERR_INVALID_ID;
-    }
-    
-    if (data == NULL)
-    {
-       return OS_INVALID_POINTER;
-    }
-    
-    /* get queue attributes */
-    if(mq_getattr(OS_queue_table[queue_id].id, &queueAttr))
-    {
-       return (OS_ERROR);
-    }
-    
-    /* check if queue is full */
-    if(queueAttr.mq_curmsgs >= queueAttr.mq_maxmsg) 
+    uint32 local_id;
+    int32  status = OS_ERROR_TIMEOUT;
+
+    if (OS_CountSemEnter(object->object_id, &local_id) != OS_SUCCESS)
     {
-       return(OS_QUEUE_FULL);
+        return OS_ERR_INVALID_ID;
     }
-    
-    /* send message */
-    if(mq_send(OS_queue_table[queue_id].id, data, size, 1) == -1) 
+
+    *source = &OS_count_sem_table[local_id].wait;
+
+    if (OS_SemTryTake(&OS_count_sem_table[local_id].sem))
     {
-        return(OS_ERROR);
+#ifdef OS_INCLUDE_LOCK_STATS
+        OS_LockStatsAcquired(&OS_count_sem_table[local_id].stats, FALSE);
+#endif
+        status = OS_SUCCESS;
     }
-    
-    return OS_SUCCESS;
 
-} /* end OS_QueuePut */
+    OS_SemLeave(&OS_count_sem_table[local_id].sem);
 
+    return status;
 
-/* --------------------- END POSIX MESSAGE QUEUE IMPLEMENTATION ---------------------- */
-#endif
+} /* end OS_CountSemWaitPoll */
+/****************************************************************************************
+                                  MUTEX API
+****************************************************************************************/
 
-/*--------------------------------------------------------------------------------------
-    Name: OS_QueueGetIdByName
+/*---------------------------------------------------------------------------------------
+    Name: OS_MutSemInitPthread
 
-    Purpose: This function tries to find a queue Id given the name of the queue. The
-             id of the queue is passed back in queue_id
+    Purpose: Creates the pthread mutex of a mutex semaphore with the options asked for
 
-    Returns: OS_INVALID_POINTER if the name or id pointers are NULL
-             OS_ERR_NAME_TOO_LONG the name passed in is too long
-             OS_ERR_NAME_NOT_FOUND the name was not found in the table
+    Returns: OS_SEM_FAILURE if the OS calls failed
              OS_SUCCESS if success
-             
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_QueueGetIdByName (uint32 *queue_id, const char *queue_name)
+static int32 OS_MutSemInitPthread (uint32 local_id, uint32 options)
 {
-    uint32 i;
+    int                 return_code;
+    pthread_mutexattr_t mutex_attr ;    
 
-    if(queue_id == NULL || queue_name == NULL)
+    /* 
+    ** initialize the attribute with default values 
+    */
+    return_code = pthread_mutexattr_init(&mutex_attr); 
+#ifndef __CYGWIN32__ 
+    if ( return_code != 0 )
     {
-       return OS_INVALID_POINTER;
+       printf("Error: Mutex could not be created. pthread_mutexattr_init failed ID = %lu\n",local_id);
+       return OS_SEM_FAILURE;
     }
-    
-    /* a name too long wouldn't have been allowed in the first place
-     * so we definitely won't find a name too long*/
- 
-    if (strlen(queue_name) >= OS_MAX_API_NAME)
+
+#ifdef _MAC_OS_	
+    /*
+    ** setprotocol and settype are unsupported by linux or cygwin
+    */  
+    return_code = pthread_mutexattr_setprotocol(&mutex_attr,PTHREAD_PRIO_INHERIT) ;
+    if ( return_code != 0 )
+    {
+       printf("Error: Mutex could not be created. pthread_mutexattr_setprotocol failed ID = %lu\n",local_id);
+       return OS_SEM_FAILURE;    
+    }	
+    /*
+    **  Set the mutex type to RECURSIVE so a thread can do nested locks
+    */
+    return_code = pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
+    if ( return_code != 0 )
+    {
+       printf("Error: Mutex could not be created. pthread_mutexattr_settype failed ID = %lu\n",local_id);
+       return OS_SEM_FAILURE;   
+    }
+#else
+    /*
+    ** Priority inheritance only takes effect between tasks running under a
+    ** real time scheduling policy
+    */
+    if ( options & OS_MUTEX_PRIO_INHERIT )
     {
-       return OS_ERR_NAME_TOO_LONG;
+       return_code = pthread_mutexattr_setprotocol(&mutex_attr, PTHREAD_PRIO_INHERIT);
+       if ( return_code != 0 )
+       {
+          printf("Error: Mutex could not be created. pthread_mutexattr_setprotocol failed ID = %lu\n",local_id);
+          pthread_mutexattr_destroy(&mutex_attr);
+          return OS_SEM_FAILURE;    
+       }
     }
 
-    for (i = 0; i < OS_MAX_QUEUES; i++)
+    if ( options & OS_MUTEX_ROBUST )
     {
-        if (OS_queue_table[i].free != TRUE &&
-           (strcmp(OS_queue_table[i].name, (char*) queue_name) == 0 ))
-        {
-            *queue_id = i;
-            return OS_SUCCESS;
-        }
+       return_code = pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+       if ( return_code != 0 )
+       {
+          printf("Error: Mutex could not be created. pthread_mutexattr_setrobust failed ID = %lu\n",local_id);
+          pthread_mutexattr_destroy(&mutex_attr);
+          return OS_SEM_FAILURE;    
+       }
     }
 
-    /* The name was not found in the table,
-     *  or it was, and the queue_id isn't valid anymore */
-    return OS_ERR_NAME_NOT_FOUND;
-
-}/* end OS_QueueGetIdByName */
-
-/*---------------------------------------------------------------------------------------
-    Name: OS_QueueGetInfo
-
-    Purpose: This function will pass back a pointer to structure that contains 
-             all of the relevant info (name and creator) about the specified queue. 
-
-    Returns: OS_INVALID_POINTER if queue_prop is NULL
-             OS_ERR_INVALID_ID if the ID given is not  a valid queue
-             OS_SUCCESS if the info was copied over correctly
----------------------------------------------------------------------------------------*/
-int32 OS_QueueGetInfo (uint32 queue_id, OS_queue_prop_t *queue_prop)  
-{
-    /* Check to see that the id given is valid */
-    
-    if (queue_prop == NULL)
+    if ( options & OS_MUTEX_ADAPTIVE )
     {
-        return OS_INVALID_POINTER;
+       return_code = pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+       if ( return_code != 0 )
+       {
+          printf("Error: Mutex could not be created. pthread_mutexattr_settype failed ID = %lu\n",local_id);
+          pthread_mutexattr_destroy(&mutex_attr);
+          return OS_SEM_FAILURE;    
+       }
     }
-    
-    if (queue_id >= OS_MAX_QUEUES || OS_queue_table[queue_id].free == TRUE)
+#endif /* _MAC_OS_ */
+#endif /* __CYGWIN32__  */
+  
+    /* 
+    ** create the mutex 
+    ** upon successful initialization, the state of the mutex becomes initialized and ulocked 
+    */
+    return_code =  pthread_mutex_init((pthread_mutex_t *) &OS_mut_sem_table[local_id].id,&mutex_attr); 
+    pthread_mutexattr_destroy(&mutex_attr);
+    if ( return_code != 0 )
     {
-        return OS_ERR_INVALID_ID;
+       printf("Error: Mutex could not be created. ID = %lu\n",local_id);
+       return OS_SEM_FAILURE;
     }
 
-    /* put the info into the stucture */
-    pthread_mutex_lock(&OS_queue_table_mut);    
-
-    queue_prop -> creator =   OS_queue_table[queue_id].creator;
-    strcpy(queue_prop -> name, OS_queue_table[queue_id].name);
-
-    pthread_mutex_unlock(&OS_queue_table_mut);
-
     return OS_SUCCESS;
-    
-} /* end OS_QueueGetInfo */
 
-/****************************************************************************************
-                                  SEMAPHORE API
-****************************************************************************************/
+}/* end OS_MutSemInitPthread */
 
 /*---------------------------------------------------------------------------------------
-   Name: OS_BinSemCreate
+    Name: OS_MutSemCreate
 
-   Purpose: Creates a binary semaphore with initial value specified by
-            sem_initial_value and name specified by sem_name. sem_id will be 
-            returned to the caller
-            
-   Returns: OS_INVALID_POINTER if sen name or sem_id are NULL
-            OS_ERR_NAME_TOO_LONG if the name given is too long
-            OS_ERR_NO_FREE_IDS if all of the semaphore ids are taken
-            OS_ERR_NAME_TAKEN if this is already the name of a binary semaphore
-            OS_SEM_FAILURE if the OS call failed
-            OS_SUCCESS if success
-            
+    Purpose: Creates a mutex semaphore initially full.
+
+    Returns: OS_INVALID_POINTER if sem_id or sem_name are NULL
+             OS_ERR_NAME_TOO_LONG if the sem_name is too long to be stored
+             OS_SEM_INVALID_OPTIONS if the options are unknown or cannot be combined
+             OS_ERR_NO_FREE_IDS if there are no more free mutex Ids
+             OS_ERR_NAME_TAKEN if there is already a mutex with the same name
+             OS_SEM_FAILURE if the OS call failed
+             OS_SUCCESS if success
+    
+    Notes: options is 0 or a combination of OS_MUTEX_PRIO_INHERIT, OS_MUTEX_ROBUST
+           and OS_MUTEX_ADAPTIVE, which select the attributes of the pthread mutex,
+           or OS_MUTEX_LIGHTWEIGHT on its own. The robust and adaptive options are
+           only available on Linux.
 
-   Notes: options is an unused parameter 
 ---------------------------------------------------------------------------------------*/
-int32 OS_BinSemCreate (uint32 *sem_id, const char *sem_name, uint32 sem_initial_value,
-                        uint32 options)
+int32 OS_MutSemCreate (uint32 *sem_id, const char *sem_name, uint32 options)
 {
-    uint32 possible_semid;
-    uint32 i;
-#ifdef _MAC_OS_
-    char   SemName [OS_MAX_API_NAME];
-#else
-    int Status;
-#endif
+    int32               return_code;
+    uint32              possible_semid;
 
+    /* Check Parameters */
     if (sem_id == NULL || sem_name == NULL)
     {
         return OS_INVALID_POINTER;
@@ -1809,423 +5536,350 @@ int32 OS_BinSemCreate (uint32 *sem_id, const char *sem_name, uint32 sem_initial_
     
     /* we don't want to allow names too long*/
     /* if truncated, two names might be the same */
-    
     if (strlen(sem_name) >= OS_MAX_API_NAME)
     {
         return OS_ERR_NAME_TOO_LONG;
     }
 
-    /* Check Parameters */
-
-    pthread_mutex_lock(&OS_bin_sem_table_mut);  
-
-    for (possible_semid = 0; possible_semid < OS_MAX_BIN_SEMAPHORES; possible_semid++)
+    if ( (options & ~(OS_MUTEX_PRIO_INHERIT | OS_MUTEX_ROBUST |
+                      OS_MUTEX_ADAPTIVE | OS_MUTEX_LIGHTWEIGHT)) != 0 ||
+         ((options & OS_MUTEX_LIGHTWEIGHT) && options != OS_MUTEX_LIGHTWEIGHT) )
     {
-        if (OS_bin_sem_table[possible_semid].free == TRUE)    
-            break;
+        return OS_SEM_INVALID_OPTIONS;
     }
-
-    if((possible_semid >= OS_MAX_BIN_SEMAPHORES) ||  
-       (OS_bin_sem_table[possible_semid].free != TRUE))
+#ifndef _LINUX_OS_
+    if ( options & (OS_MUTEX_ROBUST | OS_MUTEX_ADAPTIVE) )
     {
-        pthread_mutex_unlock(&OS_bin_sem_table_mut);
-        return OS_ERR_NO_FREE_IDS;
+        return OS_SEM_INVALID_OPTIONS;
     }
-    
-    /* Check to see if the name is already taken */
-    for (i = 0; i < OS_MAX_BIN_SEMAPHORES; i++)
+#endif
+
+    pthread_mutex_lock(&OS_mut_sem_table_mut);  
+
+    return_code = OS_RegistryAlloc(&OS_mut_sem_registry, sem_name, &possible_semid);
+    if (return_code != OS_SUCCESS)
     {
-        if ((OS_bin_sem_table[i].free == FALSE) &&
-                strcmp ((char*) sem_name, OS_bin_sem_table[i].name) == 0)
-        {
-            pthread_mutex_unlock(&OS_bin_sem_table_mut);
-            return OS_ERR_NAME_TAKEN;
-        }
-    }  
+        pthread_mutex_unlock(&OS_mut_sem_table_mut);
+        return return_code;
+    }
 
-    /* Set the ID to be taken so another task doesn't try to grab it */
-    OS_bin_sem_table[possible_semid].free = FALSE;
+    /* Set the free flag to false to make sure no other task grabs it */
 
-    pthread_mutex_unlock(&OS_bin_sem_table_mut);
+    OS_mut_sem_table[possible_semid].free = FALSE;
+    pthread_mutex_unlock(&OS_mut_sem_table_mut);
 
-    /*
-    ** Create semaphore
-    */
-    errno = 0;
-   
-    /* Check to make sure the sem value is going to be either 0 or 1 */
-    if (sem_initial_value < 0)
+    if ( options & OS_MUTEX_LIGHTWEIGHT )
     {
-        sem_initial_value = 0;
+       OS_LwMutexInit(&OS_mut_sem_table[possible_semid].lw);
+       return_code = OS_SUCCESS;
     }
     else
     {
-        if (sem_initial_value > 1)
-        {
-            sem_initial_value = 1;
-        }
+       return_code = OS_MutSemInitPthread(possible_semid, options);
     }
 
-#ifdef _MAC_OS_
-    sprintf(SemName,"OS_BinSemName%lu",possible_semid);
-    /* unlink the name first, to make sure it doesn't exist anywhere*/
-    sem_unlink(SemName);
-    OS_bin_sem_table[possible_semid].id = sem_open(SemName,O_CREAT, 666, sem_initial_value);
-    if(OS_bin_sem_table[possible_semid].id == (sem_t*) SEM_FAILED )
-    {        
-       /* Since the call failed, set the free flag back to true */
-       pthread_mutex_lock(&OS_bin_sem_table_mut);        
-       OS_bin_sem_table[possible_semid].free = TRUE;
-       pthread_mutex_unlock(&OS_bin_sem_table_mut);
-       printf("Error Creating semaphore in OS_BinSemCreate! errno = %d\n", errno); 
-       return OS_SEM_FAILURE;
-    }
-#else /* _LINUX_OS_ */
-    Status = sem_init( &(OS_bin_sem_table[possible_semid].id) ,0 , sem_initial_value);
-    if( Status == -1 )
+    if ( return_code != OS_SUCCESS )
     {
-        /* Since the call failed, set the free flag back to true */
-       pthread_mutex_lock(&OS_bin_sem_table_mut);        
-       OS_bin_sem_table[possible_semid].free = TRUE;
-       pthread_mutex_unlock(&OS_bin_sem_table_mut);
+        /* Since the call failed, set free back to true */
+        pthread_mutex_lock(&OS_mut_sem_table_mut);
+        OS_mut_sem_table[possible_semid].free = TRUE;
+        OS_RegistryFree(&OS_mut_sem_registry, possible_semid);
+        pthread_mutex_unlock(&OS_mut_sem_table_mut);
 
-       printf("Error Creating semaphore in OS_BinSemCreate! errno = %d\n", errno);
-       return OS_SEM_FAILURE;
+        return return_code;
     }
-#endif
-            
-    *sem_id = possible_semid;
-
-    pthread_mutex_lock(&OS_bin_sem_table_mut);  
-
-    strcpy(OS_bin_sem_table[*sem_id].name , (char*) sem_name);
-    OS_bin_sem_table[*sem_id].creator = OS_FindCreator();
-    
-    OS_bin_sem_table[*sem_id].max_value = 1;
-    OS_bin_sem_table[*sem_id].current_value = sem_initial_value;
-    
-    pthread_mutex_unlock(&OS_bin_sem_table_mut);
-
-    return OS_SUCCESS;
-}/* end OS_BinSemCreate */
 
-/*--------------------------------------------------------------------------------------
-     Name: OS_BinSemDelete
-
-    Purpose: Deletes the specified Binary Semaphore.
-
-    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid binary semaphore
-             OS_SEM_FAILURE the OS call failed
-             OS_SUCCESS if success
-    
-    Notes: Since we can't delete a semaphore which is currently locked by some task 
-           (as it may ber crucial to completing the task), the semaphore must be full to
-           allow deletion.
----------------------------------------------------------------------------------------*/
-int32 OS_BinSemDelete (uint32 sem_id)
-{
-    /* Check to see if this sem_id is valid */
-    if (sem_id >= OS_MAX_BIN_SEMAPHORES || OS_bin_sem_table[sem_id].free == TRUE)
-    {
-        return OS_ERR_INVALID_ID;
-    }
+    /*
+    ** Mark mutex as initialized
+    */
+    pthread_mutex_lock(&OS_mut_sem_table_mut);  
 
-#ifdef _MAC_OS_
-    if (sem_close( (OS_bin_sem_table[sem_id].id)) != 0) /* 0 = success */ 
-#else /* _LINUX_OS_ */       
-    if (sem_destroy( &(OS_bin_sem_table[sem_id].id)) != 0) /* 0 = success */ 
+    strcpy(OS_mut_sem_table[possible_semid].name, (char*) sem_name);
+    OS_mut_sem_table[possible_semid].creator = OS_FindCreator();
+    OS_mut_sem_table[possible_semid].options = options;
+    OS_mut_sem_table[possible_semid].nested_value = 0;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_LockStatsClear(&OS_mut_sem_table[possible_semid].stats);
 #endif
-    {
-        return OS_SEM_FAILURE;
-    }
 
-    /* Remove the Id from the table, and its name, so that it cannot be found again */
-    pthread_mutex_lock(&OS_bin_sem_table_mut);  
-   
-    OS_bin_sem_table[sem_id].free = TRUE;
-    strcpy(OS_bin_sem_table[sem_id].name , "");
-    OS_bin_sem_table[sem_id].creator = UNINITIALIZED;
-    OS_bin_sem_table[sem_id].max_value = 0;
-    OS_bin_sem_table[sem_id].current_value = 0;
+    OS_RegistryPublish(&OS_mut_sem_registry, possible_semid);
+    *sem_id = OS_RegistryGetId(&OS_mut_sem_registry, possible_semid);
+    
+    pthread_mutex_unlock(&OS_mut_sem_table_mut);
 
-    pthread_mutex_unlock(&OS_bin_sem_table_mut);
-   
     return OS_SUCCESS;
 
-}/* end OS_BinSemDelete */
-
-
-/*---------------------------------------------------------------------------------------
-    Name: OS_BinSemGive
+}/* end OS_MutexSemCreate */
 
-    Purpose: The function  unlocks the semaphore referenced by sem_id by performing
-             a semaphore unlock operation on that semaphore.If the semaphore value 
-             resulting from this operation is positive, then no threads were blocked             
-             waiting for the semaphore to become unlocked; the semaphore value is
-             simply incremented for this semaphore.
+/*--------------------------------------------------------------------------------------
+     Name: OS_MutSemDelete
 
+    Purpose: Deletes the specified Mutex Semaphore.
     
-    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
-             in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID if the id passed in is not a binary semaphore
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid mutex
+             OS_SEM_FAILURE if the OS call failed
              OS_SUCCESS if success
-                
----------------------------------------------------------------------------------------*/
-
-int32 OS_BinSemGive ( uint32 sem_id )
-{
-    uint32 ret_val ;
-    int32    ret;
-   
-    /* Check Parameters */
-    if(sem_id >= OS_MAX_BIN_SEMAPHORES || OS_bin_sem_table[sem_id].free == TRUE)
-    {
-        return OS_ERR_INVALID_ID;
-    }
-    
-    /* If the semaphore isn't totally full, perform the give */
-    if ( OS_bin_sem_table[sem_id].current_value  < OS_bin_sem_table[sem_id].max_value )
-    {
-        #ifdef _MAC_OS_
-           ret = sem_post(OS_bin_sem_table[sem_id].id);
-        #else
-           ret = sem_post(&OS_bin_sem_table[sem_id].id);
-        #endif
-        if ( ret != 0 )
-        {
-            ret_val = OS_SEM_FAILURE;
-        }
-        else
-        {
-            ret_val = OS_SUCCESS ;
-            OS_bin_sem_table[sem_id].current_value ++;
-        }
-    }
-    else /* drop the post call */
-    {
-        ret_val = OS_SUCCESS ;
-    }
-    
-    return ret_val;
-}/* end OS_BinSemGive */
-
-/*---------------------------------------------------------------------------------------
-    Name: OS_BinSemFlush
-
-    Purpose: The function unblocks all tasks pending on the specified semaphore. However,
-             this function does not change the state of the semaphore.
 
-    
-    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
-             in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID if the id passed in is not a binary semaphore
-             OS_SUCCESS if success
+    Notes: The mutex must be full to take it, so we have to check for fullness
 
 ---------------------------------------------------------------------------------------*/
-int32 OS_BinSemFlush (uint32 sem_id)
+
+int32 OS_MutSemDelete (uint32 sem_id)
 {
-    uint32 ret_val ;
-    int32    ret = 0;
-    int i;
+    uint32 local_id;
+    int    status=-1;
 
-    /* Check Parameters */
-    if(sem_id >= OS_MAX_BIN_SEMAPHORES || OS_bin_sem_table[sem_id].free == TRUE)
+    /* Check to see if this sem_id is valid, and retire it while it is deleted */
+    if (OS_RegistryRetire(&OS_mut_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
-    
-    for (i = OS_bin_sem_table[sem_id].current_value  ; i < 0; i++)
+
+    if ( OS_mut_sem_table[local_id].options & OS_MUTEX_LIGHTWEIGHT )
     {
-         #ifdef _MAC_OS_ 
-            sem_post(OS_bin_sem_table[sem_id].id);
-         #else      
-            sem_post(&(OS_bin_sem_table[sem_id].id));
-         #endif
+        /* like pthread_mutex_destroy, refuse to delete a mutex that is held */
+        status = OS_LwMutexIsLocked(&OS_mut_sem_table[local_id].lw) ? EBUSY : 0;
     }
-    
-    
-    if ( ret != 0 )
+    else
     {
-       ret_val = OS_SEM_FAILURE;
+        status = pthread_mutex_destroy( &(OS_mut_sem_table[local_id].id)); /* 0 = success */   
     }
-    else
+    
+    if( status != 0)
     {
-       ret_val = OS_SUCCESS ;
+        OS_RegistryPublish(&OS_mut_sem_registry, local_id);
+        return OS_SEM_FAILURE;
     }
+    /* Delete its presence in the table */
+   
+    pthread_mutex_lock(&OS_mut_sem_table_mut);  
+
+    OS_mut_sem_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_mut_sem_registry, local_id);
+    strcpy(OS_mut_sem_table[local_id].name , "");
+    OS_mut_sem_table[local_id].creator = UNINITIALIZED;
+    
+    pthread_mutex_unlock(&OS_mut_sem_table_mut);
     
-    return(ret_val);
+    return OS_SUCCESS;
 
-}/* end OS_BinSemFlush */
+}/* end OS_MutSemDelete */
 
 /*---------------------------------------------------------------------------------------
-    Name:    OS_BinSemTake
+    Name: OS_MutSemGive
 
-    Purpose: The locks the semaphore referenced by sem_id by performing a 
-             semaphore lock operation on that semaphore.If the semaphore value 
-             is currently zero, then the calling thread shall not return from 
-             the call until it either locks the semaphore or the call is 
-             interrupted by a signal.
+    Purpose: The function releases the mutex object referenced by sem_id.The 
+             manner in which a mutex is released is dependent upon the mutex's type 
+             attribute.  If there are threads blocked on the mutex object referenced by 
+             mutex when this function is called, resulting in the mutex becoming 
+             available, the scheduling policy shall determine which thread shall 
+             acquire the mutex.
 
-    Return:  OS_ERR_INVALID_ID the Id passed in is not a valid binary semaphore
-             OS_SEM_FAILURE if the OS call failed
-             OS_SUCCESS if success
-             
-----------------------------------------------------------------------------------------*/
+    Returns: OS_SUCCESS if success
+             OS_SEM_FAILURE if the semaphore was not previously  initialized 
+             OS_ERR_INVALID_ID if the id passed in is not a valid mutex
 
-int32 OS_BinSemTake ( uint32 sem_id )
+---------------------------------------------------------------------------------------*/
+
+int32 OS_MutSemGive ( uint32 sem_id )
 {
+    uint32 local_id;
     uint32 ret_val ;
-    int    ret = -1;
-    
-    if(sem_id >= OS_MAX_BIN_SEMAPHORES  || OS_bin_sem_table[sem_id].free == TRUE)
+
+    /* Check Parameters */
+
+    if (OS_RegistryCheckId(&OS_mut_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
-    
-    /* decrement in anticipation of a good take, because if it is, the task may block and 
-     it won't be able to decrement the counter */
-    OS_bin_sem_table[sem_id].current_value --;
-    
+
     /*
-    ** A signal can interrupt the sem_wait call, so the call has to be done with 
-    ** a loop
+    ** Unlock the mutex
     */
-    do 
-    {
-       #ifdef _MAC_OS_
-          ret = sem_wait(OS_bin_sem_table[sem_id].id);
-       #else 
-          ret = sem_wait(&OS_bin_sem_table[sem_id].id);
-       #endif
-    } while ( ret == -1 && errno == EINTR );
-    
-    if ( ret == 0 )
+    if ( OS_mut_sem_table[local_id].options & OS_MUTEX_LIGHTWEIGHT )
     {
-        ret_val = OS_SUCCESS;
+       if ( !OS_LwMutexIsOwner(&OS_mut_sem_table[local_id].lw) )
+       {
+          ret_val = OS_SEM_FAILURE;
+       }
+       else if ( OS_mut_sem_table[local_id].nested_value > 0 )
+       {
+          OS_mut_sem_table[local_id].nested_value--;
+          ret_val = OS_SUCCESS;
+       }
+       else
+       {
+#ifdef OS_INCLUDE_LOCK_STATS
+          OS_LockStatsReleased(&OS_mut_sem_table[local_id].stats);
+#endif
+          ret_val = OS_LwMutexUnlock(&OS_mut_sem_table[local_id].lw);
+       }
     }
+    else if ( OS_mut_sem_table[local_id].nested_value > 0 )
+    {
+       OS_mut_sem_table[local_id].nested_value--;
+       return OS_SUCCESS;
+    }    
     else
     {
-        /* undo the premature decrement */
-        OS_bin_sem_table[sem_id].current_value ++;
-        ret_val = OS_SEM_FAILURE;
+#ifdef OS_INCLUDE_LOCK_STATS
+       /*
+       ** The hold time ends before the unlock, while the stats still belong
+       ** to this task, and only when the outermost take is given back
+       */
+       if ( !OS_LockStatsUnnest(&OS_mut_sem_table[local_id].stats) )
+       {
+          OS_LockStatsReleased(&OS_mut_sem_table[local_id].stats);
+       }
+#endif
+       if(pthread_mutex_unlock(&(OS_mut_sem_table[local_id].id)))
+       {
+           ret_val = OS_SEM_FAILURE ;
+       }
+       else
+       {
+           ret_val = OS_SUCCESS ;
+       }
     }
     
     return ret_val;
-}/* end OS_BinSemTake */
+} /* end OS_MutSemGive */
 
 /*---------------------------------------------------------------------------------------
-    Name: OS_BinSemTimedWait
-    
-    Purpose: The function locks the semaphore referenced by sem_id . However,
-             if the semaphore cannot be locked without waiting for another process
-             or thread to unlock the semaphore , this wait shall be terminated when 
-             the specified timeout ,msecs, expires.
-
-    Returns: OS_SEM_TIMEOUT if semaphore was not relinquished in time
-             OS_SUCCESS if success
-             OS_SEM_FAILURE the semaphore was not previously initialized or is not
-             in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID if the ID passed in is not a valid semaphore ID
+    Name: OS_MutSemTake
 
-    Notes:
-             Fix provided by Joshua M. Eliser 
-----------------------------------------------------------------------------------------*/
+    Purpose: The mutex object referenced by sem_id shall be locked by calling this
+             function. If the mutex is already locked, the calling thread shall
+             block until the mutex becomes available. This operation shall return
+             with the mutex object referenced by mutex in the locked state with the              
+             calling thread as its owner.
 
-#ifdef _MAC_OS_ 
-/*
-** The Mac OS X version must do a busy loop trying to see if the semaphore is available
-*/
-   int32 OS_BinSemTimedWait ( uint32 sem_id, uint32 msecs )
-   {
-       uint32           ret_val ;
-       int              timeloop;
+    Returns: OS_SUCCESS if success
+             OS_SEM_FAILURE if the semaphore was not previously initialized or is 
+             not in the array of semaphores defined by the system
+             OS_ERR_INVALID_ID the id passed in is not a valid mutex
+---------------------------------------------------------------------------------------*/
+int32 OS_MutSemTake ( uint32 sem_id )
+{
+    uint32 local_id;
+    int status;
+#ifdef OS_INCLUDE_LOCK_STATS
+    uint64 start;
+    int    nested;
+#endif
 
-       if( (sem_id >= OS_MAX_BIN_SEMAPHORES) || (OS_bin_sem_table[sem_id].free == TRUE) )
+    /* 
+    ** Check Parameters
+    */  
+    if (OS_RegistryCheckId(&OS_mut_sem_registry, sem_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
+ 
+    if ( OS_mut_sem_table[local_id].options & OS_MUTEX_LIGHTWEIGHT )
+    {
+       /*
+       ** A task taking a mutex it already holds nests, as it does for the
+       ** pthread mutexes that report EDEADLK
+       */
+       if ( OS_LwMutexIsOwner(&OS_mut_sem_table[local_id].lw) )
        {
-           return OS_ERR_INVALID_ID;
+          OS_mut_sem_table[local_id].nested_value++;
        }
-
-       /* 
-       ** Simulate the timeout with a sleep loop 
-       */
-       OS_bin_sem_table[sem_id].current_value --;
-       for (timeloop = msecs; timeloop >0; timeloop -= 100)
+#ifdef OS_INCLUDE_LOCK_STATS
+       else if ( OS_LwMutexTryLock(&OS_mut_sem_table[local_id].lw) )
        {
-           if((ret_val = sem_trywait(OS_bin_sem_table[sem_id].id)) == 0)
-           {
-              return OS_SUCCESS;
-           }
-           else if(errno == EAGAIN)
-           {
-              /* sleep for 100 msecs */
-              usleep(100*1000);
-           }
-           else
-           {
-              /* 
-              ** something besides the sem being taken made it fail 
-              */
-              OS_bin_sem_table[sem_id].current_value ++;
-              return OS_SEM_FAILURE;
-           }
+          OS_LockStatsAcquired(&OS_mut_sem_table[local_id].stats, TRUE);
+       }
+       else
+       {
+          start = OS_MonotonicNow();
+          OS_LwMutexLock(&OS_mut_sem_table[local_id].lw);
+          OS_LockStatsWaited(&OS_mut_sem_table[local_id].stats, start);
+          OS_LockStatsAcquired(&OS_mut_sem_table[local_id].stats, TRUE);
        }
- 
-       OS_bin_sem_table[sem_id].current_value++;
-       return OS_SEM_TIMEOUT;
-   }
-
 #else
-/*
-** The Linux version can use the sem_timedwait call
-*/
-   int32 OS_BinSemTimedWait ( uint32 sem_id, uint32 msecs )
-   {
-       uint32           ret_val;
-       struct timespec  ts;
-       int              sem_stat;
-
-       if( (sem_id >= OS_MAX_BIN_SEMAPHORES) || (OS_bin_sem_table[sem_id].free == TRUE) )
+       else
        {
-          return OS_ERR_INVALID_ID;
+          OS_LwMutexLock(&OS_mut_sem_table[local_id].lw);
        }
+#endif
 
-       OS_bin_sem_table[sem_id].current_value --;
-
+       return OS_SUCCESS;
+    }
+ 
+    /*
+    ** Lock the mutex - unlike the sem calls, the pthread mutex call
+    ** should not be interrupted by a signal
+    */
+#ifdef OS_INCLUDE_LOCK_STATS
+    /*
+    ** Only a mutex that is busy is timed as a wait. The recursive mutex
+    ** lets its holder take it again at once, that take is not counted.
+    */
+    nested = OS_LockStatsNest(&OS_mut_sem_table[local_id].stats);
+    status = pthread_mutex_trylock(&(OS_mut_sem_table[local_id].id));
+    if ( status == EBUSY )
+    {
+       start = OS_MonotonicNow();
+       status = pthread_mutex_lock(&(OS_mut_sem_table[local_id].id));
+       if ( status != EDEADLK )
+       {
+          OS_LockStatsWaited(&OS_mut_sem_table[local_id].stats, start);
+       }
+    }
+#else
+    status = pthread_mutex_lock(&(OS_mut_sem_table[local_id].id));
+#endif
+#ifdef _LINUX_OS_
+    if ( status == EOWNERDEAD )
+    {
        /*
-       ** Compute an absolute time for the delay
+       ** A robust mutex whose owner died holding it. The data it protects may
+       ** be half updated, but the mutex is usable again once marked consistent.
        */
-       ret_val = OS_CompAbsDelayTime( msecs , &ts);
-
+       OS_mut_sem_table[local_id].nested_value = 0;
+#ifdef OS_INCLUDE_LOCK_STATS
+       /* the hold of the dead owner ends here */
+       OS_LockStatsReleased(&OS_mut_sem_table[local_id].stats);
+       OS_mut_sem_table[local_id].stats.depth = 0;
+#endif
+       status = pthread_mutex_consistent(&(OS_mut_sem_table[local_id].id));
+    }
+#endif
+    if( status == EINVAL )
+    {
+      return OS_SEM_FAILURE ;
+    }
+    else if ( status == EDEADLK )
+    {
        /*
-       ** If the pend gets interrupted by a system call, then re-enter the wait
+       ** This status code happens if the task already has the mutex locked. In this case we do not want
+       ** to return an error code.
        */
-       do
-       {
-           sem_stat = sem_timedwait(&OS_bin_sem_table[sem_id].id, &ts);
-       } while ( sem_stat == -1 && errno == EINTR );
-
-       if ( sem_stat == 0 )
-       {
-            return(OS_SUCCESS);
-       }
-       else if ( sem_stat == -1 && errno == ETIMEDOUT ) 
-       {
-          /* Time out */ 
-          OS_bin_sem_table[sem_id].current_value++;
-          return(OS_SEM_TIMEOUT);
-       }
+       OS_mut_sem_table[local_id].nested_value++;
+#ifdef OS_INCLUDE_LOCK_STATS
+       OS_LockStatsUnnest(&OS_mut_sem_table[local_id].stats);
+#endif
 
-       /* 
-       ** something besides the sem being taken made it fail 
-       */
-       OS_bin_sem_table[sem_id].current_value ++;
-       return OS_SEM_FAILURE;
-   }
+       return OS_SUCCESS ;
+    }
+    else
+    {
+#ifdef OS_INCLUDE_LOCK_STATS
+      if ( !nested )
+      {
+         OS_LockStatsAcquired(&OS_mut_sem_table[local_id].stats, TRUE);
+      }
 #endif
+      return OS_SUCCESS;
+    }
+
+}
 /*--------------------------------------------------------------------------------------
-    Name: OS_BinSemGetIdByName
+    Name: OS_MutSemGetIdByName
 
-    Purpose: This function tries to find a binary sem Id given the name of a bin_sem
+    Purpose: This function tries to find a mutex sem Id given the name of a mut_sem
              The id is returned through sem_id
 
     Returns: OS_INVALID_POINTER is semid or sem_name are NULL pointers
@@ -2234,11 +5888,11 @@ int32 OS_BinSemTake ( uint32 sem_id )
              OS_SUCCESS if success
              
 ---------------------------------------------------------------------------------------*/
-int32 OS_BinSemGetIdByName (uint32 *sem_id, const char *sem_name)
+int32 OS_MutSemGetIdByName (uint32 *sem_id, const char *sem_name)
 {
-    uint32 i;
+    int32 status;
 
-    if (sem_id == NULL || sem_name == NULL)
+    if(sem_id == NULL || sem_name == NULL)
     {
         return OS_INVALID_POINTER;
     }
@@ -2248,1036 +5902,739 @@ int32 OS_BinSemGetIdByName (uint32 *sem_id, const char *sem_name)
     
     if (strlen(sem_name) >= OS_MAX_API_NAME)
     {
-       return OS_ERR_NAME_TOO_LONG;
+        return OS_ERR_NAME_TOO_LONG;
     }
 
-    for (i = 0; i < OS_MAX_BIN_SEMAPHORES; i++)
-    {
-        if (OS_bin_sem_table[i].free != TRUE &&
-                (strcmp (OS_bin_sem_table[i].name , (char*) sem_name) == 0))
-        {
-            *sem_id = i;
-            return OS_SUCCESS;
-        }
-    }
-    /* The name was not found in the table,
-     *  or it was, and the sem_id isn't valid anymore */
+    pthread_mutex_lock(&OS_mut_sem_table_mut);
+    status = OS_RegistryFindId(&OS_mut_sem_registry, sem_name, sem_id);
+    pthread_mutex_unlock(&OS_mut_sem_table_mut);
+
+    return status;
+
+}/* end OS_MutSemGetIdByName */
 
-    return OS_ERR_NAME_NOT_FOUND;
-    
-}/* end OS_BinSemGetIdByName */
 /*---------------------------------------------------------------------------------------
-    Name: OS_BinSemGetInfo
+    Name: OS_MutSemGetInfo
 
     Purpose: This function will pass back a pointer to structure that contains 
-             all of the relevant info( name and creator) about the specified binary
+             all of the relevant info( name and creator) about the specified mutex
              semaphore.
              
     Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore 
-             OS_INVALID_POINTER if the bin_prop pointer is null
+             OS_INVALID_POINTER if the mut_prop pointer is null
              OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
 
-int32 OS_BinSemGetInfo (uint32 sem_id, OS_bin_sem_prop_t *bin_prop)  
+int32 OS_MutSemGetInfo (uint32 sem_id, OS_mut_sem_prop_t *mut_prop)  
 {
+    uint32 local_id;
+
     /* Check to see that the id given is valid */
     
-    if (sem_id >= OS_MAX_BIN_SEMAPHORES || OS_bin_sem_table[sem_id].free == TRUE)
+    if (OS_RegistryCheckId(&OS_mut_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
 
-    if (bin_prop == NULL)
-    {
-        return OS_INVALID_POINTER;
-    }
-
-    /* put the info into the stucture */
-    pthread_mutex_lock(&OS_bin_sem_table_mut);  
-
-    bin_prop ->creator =    OS_bin_sem_table[sem_id].creator;
-    bin_prop -> value = OS_bin_sem_table[sem_id].current_value ;
-    strcpy(bin_prop-> name, OS_bin_sem_table[sem_id].name);
-    
-    pthread_mutex_unlock(&OS_bin_sem_table_mut);
-
-    return OS_SUCCESS;
-    
-} /* end OS_BinSemGetInfo */
-
-/*---------------------------------------------------------------------------------------
-   Name: OS_CountSemCreate
-
-   Purpose: Creates a counting semaphore with initial value specified by
-            sem_initial_value and name specified by sem_name. sem_id will be 
-            returned to the caller
-            
-   Returns: OS_INVALID_POINTER if sen name or sem_id are NULL
-            OS_ERR_NAME_TOO_LONG if the name given is too long
-            OS_ERR_NO_FREE_IDS if all of the semaphore ids are taken
-            OS_ERR_NAME_TAKEN if this is already the name of a counting semaphore
-            OS_SEM_FAILURE if the OS call failed
-            OS_INVALID_SEM_VALUE if the semaphore value is too high
-            OS_SUCCESS if success
-            
-
-   Notes: options is an unused parameter 
----------------------------------------------------------------------------------------*/
-int32 OS_CountSemCreate (uint32 *sem_id, const char *sem_name, uint32 sem_initial_value,
-                        uint32 options)
-{
-    uint32 possible_semid;
-    uint32 i;
-#ifdef _MAC_OS_
-    char   SemName [OS_MAX_API_NAME];
-#else
-    int Status;
-#endif
-
-    if (sem_id == NULL || sem_name == NULL)
-    {
-        return OS_INVALID_POINTER;
-    }
-   
-    /*
-    ** Verify that the semaphore maximum value is not too high
-    */
-    if ( sem_initial_value > SEM_VALUE_MAX )
-    {
-        return OS_INVALID_SEM_VALUE;
-    }
- 
-    /* 
-    ** we don't want to allow names too long
-    ** if truncated, two names might be the same 
-    */
-    if (strlen(sem_name) >= OS_MAX_API_NAME)
-    {
-        return OS_ERR_NAME_TOO_LONG;
-    }
-
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
-
-    for (possible_semid = 0; possible_semid < OS_MAX_COUNT_SEMAPHORES; possible_semid++)
+    if (mut_prop == NULL)
     {
-        if (OS_count_sem_table[possible_semid].free == TRUE)    
-            break;
+        return OS_INVALID_POINTER;
     }
     
-    if((possible_semid >= OS_MAX_COUNT_SEMAPHORES) ||  
-       (OS_count_sem_table[possible_semid].free != TRUE))
-    {
-        /*
-        ** Unlock
-        */
-        pthread_mutex_unlock(&OS_count_sem_table_mut);
-        return OS_ERR_NO_FREE_IDS;
-    }
+    /* put the info into the stucture */    
     
-    /* Check to see if the name is already taken */
-    for (i = 0; i < OS_MAX_COUNT_SEMAPHORES; i++)
-    {
-        if ((OS_count_sem_table[i].free == FALSE) &&
-                strcmp ((char*) sem_name, OS_count_sem_table[i].name) == 0)
-        {
-            /*
-            ** Unlock
-            */
-            pthread_mutex_unlock(&OS_count_sem_table_mut);
-            return OS_ERR_NAME_TAKEN;
-        }
-    }   
+    pthread_mutex_lock(&OS_mut_sem_table_mut);  
 
-    /* 
-    ** set the ID to taken so no other task can grab it 
-    */
-    OS_count_sem_table[possible_semid].free = FALSE;
+    mut_prop -> creator =   OS_mut_sem_table[local_id].creator;
+    strcpy(mut_prop-> name, OS_mut_sem_table[local_id].name);
 
+    pthread_mutex_unlock(&OS_mut_sem_table_mut);
+    
+    return OS_SUCCESS;
+    
+} /* end OS_BinSemGetInfo */
 
-    /*
-    ** Unlock
-    */
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
+/****************************************************************************************
+                                 READER-WRITER LOCK API
+****************************************************************************************/
 
-    /*
-    ** Create semaphore
-    */
-    errno = 0;
-    
-#ifdef _MAC_OS_
-   sprintf(SemName,"OS_CountSemName%lu",possible_semid);
-   /* unlink the name first, to make sure it doesn't exist anywhere*/
-   sem_unlink(SemName);
-   
-   OS_count_sem_table[possible_semid].id = sem_open(SemName,O_CREAT, 666, sem_initial_value);
-   if(OS_count_sem_table[possible_semid].id == (sem_t *)SEM_FAILED )
-   {
-       /* Since the call failed, set it the free flag back to true */
+/*---------------------------------------------------------------------------------------
+    Name: OS_RwLockCreate
 
-      /*
-      ** Lock
-      */
-      pthread_mutex_lock(&OS_count_sem_table_mut); 
+    Purpose: Creates a reader-writer lock, initially free. Any number of tasks
+             can hold it for reading at once, or one task for writing.
 
-      OS_count_sem_table[possible_semid].free = TRUE;
+    Returns: OS_INVALID_POINTER if rw_id or rw_name are NULL
+             OS_ERR_NAME_TOO_LONG if the rw_name is too long to be stored
+             OS_SEM_INVALID_OPTIONS if the options are unknown
+             OS_ERR_NO_FREE_IDS if there are no more free reader-writer lock Ids
+             OS_ERR_NAME_TAKEN if there is already a reader-writer lock with the
+             same name
+             OS_SUCCESS if success
 
-      /*
-      ** Unlock
-      */
-      pthread_mutex_unlock(&OS_count_sem_table_mut); 
-      printf("Error Creating semaphore in OS_CountSemCreate! errno = %d\n", errno);
-      return OS_SEM_FAILURE;
-   }
-#else
-    Status = sem_init( &(OS_count_sem_table[possible_semid].id) ,0 , sem_initial_value);
-    if( Status == -1 )
+    Notes: options is 0 or OS_RWLOCK_WRITER_PREFERENCE. By default a reader takes
+           the lock whenever no writer holds it, so a steady stream of readers can
+           keep a writer waiting. With OS_RWLOCK_WRITER_PREFERENCE new readers wait
+           while a writer is waiting, and a writer giving the lock hands it to the
+           next writer before the readers.
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockCreate (uint32 *rw_id, const char *rw_name, uint32 options)
+{
+    int32               return_code;
+    uint32              possible_rwid;
+
+    /* Check Parameters */
+    if (rw_id == NULL || rw_name == NULL)
     {
-      /* Since the call failed, set it the free flag back to true */
+        return OS_INVALID_POINTER;
+    }
 
-      /*
-      ** Lock
-      */
-      pthread_mutex_lock(&OS_count_sem_table_mut); 
-      OS_count_sem_table[possible_semid].free = TRUE;
+    /* we don't want to allow names too long*/
+    /* if truncated, two names might be the same */
+    if (strlen(rw_name) >= OS_MAX_API_NAME)
+    {
+        return OS_ERR_NAME_TOO_LONG;
+    }
 
-      /*
-      ** Unlock
-      */
-      pthread_mutex_unlock(&OS_count_sem_table_mut); 
-      printf("Error Creating semaphore in OS_CountSemCreate! errno = %d\n", errno);
-      return OS_SEM_FAILURE;
+    if ( (options & ~OS_RWLOCK_WRITER_PREFERENCE) != 0 )
+    {
+        return OS_SEM_INVALID_OPTIONS;
     }
-#endif
 
-    *sem_id = possible_semid;
+    pthread_mutex_lock(&OS_rwlock_table_mut);
 
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
+    return_code = OS_RegistryAlloc(&OS_rwlock_registry, rw_name, &possible_rwid);
+    if (return_code != OS_SUCCESS)
+    {
+        pthread_mutex_unlock(&OS_rwlock_table_mut);
+        return return_code;
+    }
 
-    OS_count_sem_table[*sem_id].free = FALSE;
-    strcpy(OS_count_sem_table[*sem_id].name , (char*) sem_name);
-    OS_count_sem_table[*sem_id].creator = OS_FindCreator();
-    OS_count_sem_table[*sem_id].max_value = SEM_VALUE_MAX; /* Linux semaphore max value */
-    OS_count_sem_table[*sem_id].current_value = sem_initial_value;
-    
-    /*
-    ** Unlock
-    */
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
+    OS_rwlock_table[possible_rwid].free = FALSE;
+
+    OS_RwInit(&OS_rwlock_table[possible_rwid].rw,
+              (options & OS_RWLOCK_WRITER_PREFERENCE) != 0);
+
+    strcpy(OS_rwlock_table[possible_rwid].name, (char*) rw_name);
+    OS_rwlock_table[possible_rwid].creator = OS_FindCreator();
+    OS_rwlock_table[possible_rwid].options = options;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_LockStatsClear(&OS_rwlock_table[possible_rwid].stats);
+#endif
+
+    OS_RegistryPublish(&OS_rwlock_registry, possible_rwid);
+    *rw_id = OS_RegistryGetId(&OS_rwlock_registry, possible_rwid);
+
+    pthread_mutex_unlock(&OS_rwlock_table_mut);
 
     return OS_SUCCESS;
 
-}/* end OS_CountSemCreate */
+}/* end OS_RwLockCreate */
 
 /*--------------------------------------------------------------------------------------
-     Name: OS_CountSemDelete
+    Name: OS_RwLockDelete
 
-    Purpose: Deletes the specified Countary Semaphore.
+    Purpose: Deletes the specified reader-writer lock. Tasks blocked on it return
+             OS_SEM_FAILURE.
 
-    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid counting semaphore
-             OS_SEM_FAILURE the OS call failed
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_FAILURE if the lock is held
              OS_SUCCESS if success
-    
-    Notes: Since we can't delete a semaphore which is currently locked by some task 
-           (as it may ber crucial to completing the task), the semaphore must be full to
-           allow deletion.
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_CountSemDelete (uint32 sem_id)
+int32 OS_RwLockDelete (uint32 rw_id)
 {
-    /* 
-    ** Check to see if this sem_id is valid 
-    */
-    if (sem_id >= OS_MAX_COUNT_SEMAPHORES || OS_count_sem_table[sem_id].free == TRUE)
+    uint32 local_id;
+
+    /* Check to see if this rw_id is valid, and retire it while it is deleted */
+    if (OS_RegistryRetire(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
-    }   
+    }
 
-    #ifdef _MAC_OS_
-       if (sem_close( (OS_count_sem_table[sem_id].id)) != 0) /* 0 = success */ 
-    #else
-       if (sem_destroy( &(OS_count_sem_table[sem_id].id)) != 0) /* 0 = success */
-    #endif
+    /* like OS_MutSemDelete, refuse to delete a lock that is held */
+    if (OS_RwDestroy(&OS_rwlock_table[local_id].rw) != OS_SUCCESS)
     {
+        OS_RegistryPublish(&OS_rwlock_registry, local_id);
         return OS_SEM_FAILURE;
     }
 
-    /* 
-    ** Remove the Id from the table, and its name, so that it cannot be found again 
-    */
+    /* Delete its presence in the table */
 
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
-   
-    OS_count_sem_table[sem_id].free = TRUE;
-    strcpy(OS_count_sem_table[sem_id].name , "");
-    OS_count_sem_table[sem_id].creator = UNINITIALIZED;
-    OS_count_sem_table[sem_id].max_value = 0;
-    OS_count_sem_table[sem_id].current_value = 0;
+    pthread_mutex_lock(&OS_rwlock_table_mut);
+
+    OS_rwlock_table[local_id].free = TRUE;
+    OS_RegistryFree(&OS_rwlock_registry, local_id);
+    strcpy(OS_rwlock_table[local_id].name , "");
+    OS_rwlock_table[local_id].creator = UNINITIALIZED;
+
+    pthread_mutex_unlock(&OS_rwlock_table_mut);
 
-    /* 
-    ** Unlock
-    */
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
-   
     return OS_SUCCESS;
 
-}/* end OS_CountSemDelete */
+}/* end OS_RwLockDelete */
 
 /*---------------------------------------------------------------------------------------
-    Name: OS_CountSemGive
+    Name: OS_RwLockTake
 
-    Purpose: The function  unlocks the semaphore referenced by sem_id by performing
-             a semaphore unlock operation on that semaphore.If the semaphore value 
-             resulting from this operation is positive, then no threads were blocked             
-             waiting for the semaphore to become unlocked; the semaphore value is
-             simply incremented for this semaphore.
+    Purpose: Takes a reader-writer lock for reading or writing, blocking until it
+             can or the deadline passes. A NULL deadline waits forever. The call
+             is counted as a user of the lock while it works on it, and checks
+             the ID again once it is counted, so a delete waits for it and an ID
+             that went stale never reaches a new lock in the same slot.
 
-    
-    Returns: OS_SEM_FAILURE the semaphore was not previously  initialized or is not
-             in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID if the id passed in is not a counting semaphore
-             OS_SUCCESS if success
-                
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             The status of OS_RwReadLock or OS_RwWriteLock otherwise
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_CountSemGive ( uint32 sem_id )
+static int32 OS_RwLockTake (uint32 rw_id, const struct timespec *deadline, int write)
 {
-    int32  ret_val = OS_SUCCESS;
-    int32  ret;
-    
-    /* 
-    ** Check Parameters 
-    */
-    if(sem_id >= OS_MAX_COUNT_SEMAPHORES || OS_count_sem_table[sem_id].free == TRUE)
+    uint32 local_id;
+    int32  status;
+
+    if (OS_RegistryCheckId(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
-    
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
 
-    /* 
-    ** If the semaphore isn't totally full, perform the give 
-    */
-    if ( OS_count_sem_table[sem_id].current_value  < OS_count_sem_table[sem_id].max_value )
+    OS_RwEnter(&OS_rwlock_table[local_id].rw);
+
+    if (OS_RegistryCheckId(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
     {
-        #ifdef _MAC_OS_
-           ret = sem_post(OS_count_sem_table[sem_id].id);
-        #else
-           ret = sem_post(&OS_count_sem_table[sem_id].id);
-        #endif
-        if ( ret != 0 )
-        {
-            ret_val = OS_SEM_FAILURE;
-        }
-        else
-        {
-            ret_val = OS_SUCCESS ;
-            OS_count_sem_table[sem_id].current_value ++;
-        }
+        OS_RwLeave(&OS_rwlock_table[local_id].rw);
+        return OS_ERR_INVALID_ID;
+    }
+
+#ifdef OS_INCLUDE_LOCK_STATS
+    status = OS_LockStatsRwTake(&OS_rwlock_table[local_id].rw,
+                                &OS_rwlock_table[local_id].stats, deadline, write);
+#else
+    if (write)
+    {
+        status = OS_RwWriteLock(&OS_rwlock_table[local_id].rw, deadline);
     }
-    else /* drop the post call */
+    else
     {
-        ret_val = OS_SUCCESS ;
+        status = OS_RwReadLock(&OS_rwlock_table[local_id].rw, deadline);
     }
+#endif
 
-    /* 
-    ** Unlock
-    */
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
-
-    return(ret_val);
+    OS_RwLeave(&OS_rwlock_table[local_id].rw);
 
-}/* end OS_CountSemGive */
+    return status;
+}/* end OS_RwLockTake */
 
 /*---------------------------------------------------------------------------------------
-    Name:    OS_CountSemTake
+    Name: OS_RwLockReadTake
 
-    Purpose: The locks the semaphore referenced by sem_id by performing a 
-             semaphore lock operation on that semaphore.If the semaphore value 
-             is currently zero, then the calling thread shall not return from 
-             the call until it either locks the semaphore or the call is 
-             interrupted by a signal.
+    Purpose: Takes the reader-writer lock for reading, blocking while a writer
+             holds it, or with OS_RWLOCK_WRITER_PREFERENCE while a writer waits
+             for it. A task may take the lock for reading more than once, each
+             take is given back with its own OS_RwLockGive.
 
-    Return:  OS_ERR_INVALID_ID the Id passed in is not a valid counting semaphore
-             OS_SEM_FAILURE if the OS call failed
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_FAILURE if the calling task holds the lock for writing, or the
+             lock was deleted while the task waited
              OS_SUCCESS if success
-             
-----------------------------------------------------------------------------------------*/
-
-int32 OS_CountSemTake ( uint32 sem_id )
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockReadTake (uint32 rw_id)
 {
-    int32  ret_val = OS_SUCCESS;
-    int    ret = -1;
-    
-    /* 
-    ** Check Parameters 
-    */
-    if(sem_id >= OS_MAX_COUNT_SEMAPHORES  || OS_count_sem_table[sem_id].free == TRUE)
-    {
-        return OS_ERR_INVALID_ID;
-    } 
-
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
-
-    /* 
-    ** decrement in anticipation of a good take, because if it is, the task may block and 
-    **  it won't be able to decrement the counter 
-    */
-    OS_count_sem_table[sem_id].current_value --;
+    return OS_RwLockTake(rw_id, NULL, FALSE);
 
-    /*
-    ** A signal can interrupt the sem_wait call, so the call has to be done with     
-    ** a loop
-    */
-    do   
-    {
-       #ifdef _MAC_OS_
-          ret = sem_wait(OS_count_sem_table[sem_id].id);    
-       #else   
-          ret = sem_wait(&OS_count_sem_table[sem_id].id);
-       #endif
-    } while ( ret == -1 && errno == EINTR );
+}/* end OS_RwLockReadTake */
 
-    if ( ret == 0 )
-    {
-        ret_val = OS_SUCCESS;
-    }
-    else
-    {
-        /* undo the premature decrement */
-        OS_count_sem_table[sem_id].current_value ++;
-        ret_val = OS_SEM_FAILURE;
-    }
-    
-    /* 
-    ** Unlock
-    */
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
+/*---------------------------------------------------------------------------------------
+    Name: OS_RwLockReadTimedWait
 
-    return ret_val;
+    Purpose: Takes the reader-writer lock for reading as OS_RwLockReadTake does,
+             waiting at most msecs milliseconds for it
 
-}/* end OS_CountSemTake */
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_TIMEOUT if the lock could not be taken in time
+             OS_SEM_FAILURE if the calling task holds the lock for writing, or the
+             lock was deleted while the task waited
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockReadTimedWait (uint32 rw_id, uint32 msecs)
+{
+    struct timespec  deadline;
 
-/*---------------------------------------------------------------------------------------
-    Name: OS_CountSemTimedWait
-    
-    Purpose: The function locks the semaphore referenced by sem_id . However,
-             if the semaphore cannot be locked without waiting for another process
-             or thread to unlock the semaphore , this wait shall be terminated when 
-             the specified timeout ,msecs, expires.
+    OS_CompMonotonicDeadline(msecs, &deadline);
 
-    Returns: OS_SEM_TIMEOUT if semaphore was not relinquished in time
-             OS_SUCCESS if success
-             OS_SEM_FAILURE the semaphore was not previously initialized or is not
-             in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID if the ID passed in is not a valid semaphore ID
+    return OS_RwLockTake(rw_id, &deadline, FALSE);
 
-----------------------------------------------------------------------------------------*/
+}/* end OS_RwLockReadTimedWait */
 
-#ifdef _MAC_OS_
-   int32 OS_CountSemTimedWait ( uint32 sem_id, uint32 msecs )
-   {
-       int32 ret_val = OS_SUCCESS;
-       int   timeloop;
+/*---------------------------------------------------------------------------------------
+    Name: OS_RwLockWriteTake
 
-       /* 
-       ** Check Parameters 
-       */
-       if( (sem_id >= OS_MAX_COUNT_SEMAPHORES) || (OS_count_sem_table[sem_id].free == TRUE) )
-       {
-           return OS_ERR_INVALID_ID;   
-       }
+    Purpose: Takes the reader-writer lock for writing, blocking until no task
+             holds it
 
-       /*
-       ** Lock
-       */
-       pthread_mutex_lock(&OS_count_sem_table_mut);  
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_FAILURE if the calling task already holds the lock for writing,
+             or the lock was deleted while the task waited
+             OS_SUCCESS if success
 
-       /* premature decrement, just like regurlar SemTake */
-       OS_count_sem_table[sem_id].current_value --;
+    Notes: The write take does not nest, and a task holding the lock for reading
+           that takes it for writing waits for itself forever
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockWriteTake (uint32 rw_id)
+{
+    return OS_RwLockTake(rw_id, NULL, TRUE);
 
-       for (timeloop = msecs; timeloop >0; timeloop -= 100)
-       {
-          if((ret_val = sem_trywait(OS_count_sem_table[sem_id].id)) == 0)
-          {
-             ret_val =  OS_SUCCESS;
-             break;
-          }
-          else if(errno == EAGAIN)
-          {
-              /* sleep for 100 msecs */
-              usleep(100*1000);
-          }
-          else
-          {
-             /* 
-             ** something besides the sem being taken made it fail 
-             */
-             OS_count_sem_table[sem_id].current_value ++;
-             ret_val =  OS_SEM_FAILURE;
-             break;
-          }
-      }
+}/* end OS_RwLockWriteTake */
 
-      ret_val =  OS_SEM_TIMEOUT;
+/*---------------------------------------------------------------------------------------
+    Name: OS_RwLockWriteTimedWait
 
-      /* 
-      ** Unlock
-      */
-      pthread_mutex_unlock(&OS_count_sem_table_mut);
+    Purpose: Takes the reader-writer lock for writing as OS_RwLockWriteTake does,
+             waiting at most msecs milliseconds for it
 
-      return(ret_val);
-   }
-#else
-   /*
-   ** The Linux version can use the sem_timedwait call
-   */
-   int32 OS_CountSemTimedWait ( uint32 sem_id, uint32 msecs )
-   {
-       int32           ret_val = OS_SUCCESS;
-       struct timespec ts;
-       int             sem_stat;
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_TIMEOUT if the lock could not be taken in time
+             OS_SEM_FAILURE if the calling task already holds the lock for writing,
+             or the lock was deleted while the task waited
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockWriteTimedWait (uint32 rw_id, uint32 msecs)
+{
+    struct timespec  deadline;
 
-       if( (sem_id >= OS_MAX_COUNT_SEMAPHORES) || (OS_count_sem_table[sem_id].free == TRUE) )
-       {
-          return OS_ERR_INVALID_ID;
-       }
+    OS_CompMonotonicDeadline(msecs, &deadline);
 
-       /*
-       ** Lock
-       */
-       pthread_mutex_lock(&OS_count_sem_table_mut);  
+    return OS_RwLockTake(rw_id, &deadline, TRUE);
 
-       OS_count_sem_table[sem_id].current_value --;
+}/* end OS_RwLockWriteTimedWait */
 
-       /*
-       ** Compute an absolute time for the delay
-       */
-       ret_val = OS_CompAbsDelayTime( msecs , &ts) ;
+/*---------------------------------------------------------------------------------------
+    Name: OS_RwLockGive
 
-       /*
-       ** If the pend gets interrupted by a system call, then re-enter the wait
-       */
-       do
-       {
-           sem_stat = sem_timedwait(&OS_count_sem_table[sem_id].id, &ts);
-       } while ( sem_stat == -1 && errno == EINTR );
+    Purpose: Gives back the reader-writer lock. A task holding the lock for
+             writing gives back its write take, any other task one read take.
 
-       if ( sem_stat == 0 )
-       {
-            ret_val = OS_SUCCESS;
-       }
-       else if ( sem_stat == -1 && errno == ETIMEDOUT )
-       {
-          /* Time out */
-          OS_count_sem_table[sem_id].current_value++;
-          ret_val = OS_SEM_TIMEOUT;
-       }
-       else
-       {
-          /*
-          ** something besides the sem being taken made it fail
-          */
-          OS_count_sem_table[sem_id].current_value ++;
-       
-          ret_val = OS_SEM_FAILURE;
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_SEM_FAILURE if the lock is not held, or another task holds it for
+             writing
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RwLockGive (uint32 rw_id)
+{
+    uint32 local_id;
 
-       }
-    
-       /* 
-       ** Unlock
-       */
-       pthread_mutex_unlock(&OS_count_sem_table_mut);
+    if (OS_RegistryCheckId(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
+    {
+        return OS_ERR_INVALID_ID;
+    }
 
-       return(ret_val);
-   }
+#ifdef OS_INCLUDE_LOCK_STATS
+    if ( OS_RwIsWriter(&OS_rwlock_table[local_id].rw) )
+    {
+        OS_LockStatsReleased(&OS_rwlock_table[local_id].stats);
+    }
 #endif
+
+    return OS_RwUnlock(&OS_rwlock_table[local_id].rw);
+
+}/* end OS_RwLockGive */
+
 /*--------------------------------------------------------------------------------------
-    Name: OS_CountSemGetIdByName
+    Name: OS_RwLockGetIdByName
 
-    Purpose: This function tries to find a counting sem Id given the name of a count_sem
-             The id is returned through sem_id
+    Purpose: This function tries to find a reader-writer lock Id given its name.
+             The id is returned through rw_id
 
-    Returns: OS_INVALID_POINTER is semid or sem_name are NULL pointers
+    Returns: OS_INVALID_POINTER is rw_id or rw_name are NULL pointers
              OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
              OS_ERR_NAME_NOT_FOUND if the name was not found in the table
              OS_SUCCESS if success
-             
 ---------------------------------------------------------------------------------------*/
-int32 OS_CountSemGetIdByName (uint32 *sem_id, const char *sem_name)
+int32 OS_RwLockGetIdByName (uint32 *rw_id, const char *rw_name)
 {
-    uint32 i;
+    int32 status;
 
-    if (sem_id == NULL || sem_name == NULL)
+    if(rw_id == NULL || rw_name == NULL)
     {
         return OS_INVALID_POINTER;
     }
 
-    /* 
-    ** a name too long wouldn't have been allowed in the first place
-    ** so we definitely won't find a name too long
-    */    
-    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    if (strlen(rw_name) >= OS_MAX_API_NAME)
     {
         return OS_ERR_NAME_TOO_LONG;
     }
 
-    for (i = 0; i < OS_MAX_COUNT_SEMAPHORES; i++)
-    {
-        if (OS_count_sem_table[i].free != TRUE &&
-                (strcmp (OS_count_sem_table[i].name , (char*) sem_name) == 0))
-        {
-            *sem_id = i;
-            return OS_SUCCESS;
-        }
-    }
-    /* 
-    ** The name was not found in the table,
-    ** or it was, and the sem_id isn't valid anymore 
-    */
-    return OS_ERR_NAME_NOT_FOUND;
-    
-}/* end OS_CountSemGetIdByName */
+    pthread_mutex_lock(&OS_rwlock_table_mut);
+    status = OS_RegistryFindId(&OS_rwlock_registry, rw_name, rw_id);
+    pthread_mutex_unlock(&OS_rwlock_table_mut);
+
+    return status;
+
+}/* end OS_RwLockGetIdByName */
+
 /*---------------------------------------------------------------------------------------
-    Name: OS_CountSemGetInfo
+    Name: OS_RwLockGetInfo
 
-    Purpose: This function will pass back a pointer to structure that contains 
-             all of the relevant info( name and creator) about the specified counting
-             semaphore.
-             
-    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore 
-             OS_INVALID_POINTER if the count_prop pointer is null
+    Purpose: This function will pass back a pointer to structure that contains
+             the name and creator of the specified reader-writer lock, with a
+             snapshot of who holds it and how many tasks wait for it.
+
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_INVALID_POINTER if the rw_prop pointer is null
              OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_CountSemGetInfo (uint32 sem_id, OS_count_sem_prop_t *count_prop)  
+int32 OS_RwLockGetInfo (uint32 rw_id, OS_rwlock_prop_t *rw_prop)
 {
-    /* 
-    ** Check to see that the id given is valid 
-    */
-    if (sem_id >= OS_MAX_COUNT_SEMAPHORES || OS_count_sem_table[sem_id].free == TRUE)
+    uint32       local_id;
+    OS_rwlock_t *rw;
+
+    if (OS_RegistryCheckId(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
 
-    if (count_prop == NULL)
+    if (rw_prop == NULL)
     {
         return OS_INVALID_POINTER;
     }
 
-    /*
-    ** Lock
-    */
-    pthread_mutex_lock(&OS_count_sem_table_mut);  
-    
-    /* put the info into the stucture */
-    count_prop -> value = OS_count_sem_table[sem_id].current_value;
-    
-    count_prop -> creator =    OS_count_sem_table[sem_id].creator;
-    strcpy(count_prop-> name, OS_count_sem_table[sem_id].name);
-   
-    /*
-    ** Unlock
-    */ 
-    pthread_mutex_unlock(&OS_count_sem_table_mut);
+    rw = &OS_rwlock_table[local_id].rw;
+
+    pthread_mutex_lock(&OS_rwlock_table_mut);
+
+    rw_prop -> creator = OS_rwlock_table[local_id].creator;
+    rw_prop -> options = OS_rwlock_table[local_id].options;
+    strcpy(rw_prop-> name, OS_rwlock_table[local_id].name);
+
+    pthread_mutex_unlock(&OS_rwlock_table_mut);
+
+    rw_prop -> readers       = OS_RwGetReaders(rw);
+    rw_prop -> writer        = (OS_AtomicLoad(&rw->state) == OS_RW_WRITER);
+    rw_prop -> read_waiters  = OS_AtomicLoad(&rw->read_waiters);
+    rw_prop -> write_waiters = OS_AtomicLoad(&rw->write_waiters);
 
     return OS_SUCCESS;
-    
-} /* end OS_CountSemGetInfo */
+
+} /* end OS_RwLockGetInfo */
+
 /****************************************************************************************
-                                  MUTEX API
+                                  LOCK STATISTICS API
 ****************************************************************************************/
 
+#ifdef OS_INCLUDE_LOCK_STATS
 /*---------------------------------------------------------------------------------------
-    Name: OS_MutSemCreate
+    Name: OS_LockStatsDumpOne
 
-    Purpose: Creates a mutex semaphore initially full.
+    Purpose: Writes the statistics of one lock to an open file, with the owner and
+             the last waiter named from the task table
 
-    Returns: OS_INVALID_POINTER if sem_id or sem_name are NULL
-             OS_ERR_NAME_TOO_LONG if the sem_name is too long to be stored
-             OS_ERR_NO_FREE_IDS if there are no more free mutex Ids
-             OS_ERR_NAME_TAKEN if there is already a mutex with the same name
-             OS_SEM_FAILURE if the OS call failed
+    Returns: OS_ERR_FILE if the file could not be written
              OS_SUCCESS if success
-    
-    Notes: the options parameter is not used in this implementation
-
 ---------------------------------------------------------------------------------------*/
-int32 OS_MutSemCreate (uint32 *sem_id, const char *sem_name, uint32 options)
+static int32 OS_LockStatsDumpOne (int32 fd, const char *type, const char *name,
+                                  OS_lock_stats_t *stats)
 {
-    int                 return_code;
-    pthread_mutexattr_t mutex_attr ;    
-    uint32              possible_semid;
-    uint32              i;      
+    OS_task_prop_t owner;
+    OS_task_prop_t waiter;
+    char           line[OS_LOCK_STATS_BUCKETS * 24 + 128];
+    uint32        *histogram;
+    int            len;
+    int            i;
+    int            j;
 
-    /* Check Parameters */
-    if (sem_id == NULL || sem_name == NULL)
+    if ( stats->owner == 0 || OS_TaskGetInfo(stats->owner, &owner) != OS_SUCCESS )
     {
-        return OS_INVALID_POINTER;
+        strcpy(owner.name, "-");
     }
-    
-    /* we don't want to allow names too long*/
-    /* if truncated, two names might be the same */
-    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    if ( stats->last_waiter == 0 ||
+         OS_TaskGetInfo(stats->last_waiter, &waiter) != OS_SUCCESS )
     {
-        return OS_ERR_NAME_TOO_LONG;
+        strcpy(waiter.name, "-");
     }
 
-    pthread_mutex_lock(&OS_mut_sem_table_mut);  
-
-    for (possible_semid = 0; possible_semid < OS_MAX_MUTEXES; possible_semid++)
+    len = snprintf(line, sizeof(line),
+                   "%-6s %-20s acquired %lu contended %lu owner %s last waiter %s"
+                   " max wait %lu us max hold %lu us\n",
+                   type, name, stats->acquisitions, stats->contended, owner.name,
+                   waiter.name, stats->max_wait_usecs, stats->max_hold_usecs);
+    if ( OS_write(fd, line, len) != len )
     {
-        if (OS_mut_sem_table[possible_semid].free == TRUE)    
-            break;
+        return OS_ERR_FILE;
     }
-    
-    if( (possible_semid == OS_MAX_MUTEXES) ||
-        (OS_mut_sem_table[possible_semid].free != TRUE) )
+
+    /*
+    ** One line per histogram, bucket 0 first
+    */
+    for ( j = 0; j < 2; j++ )
     {
-        pthread_mutex_unlock(&OS_mut_sem_table_mut);
-        return OS_ERR_NO_FREE_IDS;
-    }
+        histogram = (j == 0) ? stats->wait_histogram : stats->hold_histogram;
 
-    /* Check to see if the name is already taken */
+        len = sprintf(line, "   %s", (j == 0) ? "wait" : "hold");
+        for ( i = 0; i < OS_LOCK_STATS_BUCKETS; i++ )
+        {
+            len += sprintf(line + len, " %lu", histogram[i]);
+        }
+        len += sprintf(line + len, "\n");
 
-    for (i = 0; i < OS_MAX_MUTEXES; i++)
-    {
-        if ((OS_mut_sem_table[i].free == FALSE) &&
-                strcmp ((char*) sem_name, OS_mut_sem_table[i].name) == 0)
+        if ( OS_write(fd, line, len) != len )
         {
-            pthread_mutex_unlock(&OS_mut_sem_table_mut);
-            return OS_ERR_NAME_TAKEN;
+            return OS_ERR_FILE;
         }
     }
 
-    /* Set the free flag to false to make sure no other task grabs it */
+    return OS_SUCCESS;
 
-    OS_mut_sem_table[possible_semid].free = FALSE;
-    pthread_mutex_unlock(&OS_mut_sem_table_mut);
+}/* end OS_LockStatsDumpOne */
+#endif
 
-    /* 
-          ** initialize the attribute with default values 
-          */
-    return_code = pthread_mutexattr_init(&mutex_attr); 
-#ifndef __CYGWIN32__ 
-    if ( return_code != 0 )
-    {
-        /* Since the call failed, set free back to true */
-        pthread_mutex_lock(&OS_mut_sem_table_mut);
-        OS_mut_sem_table[possible_semid].free = TRUE;
-        pthread_mutex_unlock(&OS_mut_sem_table_mut);
+/*---------------------------------------------------------------------------------------
+    Name: OS_BinSemGetStats
 
-       printf("Error: Mutex could not be created. pthread_mutexattr_init failed ID = %lu\n",possible_semid);
-       return OS_SEM_FAILURE;
-    }
+    Purpose: Copies the lock statistics of a binary semaphore into stats
 
-#ifdef _MAC_OS_	
-    /*
-    ** setprotocol and settype are unsupported by linux or cygwin
-    */  
-    return_code = pthread_mutexattr_setprotocol(&mutex_attr,PTHREAD_PRIO_INHERIT) ;
-    if ( return_code != 0 )
-    {
-        /* Since the call failed, set free back to true */
-        pthread_mutex_lock(&OS_mut_sem_table_mut);
-        OS_mut_sem_table[possible_semid].free = TRUE;
-        pthread_mutex_unlock(&OS_mut_sem_table_mut);
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore
+             OS_INVALID_POINTER if the stats pointer is null
+             OS_ERR_NOT_IMPLEMENTED if OS_INCLUDE_LOCK_STATS is not defined
+             OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_BinSemGetStats (uint32 sem_id, OS_lock_stats_t *stats)
+{
+#ifdef OS_INCLUDE_LOCK_STATS
+    uint32 local_id;
 
-       printf("Error: Mutex could not be created. pthread_mutexattr_setprotocol failed ID = %lu\n",possible_semid);
-       return OS_SEM_FAILURE;    
-    }	
-    /*
-    **  Set the mutex type to RECURSIVE so a thread can do nested locks
-    */
-    return_code = pthread_mutexattr_settype(&mutex_attr, PTHREAD_MUTEX_RECURSIVE);
-    if ( return_code != 0 )
+    if (OS_RegistryCheckId(&OS_bin_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
-        /* Since the call failed, set free back to true */
-        pthread_mutex_lock(&OS_mut_sem_table_mut);
-        OS_mut_sem_table[possible_semid].free = TRUE;
-        pthread_mutex_unlock(&OS_mut_sem_table_mut);
-
-       printf("Error: Mutex could not be created. pthread_mutexattr_settype failed ID = %lu\n",possible_semid);
-       return OS_SEM_FAILURE;   
+        return OS_ERR_INVALID_ID;
     }
-#endif /* _MAC_OS_ */
-#endif /* __CYGWIN32__  */
-  
-    /* 
-    ** create the mutex 
-    ** upon successful initialization, the state of the mutex becomes initialized and ulocked 
-    */
-    return_code =  pthread_mutex_init((pthread_mutex_t *) &OS_mut_sem_table[possible_semid].id,&mutex_attr); 
-    if ( return_code != 0 )
-    {
-        /* Since the call failed, set free back to true */
-        pthread_mutex_lock(&OS_mut_sem_table_mut);
-        OS_mut_sem_table[possible_semid].free = TRUE;
-        pthread_mutex_unlock(&OS_mut_sem_table_mut);
 
-       printf("Error: Mutex could not be created. ID = %lu\n",possible_semid);
-       return OS_SEM_FAILURE;
-    }
-    else
+    if (stats == NULL)
     {
-       /*
-       ** Mark mutex as initialized
-       */
-       /* printf("Mutex created, mutex_id = %d \n" ,possible_semid) ;*/
-       
-       *sem_id = possible_semid;
-    
-       pthread_mutex_lock(&OS_mut_sem_table_mut);  
-
-       strcpy(OS_mut_sem_table[*sem_id].name, (char*) sem_name);
-       OS_mut_sem_table[*sem_id].free = FALSE;
-       OS_mut_sem_table[*sem_id].creator = OS_FindCreator();
-    
-       pthread_mutex_unlock(&OS_mut_sem_table_mut);
-
-       return OS_SUCCESS;
+        return OS_INVALID_POINTER;
     }
 
-}/* end OS_MutexSemCreate */
+    OS_LockStatsCopy(&OS_bin_sem_table[local_id].stats, stats);
 
-/*--------------------------------------------------------------------------------------
-     Name: OS_MutSemDelete
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_BinSemGetStats */
 
-    Purpose: Deletes the specified Mutex Semaphore.
-    
-    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid mutex
-             OS_SEM_FAILURE if the OS call failed
-             OS_SUCCESS if success
+/*---------------------------------------------------------------------------------------
+    Name: OS_CountSemGetStats
 
-    Notes: The mutex must be full to take it, so we have to check for fullness
+    Purpose: Copies the lock statistics of a counting semaphore into stats. A
+             counting semaphore has no single owner, so its owner, maximum hold
+             time and hold histogram are always zero.
 
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore
+             OS_INVALID_POINTER if the stats pointer is null
+             OS_ERR_NOT_IMPLEMENTED if OS_INCLUDE_LOCK_STATS is not defined
+             OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_MutSemDelete (uint32 sem_id)
+int32 OS_CountSemGetStats (uint32 sem_id, OS_lock_stats_t *stats)
 {
-    int status=-1;
+#ifdef OS_INCLUDE_LOCK_STATS
+    uint32 local_id;
 
-    /* Check to see if this sem_id is valid   */
-    if (sem_id >= OS_MAX_MUTEXES || OS_mut_sem_table[sem_id].free == TRUE)
+    if (OS_RegistryCheckId(&OS_count_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
 
-    status = pthread_mutex_destroy( &(OS_mut_sem_table[sem_id].id)); /* 0 = success */   
-    
-    if( status != 0)
+    if (stats == NULL)
     {
-        return OS_SEM_FAILURE;
+        return OS_INVALID_POINTER;
     }
-    /* Delete its presence in the table */
-   
-    pthread_mutex_lock(&OS_mut_sem_table_mut);  
 
-    OS_mut_sem_table[sem_id].free = TRUE;
-    strcpy(OS_mut_sem_table[sem_id].name , "");
-    OS_mut_sem_table[sem_id].creator = UNINITIALIZED;
-    
-    pthread_mutex_unlock(&OS_mut_sem_table_mut);
-    
-    return OS_SUCCESS;
+    OS_LockStatsCopy(&OS_count_sem_table[local_id].stats, stats);
 
-}/* end OS_MutSemDelete */
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_CountSemGetStats */
 
 /*---------------------------------------------------------------------------------------
-    Name: OS_MutSemGive
-
-    Purpose: The function releases the mutex object referenced by sem_id.The 
-             manner in which a mutex is released is dependent upon the mutex's type 
-             attribute.  If there are threads blocked on the mutex object referenced by 
-             mutex when this function is called, resulting in the mutex becoming 
-             available, the scheduling policy shall determine which thread shall 
-             acquire the mutex.
+    Name: OS_MutSemGetStats
 
-    Returns: OS_SUCCESS if success
-             OS_SEM_FAILURE if the semaphore was not previously  initialized 
-             OS_ERR_INVALID_ID if the id passed in is not a valid mutex
+    Purpose: Copies the lock statistics of a mutex into stats. Nested takes by the
+             task that holds the mutex are not counted.
 
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid mutex
+             OS_INVALID_POINTER if the stats pointer is null
+             OS_ERR_NOT_IMPLEMENTED if OS_INCLUDE_LOCK_STATS is not defined
+             OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-
-int32 OS_MutSemGive ( uint32 sem_id )
+int32 OS_MutSemGetStats (uint32 sem_id, OS_lock_stats_t *stats)
 {
-    uint32 ret_val ;
-
-    /* Check Parameters */
+#ifdef OS_INCLUDE_LOCK_STATS
+    uint32 local_id;
 
-    if(sem_id >= OS_MAX_MUTEXES || OS_mut_sem_table[sem_id].free == TRUE)
+    if (OS_RegistryCheckId(&OS_mut_sem_registry, sem_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
 
-    /*
-    ** Unlock the mutex
-    */
-    if ( OS_mut_sem_table[sem_id].nested_value > 0 )
-    {
-       OS_mut_sem_table[sem_id].nested_value--;
-       return OS_SUCCESS;
-    }    
-    else if(pthread_mutex_unlock(&(OS_mut_sem_table[sem_id].id)))
-    {
-        ret_val = OS_SEM_FAILURE ;
-    }
-    else
+    if (stats == NULL)
     {
-        ret_val = OS_SUCCESS ;
+        return OS_INVALID_POINTER;
     }
-    
-    return ret_val;
-} /* end OS_MutSemGive */
+
+    OS_LockStatsCopy(&OS_mut_sem_table[local_id].stats, stats);
+
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_MutSemGetStats */
 
 /*---------------------------------------------------------------------------------------
-    Name: OS_MutSemTake
+    Name: OS_RwLockGetStats
 
-    Purpose: The mutex object referenced by sem_id shall be locked by calling this
-             function. If the mutex is already locked, the calling thread shall
-             block until the mutex becomes available. This operation shall return
-             with the mutex object referenced by mutex in the locked state with the              
-             calling thread as its owner.
+    Purpose: Copies the lock statistics of a reader-writer lock into stats. Read
+             and write takes are both counted, the owner and the hold times are
+             only kept for the writers.
 
-    Returns: OS_SUCCESS if success
-             OS_SEM_FAILURE if the semaphore was not previously initialized or is 
-             not in the array of semaphores defined by the system
-             OS_ERR_INVALID_ID the id passed in is not a valid mutex
+    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid reader-writer lock
+             OS_INVALID_POINTER if the stats pointer is null
+             OS_ERR_NOT_IMPLEMENTED if OS_INCLUDE_LOCK_STATS is not defined
+             OS_SUCCESS if success
 ---------------------------------------------------------------------------------------*/
-int32 OS_MutSemTake ( uint32 sem_id )
+int32 OS_RwLockGetStats (uint32 rw_id, OS_lock_stats_t *stats)
 {
-    int status;
+#ifdef OS_INCLUDE_LOCK_STATS
+    uint32 local_id;
 
-    /* 
-    ** Check Parameters
-    */  
-    if(sem_id >= OS_MAX_MUTEXES || OS_mut_sem_table[sem_id].free == TRUE)
+    if (OS_RegistryCheckId(&OS_rwlock_registry, rw_id, &local_id) != OS_SUCCESS)
     {
         return OS_ERR_INVALID_ID;
     }
- 
-    /*
-    ** Lock the mutex - unlike the sem calls, the pthread mutex call
-    ** should not be interrupted by a signal
-    */
-    status = pthread_mutex_lock(&(OS_mut_sem_table[sem_id].id));
-    if( status == EINVAL )
-    {
-      return OS_SEM_FAILURE ;
-    }
-    else if ( status == EDEADLK )
-    {
-       /*
-       ** This status code happens if the task already has the mutex locked. In this case we do not want
-       ** to return an error code.
-       */
-       OS_mut_sem_table[sem_id].nested_value++;
 
-       return OS_SUCCESS ;
-    }
-    else
+    if (stats == NULL)
     {
-      return OS_SUCCESS;
+        return OS_INVALID_POINTER;
     }
 
-}
-/*--------------------------------------------------------------------------------------
-    Name: OS_MutSemGetIdByName
+    OS_LockStatsCopy(&OS_rwlock_table[local_id].stats, stats);
 
-    Purpose: This function tries to find a mutex sem Id given the name of a mut_sem
-             The id is returned through sem_id
+    return OS_SUCCESS;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_RwLockGetStats */
 
-    Returns: OS_INVALID_POINTER is semid or sem_name are NULL pointers
-             OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
-             OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+/*---------------------------------------------------------------------------------------
+    Name: OS_LockStatsDump
+
+    Purpose: Writes the lock statistics of every binary semaphore, counting
+             semaphore, mutex and reader-writer lock to a file, one line per lock followed by its
+             wait and hold histograms.
+
+    Returns: OS_INVALID_POINTER if the filename is null
+             OS_ERR_FILE if the file could not be created or written
+             OS_ERR_NOT_IMPLEMENTED if OS_INCLUDE_LOCK_STATS is not defined
              OS_SUCCESS if success
-             
+
+    Notes: filename is an OSAL path, such as /ram/lockstats.txt
 ---------------------------------------------------------------------------------------*/
-int32 OS_MutSemGetIdByName (uint32 *sem_id, const char *sem_name)
+int32 OS_LockStatsDump (const char *filename)
 {
-    uint32 i;
+#ifdef OS_INCLUDE_LOCK_STATS
+    OS_lock_stats_t stats;
+    char            name[OS_MAX_API_NAME];
+    int32           fd;
+    int32           status = OS_SUCCESS;
+    int             in_use;
+    int             i;
 
-    if(sem_id == NULL || sem_name == NULL)
+    if (filename == NULL)
     {
         return OS_INVALID_POINTER;
     }
 
-    /* a name too long wouldn't have been allowed in the first place
-     * so we definitely won't find a name too long*/
-    
-    if (strlen(sem_name) >= OS_MAX_API_NAME)
+    fd = OS_creat(filename, OS_WRITE_ONLY);
+    if (fd < 0)
     {
-        return OS_ERR_NAME_TOO_LONG;
+        return OS_ERR_FILE;
     }
 
-    for (i = 0; i < OS_MAX_MUTEXES; i++)
+    /*
+    ** Each record is copied out under its table mutex, the file is
+    ** written with no table mutex held
+    */
+    for (i = 0; i < OS_MAX_BIN_SEMAPHORES && status == OS_SUCCESS; i++)
     {
-        if ((OS_mut_sem_table[i].free != TRUE) &&
-           (strcmp (OS_mut_sem_table[i].name, (char*) sem_name) == 0) )
+        pthread_mutex_lock(&OS_bin_sem_table_mut);
+        in_use = (OS_bin_sem_table[i].free == FALSE);
+        if (in_use)
         {
-            *sem_id = i;
-            return OS_SUCCESS;
+            strcpy(name, OS_bin_sem_table[i].name);
+            OS_LockStatsCopy(&OS_bin_sem_table[i].stats, &stats);
         }
-    }
-    
-    /* The name was not found in the table,
-     *  or it was, and the sem_id isn't valid anymore */
-    return OS_ERR_NAME_NOT_FOUND;
+        pthread_mutex_unlock(&OS_bin_sem_table_mut);
 
-}/* end OS_MutSemGetIdByName */
+        if (in_use)
+        {
+            status = OS_LockStatsDumpOne(fd, "BINSEM", name, &stats);
+        }
+    }
 
-/*---------------------------------------------------------------------------------------
-    Name: OS_MutSemGetInfo
+    for (i = 0; i < OS_MAX_COUNT_SEMAPHORES && status == OS_SUCCESS; i++)
+    {
+        pthread_mutex_lock(&OS_count_sem_table_mut);
+        in_use = (OS_count_sem_table[i].free == FALSE);
+        if (in_use)
+        {
+            strcpy(name, OS_count_sem_table[i].name);
+            OS_LockStatsCopy(&OS_count_sem_table[i].stats, &stats);
+        }
+        pthread_mutex_unlock(&OS_count_sem_table_mut);
 
-    Purpose: This function will pass back a pointer to structure that contains 
-             all of the relevant info( name and creator) about the specified mutex
-             semaphore.
-             
-    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid semaphore 
-             OS_INVALID_POINTER if the mut_prop pointer is null
-             OS_SUCCESS if success
----------------------------------------------------------------------------------------*/
+        if (in_use)
+        {
+            status = OS_LockStatsDumpOne(fd, "CNTSEM", name, &stats);
+        }
+    }
 
-int32 OS_MutSemGetInfo (uint32 sem_id, OS_mut_sem_prop_t *mut_prop)  
-{
-    /* Check to see that the id given is valid */
-    
-    if (sem_id >= OS_MAX_MUTEXES || OS_mut_sem_table[sem_id].free == TRUE)
+    for (i = 0; i < OS_MAX_MUTEXES && status == OS_SUCCESS; i++)
     {
-        return OS_ERR_INVALID_ID;
+        pthread_mutex_lock(&OS_mut_sem_table_mut);
+        in_use = (OS_mut_sem_table[i].free == FALSE);
+        if (in_use)
+        {
+            strcpy(name, OS_mut_sem_table[i].name);
+            OS_LockStatsCopy(&OS_mut_sem_table[i].stats, &stats);
+        }
+        pthread_mutex_unlock(&OS_mut_sem_table_mut);
+
+        if (in_use)
+        {
+            status = OS_LockStatsDumpOne(fd, "MUTEX", name, &stats);
+        }
     }
 
-    if (mut_prop == NULL)
+    for (i = 0; i < OS_MAX_RWLOCKS && status == OS_SUCCESS; i++)
     {
-        return OS_INVALID_POINTER;
+        pthread_mutex_lock(&OS_rwlock_table_mut);
+        in_use = (OS_rwlock_table[i].free == FALSE);
+        if (in_use)
+        {
+            strcpy(name, OS_rwlock_table[i].name);
+            OS_LockStatsCopy(&OS_rwlock_table[i].stats, &stats);
+        }
+        pthread_mutex_unlock(&OS_rwlock_table_mut);
+
+        if (in_use)
+        {
+            status = OS_LockStatsDumpOne(fd, "RWLOCK", name, &stats);
+        }
     }
-    
-    /* put the info into the stucture */    
-    
-    pthread_mutex_lock(&OS_mut_sem_table_mut);  
 
-    mut_prop -> creator =   OS_mut_sem_table[sem_id].creator;
-    strcpy(mut_prop-> name, OS_mut_sem_table[sem_id].name);
+    OS_close(fd);
 
-    pthread_mutex_unlock(&OS_mut_sem_table_mut);
-    
-    return OS_SUCCESS;
-    
-} /* end OS_BinSemGetInfo */
+    return status;
+#else
+    return OS_ERR_NOT_IMPLEMENTED;
+#endif
+}/* end OS_LockStatsDump */
 
 
 /****************************************************************************************
@@ -3427,6 +6784,130 @@ int32 OS_HeapGetInfo       (OS_heap_prop_t *heap_prop)
     */
     return (OS_ERR_NOT_IMPLEMENTED);
 }
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_GetSystemLoad
+
+   Purpose: Passes back how busy the whole system and each core were since the
+            previous call, and the load averages. The busy time of a core is all
+            of its time except idle and I/O wait.
+
+   Returns: OS_INVALID_POINTER if system_load is NULL
+            OS_ERR_NOT_IMPLEMENTED if the host OS has no /proc/stat
+            OS_ERROR if /proc/stat cannot be read
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_GetSystemLoad (OS_system_load_t *system_load)
+{
+#ifdef _LINUX_OS_
+    FILE              *fp;
+    char               line[256];
+    unsigned long long times[8];
+    uint64             total;
+    uint64             busy;
+    uint32             percent;
+    double             averages[3];
+    int                cpu;
+    int                slot;
+    int                i;
+
+    if (system_load == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    memset(system_load, 0, sizeof(OS_system_load_t));
+
+    fp = fopen("/proc/stat", "r");
+    if ( fp == NULL )
+    {
+        return OS_ERROR;
+    }
+
+    pthread_mutex_lock(&OS_system_load_mut);
+
+    /*
+    ** Each line lists user, nice, system, idle, iowait, irq, softirq and
+    ** steal time, the "cpu" line for the whole system and "cpuN" for core N
+    */
+    while ( fgets(line, sizeof(line), fp) != NULL && strncmp(line, "cpu", 3) == 0 )
+    {
+        memset(times, 0, sizeof(times));
+
+        if ( line[3] == ' ' )
+        {
+            slot = 0;
+            sscanf(line + 3, "%llu %llu %llu %llu %llu %llu %llu %llu", &times[0], &times[1],
+                   &times[2], &times[3], &times[4], &times[5], &times[6], &times[7]);
+        }
+        else
+        {
+            system_load -> num_cpus++;
+            if ( sscanf(line + 3, "%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu, &times[0],
+                        &times[1], &times[2], &times[3], &times[4], &times[5], &times[6],
+                        &times[7]) < 5 || cpu < 0 || cpu >= OS_SYSTEM_LOAD_CPUS )
+            {
+                continue;
+            }
+            slot = cpu + 1;
+        }
+
+        total = 0;
+        for ( i = 0; i < 8; i++ )
+        {
+            total += times[i];
+        }
+        busy = total - times[3] - times[4];
+
+        /*
+        ** The iowait count of a core can go backwards, so busy may drop between
+        ** calls or grow by more than total did. A drop is taken as no busy time
+        ** and the percentage is capped at 100.
+        */
+        percent = 0;
+        if ( total > OS_system_load_total[slot] && busy > OS_system_load_busy[slot] )
+        {
+            percent = (uint32) (((busy - OS_system_load_busy[slot]) * 100) /
+                                (total - OS_system_load_total[slot]));
+            if ( percent > 100 )
+            {
+                percent = 100;
+            }
+        }
+        OS_system_load_total[slot] = total;
+        OS_system_load_busy[slot]  = busy;
+
+        if ( slot == 0 )
+        {
+            system_load -> busy_percent = percent;
+        }
+        else
+        {
+            system_load -> cpu_busy_percent[slot - 1] = percent;
+        }
+    }
+
+    pthread_mutex_unlock(&OS_system_load_mut);
+    fclose(fp);
+
+    if ( getloadavg(averages, 3) == 3 )
+    {
+        for ( i = 0; i < 3; i++ )
+        {
+            system_load -> load_average[i] = (uint32) (averages[i] * 100.0);
+        }
+    }
+
+    return OS_SUCCESS;
+#else
+    if (system_load == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    return (OS_ERR_NOT_IMPLEMENTED);
+#endif
+}
 /*---------------------------------------------------------------------------------------
 ** Name: OS_Tick2Micros
 **
@@ -3499,55 +6980,97 @@ int32 OS_Milli2Ticks(uint32 milli_seconds)
 
 int32 OS_GetLocalTime(OS_time_t *time_struct)
 {
-/* the code that is #if 0'd out below is what we actually want to use. However 
- * clock_gettime doesn;t seem to be implemented in linux right now. The code that is
- * being used instead will return the clock of the system its in. Hopefully that will
- * be good enough for this port for now. */
-    
-    struct timeval tv;
-    int Status;
-    int32 ReturnCode;
+    struct timespec now;
 
     if (time_struct == NULL)
     {
        return OS_INVALID_POINTER;
     }
 
-    Status = gettimeofday(&tv, NULL);
-    time_struct-> seconds = tv.tv_sec;
-    time_struct-> microsecs = tv.tv_usec;
-    
-    if (Status == 0)
+    if (clock_gettime(CLOCK_REALTIME, &now) != 0)
     {
-        ReturnCode = OS_SUCCESS;
+       return OS_ERROR;
     }
-    else
+
+    time_struct->seconds   = now.tv_sec;
+    time_struct->microsecs = now.tv_nsec / 1000;
+
+    return OS_SUCCESS;
+
+}/* end OS_GetLocalTime */
+
+/*---------------------------------------------------------------------------------------
+ * Name: OS_GetMonotonicTime
+ * 
+ * Purpose: Gets the time of a clock that only moves forward at a steady rate and is
+ *          not changed by OS_SetLocalTime. The time is counted from an unspecified
+ *          start, such as boot. It is the clock of OS_TaskDelayUntil.
+ * ------------------------------------------------------------------------------------*/
+int32 OS_GetMonotonicTime(OS_time_t *time_struct)
+{
+    struct timespec now;
+
+    if (time_struct == NULL)
     {
-        ReturnCode = OS_ERROR;
+       return OS_INVALID_POINTER;
     }
-    
-    return ReturnCode;
 
-#if 0  
-   int status;
-   struct  timespec  time;
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+    {
+       return OS_ERROR;
+    }
 
-   if (time_struct == NULL)
-      return OS_INVALID_POINTER;
-   
-    /*status = clock_gettime(CLOCK_REALTIME, &time);*/
-    if (status != 0)
-        return OS_ERROR;
+    time_struct->seconds   = now.tv_sec;
+    time_struct->microsecs = now.tv_nsec / 1000;
+
+    return OS_SUCCESS;
+
+}/* end OS_GetMonotonicTime */
+
+/*---------------------------------------------------------------------------------------
+ * Name: OS_GetMonotonicTimeNs
+ * 
+ * Purpose: Gets the time of the clock of OS_GetMonotonicTime in nanoseconds, which
+ *          lasts for centuries in 64 bits. On Linux clock_gettime reads the clock in
+ *          the vDSO, without entering the kernel.
+ * ------------------------------------------------------------------------------------*/
+int32 OS_GetMonotonicTimeNs(uint64 *nsecs)
+{
+    if (nsecs == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
 
-   time_struct -> seconds = time.tv_sec;
-   time_struct -> microsecs = time.tv_nsec / 1000;
+    *nsecs = OS_MonotonicNow();
 
     return OS_SUCCESS;
 
-#endif
+}/* end OS_GetMonotonicTimeNs */
+
+/*---------------------------------------------------------------------------------------
+ * Name: OS_GetRealTimeNs
+ * 
+ * Purpose: Gets the local time of OS_GetLocalTime in nanoseconds since the epoch
+ * ------------------------------------------------------------------------------------*/
+int32 OS_GetRealTimeNs(uint64 *nsecs)
+{
+    struct timespec now;
 
+    if (nsecs == NULL)
+    {
+       return OS_INVALID_POINTER;
+    }
 
-}/* end OS_GetLocalTime */
+    if (clock_gettime(CLOCK_REALTIME, &now) != 0)
+    {
+       return OS_ERROR;
+    }
+
+    *nsecs = OS_TimespecToNs(&now);
+
+    return OS_SUCCESS;
+
+}/* end OS_GetRealTimeNs */
 
 
 /*---------------------------------------------------------------------------------------
@@ -3634,71 +7157,13 @@ int32 OS_GetMask ( uint32 * MaskSettingPtr )
 /*--------------------------------------------------------------------------------------
  * uint32 FindCreator
  * purpose: Finds the creator of the calling thread
+ * returns: the task id of the calling thread, or 0 if it is not an OSAL task
 ---------------------------------------------------------------------------------------*/
 uint32 OS_FindCreator(void)
 {
-    pthread_t    pthread_id;
-    uint32 i;  
-   
-    pthread_id = pthread_self();
-    /* 
-    ** Get PTHREAD Id
-    */
-    for (i = 0; i < OS_MAX_TASKS; i++)
-    {
-        if (pthread_equal(pthread_id, OS_task_table[i].id) != 0 )
-        {
-            break;
-        }
-    }
-
-    return i;
+    return OS_task_self_id;
 }
 
-/*---------------------------------------------------------------------------------------
-** Name: OS_CompAbsDelayTime
-**
-** Purpose:
-** This function accept time interval, msecs, as an input and 
-** computes the absolute time at which this time interval will expire. 
-** The absolute time is programmed into a struct.
-**
-** Assumptions and Notes:
-**
-** Parameters:
-**
-** Global Inputs: None
-**
-** Global Outputs: None
-**
-**
-** Return Values: OS_SUCCESS, 
----------------------------------------------------------------------------------------*/
-uint32  OS_CompAbsDelayTime( uint32 msecs, struct timespec * tm)
-{
-#ifdef _MAC_OS_
-    struct timeval tv;
-
-    gettimeofday(&tv, NULL);
-    tm->tv_sec = tv.tv_sec;
-    tm->tv_nsec = tv.tv_usec * 1000;
-#else
-    clock_gettime( CLOCK_REALTIME,  tm ); 
-#endif
-
-    /* add the delay to the current time */
-    tm->tv_sec  += (time_t) (msecs / 1000) ;
-    /* convert residue ( msecs )  to nanoseconds */
-    tm->tv_nsec +=  (msecs % 1000) * 1000000L ;
-    
-    if(tm->tv_nsec  >= 1000000000L )
-    {
-        tm->tv_nsec -= 1000000000L ;
-        tm->tv_sec ++ ;
-    }
-    
-    return(OS_SUCCESS) ;    
-}
 /* ---------------------------------------------------------------------------
  * Name: OS_printf 
  * 
@@ -3772,6 +7237,20 @@ int32 OS_GetErrorName(int32 error_num, os_err_name_t * err_name)
             strcpy(local_name,"OS_ERR_SEM_NOT_FULL"); break;
         case OS_ERR_INVALID_PRIORITY:
             strcpy(local_name,"OS_ERR_INVALID_PRIORITY"); break;
+        case OS_QUEUE_INVALID_DEPTH:
+            strcpy(local_name,"OS_QUEUE_INVALID_DEPTH"); break;
+        case OS_QUEUE_NO_BUFFERS:
+            strcpy(local_name,"OS_QUEUE_NO_BUFFERS"); break;
+        case OS_SEM_INVALID_OPTIONS:
+            strcpy(local_name,"OS_SEM_INVALID_OPTIONS"); break;
+        case OS_TASK_INVALID_AFFINITY:
+            strcpy(local_name,"OS_TASK_INVALID_AFFINITY"); break;
+        case OS_TASK_INVALID_PERIOD:
+            strcpy(local_name,"OS_TASK_INVALID_PERIOD"); break;
+        case OS_TASK_PERIOD_OVERRUN:
+            strcpy(local_name,"OS_TASK_PERIOD_OVERRUN"); break;
+        case OS_ERR_INVALID_TIMEOUT:
+            strcpy(local_name,"OS_ERR_INVALID_TIMEOUT"); break;
 
         default: strcpy(local_name,"ERROR_UNKNOWN");
                  return_code = OS_ERROR;
@@ -0,0 +1,633 @@
+/*
+** File   : osevent.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the OSAL Event Flags API for POSIX systems.
+**
+**          The flags of a group live in one futex word. Bit 31 of the word is
+**          set by tasks before they block on it, so a set that finds it clear
+**          wakes nobody and is a single atomic OR. A set that finds it set
+**          clears it and wakes every blocked task, and the tasks whose wait is
+**          not met yet set it again and go back to sleep.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+
+/****************************************************************************************
+                                EXTERNAL FUNCTION PROTOTYPES
+****************************************************************************************/
+
+uint32 OS_FindCreator(void);
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#define OS_EVENT_WAITERS  0x80000000U
+
+#define UNINITIALIZED 0
+
+/****************************************************************************************
+                                    LOCAL TYPEDEFS
+****************************************************************************************/
+
+/*
+** word holds the flags and OS_EVENT_WAITERS. waiters counts the tasks in
+** OS_EventFlagsWait that blocked, so OS_EventFlagsDelete can wait them out.
+** It sleeps on waiters, and the last task to leave a destroyed group wakes it.
+** A task with a stale ID may still be counted when the slot is created again,
+** so only OS_EventFlagsAPIInit zeroes waiters.
+** wait is the source for the tasks in OS_WaitMultiple.
+*/
+typedef struct
+{
+   uint32              free;
+   char                name[OS_MAX_API_NAME];
+   uint32              creator;
+   volatile OS_futex_t word;
+   volatile OS_futex_t waiters;
+   volatile OS_futex_t destroyed;
+   volatile uint32     waits;
+   volatile uint32     blocked;
+   volatile uint32     timeouts;
+   volatile uint32     wakeups;
+   OS_wait_source_t    wait;
+
+} OS_event_flags_record_t;
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+OS_event_flags_record_t OS_event_flags_table[OS_MAX_EVENT_FLAGS];
+
+/*
+** The Mutex for protecting the above table
+*/
+pthread_mutex_t    OS_event_flags_table_mut;
+
+/*
+** The registry that hands out event flag table slots and indexes the names
+*/
+static OS_registry_t OS_event_flags_registry;
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsMet
+
+   Purpose: Returns TRUE if the flags in word satisfy a wait for flags
+---------------------------------------------------------------------------------------*/
+static int OS_EventFlagsMet (OS_futex_t word, uint32 flags, uint32 options)
+{
+   if ( options & OS_EVENT_WAIT_ALL )
+   {
+      return((word & flags) == flags);
+   }
+
+   return((word & flags) != 0);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsBadWait
+
+   Purpose: Returns TRUE if flags and options are not valid for a wait
+---------------------------------------------------------------------------------------*/
+static int OS_EventFlagsBadWait (uint32 flags, uint32 options)
+{
+   return(flags == 0 || (flags & ~OS_EVENT_FLAGS_ALL) != 0 ||
+          (options & ~(OS_EVENT_WAIT_ALL | OS_EVENT_WAIT_CLEAR)) != 0);
+}
+
+/****************************************************************************************
+                                INITIALIZATION FUNCTION
+****************************************************************************************/
+int32 OS_EventFlagsAPIInit (void)
+{
+   int i;
+
+   for ( i = 0; i < OS_MAX_EVENT_FLAGS; i++ )
+   {
+      OS_event_flags_table[i].free    = TRUE;
+      OS_event_flags_table[i].creator = UNINITIALIZED;
+      OS_event_flags_table[i].waiters = 0;
+      strcpy(OS_event_flags_table[i].name, "");
+      OS_WaitSourceInit(&OS_event_flags_table[i].wait);
+   }
+
+   if ( OS_RegistryInit(&OS_event_flags_registry, OS_OBJECT_TYPE_EVENTFLAGS,
+                        OS_MAX_EVENT_FLAGS, OS_MAX_API_NAME) != OS_SUCCESS )
+   {
+      OS_printf("OS_EventFlagsAPIInit: Error allocating the event flags registry\n");
+      return(OS_ERROR);
+   }
+
+   if ( pthread_mutex_init(&OS_event_flags_table_mut, NULL) != 0 )
+   {
+      OS_printf("OS_EventFlagsAPIInit: Error creating the event flags table mutex\n");
+      return(OS_ERROR);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/****************************************************************************************
+                                   EVENT FLAGS API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsCreate
+
+   Purpose: Creates an event flag group with initial_flags set
+
+   Returns: OS_INVALID_POINTER if flags_id or flags_name are NULL
+            OS_ERR_NAME_TOO_LONG if the name given is too long
+            OS_ERR_NO_FREE_IDS if all of the event flag ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of an event flag group
+            OS_ERROR if initial_flags has a bit outside OS_EVENT_FLAGS_ALL
+            OS_SUCCESS if success
+
+   Notes: options is an unused parameter
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsCreate (uint32 *flags_id, const char *flags_name, uint32 initial_flags,
+                           uint32 options)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   possible_id;
+   int32                    status;
+
+   if ( flags_id == NULL || flags_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(flags_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   if ( (initial_flags & ~OS_EVENT_FLAGS_ALL) != 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   pthread_mutex_lock(&OS_event_flags_table_mut);
+
+   status = OS_RegistryAlloc(&OS_event_flags_registry, flags_name, &possible_id);
+   if ( status != OS_SUCCESS )
+   {
+      pthread_mutex_unlock(&OS_event_flags_table_mut);
+      return(status);
+   }
+
+   rec = &OS_event_flags_table[possible_id];
+
+   rec->free      = FALSE;
+   rec->destroyed = FALSE;
+   rec->waits     = 0;
+   rec->blocked   = 0;
+   rec->timeouts  = 0;
+   rec->wakeups   = 0;
+   OS_AtomicStore(&rec->word, (OS_futex_t) initial_flags);
+
+   strcpy(rec->name, flags_name);
+   rec->creator = OS_FindCreator();
+
+   OS_RegistryPublish(&OS_event_flags_registry, possible_id);
+   *flags_id = OS_RegistryGetId(&OS_event_flags_registry, possible_id);
+
+   pthread_mutex_unlock(&OS_event_flags_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsCreate */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsDelete
+
+   Purpose: Deletes an event flag group. Tasks still waiting on it return
+            OS_ERROR.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsDelete (uint32 flags_id)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   local_id;
+   OS_futex_t               waiters;
+
+   if ( OS_RegistryRetire(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_event_flags_table[local_id];
+
+   /*
+   ** Clearing the waiters bit makes a task that is about to block return at
+   ** once, the wake releases the ones already blocked. A task that sets the
+   ** bit again afterwards sees destroyed before it sleeps.
+   */
+   OS_AtomicStore(&rec->destroyed, TRUE);
+   OS_AtomicAnd(&rec->word, ~OS_EVENT_WAITERS);
+   OS_FutexWake(&rec->word, INT_MAX);
+
+   while ( (waiters = OS_AtomicLoad(&rec->waiters)) != 0 )
+   {
+      OS_FutexWait(&rec->waiters, waiters, NULL);
+   }
+   OS_WaitNotify(&rec->wait);
+
+   pthread_mutex_lock(&OS_event_flags_table_mut);
+
+   rec->free = TRUE;
+   OS_RegistryFree(&OS_event_flags_registry, local_id);
+   strcpy(rec->name, "");
+   rec->creator = UNINITIALIZED;
+
+   pthread_mutex_unlock(&OS_event_flags_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsSet
+
+   Purpose: Sets flags in the group and wakes the tasks waiting on it. Flags that
+            are already set stay set.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_ERROR if flags has a bit outside OS_EVENT_FLAGS_ALL
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsSet (uint32 flags_id, uint32 flags)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   local_id;
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( (flags & ~OS_EVENT_FLAGS_ALL) != 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   rec = &OS_event_flags_table[local_id];
+
+   if ( OS_AtomicOr(&rec->word, (OS_futex_t) flags) & OS_EVENT_WAITERS )
+   {
+      OS_AtomicAnd(&rec->word, ~OS_EVENT_WAITERS);
+      OS_FutexWake(&rec->word, INT_MAX);
+      OS_AtomicAdd(&rec->wakeups, 1);
+   }
+   OS_WaitNotify(&rec->wait);
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsSet */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsClear
+
+   Purpose: Clears flags in the group
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_ERROR if flags has a bit outside OS_EVENT_FLAGS_ALL
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsClear (uint32 flags_id, uint32 flags)
+{
+   uint32 local_id;
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( (flags & ~OS_EVENT_FLAGS_ALL) != 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   /* Clearing flags never meets a wait, so nobody is woken */
+   OS_AtomicAnd(&OS_event_flags_table[local_id].word, ~((OS_futex_t) flags));
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsClear */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsGet
+
+   Purpose: Passes back the flags that are set in the group
+
+   Returns: OS_INVALID_POINTER if flags is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsGet (uint32 flags_id, uint32 *flags)
+{
+   uint32 local_id;
+
+   if ( flags == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   *flags = OS_AtomicLoad(&OS_event_flags_table[local_id].word) & OS_EVENT_FLAGS_ALL;
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsGet */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsWait
+
+   Purpose: Waits until the flags of the group meet the wait. options is
+            OS_EVENT_WAIT_ANY or OS_EVENT_WAIT_ALL, and may add
+            OS_EVENT_WAIT_CLEAR. timeout is OS_PEND to wait forever, OS_CHECK to
+            only look, or a time in milliseconds. When flags_seen is not NULL it
+            gets all of the flags that were set when the wait was met, before
+            any were cleared.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid event flag group,
+            or the group was deleted before the task blocked
+            OS_ERROR if flags is 0 or has a bit outside OS_EVENT_FLAGS_ALL, options
+            is not valid, or the group was deleted during the wait
+            OS_ERR_INVALID_TIMEOUT if timeout is negative and not OS_CHECK
+            OS_ERROR_TIMEOUT if the wait was not met in time
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsWait (uint32 flags_id, uint32 flags, uint32 options, int32 timeout,
+                         uint32 *flags_seen)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   local_id;
+   OS_futex_t               word;
+   struct timespec          deadline;
+   int                      counted = FALSE;
+   int                      timed_out = FALSE;
+   int32                    status;
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( OS_EventFlagsBadWait(flags, options) )
+   {
+      return(OS_ERROR);
+   }
+
+   if ( timeout < 0 && timeout != OS_CHECK )
+   {
+      return(OS_ERR_INVALID_TIMEOUT);
+   }
+
+   rec = &OS_event_flags_table[local_id];
+   OS_AtomicAdd(&rec->waits, 1);
+
+   if ( timeout > 0 )
+   {
+      OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+   }
+
+   word = OS_AtomicLoad(&rec->word);
+   for ( ;; )
+   {
+      /* Checked after counting in waiters, so a delete either sees this task or is seen */
+      if ( OS_AtomicLoad(&rec->destroyed) )
+      {
+         status = OS_ERROR;
+         break;
+      }
+
+      if ( OS_EventFlagsMet(word, flags, options) )
+      {
+         if ( (options & OS_EVENT_WAIT_CLEAR) &&
+              !OS_AtomicCas(&rec->word, &word, word & ~((OS_futex_t) flags)) )
+         {
+            continue;
+         }
+
+         if ( flags_seen != NULL )
+         {
+            *flags_seen = word & OS_EVENT_FLAGS_ALL;
+         }
+         status = OS_SUCCESS;
+         break;
+      }
+
+      if ( timeout == OS_CHECK || timed_out )
+      {
+         OS_AtomicAdd(&rec->timeouts, 1);
+         status = OS_ERROR_TIMEOUT;
+         break;
+      }
+
+      if ( !counted )
+      {
+         OS_AtomicAdd(&rec->waiters, 1);
+         counted = TRUE;
+
+         /*
+         ** A delete that read waiters before the count went up does not wait
+         ** for this task, and the slot may already hold a new group, so check
+         ** the ID again now that it is counted
+         */
+         if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+         {
+            status = OS_ERR_INVALID_ID;
+            break;
+         }
+
+         OS_AtomicAdd(&rec->blocked, 1);
+         continue;
+      }
+
+      /*
+      ** Mark the word before sleeping, so the next set wakes this task, and
+      ** look at destroyed again in case a delete cleared the mark just before
+      */
+      if ( !(word & OS_EVENT_WAITERS) )
+      {
+         if ( OS_AtomicCas(&rec->word, &word, word | OS_EVENT_WAITERS) )
+         {
+            word |= OS_EVENT_WAITERS;
+         }
+         continue;
+      }
+
+      if ( OS_FutexWait(&rec->word, word, timeout == OS_PEND ? NULL : &deadline)
+           == OS_ERROR_TIMEOUT )
+      {
+         /* Look at the flags one last time before giving up */
+         timed_out = TRUE;
+      }
+
+      word = OS_AtomicLoad(&rec->word);
+   }
+
+   /* the last task to leave a deleted group releases OS_EventFlagsDelete */
+   if ( counted && OS_AtomicSub(&rec->waiters, 1) == 0 && OS_AtomicLoad(&rec->destroyed) )
+   {
+      OS_FutexWake(&rec->waiters, 1);
+   }
+
+   return(status);
+
+}/* end OS_EventFlagsWait */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsGetIdByName
+
+   Purpose: This function tries to find an event flag group Id given its name
+
+   Returns: OS_INVALID_POINTER if flags_id or flags_name are NULL
+            OS_ERR_NAME_TOO_LONG if the name to found is too long to begin with
+            OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsGetIdByName (uint32 *flags_id, const char *flags_name)
+{
+   int32 status;
+
+   if ( flags_id == NULL || flags_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(flags_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   pthread_mutex_lock(&OS_event_flags_table_mut);
+   status = OS_RegistryFindId(&OS_event_flags_registry, flags_name, flags_id);
+   pthread_mutex_unlock(&OS_event_flags_table_mut);
+
+   return(status);
+
+}/* end OS_EventFlagsGetIdByName */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsGetInfo
+
+   Purpose: This function will pass back a structure that contains the name,
+            creator, flags and wait statistics of the specified group.
+
+   Returns: OS_INVALID_POINTER if flags_prop is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsGetInfo (uint32 flags_id, OS_event_flags_prop_t *flags_prop)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   local_id;
+
+   if ( flags_prop == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, flags_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_event_flags_table[local_id];
+
+   pthread_mutex_lock(&OS_event_flags_table_mut);
+
+   strcpy(flags_prop->name, rec->name);
+   flags_prop->creator  = rec->creator;
+   flags_prop->flags    = OS_AtomicLoad(&rec->word) & OS_EVENT_FLAGS_ALL;
+   flags_prop->waiters  = OS_AtomicLoadRelaxed(&rec->waiters);
+   flags_prop->waits    = OS_AtomicLoadRelaxed(&rec->waits);
+   flags_prop->blocked  = OS_AtomicLoadRelaxed(&rec->blocked);
+   flags_prop->timeouts = OS_AtomicLoadRelaxed(&rec->timeouts);
+   flags_prop->wakeups  = OS_AtomicLoadRelaxed(&rec->wakeups);
+
+   pthread_mutex_unlock(&OS_event_flags_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsGetInfo */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_EventFlagsWaitPoll
+
+   Purpose: Checks the flags of a group for OS_WaitMultiple, taking them as
+            OS_EventFlagsWait does with OS_CHECK. The flags seen go to the result
+            of the wait object. The wait statistics of the group are not counted.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid event flag group
+            OS_ERROR if the flags or options of the wait object are not valid
+            OS_ERROR_TIMEOUT if the wait is not met
+            OS_SUCCESS if the wait is met
+---------------------------------------------------------------------------------------*/
+int32 OS_EventFlagsWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
+{
+   OS_event_flags_record_t *rec;
+   uint32                   local_id;
+   OS_futex_t               word;
+
+   if ( OS_RegistryCheckId(&OS_event_flags_registry, object->object_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec     = &OS_event_flags_table[local_id];
+   *source = &rec->wait;
+
+   if ( OS_EventFlagsBadWait(object->flags, object->options) )
+   {
+      return(OS_ERROR);
+   }
+
+   word = OS_AtomicLoad(&rec->word);
+   do
+   {
+      if ( !OS_EventFlagsMet(word, object->flags, object->options) )
+      {
+         return(OS_ERROR_TIMEOUT);
+      }
+   } while ( (object->options & OS_EVENT_WAIT_CLEAR) &&
+             !OS_AtomicCas(&rec->word, &word, word & ~((OS_futex_t) object->flags)) );
+
+   object->result = word & OS_EVENT_FLAGS_ALL;
+
+   return(OS_SUCCESS);
+
+}/* end OS_EventFlagsWaitPoll */
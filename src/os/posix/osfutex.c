@@ -0,0 +1,321 @@
+/*
+** File   : osfutex.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the low level wait/wake primitive used by the
+**          POSIX OSAL objects that are synchronized with atomics.
+**
+**          On Linux this is the futex system call. Other POSIX hosts get an
+**          equivalent built from a small hashed table of mutex/condition
+**          variable pairs, so the objects built on top of it stay portable.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+
+#ifdef _LINUX_OS_
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#ifndef _LINUX_OS_
+/*
+** Number of wait buckets used by the non-Linux futex emulation.
+** Must be a power of two.
+*/
+#define OS_FUTEX_BUCKETS 64
+#endif
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+#ifndef _LINUX_OS_
+typedef struct
+{
+   pthread_mutex_t mut;
+   pthread_cond_t  cond;
+} OS_futex_bucket_t;
+
+static OS_futex_bucket_t OS_futex_bucket_table[OS_FUTEX_BUCKETS];
+static pthread_once_t    OS_futex_once = PTHREAD_ONCE_INIT;
+#endif
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+#ifndef _LINUX_OS_
+static void OS_FutexBucketInit(void)
+{
+   int i;
+
+   for ( i = 0; i < OS_FUTEX_BUCKETS; i++ )
+   {
+      pthread_mutex_init(&OS_futex_bucket_table[i].mut, NULL);
+      pthread_cond_init(&OS_futex_bucket_table[i].cond, NULL);
+   }
+}
+
+static OS_futex_bucket_t *OS_FutexBucket(volatile OS_futex_t *addr)
+{
+   unsigned long hash;
+
+   pthread_once(&OS_futex_once, OS_FutexBucketInit);
+
+   hash = ((unsigned long)addr) >> 2;
+   hash ^= hash >> 7;
+
+   return(&OS_futex_bucket_table[hash & (OS_FUTEX_BUCKETS - 1)]);
+}
+#endif
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_CompMonotonicDeadline
+
+   Purpose: Computes the absolute CLOCK_MONOTONIC time at which a delay of msecs
+            milliseconds from now expires.
+---------------------------------------------------------------------------------------*/
+void OS_CompMonotonicDeadline(uint32 msecs, struct timespec *deadline)
+{
+   clock_gettime(CLOCK_MONOTONIC, deadline);
+
+   deadline->tv_sec  += (time_t) (msecs / 1000);
+   deadline->tv_nsec += (msecs % 1000) * 1000000L;
+
+   if ( deadline->tv_nsec >= 1000000000L )
+   {
+      deadline->tv_nsec -= 1000000000L;
+      deadline->tv_sec ++;
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_CompMonotonicRemaining
+
+   Purpose: Computes the time left until an absolute CLOCK_MONOTONIC deadline. Waits
+            that can only be given a relative timeout call this again after every
+            interruption, so they never wait longer than the original timeout.
+
+   Returns: OS_ERROR_TIMEOUT if the deadline has passed
+            OS_SUCCESS otherwise, with the time left in *remaining
+---------------------------------------------------------------------------------------*/
+int32 OS_CompMonotonicRemaining(const struct timespec *deadline, struct timespec *remaining)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   remaining->tv_sec  = deadline->tv_sec - now.tv_sec;
+   remaining->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+   if ( remaining->tv_nsec < 0 )
+   {
+      remaining->tv_nsec += 1000000000L;
+      remaining->tv_sec--;
+   }
+
+   if ( remaining->tv_sec < 0 || ( remaining->tv_sec == 0 && remaining->tv_nsec == 0 ) )
+   {
+      return(OS_ERROR_TIMEOUT);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_MonotonicNow
+
+   Purpose: Returns the CLOCK_MONOTONIC time in nanoseconds
+---------------------------------------------------------------------------------------*/
+uint64 OS_MonotonicNow(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return(OS_TimespecToNs(&now));
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_TimespecToNs
+
+   Purpose: Returns a time in nanoseconds
+---------------------------------------------------------------------------------------*/
+uint64 OS_TimespecToNs(const struct timespec *time)
+{
+   return((uint64) time->tv_sec * 1000000000ULL + (uint64) time->tv_nsec);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SleepUntil
+
+   Purpose: Sleeps until an absolute CLOCK_MONOTONIC time. A sleep interrupted by a
+            signal goes back to sleep until the same time, so it never ends early
+            and a loop of sleeps to evenly spaced times does not drift.
+
+   Returns: OS_ERROR if the sleep failed
+            OS_SUCCESS otherwise, also when the time has already passed
+---------------------------------------------------------------------------------------*/
+int32 OS_SleepUntil(const struct timespec *deadline)
+{
+#ifdef _MAC_OS_
+   struct timespec remaining;
+
+   /* there is no clock_nanosleep, sleep for the time left until it runs out */
+   while ( OS_CompMonotonicRemaining(deadline, &remaining) == OS_SUCCESS )
+   {
+      if ( nanosleep(&remaining, NULL) != 0 && errno != EINTR )
+      {
+         return(OS_ERROR);
+      }
+   }
+#else
+   int ret;
+
+   do
+   {
+      ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, deadline, NULL);
+   } while ( ret == EINTR );
+
+   if ( ret != 0 )
+   {
+      return(OS_ERROR);
+   }
+#endif
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_FutexWait
+
+   Purpose: Blocks the caller while *addr still holds expected.
+
+   Returns: OS_ERROR_TIMEOUT if the deadline passed
+            OS_SUCCESS otherwise ( woken, value changed or interrupted )
+---------------------------------------------------------------------------------------*/
+int32 OS_FutexWait(volatile OS_futex_t *addr, OS_futex_t expected, const struct timespec *deadline)
+{
+#ifdef _LINUX_OS_
+   int ret;
+
+   /*
+   ** FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout, so a wait
+   ** that is restarted after a signal keeps its original deadline.
+   */
+   ret = syscall(SYS_futex, addr, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+                 expected, deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+   if ( ret == -1 && errno == ETIMEDOUT )
+   {
+      return(OS_ERROR_TIMEOUT);
+   }
+
+   return(OS_SUCCESS);
+#else
+   OS_futex_bucket_t *bucket;
+   struct timespec    now;
+   struct timespec    abs_time;
+   struct timeval     tv;
+   long               remain_sec;
+   long               remain_nsec;
+   int                ret = 0;
+
+   bucket = OS_FutexBucket(addr);
+
+   if ( deadline != NULL )
+   {
+      /*
+      ** Condition variables here wait on the realtime clock, so the
+      ** remaining monotonic time is re-based onto it.
+      */
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      remain_sec  = deadline->tv_sec - now.tv_sec;
+      remain_nsec = deadline->tv_nsec - now.tv_nsec;
+      if ( remain_nsec < 0 )
+      {
+         remain_nsec += 1000000000L;
+         remain_sec--;
+      }
+      if ( remain_sec < 0 )
+      {
+         return(OS_ERROR_TIMEOUT);
+      }
+
+      gettimeofday(&tv, NULL);
+      abs_time.tv_sec  = tv.tv_sec + remain_sec;
+      abs_time.tv_nsec = (tv.tv_usec * 1000) + remain_nsec;
+      if ( abs_time.tv_nsec >= 1000000000L )
+      {
+         abs_time.tv_nsec -= 1000000000L;
+         abs_time.tv_sec++;
+      }
+   }
+
+   pthread_mutex_lock(&bucket->mut);
+   if ( *addr == expected )
+   {
+      if ( deadline == NULL )
+      {
+         ret = pthread_cond_wait(&bucket->cond, &bucket->mut);
+      }
+      else
+      {
+         ret = pthread_cond_timedwait(&bucket->cond, &bucket->mut, &abs_time);
+      }
+   }
+   pthread_mutex_unlock(&bucket->mut);
+
+   if ( ret == ETIMEDOUT )
+   {
+      return(OS_ERROR_TIMEOUT);
+   }
+
+   return(OS_SUCCESS);
+#endif
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_FutexWake
+
+   Purpose: Wakes up to count tasks blocked in OS_FutexWait on addr.
+---------------------------------------------------------------------------------------*/
+void OS_FutexWake(volatile OS_futex_t *addr, int count)
+{
+#ifdef _LINUX_OS_
+   syscall(SYS_futex, addr, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, NULL, NULL, 0);
+#else
+   OS_futex_bucket_t *bucket;
+
+   /*
+   ** The bucket may be shared with other addresses, so everybody is woken
+   ** and the waiters sort it out by re-checking their condition.
+   */
+   bucket = OS_FutexBucket(addr);
+   pthread_mutex_lock(&bucket->mut);
+   pthread_cond_broadcast(&bucket->cond);
+   pthread_mutex_unlock(&bucket->mut);
+#endif
+}
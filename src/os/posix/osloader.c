@@ -24,6 +24,7 @@
 
 #include "common_types.h"
 #include "osapi.h"
+#include "osprivate.h"
 
 #include <stdio.h>
 #include <unistd.h> /* close() */
@@ -57,6 +58,11 @@ OS_module_record_t OS_module_table[OS_MAX_MODULES];
 */
 pthread_mutex_t    OS_module_table_mut;
 
+/*
+** The registry that hands out module table slots and indexes the module names
+*/
+static OS_registry_t OS_module_registry;
+
 /****************************************************************************************
                                 INITIALIZATION FUNCTION
 ****************************************************************************************/
@@ -78,6 +84,12 @@ int32  OS_ModuleTableInit ( void )
       strcpy(OS_module_table[i].filename,"");
    }
 
+   if ( OS_RegistryInit(&OS_module_registry, OS_OBJECT_TYPE_MODULE,
+                        OS_MAX_MODULES, OS_MAX_API_NAME) != OS_SUCCESS )
+   {
+      return(OS_ERROR);
+   }
+
    /*
    ** Create the Module Table mutex
    */
@@ -173,7 +185,6 @@ int32 OS_SymbolTableDump ( char *filename, uint32 SizeLimit )
 ---------------------------------------------------------------------------------------*/
 int32 OS_ModuleLoad ( uint32 *module_id, char *module_name, char *filename )
 {
-   int         i;
    uint32      possible_moduleid;
    char        translated_path[OS_MAX_LOCAL_PATH_LEN];
    int32       return_code;
@@ -192,36 +203,13 @@ int32 OS_ModuleLoad ( uint32 *module_id, char *module_name, char *filename )
    pthread_mutex_lock(&OS_module_table_mut); 
 
    /*
-   ** Find a free module id
+   ** Find a free module id, this fails if the name is already loaded
    */
-   for( possible_moduleid = 0; possible_moduleid < OS_MAX_MODULES; possible_moduleid++)
-   {
-       if (OS_module_table[possible_moduleid].free == TRUE)
-       {
-           break;
-       }
-   }
-
-   /* 
-   ** Check to see if the id is out of bounds 
-   */
-   if( possible_moduleid >= OS_MAX_MODULES || OS_module_table[possible_moduleid].free != TRUE)
+   return_code = OS_RegistryAlloc(&OS_module_registry, module_name, &possible_moduleid);
+   if (return_code != OS_SUCCESS)
    {
        pthread_mutex_unlock(&OS_module_table_mut);
-       return OS_ERR_NO_FREE_IDS;
-   }
-
-   /* 
-   ** Check to see if the module file is already loaded 
-   */
-   for (i = 0; i < OS_MAX_MODULES; i++)
-   {
-       if ((OS_module_table[i].free == FALSE) &&
-          ( strcmp((char*) module_name, OS_module_table[i].name) == 0)) 
-       {       
-           pthread_mutex_unlock(&OS_module_table_mut);
-           return OS_ERR_NAME_TAKEN;
-       }
+       return return_code;
    }
 
    /* 
@@ -237,6 +225,10 @@ int32 OS_ModuleLoad ( uint32 *module_id, char *module_name, char *filename )
    return_code = OS_TranslatePath((const char *)filename, (char *)translated_path); 
    if ( return_code != OS_SUCCESS )
    {
+      pthread_mutex_lock(&OS_module_table_mut); 
+      OS_module_table[possible_moduleid].free = TRUE;
+      OS_RegistryFree(&OS_module_registry, possible_moduleid);
+      pthread_mutex_unlock(&OS_module_table_mut);
       return(return_code);
    }
    /*
@@ -251,7 +243,10 @@ int32 OS_ModuleLoad ( uint32 *module_id, char *module_name, char *filename )
    if( dl_error )
    {
       OS_printf("OSAL: Error, cannot open application file: %s\n",dl_error);
+      pthread_mutex_lock(&OS_module_table_mut); 
       OS_module_table[possible_moduleid].free = TRUE;
+      OS_RegistryFree(&OS_module_registry, possible_moduleid);
+      pthread_mutex_unlock(&OS_module_table_mut);
       return(OS_ERROR);
    }
 
@@ -297,7 +292,7 @@ int32 OS_ModuleUnload ( uint32 module_id )
    /*
    ** Check the module_id
    */
-   if ( OS_module_table[module_id].free == TRUE )
+   if ( module_id >= OS_MAX_MODULES || OS_module_table[module_id].free == TRUE )
    {
       return(OS_ERR_INVALID_ID);
    }
@@ -307,13 +302,17 @@ int32 OS_ModuleUnload ( uint32 module_id )
    */ 
    ReturnCode = dlclose((void *)OS_module_table[module_id].host_module_id);
    dlError = dlerror();
+
+   pthread_mutex_lock(&OS_module_table_mut); 
+   OS_module_table[module_id].free = TRUE;
+   OS_RegistryFree(&OS_module_registry, module_id);
+   pthread_mutex_unlock(&OS_module_table_mut);
+
    if( dlError )
    {
       OS_printf("OSAL Error, Cannot Unload module: %s\n",dlError);
-      OS_module_table[module_id].free = TRUE;  
       return(OS_ERROR);
    }
-   OS_module_table[module_id].free = TRUE;
  
    return(OS_SUCCESS);
    
@@ -0,0 +1,287 @@
+/*
+** File   : oslockstats.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the bookkeeping behind the lock statistics of the
+**          OSAL mutexes and semaphores.
+**
+**          Every counter is updated with an atomic add, so recording takes no
+**          lock and a take that does not have to wait only adds a clock read
+**          and two atomics to its fast path.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include <string.h>
+#include <time.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+/*
+** If OS_INCLUDE_LOCK_STATS is not defined, skip the whole module
+*/
+#ifdef OS_INCLUDE_LOCK_STATS
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+/*
+** Its address identifies the calling thread as the holder of a lock
+*/
+static __thread char OS_lockstats_self;
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsBucket
+
+   Purpose: Returns the histogram bucket of a time in microseconds
+---------------------------------------------------------------------------------------*/
+static uint32 OS_LockStatsBucket (uint64 usecs)
+{
+   uint32 bucket = 0;
+
+   while ( usecs != 0 && bucket < OS_LOCK_STATS_BUCKETS - 1 )
+   {
+      usecs >>= 1;
+      bucket++;
+   }
+
+   return(bucket);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsRecord
+
+   Purpose: Adds a time in nanoseconds to a histogram and raises the maximum if
+            the time is longer
+---------------------------------------------------------------------------------------*/
+static void OS_LockStatsRecord (uint32 *histogram, uint32 *max_usecs, uint64 nsecs)
+{
+   uint64 usecs = nsecs / 1000;
+   uint32 max;
+
+   OS_AtomicAdd(&histogram[OS_LockStatsBucket(usecs)], 1);
+
+   if ( usecs > 0xFFFFFFFFUL )
+   {
+      usecs = 0xFFFFFFFFUL;
+   }
+
+   max = OS_AtomicLoadRelaxed(max_usecs);
+   while ( usecs > max && !OS_AtomicCas(max_usecs, &max, (uint32) usecs) )
+   {
+   }
+}
+
+/****************************************************************************************
+                                   LOCK STATISTICS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsClear
+
+   Purpose: Resets the statistics of a newly created lock
+---------------------------------------------------------------------------------------*/
+void OS_LockStatsClear (OS_lock_stats_rec_t *rec)
+{
+   memset(rec, 0, sizeof(*rec));
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsWaited
+
+   Purpose: Records that the calling task had to wait for the lock, from the
+            OS_MonotonicNow time start until now
+---------------------------------------------------------------------------------------*/
+void OS_LockStatsWaited (OS_lock_stats_rec_t *rec, uint64 start)
+{
+   OS_AtomicAdd(&rec->stats.contended, 1);
+   OS_AtomicStore(&rec->stats.last_waiter, OS_TaskGetId());
+
+   OS_LockStatsRecord(rec->stats.wait_histogram, &rec->stats.max_wait_usecs,
+                      OS_MonotonicNow() - start);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsAcquired
+
+   Purpose: Records that the calling task took the lock. When track_hold is TRUE
+            the task becomes the owner and the hold time starts.
+---------------------------------------------------------------------------------------*/
+void OS_LockStatsAcquired (OS_lock_stats_rec_t *rec, int track_hold)
+{
+   OS_AtomicAdd(&rec->stats.acquisitions, 1);
+
+   if ( track_hold )
+   {
+      rec->holder = &OS_lockstats_self;
+      OS_AtomicStore(&rec->stats.owner, OS_TaskGetId());
+      OS_AtomicStore(&rec->hold_start, OS_MonotonicNow());
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsReleased
+
+   Purpose: Ends the hold time started by OS_LockStatsAcquired. A release with
+            no hold time running, such as a give to a binary semaphore used as a
+            signal, records nothing.
+---------------------------------------------------------------------------------------*/
+void OS_LockStatsReleased (OS_lock_stats_rec_t *rec)
+{
+   uint64 start;
+
+   start = OS_AtomicExchange(&rec->hold_start, 0);
+   if ( start != 0 )
+   {
+      rec->holder = NULL;
+      OS_AtomicStore(&rec->stats.owner, 0);
+      OS_LockStatsRecord(rec->stats.hold_histogram, &rec->stats.max_hold_usecs,
+                         OS_MonotonicNow() - start);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsNest
+
+   Purpose: Checks for a nested take of a recursive mutex by the task that
+            holds it. Such a take is not counted as an acquisition.
+
+   Returns: TRUE if the calling task already holds the lock
+---------------------------------------------------------------------------------------*/
+int OS_LockStatsNest (OS_lock_stats_rec_t *rec)
+{
+   if ( rec->holder != &OS_lockstats_self )
+   {
+      return(FALSE);
+   }
+
+   rec->depth++;
+   return(TRUE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsUnnest
+
+   Purpose: Undoes an OS_LockStatsNest when a nested take is given back
+
+   Returns: TRUE if the give only ends a nested take, so the hold time goes on
+---------------------------------------------------------------------------------------*/
+int OS_LockStatsUnnest (OS_lock_stats_rec_t *rec)
+{
+   if ( rec->holder != &OS_lockstats_self || rec->depth == 0 )
+   {
+      return(FALSE);
+   }
+
+   rec->depth--;
+   return(TRUE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsSemTake
+
+   Purpose: OS_SemTake with statistics. Only a take that finds the semaphore
+            empty is timed as a wait.
+
+   Returns: The status of OS_SemTake
+---------------------------------------------------------------------------------------*/
+int32 OS_LockStatsSemTake (OS_sem_t *sem, OS_lock_stats_rec_t *rec,
+                           const struct timespec *deadline, int track_hold)
+{
+   uint64 start;
+   int32  status;
+
+   if ( OS_SemTryTake(sem) )
+   {
+      OS_LockStatsAcquired(rec, track_hold);
+      return(OS_SUCCESS);
+   }
+
+   start  = OS_MonotonicNow();
+   status = OS_SemTake(sem, deadline);
+   OS_LockStatsWaited(rec, start);
+
+   if ( status == OS_SUCCESS )
+   {
+      OS_LockStatsAcquired(rec, track_hold);
+   }
+
+   return(status);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsRwTake
+
+   Purpose: OS_RwReadLock or OS_RwWriteLock with statistics. Only a take that
+            finds the lock busy is timed as a wait. A reader shares the lock
+            with the other readers, so only writers become its owner and have
+            their hold time kept.
+
+   Returns: The status of OS_RwReadLock or OS_RwWriteLock
+---------------------------------------------------------------------------------------*/
+int32 OS_LockStatsRwTake (OS_rwlock_t *rw, OS_lock_stats_rec_t *rec,
+                          const struct timespec *deadline, int write)
+{
+   uint64 start;
+   int32  status;
+
+   if ( write ? OS_RwTryWrite(rw) : OS_RwTryRead(rw) )
+   {
+      OS_LockStatsAcquired(rec, write);
+      return(OS_SUCCESS);
+   }
+
+   start  = OS_MonotonicNow();
+   status = write ? OS_RwWriteLock(rw, deadline) : OS_RwReadLock(rw, deadline);
+   OS_LockStatsWaited(rec, start);
+
+   if ( status == OS_SUCCESS )
+   {
+      OS_LockStatsAcquired(rec, write);
+   }
+
+   return(status);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LockStatsCopy
+
+   Purpose: Copies the statistics out for the caller. The counters keep
+            changing while they are copied, so fields may be a few counts
+            apart from each other.
+---------------------------------------------------------------------------------------*/
+void OS_LockStatsCopy (OS_lock_stats_rec_t *rec, OS_lock_stats_t *stats)
+{
+   uint32 i;
+
+   stats->acquisitions   = OS_AtomicLoadRelaxed(&rec->stats.acquisitions);
+   stats->contended      = OS_AtomicLoadRelaxed(&rec->stats.contended);
+   stats->owner          = OS_AtomicLoadRelaxed(&rec->stats.owner);
+   stats->last_waiter    = OS_AtomicLoadRelaxed(&rec->stats.last_waiter);
+   stats->max_wait_usecs = OS_AtomicLoadRelaxed(&rec->stats.max_wait_usecs);
+   stats->max_hold_usecs = OS_AtomicLoadRelaxed(&rec->stats.max_hold_usecs);
+
+   for ( i = 0; i < OS_LOCK_STATS_BUCKETS; i++ )
+   {
+      stats->wait_histogram[i] = OS_AtomicLoadRelaxed(&rec->stats.wait_histogram[i]);
+      stats->hold_histogram[i] = OS_AtomicLoadRelaxed(&rec->stats.hold_histogram[i]);
+   }
+}
+
+#endif
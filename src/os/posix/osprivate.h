@@ -0,0 +1,433 @@
+/*
+** File   : osprivate.h
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: Private definitions shared by the POSIX OSAL source files.
+**          Nothing in this file is part of the OSAL API. Applications must
+**          not include it.
+*/
+
+#ifndef _osprivate_
+#define _osprivate_
+
+#include <time.h>
+
+#include "common_types.h"
+#include "osapi.h"
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+/*
+** Size of a cache line on the target. Data that is written by one task and
+** read by another is padded out to this size so two unrelated objects do not
+** share a line. It can be overridden in osconfig.h.
+*/
+#ifndef OS_CACHE_LINE_SIZE
+   #define OS_CACHE_LINE_SIZE 64
+#endif
+
+/*
+** Atomic operations.
+** These map onto the GCC __atomic builtins. Loads acquire, stores release and
+** read-modify-write operations are sequentially consistent, so they can be
+** used on both sides of a "set flag then check the other flag" handshake.
+*/
+#define OS_AtomicLoad(ptr)             __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define OS_AtomicLoadRelaxed(ptr)      __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define OS_AtomicStore(ptr, val)       __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define OS_AtomicAdd(ptr, val)         __atomic_add_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#define OS_AtomicSub(ptr, val)         __atomic_sub_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#define OS_AtomicOr(ptr, val)          __atomic_fetch_or((ptr), (val), __ATOMIC_SEQ_CST)
+#define OS_AtomicAnd(ptr, val)         __atomic_fetch_and((ptr), (val), __ATOMIC_SEQ_CST)
+#define OS_AtomicCas(ptr, expected_ptr, desired) \
+        __atomic_compare_exchange_n((ptr), (expected_ptr), (desired), 0, \
+                                    __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)
+#define OS_AtomicExchange(ptr, val)    __atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define OS_AtomicFence()               __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/*
+** Tells the CPU that the caller is busy waiting, so it can let the other
+** hardware thread run and does not speculate past the loop.
+*/
+#if defined(__i386__) || defined(__x86_64__)
+   #define OS_CpuRelax()               __asm__ __volatile__ ("pause" ::: "memory")
+#elif defined(__arm__) || defined(__aarch64__)
+   #define OS_CpuRelax()               __asm__ __volatile__ ("yield" ::: "memory")
+#else
+   #define OS_CpuRelax()               __asm__ __volatile__ ("" ::: "memory")
+#endif
+
+/*
+** Number of times a lightweight mutex is retried before the task blocks.
+** It can be overridden in osconfig.h, 0 turns the spin off.
+*/
+#ifndef OS_MUTEX_SPIN_COUNT
+   #define OS_MUTEX_SPIN_COUNT 100
+#endif
+
+/****************************************************************************************
+                                    TYPEDEFS
+****************************************************************************************/
+
+/*
+** A futex word. The kernel requires exactly 32 bits, which the OSAL uint32
+** type is not on LP64 hosts.
+*/
+typedef unsigned int OS_futex_t;
+
+/*
+** Object IDs
+** The ID handed out for a task, queue, semaphore or mutex packs the object
+** type, a generation count and the table index of the object:
+**
+**     31    28 27          16 15             0
+**    +--------+--------------+---------------+
+**    |  type  |  generation  |     index     |
+**    +--------+--------------+---------------+
+**
+** The generation of a slot changes every time the slot is reused, so an ID
+** kept after its object was deleted no longer matches. No object type is
+** zero, so zero is never a valid ID.
+**
+** Timer and module IDs are still plain table indexes, because applications
+** use them as array indexes.
+*/
+#define OS_OBJECT_TYPE_SHIFT     28
+#define OS_OBJECT_GEN_SHIFT      16
+#define OS_OBJECT_GEN_MASK       0x0FFF
+#define OS_OBJECT_INDEX_MASK     0xFFFF
+
+#define OS_OBJECT_TYPE_TASK      1
+#define OS_OBJECT_TYPE_QUEUE     2
+#define OS_OBJECT_TYPE_BINSEM    3
+#define OS_OBJECT_TYPE_COUNTSEM  4
+#define OS_OBJECT_TYPE_MUTEX     5
+#define OS_OBJECT_TYPE_TIMER     6
+#define OS_OBJECT_TYPE_MODULE    7
+#define OS_OBJECT_TYPE_WORKPOOL  8
+#define OS_OBJECT_TYPE_EVENTFLAGS 9
+#define OS_OBJECT_TYPE_RWLOCK    10
+#define OS_OBJECT_TYPE_SEQLOCK   11
+#define OS_OBJECT_TYPE_PUBLISH   12
+
+/*
+** Object registry (osregistry.c)
+** Slot allocation, name lookup and IDs for one object table. The arrays are
+** allocated by OS_RegistryInit. free_map[] has a bit set for every free
+** slot, and next[] links a slot in use into its hash bucket chain.
+** active_id[] holds the ID of the object in each slot once it has been
+** published, and zero otherwise.
+*/
+#define OS_REGISTRY_NONE 0xFFFFFFFF
+
+typedef struct
+{
+    uint32          object_type;
+    uint32          max_objects;
+    uint32          name_len;
+    uint32          bucket_mask;
+    uint32          map_words;
+    uint32          free_word;
+    unsigned long  *free_map;
+    uint32         *next;
+    uint32         *bucket;
+    char           *names;
+    uint32         *generation;
+    uint32         *active_id;
+}OS_registry_t;
+
+/*
+** Semaphore (ossem.c)
+** count is the number of tokens held, or OS_SEM_DESTROYED once the semaphore
+** is being destroyed. seq is the futex word blocked tasks sleep on, it
+** changes on every give and flush. flushes counts the OS_SemFlush calls, so
+** a task can tell that it was released by one. wake_time is the
+** OS_MonotonicNow time of the last give or flush that woke a blocked task.
+** waiters counts the blocked tasks and users the API calls that are working
+** with the ID of the semaphore, OS_SemDestroy waits for both to drop to zero.
+** A call with a stale ID may still be counted in them when the semaphore is
+** set up again, so OS_SemInit leaves them alone; they start at zero in the
+** static tables.
+*/
+#define OS_SEM_DESTROYED 0xFFFFFFFFU
+
+typedef struct
+{
+    volatile OS_futex_t count;
+    volatile OS_futex_t seq;
+    volatile OS_futex_t waiters;
+    volatile OS_futex_t users;
+    volatile OS_futex_t flushes;
+    OS_futex_t          max_value;
+    volatile uint64     wake_time;
+}OS_sem_t;
+
+/*
+** Lightweight mutex (ossem.c)
+** state is 0 when unlocked, 1 when locked and 2 when locked with tasks
+** blocked on it. owner identifies the thread holding it.
+*/
+typedef struct
+{
+    volatile OS_futex_t state;
+    void * volatile     owner;
+}OS_lwmutex_t;
+
+/*
+** Reader-writer lock (ossem.c)
+** state is the number of read takes held, OS_RW_WRITER when a writer holds
+** the lock, or OS_RW_DESTROYED once it is being destroyed. Blocked readers
+** sleep on read_seq and blocked writers on write_seq. writer identifies the
+** thread that holds the lock for writing. users counts the API calls working
+** with the ID of the lock. As for OS_sem_t, OS_RwInit leaves the waiter and
+** user counts alone, they start at zero in the static table.
+*/
+#define OS_RW_WRITER     0x80000000U
+#define OS_RW_DESTROYED  0xFFFFFFFFU
+
+typedef struct
+{
+    volatile OS_futex_t state;
+    volatile OS_futex_t read_seq;
+    volatile OS_futex_t write_seq;
+    volatile OS_futex_t read_waiters;
+    volatile OS_futex_t write_waiters;
+    volatile OS_futex_t users;
+    int                 prefer_writer;
+    void * volatile     writer;
+}OS_rwlock_t;
+
+/*
+** Lock statistics (oslockstats.c)
+** hold_start is the OS_MonotonicNow time the current holder took the lock
+** at, or 0 when no hold time is running. holder identifies the thread that
+** holds the lock and depth counts its nested takes of a recursive mutex.
+*/
+typedef struct
+{
+    OS_lock_stats_t     stats;
+    volatile uint64     hold_start;
+    void * volatile     holder;
+    uint32              depth;
+}OS_lock_stats_rec_t;
+
+/*
+** Multiple object wait (oswait.c)
+** Every object that OS_WaitMultiple can wait on has a wait source. A task in
+** OS_WaitMultiple links a node into the source of each of its objects, and
+** the object calls OS_WaitNotify after every event. The node marks its bit in
+** the ready words of its waiter and wakes it, so the waiter only looks again
+** at the objects that had an event. watchers counts the nodes linked, so an
+** event on an object nobody waits on costs one atomic load. Every notify
+** comes from a task, the timers included, so the lock of a source is never
+** taken from a signal handler.
+*/
+typedef struct OS_wait_node_s
+{
+    struct OS_wait_node_s *next;
+    struct OS_wait_node_s *prev;
+    volatile OS_futex_t   *seq;
+    volatile OS_futex_t   *ready;
+    OS_futex_t             bit;
+}OS_wait_node_t;
+
+typedef struct
+{
+    volatile OS_futex_t watchers;
+    OS_lwmutex_t        lock;
+    OS_wait_node_t     *head;
+}OS_wait_source_t;
+
+/****************************************************************************************
+                                 FUNCTION PROTOTYPES
+****************************************************************************************/
+
+/*
+** Futex wait/wake (osfutex.c)
+** OS_FutexWait blocks while *addr == expected. The deadline is an absolute
+** CLOCK_MONOTONIC time, or NULL to wait forever. It returns OS_SUCCESS when
+** woken, when the value already changed, or when interrupted by a signal, and
+** OS_ERROR_TIMEOUT when the deadline passes. Callers always re-check their
+** condition after it returns.
+*/
+int32 OS_FutexWait           (volatile OS_futex_t *addr, OS_futex_t expected,
+                              const struct timespec *deadline);
+void  OS_FutexWake           (volatile OS_futex_t *addr, int count);
+void  OS_CompMonotonicDeadline (uint32 msecs, struct timespec *deadline);
+int32 OS_CompMonotonicRemaining (const struct timespec *deadline,
+                                struct timespec *remaining);
+uint64 OS_MonotonicNow       (void);
+uint64 OS_TimespecToNs       (const struct timespec *time);
+int32 OS_SleepUntil          (const struct timespec *deadline);
+
+/*
+** Task accounting (osapi.c)
+** Records a wakeup latency in the statistics of the calling task. Calls made
+** by a thread that is not an OSAL task are ignored.
+*/
+void  OS_TaskRecordWakeup    (uint64 latency_ns);
+
+/*
+** Task read section epochs (osapi.c), used by ospublish.c
+** A task outside any OS_PublishReadBegin section has 0 in its epoch word.
+** The words of the tasks not in use are 0.
+*/
+#define OS_TASK_EPOCH_SELF     0xFFFFFFFF
+
+volatile OS_futex_t *OS_TaskEpochSlot (uint32 index);
+
+/*
+** Semaphore (ossem.c)
+** None of these take a lock. OS_SemTake returns OS_SUCCESS, OS_SEM_TIMEOUT
+** or OS_SEM_FAILURE, its deadline is an absolute CLOCK_MONOTONIC time or
+** NULL to wait forever.
+*/
+void   OS_SemInit            (OS_sem_t *sem, uint32 value, uint32 max_value);
+void   OS_SemDestroy         (OS_sem_t *sem);
+void   OS_SemEnter           (OS_sem_t *sem);
+void   OS_SemLeave           (OS_sem_t *sem);
+void   OS_SemGive            (OS_sem_t *sem);
+int32  OS_SemTake            (OS_sem_t *sem, const struct timespec *deadline);
+int    OS_SemTryTake         (OS_sem_t *sem);
+void   OS_SemFlush           (OS_sem_t *sem);
+uint32 OS_SemGetValue        (OS_sem_t *sem);
+
+/*
+** Lightweight mutex (ossem.c)
+** OS_LwMutexUnlock returns OS_SEM_FAILURE if the caller does not hold the mutex.
+*/
+void   OS_LwMutexInit        (OS_lwmutex_t *mut);
+void   OS_LwMutexLock        (OS_lwmutex_t *mut);
+int    OS_LwMutexTryLock     (OS_lwmutex_t *mut);
+int32  OS_LwMutexUnlock      (OS_lwmutex_t *mut);
+int    OS_LwMutexIsOwner     (OS_lwmutex_t *mut);
+int    OS_LwMutexIsLocked    (OS_lwmutex_t *mut);
+
+/*
+** Reader-writer lock (ossem.c)
+** OS_RwReadLock and OS_RwWriteLock return OS_SUCCESS, OS_SEM_TIMEOUT or
+** OS_SEM_FAILURE, their deadline is an absolute CLOCK_MONOTONIC time or NULL
+** to wait forever.
+*/
+void   OS_RwInit             (OS_rwlock_t *rw, int prefer_writer);
+int32  OS_RwDestroy          (OS_rwlock_t *rw);
+void   OS_RwEnter            (OS_rwlock_t *rw);
+void   OS_RwLeave            (OS_rwlock_t *rw);
+int    OS_RwTryRead          (OS_rwlock_t *rw);
+int    OS_RwTryWrite         (OS_rwlock_t *rw);
+int32  OS_RwReadLock         (OS_rwlock_t *rw, const struct timespec *deadline);
+int32  OS_RwWriteLock        (OS_rwlock_t *rw, const struct timespec *deadline);
+int32  OS_RwUnlock           (OS_rwlock_t *rw);
+int    OS_RwIsWriter         (OS_rwlock_t *rw);
+uint32 OS_RwGetReaders       (OS_rwlock_t *rw);
+
+/*
+** Lock statistics (oslockstats.c), only built with OS_INCLUDE_LOCK_STATS.
+** Passing FALSE for track_hold counts the take without an owner or hold
+** time, for the counting semaphores that have many holders at once.
+*/
+void   OS_LockStatsClear     (OS_lock_stats_rec_t *rec);
+void   OS_LockStatsWaited    (OS_lock_stats_rec_t *rec, uint64 start);
+void   OS_LockStatsAcquired  (OS_lock_stats_rec_t *rec, int track_hold);
+void   OS_LockStatsReleased  (OS_lock_stats_rec_t *rec);
+int    OS_LockStatsNest      (OS_lock_stats_rec_t *rec);
+int    OS_LockStatsUnnest    (OS_lock_stats_rec_t *rec);
+int32  OS_LockStatsSemTake   (OS_sem_t *sem, OS_lock_stats_rec_t *rec,
+                              const struct timespec *deadline, int track_hold);
+int32  OS_LockStatsRwTake    (OS_rwlock_t *rw, OS_lock_stats_rec_t *rec,
+                              const struct timespec *deadline, int write);
+void   OS_LockStatsCopy      (OS_lock_stats_rec_t *rec, OS_lock_stats_t *stats);
+
+/*
+** Task stacks (osstack.c)
+** OS_StackAlloc returns OS_ERR_NOT_IMPLEMENTED when OS_STACK_ARENA_SIZE is
+** not defined, and the other arena calls do nothing. A block that a thread
+** ran on is given back with OS_StackRelease, one that no thread ran on with
+** OS_StackFree.
+*/
+#define OS_STACK_NO_BLOCK 0xFFFFFFFF
+
+int32  OS_StackArenaInit     (void);
+int32  OS_StackAlloc         (uint32 size, void **base, uint32 *alloc_size, uint32 *block);
+void   OS_StackSetThread     (uint32 block, int tid);
+void   OS_StackRelease       (uint32 block);
+void   OS_StackFree          (uint32 block);
+void   OS_StackPaint         (void *base, uint32 size);
+uint32 OS_StackUsed          (const void *base, uint32 size);
+
+/*
+** Multiple object wait (oswait.c)
+** A source is set up once by OS_API_Init and keeps its nodes across the
+** deletion and creation of the objects in its table slot. An object that is
+** deleted notifies its source, so the tasks waiting on it see the bad ID.
+**
+** Each object type has a poll call that checks its ID, passes back its source
+** and takes one event from it without blocking: a message from a queue into
+** the buffer of the wait object, a token from a semaphore, the flags from an
+** event flag group or the expirations of a timer. It returns OS_SUCCESS when
+** it took one, OS_ERROR_TIMEOUT when there is none, or the error that ends
+** the wait.
+*/
+void   OS_WaitSourceInit     (OS_wait_source_t *source);
+void   OS_WaitNotifySource   (OS_wait_source_t *source);
+
+static inline void OS_WaitNotify (OS_wait_source_t *source)
+{
+    if ( OS_AtomicLoad(&source->watchers) != 0 )
+    {
+        OS_WaitNotifySource(source);
+    }
+}
+
+int32  OS_QueueWaitPoll      (OS_wait_object_t *object, OS_wait_source_t **source);
+int32  OS_BinSemWaitPoll     (OS_wait_object_t *object, OS_wait_source_t **source);
+int32  OS_CountSemWaitPoll   (OS_wait_object_t *object, OS_wait_source_t **source);
+int32  OS_EventFlagsWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source);
+int32  OS_TimerWaitPoll      (OS_wait_object_t *object, OS_wait_source_t **source);
+
+/*
+** Object registry (osregistry.c)
+** All calls except OS_RegistryRetire and OS_RegistryCheckId must be made with
+** the mutex of the owning table held.
+*/
+int32  OS_RegistryInit       (OS_registry_t *reg, uint32 object_type, uint32 max_objects,
+                              uint32 name_len);
+int32  OS_RegistryAlloc      (OS_registry_t *reg, const char *name, uint32 *index);
+void   OS_RegistryFree       (OS_registry_t *reg, uint32 index);
+int32  OS_RegistryFind       (const OS_registry_t *reg, const char *name, uint32 *index);
+int32  OS_RegistryFindId     (const OS_registry_t *reg, const char *name, uint32 *object_id);
+uint32 OS_RegistryGetId      (const OS_registry_t *reg, uint32 index);
+void   OS_RegistryPublish    (OS_registry_t *reg, uint32 index);
+int32  OS_RegistryRetire     (OS_registry_t *reg, uint32 object_id, uint32 *index);
+
+/*
+** Validates an object ID and returns its table index. This is the check made
+** by every call that is handed an ID: one atomic load and a compare, with no
+** lock taken. It fails for an ID of the wrong type, for an object that was
+** deleted or is being deleted, and for an older object in the same slot.
+*/
+static inline int32 OS_RegistryCheckId (const OS_registry_t *reg, uint32 object_id,
+                                        uint32 *index)
+{
+    uint32 slot = object_id & OS_OBJECT_INDEX_MASK;
+
+    if ( object_id == 0 || slot >= reg->max_objects ||
+         OS_AtomicLoad(&reg->active_id[slot]) != object_id )
+    {
+        return(OS_ERR_INVALID_ID);
+    }
+
+    *index = slot;
+    return(OS_SUCCESS);
+}
+
+#endif
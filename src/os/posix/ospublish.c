@@ -0,0 +1,999 @@
+/*
+** File   : ospublish.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the OSAL Published Data API for POSIX systems,
+**          for data written by one task and read by many, where the readers
+**          write no cache line that another task uses.
+**
+**          A sequence lock keeps a small record and a sequence number that is
+**          odd while a write is in progress. A reader copies the record out
+**          and starts again if the sequence number changed under it.
+**
+**          A publication keeps a pointer to a larger record. An update swaps
+**          the pointer and retires the old record, which is released once
+**          every task that could still be reading it has left its read
+**          section. A task in a read section has the global epoch it saw on
+**          entry in its slot of the task table, and 0 otherwise, so a record
+**          retired at epoch E is free once no slot holds an epoch before E.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+
+/****************************************************************************************
+                                EXTERNAL FUNCTION PROTOTYPES
+****************************************************************************************/
+
+uint32 OS_FindCreator(void);
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+/*
+** A task waiting for a write or a grace period yields the CPU this many times
+** before it starts sleeping a tick at a time
+*/
+#define OS_PUBLISH_YIELDS  100
+
+#define UNINITIALIZED 0
+
+/****************************************************************************************
+                                    LOCAL TYPEDEFS
+****************************************************************************************/
+
+/*
+** seq and the record share the cache lines written by the writer. seq keeps
+** counting across a delete and create of the slot, so a reader that was
+** copying from the old lock cannot match the new one, and version counts from
+** base.
+*/
+typedef struct
+{
+   volatile OS_futex_t seq OS_ALIGN(OS_CACHE_LINE_SIZE);
+   uint32              size;
+   char                data[OS_SEQLOCK_MAX_SIZE];
+   uint32              free OS_ALIGN(OS_CACHE_LINE_SIZE);
+   char                name[OS_MAX_API_NAME];
+   uint32              creator;
+   OS_futex_t          base;
+
+} OS_seqlock_record_t;
+
+/*
+** data is the only field the readers look at. The old versions wait in the
+** retired ring, oldest first, each with the epoch after which it is free.
+** lock serializes the updates of the publication.
+*/
+typedef struct
+{
+   void * volatile      data OS_ALIGN(OS_CACHE_LINE_SIZE);
+   uint32               free OS_ALIGN(OS_CACHE_LINE_SIZE);
+   char                 name[OS_MAX_API_NAME];
+   uint32               creator;
+   OS_publish_release_t release;
+   OS_lwmutex_t         lock;
+   volatile uint32      version;
+   void                *retired[OS_PUBLISH_RETIRE_DEPTH];
+   OS_futex_t           retired_epoch[OS_PUBLISH_RETIRE_DEPTH];
+   uint32               retired_head;
+   volatile uint32      retired_count;
+
+} OS_publish_record_t;
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+OS_seqlock_record_t OS_seqlock_table[OS_MAX_SEQLOCKS];
+OS_publish_record_t OS_publish_table[OS_MAX_PUBLICATIONS];
+
+/*
+** The Mutexes for protecting the above tables
+*/
+pthread_mutex_t    OS_seqlock_table_mut;
+pthread_mutex_t    OS_publish_table_mut;
+
+/*
+** The registries that hand out the table slots and index the names
+*/
+static OS_registry_t OS_seqlock_registry;
+static OS_registry_t OS_publish_registry;
+
+/*
+** The global epoch. It is odd and moves up by 2, so it is never the 0 of a
+** task outside a read section.
+*/
+static volatile OS_futex_t OS_publish_epoch OS_ALIGN(OS_CACHE_LINE_SIZE);
+
+/*
+** The epoch slot of the calling task, found on its first read, and how deep
+** it is in nested read sections
+*/
+static __thread volatile OS_futex_t *OS_publish_self;
+static __thread uint32               OS_publish_nest;
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishBackoff
+
+   Purpose: Lets other tasks run while the caller waits, yielding at first and
+            then sleeping a tick. spins counts the calls of one wait.
+---------------------------------------------------------------------------------------*/
+static void OS_PublishBackoff (uint32 *spins)
+{
+   if ( ++(*spins) < OS_PUBLISH_YIELDS )
+   {
+      sched_yield();
+   }
+   else
+   {
+      OS_TaskDelay(1);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishGracePassed
+
+   Purpose: Returns TRUE if no task is in a read section it entered before the
+            global epoch reached target
+---------------------------------------------------------------------------------------*/
+static int OS_PublishGracePassed (OS_futex_t target)
+{
+   OS_futex_t epoch;
+   uint32     i;
+
+   for ( i = 0; i < OS_MAX_TASKS; i++ )
+   {
+      epoch = OS_AtomicLoad(OS_TaskEpochSlot(i));
+      if ( epoch != 0 && (int) (epoch - target) < 0 )
+      {
+         return(FALSE);
+      }
+   }
+
+   return(TRUE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishWaitGrace
+
+   Purpose: Blocks until the grace period that ends at target has passed
+---------------------------------------------------------------------------------------*/
+static void OS_PublishWaitGrace (OS_futex_t target)
+{
+   uint32 spins = 0;
+
+   while ( !OS_PublishGracePassed(target) )
+   {
+      OS_PublishBackoff(&spins);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishRetire
+
+   Purpose: Advances the global epoch and returns it. Data unlinked before the
+            call can still be read by the tasks in a read section that started
+            before the epoch returned, and by no other task.
+---------------------------------------------------------------------------------------*/
+static OS_futex_t OS_PublishRetire (void)
+{
+   OS_futex_t target;
+
+   target = OS_AtomicAdd(&OS_publish_epoch, 2);
+
+   /* the slots must be read after the data was unlinked */
+   OS_AtomicFence();
+
+   return(target);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishReclaim
+
+   Purpose: Releases the retired versions of a publication whose grace period
+            has passed, oldest first. With wait set it releases all of them,
+            waiting for their grace periods. The caller holds the lock of the
+            publication.
+---------------------------------------------------------------------------------------*/
+static void OS_PublishReclaim (OS_publish_record_t *rec, int wait)
+{
+   uint32 head;
+
+   while ( rec->retired_count != 0 )
+   {
+      head = rec->retired_head;
+
+      if ( wait )
+      {
+         OS_PublishWaitGrace(rec->retired_epoch[head]);
+      }
+      else if ( !OS_PublishGracePassed(rec->retired_epoch[head]) )
+      {
+         break;
+      }
+
+      if ( rec->release != NULL )
+      {
+         (*rec->release)(rec->retired[head]);
+      }
+
+      rec->retired[head]  = NULL;
+      rec->retired_head   = (head + 1) % OS_PUBLISH_RETIRE_DEPTH;
+      OS_AtomicStore(&rec->retired_count, rec->retired_count - 1);
+   }
+}
+
+/****************************************************************************************
+                                INITIALIZATION FUNCTION
+****************************************************************************************/
+int32 OS_PublishAPIInit (void)
+{
+   int i;
+
+   for ( i = 0; i < OS_MAX_SEQLOCKS; i++ )
+   {
+      OS_seqlock_table[i].free    = TRUE;
+      OS_seqlock_table[i].creator = UNINITIALIZED;
+      OS_seqlock_table[i].seq     = 0;
+      strcpy(OS_seqlock_table[i].name, "");
+   }
+
+   for ( i = 0; i < OS_MAX_PUBLICATIONS; i++ )
+   {
+      OS_publish_table[i].free    = TRUE;
+      OS_publish_table[i].creator = UNINITIALIZED;
+      OS_publish_table[i].data    = NULL;
+      strcpy(OS_publish_table[i].name, "");
+   }
+
+   OS_AtomicStore(&OS_publish_epoch, 1);
+
+   if ( OS_RegistryInit(&OS_seqlock_registry, OS_OBJECT_TYPE_SEQLOCK,
+                        OS_MAX_SEQLOCKS, OS_MAX_API_NAME) != OS_SUCCESS ||
+        OS_RegistryInit(&OS_publish_registry, OS_OBJECT_TYPE_PUBLISH,
+                        OS_MAX_PUBLICATIONS, OS_MAX_API_NAME) != OS_SUCCESS )
+   {
+      OS_printf("OS_PublishAPIInit: Error allocating the published data registries\n");
+      return(OS_ERROR);
+   }
+
+   if ( pthread_mutex_init(&OS_seqlock_table_mut, NULL) != 0 ||
+        pthread_mutex_init(&OS_publish_table_mut, NULL) != 0 )
+   {
+      OS_printf("OS_PublishAPIInit: Error creating the published data table mutexes\n");
+      return(OS_ERROR);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/****************************************************************************************
+                                   SEQUENCE LOCK API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SeqLockCreate
+
+   Purpose: Creates a sequence lock holding a record of size bytes, all zero
+
+   Returns: OS_INVALID_POINTER if seq_id or seq_name are NULL
+            OS_ERR_NAME_TOO_LONG if the name given is too long
+            OS_ERROR if size is 0 or larger than OS_SEQLOCK_MAX_SIZE
+            OS_ERR_NO_FREE_IDS if all of the sequence lock ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of a sequence lock
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockCreate (uint32 *seq_id, const char *seq_name, uint32 size)
+{
+   OS_seqlock_record_t *rec;
+   uint32               possible_id;
+   int32                status;
+
+   if ( seq_id == NULL || seq_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(seq_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   if ( size == 0 || size > OS_SEQLOCK_MAX_SIZE )
+   {
+      return(OS_ERROR);
+   }
+
+   pthread_mutex_lock(&OS_seqlock_table_mut);
+
+   status = OS_RegistryAlloc(&OS_seqlock_registry, seq_name, &possible_id);
+   if ( status != OS_SUCCESS )
+   {
+      pthread_mutex_unlock(&OS_seqlock_table_mut);
+      return(status);
+   }
+
+   rec = &OS_seqlock_table[possible_id];
+
+   rec->free = FALSE;
+   rec->size = size;
+   rec->base = OS_AtomicLoad(&rec->seq);
+   memset(rec->data, 0, sizeof(rec->data));
+
+   strcpy(rec->name, seq_name);
+   rec->creator = OS_FindCreator();
+
+   OS_RegistryPublish(&OS_seqlock_registry, possible_id);
+   *seq_id = OS_RegistryGetId(&OS_seqlock_registry, possible_id);
+
+   pthread_mutex_unlock(&OS_seqlock_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_SeqLockCreate */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SeqLockDelete
+
+   Purpose: Deletes a sequence lock
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid sequence lock
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockDelete (uint32 seq_id)
+{
+   OS_seqlock_record_t *rec;
+   uint32               local_id;
+
+   if ( OS_RegistryRetire(&OS_seqlock_registry, seq_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_seqlock_table[local_id];
+
+   pthread_mutex_lock(&OS_seqlock_table_mut);
+
+   rec->free = TRUE;
+   OS_RegistryFree(&OS_seqlock_registry, local_id);
+   strcpy(rec->name, "");
+   rec->creator = UNINITIALIZED;
+
+   pthread_mutex_unlock(&OS_seqlock_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_SeqLockDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SeqLockWrite
+
+   Purpose: Replaces the record of a sequence lock with size bytes from data.
+            Writes from several tasks are serialized, a task that finds a write
+            in progress waits for it.
+
+   Returns: OS_INVALID_POINTER if data is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid sequence lock
+            OS_ERROR if size is not the size the lock was created with
+            OS_SUCCESS if success
+
+   Notes: Readers spin while a write is in progress, so the writer should not
+          block or be preempted for long between the two sequence updates.
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockWrite (uint32 seq_id, const void *data, uint32 size)
+{
+   OS_seqlock_record_t *rec;
+   uint32               local_id;
+   uint32               spins = 0;
+   OS_futex_t           seq;
+
+   if ( data == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_seqlock_registry, seq_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_seqlock_table[local_id];
+
+   if ( size != rec->size )
+   {
+      return(OS_ERROR);
+   }
+
+   /*
+   ** Make the sequence odd. A failed compare and swap reloads seq.
+   */
+   seq = OS_AtomicLoadRelaxed(&rec->seq);
+   for ( ;; )
+   {
+      if ( seq & 1 )
+      {
+         OS_PublishBackoff(&spins);
+         seq = OS_AtomicLoadRelaxed(&rec->seq);
+      }
+      else if ( OS_AtomicCas(&rec->seq, &seq, seq + 1) )
+      {
+         break;
+      }
+   }
+
+   /* the odd sequence must be seen before any of the new record */
+   OS_AtomicFence();
+
+   memcpy(rec->data, data, size);
+
+   OS_AtomicStore(&rec->seq, seq + 2);
+
+   return(OS_SUCCESS);
+
+}/* end OS_SeqLockWrite */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SeqLockRead
+
+   Purpose: Copies the record of a sequence lock to data, as one consistent
+            version. version, if not NULL, gets the number of writes made
+            before that version.
+
+   Returns: OS_INVALID_POINTER if data is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid sequence lock
+            OS_ERROR if size is not the size the lock was created with
+            OS_SUCCESS if success
+
+   Notes: The read writes nothing shared. It copies the record again for each
+          write that overlaps the copy.
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockRead (uint32 seq_id, void *data, uint32 size, uint32 *version)
+{
+   OS_seqlock_record_t *rec;
+   uint32               local_id;
+   uint32               spins = 0;
+   OS_futex_t           seq;
+
+   if ( data == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_seqlock_registry, seq_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_seqlock_table[local_id];
+
+   if ( size != rec->size )
+   {
+      return(OS_ERROR);
+   }
+
+   for ( ;; )
+   {
+      seq = OS_AtomicLoad(&rec->seq);
+      if ( seq & 1 )
+      {
+         OS_PublishBackoff(&spins);
+         continue;
+      }
+
+      memcpy(data, rec->data, size);
+
+      /* the copy must be complete before the sequence is read again */
+      OS_AtomicFence();
+
+      if ( OS_AtomicLoadRelaxed(&rec->seq) == seq )
+      {
+         break;
+      }
+   }
+
+   if ( version != NULL )
+   {
+      *version = (seq - rec->base) / 2;
+   }
+
+   return(OS_SUCCESS);
+
+}/* end OS_SeqLockRead */
+
+/*--------------------------------------------------------------------------------------
+   Name: OS_SeqLockGetIdByName
+
+   Purpose: This function tries to find a sequence lock id given the name. The id
+            is returned through seq_id
+
+   Returns: OS_INVALID_POINTER if seq_id or seq_name are NULL pointers
+            OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
+            OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockGetIdByName (uint32 *seq_id, const char *seq_name)
+{
+   int32 status;
+
+   if ( seq_id == NULL || seq_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(seq_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   pthread_mutex_lock(&OS_seqlock_table_mut);
+   status = OS_RegistryFindId(&OS_seqlock_registry, seq_name, seq_id);
+   pthread_mutex_unlock(&OS_seqlock_table_mut);
+
+   return(status);
+
+}/* end OS_SeqLockGetIdByName */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SeqLockGetInfo
+
+   Purpose: This function will pass back a structure that contains the name,
+            creator, record size and version of the specified sequence lock.
+
+   Returns: OS_INVALID_POINTER if seq_prop is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid sequence lock
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_SeqLockGetInfo (uint32 seq_id, OS_seqlock_prop_t *seq_prop)
+{
+   OS_seqlock_record_t *rec;
+   uint32               local_id;
+
+   if ( seq_prop == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_seqlock_registry, seq_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_seqlock_table[local_id];
+
+   pthread_mutex_lock(&OS_seqlock_table_mut);
+
+   strcpy(seq_prop->name, rec->name);
+   seq_prop->creator = rec->creator;
+   seq_prop->size    = rec->size;
+   seq_prop->version = (OS_AtomicLoad(&rec->seq) - rec->base) / 2;
+
+   pthread_mutex_unlock(&OS_seqlock_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_SeqLockGetInfo */
+
+/****************************************************************************************
+                                    PUBLICATION API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishCreate
+
+   Purpose: Creates a publication whose first version is data. release, if not
+            NULL, is called with each version once no task can be reading it,
+            including data itself when the publication is deleted.
+
+   Returns: OS_INVALID_POINTER if pub_id, pub_name or data are NULL
+            OS_ERR_NAME_TOO_LONG if the name given is too long
+            OS_ERR_NO_FREE_IDS if all of the publication ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of a publication
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishCreate (uint32 *pub_id, const char *pub_name, void *data,
+                        OS_publish_release_t release)
+{
+   OS_publish_record_t *rec;
+   uint32               possible_id;
+   int32                status;
+
+   if ( pub_id == NULL || pub_name == NULL || data == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(pub_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   pthread_mutex_lock(&OS_publish_table_mut);
+
+   status = OS_RegistryAlloc(&OS_publish_registry, pub_name, &possible_id);
+   if ( status != OS_SUCCESS )
+   {
+      pthread_mutex_unlock(&OS_publish_table_mut);
+      return(status);
+   }
+
+   rec = &OS_publish_table[possible_id];
+
+   rec->free          = FALSE;
+   rec->release       = release;
+   rec->version       = 0;
+   rec->retired_head  = 0;
+   rec->retired_count = 0;
+   OS_LwMutexInit(&rec->lock);
+   OS_AtomicStore(&rec->data, data);
+
+   strcpy(rec->name, pub_name);
+   rec->creator = OS_FindCreator();
+
+   OS_RegistryPublish(&OS_publish_registry, possible_id);
+   *pub_id = OS_RegistryGetId(&OS_publish_registry, possible_id);
+
+   pthread_mutex_unlock(&OS_publish_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishCreate */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishDelete
+
+   Purpose: Deletes a publication. It waits until no task can be reading it, and
+            then releases the current version and every retired one.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid publication
+            OS_ERROR if the calling task is in a read section
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishDelete (uint32 pub_id)
+{
+   OS_publish_record_t *rec;
+   uint32               local_id;
+   void                *data;
+   OS_futex_t           target;
+
+   /* the grace period would wait for the caller itself */
+   if ( OS_publish_nest != 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   if ( OS_RegistryRetire(&OS_publish_registry, pub_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_publish_table[local_id];
+
+   /*
+   ** A reader that got past the id check before the retire finds NULL and
+   ** fails, the ones that already hold the data are waited out
+   */
+   OS_LwMutexLock(&rec->lock);
+
+   data   = OS_AtomicExchange(&rec->data, NULL);
+   target = OS_PublishRetire();
+   OS_PublishWaitGrace(target);
+
+   OS_PublishReclaim(rec, TRUE);
+   if ( rec->release != NULL )
+   {
+      (*rec->release)(data);
+   }
+
+   OS_LwMutexUnlock(&rec->lock);
+
+   pthread_mutex_lock(&OS_publish_table_mut);
+
+   rec->free = TRUE;
+   OS_RegistryFree(&OS_publish_registry, local_id);
+   strcpy(rec->name, "");
+   rec->creator = UNINITIALIZED;
+
+   pthread_mutex_unlock(&OS_publish_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishUpdate
+
+   Purpose: Makes data the current version of a publication. Readers that start
+            after the call see data, the previous version is released once the
+            readers that may still hold it are done. Updates from several tasks
+            are serialized.
+
+   Returns: OS_INVALID_POINTER if data is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid publication
+            OS_ERROR if OS_PUBLISH_RETIRE_DEPTH versions are waiting for their
+            readers and the calling task is in a read section
+            OS_SUCCESS if success
+
+   Notes: The update does not block unless OS_PUBLISH_RETIRE_DEPTH versions are
+          waiting for their readers, then it waits for the oldest. The release
+          function runs in the task that updates, deletes or synchronizes the
+          publication, and must not call those for the same publication.
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishUpdate (uint32 pub_id, void *data)
+{
+   OS_publish_record_t *rec;
+   uint32               local_id;
+   uint32               slot;
+   void                *old;
+
+   if ( data == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_publish_registry, pub_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_publish_table[local_id];
+
+   OS_LwMutexLock(&rec->lock);
+
+   /* deleted while the caller waited for the lock */
+   if ( OS_AtomicLoad(&rec->data) == NULL )
+   {
+      OS_LwMutexUnlock(&rec->lock);
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( rec->retired_count == OS_PUBLISH_RETIRE_DEPTH )
+   {
+      if ( OS_publish_nest != 0 )
+      {
+         OS_LwMutexUnlock(&rec->lock);
+         return(OS_ERROR);
+      }
+
+      OS_PublishWaitGrace(rec->retired_epoch[rec->retired_head]);
+      OS_PublishReclaim(rec, FALSE);
+   }
+
+   old = OS_AtomicExchange(&rec->data, data);
+
+   slot = (rec->retired_head + rec->retired_count) % OS_PUBLISH_RETIRE_DEPTH;
+   rec->retired[slot]       = old;
+   rec->retired_epoch[slot] = OS_PublishRetire();
+   OS_AtomicStore(&rec->retired_count, rec->retired_count + 1);
+   OS_AtomicStore(&rec->version, rec->version + 1);
+
+   OS_PublishReclaim(rec, FALSE);
+
+   OS_LwMutexUnlock(&rec->lock);
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishUpdate */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishReadBegin
+
+   Purpose: Starts a read section of the calling task and returns the current
+            version of a publication in data. The version stays valid until the
+            task ends the section with OS_PublishReadEnd. Sections nest, a task
+            may read several publications in one.
+
+   Returns: OS_INVALID_POINTER if data is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid publication
+            OS_ERROR if the caller is not an OSAL task
+            OS_SUCCESS if success
+
+   Notes: A read writes only the epoch slot of the calling task. Sections should
+          be short and must not block, since every update waits for the
+          sections that were open when it was made before releasing the
+          version it replaced.
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishReadBegin (uint32 pub_id, void **data)
+{
+   OS_publish_record_t *rec;
+   uint32               local_id;
+
+   if ( data == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_publish_registry, pub_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( OS_publish_self == NULL )
+   {
+      OS_publish_self = OS_TaskEpochSlot(OS_TASK_EPOCH_SELF);
+      if ( OS_publish_self == NULL )
+      {
+         return(OS_ERROR);
+      }
+   }
+
+   rec = &OS_publish_table[local_id];
+
+   if ( OS_publish_nest++ == 0 )
+   {
+      OS_AtomicStore(OS_publish_self, OS_AtomicLoad(&OS_publish_epoch));
+
+      /* the slot must be seen before the data pointer is read */
+      OS_AtomicFence();
+   }
+
+   *data = OS_AtomicLoad(&rec->data);
+   if ( *data == NULL )
+   {
+      OS_PublishReadEnd(pub_id);
+      return(OS_ERR_INVALID_ID);
+   }
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishReadBegin */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishReadEnd
+
+   Purpose: Ends the read section started by the matching OS_PublishReadBegin.
+            The data it returned must not be used after this.
+
+   Returns: OS_ERROR if the calling task is not in a read section
+            OS_SUCCESS if success
+
+   Notes: pub_id is the id given to the matching OS_PublishReadBegin. The section
+          is ended even if the publication is no longer valid.
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishReadEnd (uint32 pub_id)
+{
+   if ( OS_publish_nest == 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   if ( --OS_publish_nest == 0 )
+   {
+      OS_AtomicStore(OS_publish_self, 0);
+   }
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishReadEnd */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishSynchronize
+
+   Purpose: Waits until every version of a publication older than the current one
+            has been released. After it returns no task is reading a version
+            that was replaced before the call.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid publication
+            OS_ERROR if the calling task is in a read section
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishSynchronize (uint32 pub_id)
+{
+   OS_publish_record_t *rec;
+   uint32               local_id;
+
+   if ( OS_publish_nest != 0 )
+   {
+      return(OS_ERROR);
+   }
+
+   if ( OS_RegistryCheckId(&OS_publish_registry, pub_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_publish_table[local_id];
+
+   OS_LwMutexLock(&rec->lock);
+   OS_PublishReclaim(rec, TRUE);
+   OS_LwMutexUnlock(&rec->lock);
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishSynchronize */
+
+/*--------------------------------------------------------------------------------------
+   Name: OS_PublishGetIdByName
+
+   Purpose: This function tries to find a publication id given the name. The id is
+            returned through pub_id
+
+   Returns: OS_INVALID_POINTER if pub_id or pub_name are NULL pointers
+            OS_ERR_NAME_TOO_LONG if the name given is to long to have been stored
+            OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishGetIdByName (uint32 *pub_id, const char *pub_name)
+{
+   int32 status;
+
+   if ( pub_id == NULL || pub_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(pub_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   pthread_mutex_lock(&OS_publish_table_mut);
+   status = OS_RegistryFindId(&OS_publish_registry, pub_name, pub_id);
+   pthread_mutex_unlock(&OS_publish_table_mut);
+
+   return(status);
+
+}/* end OS_PublishGetIdByName */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_PublishGetInfo
+
+   Purpose: This function will pass back a structure that contains the name,
+            creator, version and retired version count of the specified
+            publication.
+
+   Returns: OS_INVALID_POINTER if pub_prop is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid publication
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_PublishGetInfo (uint32 pub_id, OS_publish_prop_t *pub_prop)
+{
+   OS_publish_record_t *rec;
+   uint32               local_id;
+
+   if ( pub_prop == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( OS_RegistryCheckId(&OS_publish_registry, pub_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   rec = &OS_publish_table[local_id];
+
+   pthread_mutex_lock(&OS_publish_table_mut);
+
+   strcpy(pub_prop->name, rec->name);
+   pub_prop->creator = rec->creator;
+   pub_prop->version = OS_AtomicLoadRelaxed(&rec->version);
+   pub_prop->retired = OS_AtomicLoadRelaxed(&rec->retired_count);
+
+   pthread_mutex_unlock(&OS_publish_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_PublishGetInfo */
@@ -0,0 +1,351 @@
+/*
+** File   : osregistry.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the object registry shared by the OSAL object
+**          tables. A registry hands out the slots of one table from a bitmap of
+**          free slots and keeps a hashed index of the names in use, so creating
+**          an object and looking one up by name do not depend on the size of
+**          the table. It also hands out the generation tagged object IDs and
+**          keeps the table of published IDs that OS_RegistryCheckId reads.
+**
+**          A registry does no locking of its own. Every call that changes the
+**          slots or names must be made with the mutex of the table it belongs
+**          to held. Published IDs are only changed with atomic operations, so
+**          they can be checked and retired without the mutex.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#define OS_REGISTRY_WORD_BITS ( sizeof(unsigned long) * 8 )
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryHash
+
+   Purpose: Returns the hash bucket of a name ( FNV-1a )
+---------------------------------------------------------------------------------------*/
+static uint32 OS_RegistryHash (const OS_registry_t *reg, const char *name)
+{
+   unsigned int hash = 2166136261U;
+
+   while ( *name != '\0' )
+   {
+      hash ^= (unsigned char) *name++;
+      hash *= 16777619U;
+   }
+
+   return(hash & reg->bucket_mask);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryName
+
+   Purpose: Returns the name stored for a slot
+---------------------------------------------------------------------------------------*/
+static char *OS_RegistryName (const OS_registry_t *reg, uint32 index)
+{
+   return(reg->names + (index * reg->name_len));
+}
+
+/****************************************************************************************
+                                   REGISTRY API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryInit
+
+   Purpose: Sets up a registry for a table of max_objects slots whose names are
+            shorter than name_len, holding objects of type object_type. Every
+            slot starts out free, and the lowest free slot is always the one
+            handed out.
+
+   Returns: OS_ERROR if the registry memory could not be allocated
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RegistryInit (OS_registry_t *reg, uint32 object_type, uint32 max_objects,
+                       uint32 name_len)
+{
+   uint32 i;
+   uint32 buckets;
+   uint32 words;
+
+   /*
+   ** Keep the chains short by having at least as many buckets as slots
+   */
+   for ( buckets = 1; buckets < max_objects; buckets <<= 1 )
+   {
+      ;
+   }
+   words = ( max_objects + OS_REGISTRY_WORD_BITS - 1 ) / OS_REGISTRY_WORD_BITS;
+
+   /*
+   ** OS_API_Init may be called more than once, start from scratch each time
+   */
+   free(reg->free_map);
+   free(reg->next);
+   free(reg->bucket);
+   free(reg->names);
+   free(reg->generation);
+   free(reg->active_id);
+
+   reg->object_type = object_type;
+   reg->max_objects = max_objects;
+   reg->name_len    = name_len;
+   reg->bucket_mask = buckets - 1;
+   reg->map_words   = words;
+   reg->free_word   = 0;
+   reg->free_map    = calloc(words, sizeof(unsigned long));
+   reg->next        = calloc(max_objects, sizeof(uint32));
+   reg->bucket      = calloc(buckets, sizeof(uint32));
+   reg->names       = calloc(max_objects, name_len);
+   reg->generation  = calloc(max_objects, sizeof(uint32));
+   reg->active_id   = calloc(max_objects, sizeof(uint32));
+
+   if ( reg->free_map == NULL || reg->next == NULL || reg->bucket == NULL ||
+        reg->names == NULL || reg->generation == NULL || reg->active_id == NULL )
+   {
+      return(OS_ERROR);
+   }
+
+   for ( i = 0; i < buckets; i++ )
+   {
+      reg->bucket[i] = OS_REGISTRY_NONE;
+   }
+
+   for ( i = 0; i < max_objects; i++ )
+   {
+      reg->free_map[i / OS_REGISTRY_WORD_BITS] |= 1UL << ( i % OS_REGISTRY_WORD_BITS );
+   }
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryAlloc
+
+   Purpose: Takes a free slot and enters name in the index for it. The name is
+            taken at once, so a second create with the same name fails even
+            before the first one has finished. The slot moves on to its next
+            generation, but its ID is not valid until OS_RegistryPublish.
+
+   Returns: OS_ERR_NO_FREE_IDS if every slot is in use
+            OS_ERR_NAME_TAKEN if the name is already in use in this registry
+            OS_SUCCESS if success, with the slot in *index
+---------------------------------------------------------------------------------------*/
+int32 OS_RegistryAlloc (OS_registry_t *reg, const char *name, uint32 *index)
+{
+   uint32 slot;
+   uint32 hash;
+
+   /*
+   ** Words below free_word have no free slots, skip past any that filled up
+   */
+   while ( reg->free_word < reg->map_words && reg->free_map[reg->free_word] == 0 )
+   {
+      reg->free_word++;
+   }
+
+   if ( reg->free_word == reg->map_words )
+   {
+      return(OS_ERR_NO_FREE_IDS);
+   }
+
+   if ( OS_RegistryFind(reg, name, &slot) == OS_SUCCESS )
+   {
+      return(OS_ERR_NAME_TAKEN);
+   }
+
+   slot = ( reg->free_word * OS_REGISTRY_WORD_BITS ) +
+          __builtin_ctzl(reg->free_map[reg->free_word]);
+   reg->free_map[reg->free_word] &= ~( 1UL << ( slot % OS_REGISTRY_WORD_BITS ) );
+   reg->generation[slot] = ( reg->generation[slot] + 1 ) & OS_OBJECT_GEN_MASK;
+
+   strncpy(OS_RegistryName(reg, slot), name, reg->name_len - 1);
+   OS_RegistryName(reg, slot)[reg->name_len - 1] = '\0';
+
+   hash              = OS_RegistryHash(reg, OS_RegistryName(reg, slot));
+   reg->next[slot]   = reg->bucket[hash];
+   reg->bucket[hash] = slot;
+
+   *index = slot;
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryFree
+
+   Purpose: Removes a slot's name from the index and marks the slot free again.
+            The slot's ID is retired if it still was published. Freeing a slot
+            that is not in use does nothing.
+---------------------------------------------------------------------------------------*/
+void OS_RegistryFree (OS_registry_t *reg, uint32 index)
+{
+   uint32         *link;
+   uint32          word;
+   unsigned long   bit;
+
+   if ( index >= reg->max_objects )
+   {
+      return;
+   }
+
+   word = index / OS_REGISTRY_WORD_BITS;
+   bit  = 1UL << ( index % OS_REGISTRY_WORD_BITS );
+   if ( reg->free_map[word] & bit )
+   {
+      return;
+   }
+
+   link = &reg->bucket[OS_RegistryHash(reg, OS_RegistryName(reg, index))];
+   while ( *link != index )
+   {
+      link = &reg->next[*link];
+   }
+   *link = reg->next[index];
+
+   OS_RegistryName(reg, index)[0] = '\0';
+   OS_AtomicStore(&reg->active_id[index], 0);
+
+   reg->free_map[word] |= bit;
+   if ( word < reg->free_word )
+   {
+      reg->free_word = word;
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryFind
+
+   Purpose: Looks up the slot holding name
+
+   Returns: OS_ERR_NAME_NOT_FOUND if no slot in use has that name
+            OS_SUCCESS if success, with the slot in *index
+---------------------------------------------------------------------------------------*/
+int32 OS_RegistryFind (const OS_registry_t *reg, const char *name, uint32 *index)
+{
+   uint32 slot;
+
+   for ( slot = reg->bucket[OS_RegistryHash(reg, name)];
+         slot != OS_REGISTRY_NONE;
+         slot = reg->next[slot] )
+   {
+      if ( strcmp(OS_RegistryName(reg, slot), name) == 0 )
+      {
+         *index = slot;
+         return(OS_SUCCESS);
+      }
+   }
+
+   return(OS_ERR_NAME_NOT_FOUND);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryFindId
+
+   Purpose: Looks up the ID of the published object named name
+
+   Returns: OS_ERR_NAME_NOT_FOUND if no published object has that name
+            OS_SUCCESS if success, with the ID in *object_id
+---------------------------------------------------------------------------------------*/
+int32 OS_RegistryFindId (const OS_registry_t *reg, const char *name, uint32 *object_id)
+{
+   uint32 slot;
+   uint32 id;
+
+   if ( OS_RegistryFind(reg, name, &slot) != OS_SUCCESS )
+   {
+      return(OS_ERR_NAME_NOT_FOUND);
+   }
+
+   /*
+   ** An object that is still being created or is being deleted has no ID
+   */
+   id = OS_AtomicLoad(&reg->active_id[slot]);
+   if ( id == 0 )
+   {
+      return(OS_ERR_NAME_NOT_FOUND);
+   }
+
+   *object_id = id;
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryGetId
+
+   Purpose: Returns the ID of the current generation of a slot, whether or not it
+            has been published yet
+---------------------------------------------------------------------------------------*/
+uint32 OS_RegistryGetId (const OS_registry_t *reg, uint32 index)
+{
+   return(( reg->object_type << OS_OBJECT_TYPE_SHIFT ) |
+          ( reg->generation[index] << OS_OBJECT_GEN_SHIFT ) |
+          index);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryPublish
+
+   Purpose: Makes the ID of a slot valid. This is done once the object in the slot
+            is completely set up, since other tasks may use it from then on.
+---------------------------------------------------------------------------------------*/
+void OS_RegistryPublish (OS_registry_t *reg, uint32 index)
+{
+   OS_AtomicStore(&reg->active_id[index], OS_RegistryGetId(reg, index));
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RegistryRetire
+
+   Purpose: Makes an object ID invalid ahead of deleting the object. Only one of
+            several tasks deleting the same object at once succeeds, and every
+            call given the ID fails from then on. The slot stays allocated until
+            OS_RegistryFree.
+
+            This does not need the table mutex.
+
+   Returns: OS_ERR_INVALID_ID if object_id is not a published ID
+            OS_SUCCESS if success, with the slot in *index
+---------------------------------------------------------------------------------------*/
+int32 OS_RegistryRetire (OS_registry_t *reg, uint32 object_id, uint32 *index)
+{
+   uint32 slot;
+
+   if ( OS_RegistryCheckId(reg, object_id, &slot) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   if ( !OS_AtomicCas(&reg->active_id[slot], &object_id, 0) )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   *index = slot;
+   return(OS_SUCCESS);
+}
@@ -0,0 +1,798 @@
+/*
+** File   : ossem.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the semaphore engine behind the OSAL binary and
+**          counting semaphores.
+**
+**          A semaphore is a count of available tokens changed with atomics, and
+**          a sequence word that every give and flush bumps. Tasks that find no
+**          token sleep on the sequence word with OS_FutexWait. A give or take
+**          that does not have to block makes no system call and takes no lock,
+**          so semaphores never serialize each other.
+**
+**          It also has the lightweight mutex used for OS_MUTEX_LIGHTWEIGHT mutex
+**          semaphores. It is the three state futex mutex: a task that finds it
+**          held spins for a short while and then blocks on the state word.
+**
+**          The reader-writer lock keeps its reader count and writer bit in one
+**          word, so a read take or give with no writer around is one atomic.
+**          Readers and writers sleep on separate sequence words, so a give can
+**          wake all the readers or a single writer.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include <limits.h>
+#include <time.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+/*
+** Its address identifies the calling thread as the owner of a lightweight mutex
+*/
+static __thread char OS_lwmutex_self;
+
+/****************************************************************************************
+                                  SEMAPHORE ENGINE
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemTryTake
+
+   Purpose: Takes a token if there is one, without blocking
+
+   Returns: TRUE if a token was taken
+            FALSE if the semaphore is empty
+---------------------------------------------------------------------------------------*/
+int OS_SemTryTake (OS_sem_t *sem)
+{
+   OS_futex_t count;
+
+   count = OS_AtomicLoad(&sem->count);
+   while ( count > 0 && count != OS_SEM_DESTROYED )
+   {
+      if ( OS_AtomicCas(&sem->count, &count, count - 1) )
+      {
+         return(TRUE);
+      }
+   }
+
+   return(FALSE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemInit
+
+   Purpose: Sets up a semaphore holding value tokens that can hold at most
+            max_value tokens. max_value must be below OS_SEM_DESTROYED. The
+            waiter and user counts are kept, see OS_sem_t.
+---------------------------------------------------------------------------------------*/
+void OS_SemInit (OS_sem_t *sem, uint32 value, uint32 max_value)
+{
+   sem->max_value = max_value;
+   sem->flushes   = 0;
+   sem->seq       = 0;
+   sem->wake_time = 0;
+   OS_AtomicStore(&sem->count, value);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemDestroy
+
+   Purpose: Releases every task blocked on the semaphore with OS_SEM_FAILURE and
+            returns once they and every call counted in by OS_SemEnter have
+            left it, so the memory can be reused. The last one to leave wakes
+            the caller.
+---------------------------------------------------------------------------------------*/
+void OS_SemDestroy (OS_sem_t *sem)
+{
+   OS_futex_t waiters;
+
+   OS_AtomicStore(&sem->count, OS_SEM_DESTROYED);
+   OS_AtomicAdd(&sem->seq, 1);
+   OS_FutexWake(&sem->seq, INT_MAX);
+
+   while ( (waiters = OS_AtomicLoad(&sem->waiters)) != 0 )
+   {
+      OS_FutexWait(&sem->waiters, waiters, NULL);
+   }
+
+   while ( (waiters = OS_AtomicLoad(&sem->users)) != 0 )
+   {
+      OS_FutexWait(&sem->users, waiters, NULL);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemEnter / OS_SemLeave
+
+   Purpose: Count a call that was handed the ID of the semaphore in and out of its
+            users. A call that checks the ID again after OS_SemEnter is waited
+            for by OS_SemDestroy, or sees that the ID has gone stale.
+---------------------------------------------------------------------------------------*/
+void OS_SemEnter (OS_sem_t *sem)
+{
+   OS_AtomicAdd(&sem->users, 1);
+}
+
+void OS_SemLeave (OS_sem_t *sem)
+{
+   if ( OS_AtomicSub(&sem->users, 1) == 0 &&
+        OS_AtomicLoad(&sem->count) == OS_SEM_DESTROYED )
+   {
+      OS_FutexWake(&sem->users, 1);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemGive
+
+   Purpose: Adds a token and wakes one blocked task. A give to a semaphore that
+            already holds max_value tokens is dropped.
+---------------------------------------------------------------------------------------*/
+void OS_SemGive (OS_sem_t *sem)
+{
+   OS_futex_t count;
+
+   count = OS_AtomicLoad(&sem->count);
+   do
+   {
+      if ( count >= sem->max_value )
+      {
+         return;
+      }
+   } while ( !OS_AtomicCas(&sem->count, &count, count + 1) );
+
+   OS_AtomicAdd(&sem->seq, 1);
+
+   /*
+   ** A task that starts waiting after the waiters check still sees the new
+   ** token, since it counts itself as a waiter before it looks at the count
+   */
+   if ( OS_AtomicLoad(&sem->waiters) != 0 )
+   {
+      OS_AtomicStore(&sem->wake_time, OS_MonotonicNow());
+      OS_FutexWake(&sem->seq, 1);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemTake
+
+   Purpose: Takes a token, blocking until one is given, the semaphore is flushed
+            or the absolute CLOCK_MONOTONIC deadline passes. A NULL deadline
+            waits forever. A take that had to block records its wakeup latency
+            in the statistics of the calling task.
+
+   Returns: OS_SUCCESS if a token was taken or the semaphore was flushed
+            OS_SEM_TIMEOUT if the deadline passed first
+            OS_SEM_FAILURE if the semaphore was destroyed
+---------------------------------------------------------------------------------------*/
+int32 OS_SemTake (OS_sem_t *sem, const struct timespec *deadline)
+{
+   OS_futex_t flushes;
+   OS_futex_t seq;
+   uint64     sleep_start = 0;
+   uint64     wake_time;
+   int32      status;
+
+   if ( OS_SemTryTake(sem) )
+   {
+      return(OS_SUCCESS);
+   }
+
+   OS_AtomicAdd(&sem->waiters, 1);
+   flushes = OS_AtomicLoad(&sem->flushes);
+
+   for ( ;; )
+   {
+      /*
+      ** The sequence is read before the count, so a give that lands in
+      ** between changes it and the wait below returns at once
+      */
+      seq = OS_AtomicLoad(&sem->seq);
+
+      if ( OS_AtomicLoad(&sem->count) == OS_SEM_DESTROYED )
+      {
+         status = OS_SEM_FAILURE;
+         break;
+      }
+
+      if ( OS_AtomicLoad(&sem->flushes) != flushes )
+      {
+         status = OS_SUCCESS;
+         break;
+      }
+
+      if ( OS_SemTryTake(sem) )
+      {
+         status = OS_SUCCESS;
+         break;
+      }
+
+      sleep_start = OS_MonotonicNow();
+      if ( OS_FutexWait(&sem->seq, seq, deadline) == OS_ERROR_TIMEOUT )
+      {
+         /*
+         ** The wake meant for this task may have raced with the timeout,
+         ** take the token if it is there so it is not left behind
+         */
+         status = OS_SemTryTake(sem) ? OS_SUCCESS : OS_SEM_TIMEOUT;
+         break;
+      }
+   }
+
+   /* the last task to leave a destroyed semaphore releases OS_SemDestroy */
+   if ( OS_AtomicSub(&sem->waiters, 1) == 0 &&
+        OS_AtomicLoad(&sem->count) == OS_SEM_DESTROYED )
+   {
+      OS_FutexWake(&sem->waiters, 1);
+   }
+
+   /*
+   ** The wakeup latency runs from the give that released the task. A give
+   ** older than the sleep woke some other task, so the sleep start is used.
+   */
+   if ( status == OS_SUCCESS && sleep_start != 0 )
+   {
+      wake_time = OS_AtomicLoad(&sem->wake_time);
+      if ( wake_time < sleep_start )
+      {
+         wake_time = sleep_start;
+      }
+      OS_TaskRecordWakeup(OS_MonotonicNow() - wake_time);
+   }
+
+   return(status);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemFlush
+
+   Purpose: Releases every task blocked on the semaphore without giving it a
+            token. The count of the semaphore does not change.
+---------------------------------------------------------------------------------------*/
+void OS_SemFlush (OS_sem_t *sem)
+{
+   OS_AtomicAdd(&sem->flushes, 1);
+   OS_AtomicAdd(&sem->seq, 1);
+
+   if ( OS_AtomicLoad(&sem->waiters) != 0 )
+   {
+      OS_AtomicStore(&sem->wake_time, OS_MonotonicNow());
+      OS_FutexWake(&sem->seq, INT_MAX);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_SemGetValue
+
+   Purpose: Returns the number of tokens the semaphore holds
+---------------------------------------------------------------------------------------*/
+uint32 OS_SemGetValue (OS_sem_t *sem)
+{
+   OS_futex_t count;
+
+   count = OS_AtomicLoad(&sem->count);
+
+   return(count == OS_SEM_DESTROYED ? 0 : count);
+}
+
+/****************************************************************************************
+                                  LIGHTWEIGHT MUTEX
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexInit
+
+   Purpose: Sets up an unlocked lightweight mutex
+---------------------------------------------------------------------------------------*/
+void OS_LwMutexInit (OS_lwmutex_t *mut)
+{
+   mut->owner = NULL;
+   OS_AtomicStore(&mut->state, 0);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexLock
+
+   Purpose: Locks the mutex. A held mutex is retried OS_MUTEX_SPIN_COUNT times
+            before the caller blocks, which is cheaper than sleeping when the
+            mutex only guards a few instructions.
+---------------------------------------------------------------------------------------*/
+void OS_LwMutexLock (OS_lwmutex_t *mut)
+{
+   OS_futex_t state;
+   int        spin;
+
+   for ( spin = 0; spin <= OS_MUTEX_SPIN_COUNT; spin++ )
+   {
+      state = 0;
+      if ( OS_AtomicLoadRelaxed(&mut->state) == 0 &&
+           OS_AtomicCas(&mut->state, &state, 1) )
+      {
+         mut->owner = &OS_lwmutex_self;
+         return;
+      }
+      OS_CpuRelax();
+   }
+
+   /*
+   ** Mark the mutex contended so the owner wakes a task when it unlocks.
+   ** Getting 0 back from the exchange means the mutex was taken here.
+   */
+   while ( OS_AtomicExchange(&mut->state, 2) != 0 )
+   {
+      OS_FutexWait(&mut->state, 2, NULL);
+   }
+
+   mut->owner = &OS_lwmutex_self;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexTryLock
+
+   Purpose: Locks the mutex if it is free, without spinning or blocking
+
+   Returns: TRUE if the mutex was locked
+            FALSE if another thread holds it
+---------------------------------------------------------------------------------------*/
+int OS_LwMutexTryLock (OS_lwmutex_t *mut)
+{
+   OS_futex_t state = 0;
+
+   if ( OS_AtomicCas(&mut->state, &state, 1) )
+   {
+      mut->owner = &OS_lwmutex_self;
+      return(TRUE);
+   }
+
+   return(FALSE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexUnlock
+
+   Purpose: Unlocks the mutex and wakes one blocked task, if there is one
+
+   Returns: OS_SEM_FAILURE if the caller does not hold the mutex
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_LwMutexUnlock (OS_lwmutex_t *mut)
+{
+   if ( mut->owner != &OS_lwmutex_self )
+   {
+      return(OS_SEM_FAILURE);
+   }
+
+   mut->owner = NULL;
+
+   if ( OS_AtomicExchange(&mut->state, 0) == 2 )
+   {
+      OS_FutexWake(&mut->state, 1);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexIsOwner
+
+   Purpose: Returns TRUE if the calling thread holds the mutex
+---------------------------------------------------------------------------------------*/
+int OS_LwMutexIsOwner (OS_lwmutex_t *mut)
+{
+   return(mut->owner == &OS_lwmutex_self);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_LwMutexIsLocked
+
+   Purpose: Returns TRUE if any thread holds the mutex
+---------------------------------------------------------------------------------------*/
+int OS_LwMutexIsLocked (OS_lwmutex_t *mut)
+{
+   return(OS_AtomicLoad(&mut->state) != 0);
+}
+
+/****************************************************************************************
+                                 READER-WRITER LOCK
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwWakeReaders / OS_RwWakeWriter
+
+   Purpose: Wake every blocked reader, or one blocked writer, if there is one
+---------------------------------------------------------------------------------------*/
+static void OS_RwWakeReaders (OS_rwlock_t *rw)
+{
+   if ( OS_AtomicLoad(&rw->read_waiters) != 0 )
+   {
+      OS_AtomicAdd(&rw->read_seq, 1);
+      OS_FutexWake(&rw->read_seq, INT_MAX);
+   }
+}
+
+static void OS_RwWakeWriter (OS_rwlock_t *rw)
+{
+   if ( OS_AtomicLoad(&rw->write_waiters) != 0 )
+   {
+      OS_AtomicAdd(&rw->write_seq, 1);
+      OS_FutexWake(&rw->write_seq, 1);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwStopWaiting
+
+   Purpose: Takes a blocked task off waiters, one of the waiter counts of the
+            lock. The last one to leave a destroyed lock wakes the destroyer.
+
+   Returns: the number of tasks still counted in waiters
+---------------------------------------------------------------------------------------*/
+static OS_futex_t OS_RwStopWaiting (OS_rwlock_t *rw, volatile OS_futex_t *waiters)
+{
+   OS_futex_t left;
+
+   left = OS_AtomicSub(waiters, 1);
+   if ( left == 0 && OS_AtomicLoad(&rw->state) == OS_RW_DESTROYED )
+   {
+      OS_FutexWake(waiters, 1);
+   }
+
+   return(left);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwInit
+
+   Purpose: Sets up an unlocked reader-writer lock. With prefer_writer set, a
+            reader does not take the lock while a writer is waiting for it. The
+            waiter and user counts are kept, see OS_rwlock_t.
+---------------------------------------------------------------------------------------*/
+void OS_RwInit (OS_rwlock_t *rw, int prefer_writer)
+{
+   rw->read_seq      = 0;
+   rw->write_seq     = 0;
+   rw->prefer_writer = prefer_writer;
+   rw->writer        = NULL;
+   OS_AtomicStore(&rw->state, 0);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwDestroy
+
+   Purpose: Destroys a lock that nobody holds. Tasks still blocked on it return
+            OS_SEM_FAILURE, and it returns once they and every call counted in
+            by OS_RwEnter have left it. The last one to leave wakes the caller.
+
+   Returns: OS_SEM_FAILURE if the lock is held
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RwDestroy (OS_rwlock_t *rw)
+{
+   OS_futex_t state = 0;
+   OS_futex_t waiters;
+
+   if ( !OS_AtomicCas(&rw->state, &state, OS_RW_DESTROYED) )
+   {
+      return(OS_SEM_FAILURE);
+   }
+
+   OS_AtomicAdd(&rw->read_seq, 1);
+   OS_AtomicAdd(&rw->write_seq, 1);
+   OS_FutexWake(&rw->read_seq, INT_MAX);
+   OS_FutexWake(&rw->write_seq, INT_MAX);
+
+   /* The writers first, a writer that leaves may still wake the readers */
+   while ( (waiters = OS_AtomicLoad(&rw->write_waiters)) != 0 )
+   {
+      OS_FutexWait(&rw->write_waiters, waiters, NULL);
+   }
+
+   while ( (waiters = OS_AtomicLoad(&rw->read_waiters)) != 0 )
+   {
+      OS_FutexWait(&rw->read_waiters, waiters, NULL);
+   }
+
+   while ( (waiters = OS_AtomicLoad(&rw->users)) != 0 )
+   {
+      OS_FutexWait(&rw->users, waiters, NULL);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwEnter / OS_RwLeave
+
+   Purpose: Count a call that was handed the ID of the lock in and out of its
+            users. A call that checks the ID again after OS_RwEnter is waited
+            for by OS_RwDestroy, or sees that the ID has gone stale.
+---------------------------------------------------------------------------------------*/
+void OS_RwEnter (OS_rwlock_t *rw)
+{
+   OS_AtomicAdd(&rw->users, 1);
+}
+
+void OS_RwLeave (OS_rwlock_t *rw)
+{
+   if ( OS_AtomicSub(&rw->users, 1) == 0 &&
+        OS_AtomicLoad(&rw->state) == OS_RW_DESTROYED )
+   {
+      OS_FutexWake(&rw->users, 1);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwTryRead
+
+   Purpose: Takes the lock for reading if no writer holds it, and with writer
+            preference no writer is waiting for it, without blocking
+
+   Returns: TRUE if the lock was taken
+---------------------------------------------------------------------------------------*/
+int OS_RwTryRead (OS_rwlock_t *rw)
+{
+   OS_futex_t state;
+
+   state = OS_AtomicLoad(&rw->state);
+   while ( !(state & OS_RW_WRITER) )
+   {
+      if ( rw->prefer_writer && OS_AtomicLoad(&rw->write_waiters) != 0 )
+      {
+         return(FALSE);
+      }
+
+      if ( OS_AtomicCas(&rw->state, &state, state + 1) )
+      {
+         return(TRUE);
+      }
+   }
+
+   return(FALSE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwTryWrite
+
+   Purpose: Takes the lock for writing if nobody holds it, without blocking
+
+   Returns: TRUE if the lock was taken
+---------------------------------------------------------------------------------------*/
+int OS_RwTryWrite (OS_rwlock_t *rw)
+{
+   OS_futex_t state = 0;
+
+   if ( OS_AtomicCas(&rw->state, &state, OS_RW_WRITER) )
+   {
+      rw->writer = &OS_lwmutex_self;
+      return(TRUE);
+   }
+
+   return(FALSE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwReadLock
+
+   Purpose: Takes the lock for reading, blocking until it can or the absolute
+            CLOCK_MONOTONIC deadline passes. A NULL deadline waits forever.
+
+   Returns: OS_SUCCESS if the lock was taken
+            OS_SEM_TIMEOUT if the deadline passed first
+            OS_SEM_FAILURE if the lock was destroyed, or the caller holds it for
+            writing
+---------------------------------------------------------------------------------------*/
+int32 OS_RwReadLock (OS_rwlock_t *rw, const struct timespec *deadline)
+{
+   OS_futex_t seq;
+   int32      status;
+
+   if ( OS_RwTryRead(rw) )
+   {
+      return(OS_SUCCESS);
+   }
+
+   if ( rw->writer == &OS_lwmutex_self )
+   {
+      return(OS_SEM_FAILURE);
+   }
+
+   OS_AtomicAdd(&rw->read_waiters, 1);
+
+   for ( ;; )
+   {
+      seq = OS_AtomicLoad(&rw->read_seq);
+
+      if ( OS_AtomicLoad(&rw->state) == OS_RW_DESTROYED )
+      {
+         status = OS_SEM_FAILURE;
+         break;
+      }
+
+      if ( OS_RwTryRead(rw) )
+      {
+         status = OS_SUCCESS;
+         break;
+      }
+
+      if ( OS_FutexWait(&rw->read_seq, seq, deadline) == OS_ERROR_TIMEOUT )
+      {
+         status = OS_RwTryRead(rw) ? OS_SUCCESS : OS_SEM_TIMEOUT;
+         break;
+      }
+   }
+
+   OS_RwStopWaiting(rw, &rw->read_waiters);
+
+   return(status);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwWriteLock
+
+   Purpose: Takes the lock for writing, blocking until nobody holds it or the
+            absolute CLOCK_MONOTONIC deadline passes. A NULL deadline waits
+            forever.
+
+   Returns: OS_SUCCESS if the lock was taken
+            OS_SEM_TIMEOUT if the deadline passed first
+            OS_SEM_FAILURE if the lock was destroyed, or the caller holds it for
+            writing
+---------------------------------------------------------------------------------------*/
+int32 OS_RwWriteLock (OS_rwlock_t *rw, const struct timespec *deadline)
+{
+   OS_futex_t seq;
+   int32      status;
+
+   if ( OS_RwTryWrite(rw) )
+   {
+      return(OS_SUCCESS);
+   }
+
+   if ( rw->writer == &OS_lwmutex_self )
+   {
+      return(OS_SEM_FAILURE);
+   }
+
+   OS_AtomicAdd(&rw->write_waiters, 1);
+
+   for ( ;; )
+   {
+      seq = OS_AtomicLoad(&rw->write_seq);
+
+      if ( OS_AtomicLoad(&rw->state) == OS_RW_DESTROYED )
+      {
+         status = OS_SEM_FAILURE;
+         break;
+      }
+
+      if ( OS_RwTryWrite(rw) )
+      {
+         status = OS_SUCCESS;
+         break;
+      }
+
+      if ( OS_FutexWait(&rw->write_seq, seq, deadline) == OS_ERROR_TIMEOUT )
+      {
+         status = OS_RwTryWrite(rw) ? OS_SUCCESS : OS_SEM_TIMEOUT;
+         break;
+      }
+   }
+
+   /*
+   ** With writer preference the readers may be held back by this task alone,
+   ** they are let go when the last waiting writer leaves without the lock.
+   ** The task counts as a blocked reader while it wakes them, so a destroy
+   ** does not return before it is done with the lock.
+   */
+   if ( status != OS_SUCCESS && rw->prefer_writer )
+   {
+      OS_AtomicAdd(&rw->read_waiters, 1);
+      if ( OS_RwStopWaiting(rw, &rw->write_waiters) == 0 )
+      {
+         OS_RwWakeReaders(rw);
+      }
+      OS_RwStopWaiting(rw, &rw->read_waiters);
+   }
+   else
+   {
+      OS_RwStopWaiting(rw, &rw->write_waiters);
+   }
+
+   return(status);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwUnlock
+
+   Purpose: Gives back the lock. The calling task gives back its write take if
+            it holds the lock for writing, and a read take otherwise. The last
+            reader out wakes a writer. A writer wakes the next writer when
+            writers are preferred or no reader is waiting, and wakes all the
+            readers otherwise.
+
+   Returns: OS_SEM_FAILURE if the lock is not held, or another task holds it
+            for writing
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_RwUnlock (OS_rwlock_t *rw)
+{
+   OS_futex_t state;
+
+   if ( rw->writer == &OS_lwmutex_self )
+   {
+      rw->writer = NULL;
+      OS_AtomicStore(&rw->state, 0);
+      OS_AtomicFence();
+
+      if ( OS_AtomicLoad(&rw->write_waiters) != 0 &&
+           (rw->prefer_writer || OS_AtomicLoad(&rw->read_waiters) == 0) )
+      {
+         OS_RwWakeWriter(rw);
+      }
+      else
+      {
+         OS_RwWakeReaders(rw);
+      }
+
+      return(OS_SUCCESS);
+   }
+
+   state = OS_AtomicLoad(&rw->state);
+   do
+   {
+      if ( (state & OS_RW_WRITER) || state == 0 )
+      {
+         return(OS_SEM_FAILURE);
+      }
+   } while ( !OS_AtomicCas(&rw->state, &state, state - 1) );
+
+   if ( state == 1 )
+   {
+      OS_RwWakeWriter(rw);
+   }
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwIsWriter
+
+   Purpose: Returns TRUE if the calling thread holds the lock for writing
+---------------------------------------------------------------------------------------*/
+int OS_RwIsWriter (OS_rwlock_t *rw)
+{
+   return(rw->writer == &OS_lwmutex_self);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_RwGetReaders
+
+   Purpose: Returns the number of read takes held on the lock
+---------------------------------------------------------------------------------------*/
+uint32 OS_RwGetReaders (OS_rwlock_t *rw)
+{
+   OS_futex_t state;
+
+   state = OS_AtomicLoad(&rw->state);
+
+   return((state & OS_RW_WRITER) ? 0 : state);
+}
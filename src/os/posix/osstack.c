@@ -0,0 +1,381 @@
+/*
+** File   : osstack.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the task stacks managed by OSAL: the painting
+**          that shows how deep a stack was ever used, and the stack arena that
+**          OS_TaskCreate takes stacks from when OS_STACK_ARENA_SIZE is defined.
+**
+**          The arena is mapped once. A stack is a block of whole pages in it,
+**          with its guard pages at the low end. The thread library keeps the
+**          thread descriptor at the top of a stack it is handed, so a block is
+**          only reused once the thread that ran on it is gone, not when its
+**          task is deleted.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+#ifdef OS_STACK_ARENA_SIZE
+#ifndef _LINUX_OS_
+#error "OS_STACK_ARENA_SIZE is only supported on Linux"
+#endif
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#define OS_STACK_PAINT 0xA5A5A5A5U
+
+#ifdef OS_STACK_ARENA_SIZE
+
+/*
+** A task's block is retired when the task is deleted, and freed once its
+** thread is gone, so there can be a block for every task and one more for
+** every task deleted since
+*/
+#define OS_STACK_MAX_BLOCKS (OS_MAX_TASKS * 2)
+
+#define OS_STACK_BLOCK_FREE     0
+#define OS_STACK_BLOCK_USED     1
+#define OS_STACK_BLOCK_RETIRED  2
+
+/****************************************************************************************
+                                    LOCAL TYPEDEFS
+****************************************************************************************/
+
+/*
+** A block of the arena. offset and size are in bytes and include the guard
+** pages. tid is the thread that runs on the block, 0 until it has started.
+*/
+typedef struct
+{
+   uint32        offset;
+   uint32        size;
+   int           state;
+   volatile int  tid;
+
+} OS_stack_block_t;
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+static char            *OS_stack_arena = NULL;
+static uint32           OS_stack_page_size;
+static OS_stack_block_t OS_stack_blocks[OS_STACK_MAX_BLOCKS];
+
+/*
+** The Mutex for protecting the above table
+*/
+static pthread_mutex_t  OS_stack_mut;
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackReclaim
+
+   Purpose: Frees the retired blocks whose threads have exited. Called with
+            OS_stack_mut held.
+---------------------------------------------------------------------------------------*/
+static void OS_StackReclaim (void)
+{
+   OS_stack_block_t *blk;
+   uint32            i;
+
+   for ( i = 0; i < OS_STACK_MAX_BLOCKS; i++ )
+   {
+      blk = &OS_stack_blocks[i];
+
+      /* A signal 0 checks that the thread exists without sending anything */
+      if ( blk->state == OS_STACK_BLOCK_RETIRED && blk->tid != 0 &&
+           syscall(SYS_tgkill, getpid(), blk->tid, 0) != 0 && errno == ESRCH )
+      {
+         blk->state = OS_STACK_BLOCK_FREE;
+      }
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackFindRoom
+
+   Purpose: Finds the lowest offset of the arena where size bytes are not used
+            by any block. Called with OS_stack_mut held.
+
+   Returns: TRUE if there is room, with the offset in *offset
+---------------------------------------------------------------------------------------*/
+static int OS_StackFindRoom (uint32 size, uint32 *offset)
+{
+   OS_stack_block_t *blk;
+   uint32            start = 0;
+   uint32            i;
+   int               moved;
+
+   do
+   {
+      if ( start + size > OS_STACK_ARENA_SIZE )
+      {
+         return(FALSE);
+      }
+
+      moved = FALSE;
+      for ( i = 0; i < OS_STACK_MAX_BLOCKS; i++ )
+      {
+         blk = &OS_stack_blocks[i];
+         if ( blk->state != OS_STACK_BLOCK_FREE &&
+              blk->offset < start + size && start < blk->offset + blk->size )
+         {
+            start = blk->offset + blk->size;
+            moved = TRUE;
+         }
+      }
+   } while ( moved );
+
+   *offset = start;
+   return(TRUE);
+}
+
+#endif
+
+/****************************************************************************************
+                                    STACK ARENA
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackArenaInit
+
+   Purpose: Maps the stack arena, and locks it into RAM when
+            OS_STACK_ARENA_LOCKED is defined. A failure to lock is reported
+            and the arena is used unlocked. The arena is kept when OS_API_Init
+            is called again.
+
+   Returns: OS_ERROR if the arena could not be mapped
+            OS_SUCCESS if success, or if there is no arena
+---------------------------------------------------------------------------------------*/
+int32 OS_StackArenaInit (void)
+{
+#ifdef OS_STACK_ARENA_SIZE
+   void *arena;
+
+   if ( OS_stack_arena != NULL )
+   {
+      return(OS_SUCCESS);
+   }
+
+   OS_stack_page_size = (uint32) sysconf(_SC_PAGESIZE);
+
+   arena = mmap(NULL, OS_STACK_ARENA_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+   if ( arena == MAP_FAILED )
+   {
+      printf("OS_StackArenaInit: Error mapping a stack arena of %lu bytes\n",
+             (unsigned long) OS_STACK_ARENA_SIZE);
+      return(OS_ERROR);
+   }
+
+#ifdef OS_STACK_ARENA_LOCKED
+   if ( mlock(arena, OS_STACK_ARENA_SIZE) != 0 )
+   {
+      perror("OS_StackArenaInit: mlock");
+   }
+#endif
+
+   if ( pthread_mutex_init(&OS_stack_mut, NULL) != 0 )
+   {
+      munmap(arena, OS_STACK_ARENA_SIZE);
+      return(OS_ERROR);
+   }
+
+   memset(OS_stack_blocks, 0, sizeof(OS_stack_blocks));
+   OS_stack_arena = arena;
+#endif
+
+   return(OS_SUCCESS);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackAlloc
+
+   Purpose: Takes a stack of at least size bytes from the arena. *base is set to
+            its lowest address above the guard pages and *alloc_size to its size,
+            size rounded up to whole pages. *block identifies it for
+            OS_StackSetThread, OS_StackRelease and OS_StackFree.
+
+   Returns: OS_ERR_NOT_IMPLEMENTED if there is no stack arena
+            OS_ERROR if the arena has no room left
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_StackAlloc (uint32 size, void **base, uint32 *alloc_size, uint32 *block)
+{
+#ifdef OS_STACK_ARENA_SIZE
+   OS_stack_block_t *blk = NULL;
+   uint32            guard = OS_STACK_GUARD_PAGES * OS_stack_page_size;
+   uint32            offset;
+   uint32            i;
+
+   if ( OS_stack_arena == NULL )
+   {
+      return(OS_ERR_NOT_IMPLEMENTED);
+   }
+
+   size = (size + OS_stack_page_size - 1) & ~(OS_stack_page_size - 1);
+
+   pthread_mutex_lock(&OS_stack_mut);
+
+   OS_StackReclaim();
+
+   for ( i = 0; i < OS_STACK_MAX_BLOCKS; i++ )
+   {
+      if ( OS_stack_blocks[i].state == OS_STACK_BLOCK_FREE )
+      {
+         blk = &OS_stack_blocks[i];
+         break;
+      }
+   }
+
+   if ( blk == NULL || !OS_StackFindRoom(guard + size, &offset) )
+   {
+      pthread_mutex_unlock(&OS_stack_mut);
+      return(OS_ERROR);
+   }
+
+   blk->offset = offset;
+   blk->size   = guard + size;
+   blk->state  = OS_STACK_BLOCK_USED;
+   blk->tid    = 0;
+
+   pthread_mutex_unlock(&OS_stack_mut);
+
+   /* The guard pages of an earlier block may lie where this stack is now */
+   mprotect(OS_stack_arena + offset, guard + size, PROT_READ | PROT_WRITE);
+   if ( guard != 0 )
+   {
+      mprotect(OS_stack_arena + offset, guard, PROT_NONE);
+   }
+
+   *base       = OS_stack_arena + offset + guard;
+   *alloc_size = size;
+   *block      = i;
+
+   return(OS_SUCCESS);
+#else
+   return(OS_ERR_NOT_IMPLEMENTED);
+#endif
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackSetThread
+
+   Purpose: Records the thread running on a block. Called by the thread itself
+            when it starts.
+---------------------------------------------------------------------------------------*/
+void OS_StackSetThread (uint32 block, int tid)
+{
+#ifdef OS_STACK_ARENA_SIZE
+   if ( block < OS_STACK_MAX_BLOCKS )
+   {
+      OS_AtomicStore(&OS_stack_blocks[block].tid, tid);
+   }
+#endif
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackRelease
+
+   Purpose: Gives back the block of a task that is being deleted or is exiting.
+            The block is reused once its thread is gone. A block that no thread
+            ever recorded itself on is free at once.
+---------------------------------------------------------------------------------------*/
+void OS_StackRelease (uint32 block)
+{
+#ifdef OS_STACK_ARENA_SIZE
+   if ( block < OS_STACK_MAX_BLOCKS )
+   {
+      pthread_mutex_lock(&OS_stack_mut);
+      if ( OS_AtomicLoad(&OS_stack_blocks[block].tid) == 0 )
+      {
+         OS_stack_blocks[block].state = OS_STACK_BLOCK_FREE;
+      }
+      else
+      {
+         OS_stack_blocks[block].state = OS_STACK_BLOCK_RETIRED;
+      }
+      pthread_mutex_unlock(&OS_stack_mut);
+   }
+#endif
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackFree
+
+   Purpose: Gives back a block that no thread ever ran on, for a task that
+            could not be created. It can be reused at once.
+---------------------------------------------------------------------------------------*/
+void OS_StackFree (uint32 block)
+{
+#ifdef OS_STACK_ARENA_SIZE
+   if ( block < OS_STACK_MAX_BLOCKS )
+   {
+      pthread_mutex_lock(&OS_stack_mut);
+      OS_stack_blocks[block].state = OS_STACK_BLOCK_FREE;
+      pthread_mutex_unlock(&OS_stack_mut);
+   }
+#endif
+}
+
+/****************************************************************************************
+                                   STACK PAINTING
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackPaint
+
+   Purpose: Fills a stack that no thread runs on yet with the paint pattern
+---------------------------------------------------------------------------------------*/
+void OS_StackPaint (void *base, uint32 size)
+{
+   memset(base, (int) (OS_STACK_PAINT & 0xFF), size);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_StackUsed
+
+   Purpose: Returns the most bytes of a painted stack that were ever used. The
+            stack grows down, so the paint is scanned from the lowest address
+            up to the first word that was written.
+---------------------------------------------------------------------------------------*/
+uint32 OS_StackUsed (const void *base, uint32 size)
+{
+   const volatile unsigned int *word = (const volatile unsigned int *) base;
+   uint32                       words = size / sizeof(unsigned int);
+   uint32                       i;
+
+   for ( i = 0; i < words && word[i] == OS_STACK_PAINT; i++ )
+   {
+   }
+
+   return(size - (i * sizeof(unsigned int)));
+}
@@ -13,9 +13,21 @@
 **
 ** Purpose: This file contains the OSAL Timer API for POSIX systems.
 **            
-**          This implementation depends on the POSIX Timer API which may not be available
-**          in older versions of the Linux kernel. It was developed and tested on
-**          RHEL 5 ./ CentOS 5 with Linux kernel 2.6.18
+**          The timers are kept on a hierarchical timing wheel served by one
+**          timer service task, so a timer needs no signal or kernel timer of
+**          its own. Level 0 of the wheel has a slot for each of the next 256
+**          ticks of OS_TIMER_WHEEL_TICK_USECS, and each higher level has 64
+**          slots that each span a whole turn of the level below. Arming or
+**          cancelling a timer links or unlinks it from one slot. When the
+**          service reaches the end of a turn it moves the timers of the next
+**          slot of the level above down the wheel.
+**
+**          The service task sleeps until the exact deadline of the earliest
+**          timer in the next occupied slot and fires the timers that are due.
+**          The callbacks run in timer dispatch tasks, one for each callback
+**          priority in use, which take the expired timers off their queue in
+**          order. A timer that expires again before its callback has started
+**          is not queued twice, the callback is told the number of overruns.
 */
 
 /****************************************************************************************
@@ -24,6 +36,7 @@
 
 #include "common_types.h"
 #include "osapi.h"
+#include "osprivate.h"
 
 #include <string.h>
 #include <unistd.h>
@@ -31,8 +44,6 @@
 #include <stdio.h>
 #include <limits.h>
 #include <time.h>
-#include <sys/signal.h>
-#include <sys/errno.h>
 #include <pthread.h>
 
 
@@ -56,17 +67,6 @@ void  OS_UsecToTimespec(uint32 usecs, struct timespec *time_spec);
                                      DEFINES
 ****************************************************************************************/
 
-#ifdef _MAC_OS_
-   #define OS_STARTING_SIGNAL 32
-#else
-   /*
-   ** The timers use the RT Signals. The system that this code was developed
-   ** and tested on has 32 available RT signals ( SIGRTMIN -> SIGRTMAX ).
-   ** OS_MAX_TIMERS should not be set to more than this number.
-   */
-   #define OS_STARTING_SIGNAL  (SIGRTMAX-1)
-#endif
-
 /*
 ** Since the API is storing the timer values in a 32 bit integer as Microseconds, 
 ** there is a limit to the number of seconds that can be represented.
@@ -75,10 +75,41 @@ void  OS_UsecToTimespec(uint32 usecs, struct timespec *time_spec);
 
 #define UNINITIALIZED 0
 
+/*
+** The timing wheel. Slots 0 to 255 are level 0, then come the 64 slots of
+** each higher level. A timer further away than the whole wheel waits in the
+** last slot it can reach and is placed again when that slot is cascaded.
+*/
+#define OS_WHEEL_L0_BITS     8
+#define OS_WHEEL_L0_SIZE     (1 << OS_WHEEL_L0_BITS)
+#define OS_WHEEL_L0_MASK     (OS_WHEEL_L0_SIZE - 1)
+#define OS_WHEEL_LN_BITS     6
+#define OS_WHEEL_LN_SIZE     (1 << OS_WHEEL_LN_BITS)
+#define OS_WHEEL_LN_MASK     (OS_WHEEL_LN_SIZE - 1)
+#define OS_WHEEL_LEVELS      5
+#define OS_WHEEL_SLOTS       (OS_WHEEL_L0_SIZE + (OS_WHEEL_LEVELS - 1) * OS_WHEEL_LN_SIZE)
+#define OS_WHEEL_SHIFT(l)    (OS_WHEEL_L0_BITS + ((l) - 1) * OS_WHEEL_LN_BITS)
+#define OS_WHEEL_SPAN(l)     (1ULL << (OS_WHEEL_L0_BITS + (l) * OS_WHEEL_LN_BITS))
+
+#define OS_TIMER_NONE        0xFFFFFFFF
+#define OS_TIMER_NEVER       0xFFFFFFFFFFFFFFFFULL
+
 /****************************************************************************************
                                     LOCAL TYPEDEFS 
 ****************************************************************************************/
 
+/*
+** deadline is the CLOCK_MONOTONIC time of the next expiration in nanoseconds
+** and expires the wheel tick it falls in. next and prev link the timer into
+** wheel slot slot, OS_TIMER_NONE while it is not armed. While the timer is
+** queued on its dispatch task dispatch_next links it into the queue, overruns
+** counts the expirations merged into the queued one and fire_deadline is the
+** deadline of the latest. generation changes when the timer is deleted, so a
+** callback that deletes its own timer does not add to the statistics of the
+** next timer in the slot. expirations counts the expirations that
+** OS_WaitMultiple has not taken yet, it takes them all at once, and wait is the source for the tasks
+** waiting on the timer there.
+*/
 typedef struct 
 {
    uint32              free;
@@ -87,11 +118,52 @@ typedef struct
    uint32              start_time;
    uint32              interval_time;
    uint32              accuracy;
+   uint64              start_ns;
    OS_TimerCallback_t  callback_ptr;
-   uint32              host_timerid;
+   OS_TimerCallbackEx_t callback_ex;
+   void               *callback_arg;
+   uint32              dispatcher;
+   uint64              deadline;
+   uint64              interval_ns;
+   uint64              expires;
+   uint32              next;
+   uint32              prev;
+   uint32              slot;
+   uint32              generation;
+   uint32              queued;
+   uint32              dispatch_next;
+   uint32              overruns;
+   uint64              fire_deadline;
+   OS_timer_stats_t    stats;
+   uint64              latency_total;
+   uint64              runtime_total;
+   volatile OS_futex_t expirations;
+   OS_wait_source_t    wait;
 
 } OS_timer_record_t;
 
+/*
+** A timer dispatch task and the queue of timers waiting for their callback in
+** it, from head to tail. It sleeps on seq while sleeping is set. running is
+** the timer whose callback it is running. done_seq is bumped after every
+** callback, and woken when deleters tasks are waiting in OS_TimerDelete for
+** the callback to return.
+*/
+typedef struct
+{
+   uint32              started;
+   uint32              task_id;
+   uint32              priority;
+   uint32              head;
+   uint32              tail;
+   uint32              sleeping;
+   volatile OS_futex_t seq;
+   volatile uint32     running;
+   volatile OS_futex_t done_seq;
+   uint32              deleters;
+
+} OS_timer_dispatch_t;
+
 /****************************************************************************************
                                    GLOBAL DATA
 ****************************************************************************************/
@@ -99,11 +171,58 @@ typedef struct
 OS_timer_record_t OS_timer_table[OS_MAX_TIMERS];
 uint32           os_clock_accuracy;
 
+/*
+** The resolution of the timer clock in nanoseconds
+*/
+static uint64    OS_timer_resolution_ns;
+
 /*
 ** The Mutex for protecting the above table
 */
 pthread_mutex_t    OS_timer_table_mut;
 
+/*
+** The registry that hands out timer table slots and indexes the timer names
+*/
+static OS_registry_t OS_timer_registry;
+
+/*
+** The timing wheel and the arming state of the timers, guarded by
+** OS_timer_wheel_mut. The mutex is never initialized again, since the
+** service task keeps running if OS_API_Init is called again. The wheel has
+** processed every tick before OS_timer_wheel_now, and tick 0 starts at the
+** CLOCK_MONOTONIC time OS_timer_wheel_base. OS_timer_wheel_bits marks the
+** level 0 slots that hold a timer.
+*/
+static pthread_mutex_t OS_timer_wheel_mut = PTHREAD_MUTEX_INITIALIZER;
+static uint32          OS_timer_wheel[OS_WHEEL_SLOTS];
+static uint64          OS_timer_wheel_bits[OS_WHEEL_L0_SIZE / 64];
+static uint64          OS_timer_wheel_now;
+static uint64          OS_timer_wheel_cascaded;
+static uint64          OS_timer_wheel_base;
+static uint64          OS_timer_wheel_tick_ns;
+static uint32          OS_timer_wheel_armed;
+
+/*
+** The timer service task. It sleeps on OS_timer_service_seq until
+** OS_timer_service_wake, 0 while it is awake, and an arm that is due sooner
+** wakes it. The timers that expire in one pass wait in the fire list to
+** have their OS_WaitMultiple waiters woken.
+*/
+static int                 OS_timer_service_started = FALSE;
+static uint64              OS_timer_service_wake;
+static volatile OS_futex_t OS_timer_service_seq;
+static uint32              OS_timer_fire_id[OS_MAX_TIMERS];
+
+/*
+** The timer dispatch tasks, guarded by OS_timer_wheel_mut. Like the service
+** task they are started when first needed and keep running if OS_API_Init is
+** called again. OS_timer_dispatch_self is the dispatch task of the calling
+** task, if it is one.
+*/
+static OS_timer_dispatch_t            OS_timer_dispatch[OS_MAX_TIMER_DISPATCHERS];
+static __thread OS_timer_dispatch_t  *OS_timer_dispatch_self;
+
 /****************************************************************************************
                                 INITIALIZATION FUNCTION
 ****************************************************************************************/
@@ -117,20 +236,53 @@ int32  OS_TimerAPIInit ( void )
    int32  return_code = OS_SUCCESS;
 
    /*
-   ** Mark all timers as available
+   ** Mark all timers as available, on an empty wheel
    */
+   pthread_mutex_lock(&OS_timer_wheel_mut);
+
    for ( i = 0; i < OS_MAX_TIMERS; i++ )
    {
-      OS_timer_table[i].free      = TRUE;
-      OS_timer_table[i].creator   = UNINITIALIZED;
+      OS_timer_table[i].free       = TRUE;
+      OS_timer_table[i].creator    = UNINITIALIZED;
+      OS_timer_table[i].slot       = OS_TIMER_NONE;
+      OS_timer_table[i].generation = 0;
       strcpy(OS_timer_table[i].name,"");
+      OS_timer_table[i].queued     = FALSE;
+      OS_WaitSourceInit(&OS_timer_table[i].wait);
 
    }
+
+   for ( i = 0; i < OS_MAX_TIMER_DISPATCHERS; i++ )
+   {
+      OS_timer_dispatch[i].head = OS_TIMER_NONE;
+      OS_timer_dispatch[i].tail = OS_TIMER_NONE;
+   }
+
+   for ( i = 0; i < OS_WHEEL_SLOTS; i++ )
+   {
+      OS_timer_wheel[i] = OS_TIMER_NONE;
+   }
+   memset(OS_timer_wheel_bits, 0, sizeof(OS_timer_wheel_bits));
+
+   OS_timer_wheel_now      = 0;
+   OS_timer_wheel_cascaded = OS_TIMER_NEVER;
+   OS_timer_wheel_base     = OS_MonotonicNow();
+   OS_timer_wheel_tick_ns  = (uint64) OS_TIMER_WHEEL_TICK_USECS * 1000;
+   OS_timer_wheel_armed    = 0;
+
+   pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+   if ( OS_RegistryInit(&OS_timer_registry, OS_OBJECT_TYPE_TIMER,
+                        OS_MAX_TIMERS, OS_MAX_API_NAME) != OS_SUCCESS )
+   {
+      OS_printf("OS_TimerAPIInit: Error allocating the timer registry\n");
+      return(OS_ERROR);
+   }
 #ifdef _LINUX_OS_	
    /*
-   ** get the resolution of the realtime clock
+   ** get the resolution of the monotonic clock the timers run on
    */
-   status = clock_getres(CLOCK_REALTIME, &clock_resolution);
+   status = clock_getres(CLOCK_MONOTONIC, &clock_resolution);
    if ( status < 0 )
    {
       OS_printf("OS_TimerAPIInit: Error calling clock_getres\n");
@@ -142,6 +294,8 @@ int32  OS_TimerAPIInit ( void )
       ** Convert to microseconds
       */
       OS_TimespecToUsec(clock_resolution, &os_clock_accuracy);
+      OS_timer_resolution_ns = (uint64) clock_resolution.tv_sec * 1000000000ULL +
+                               (uint64) clock_resolution.tv_nsec;
    
       /*
       ** Create the Timer Table mutex
@@ -156,6 +310,7 @@ int32  OS_TimerAPIInit ( void )
 #else  /* _MAC_OS_ */
 
    os_clock_accuracy = 10000;
+   OS_timer_resolution_ns = 10000000;
 
 #endif
    
@@ -167,27 +322,665 @@ int32  OS_TimerAPIInit ( void )
                                 INTERNAL FUNCTIONS
 ****************************************************************************************/
 
-/*
-** Timer Signal Handler.
-** The purpose of this function is to convert the POSIX signal number to the 
-** OSAL signal number and pass it to the User defined signal handler.
-*/
-void OS_TimerSignalHandler(int signum)
+/******************************************************************************
+ **  Function:  OS_TimerWheelLink / OS_TimerWheelUnlink
+ **
+ **  Purpose:  Add a timer to the front of a wheel slot, or take it off the
+ **            slot it is in. The caller holds OS_timer_wheel_mut.
+ */
+static void OS_TimerWheelLink(uint32 timer_id, uint32 slot)
+{
+   OS_timer_record_t *timer = &OS_timer_table[timer_id];
+
+   timer->slot = slot;
+   timer->prev = OS_TIMER_NONE;
+   timer->next = OS_timer_wheel[slot];
+   if ( timer->next != OS_TIMER_NONE )
+   {
+      OS_timer_table[timer->next].prev = timer_id;
+   }
+   OS_timer_wheel[slot] = timer_id;
+
+   if ( slot < OS_WHEEL_L0_SIZE )
+   {
+      OS_timer_wheel_bits[slot / 64] |= 1ULL << (slot % 64);
+   }
+}
+
+static void OS_TimerWheelUnlink(uint32 timer_id)
+{
+   OS_timer_record_t *timer = &OS_timer_table[timer_id];
+   uint32             slot  = timer->slot;
+
+   if ( slot == OS_TIMER_NONE )
+   {
+      return;
+   }
+
+   if ( timer->prev != OS_TIMER_NONE )
+   {
+      OS_timer_table[timer->prev].next = timer->next;
+   }
+   else
+   {
+      OS_timer_wheel[slot] = timer->next;
+   }
+   if ( timer->next != OS_TIMER_NONE )
+   {
+      OS_timer_table[timer->next].prev = timer->prev;
+   }
+
+   if ( slot < OS_WHEEL_L0_SIZE && OS_timer_wheel[slot] == OS_TIMER_NONE )
+   {
+      OS_timer_wheel_bits[slot / 64] &= ~(1ULL << (slot % 64));
+   }
+
+   timer->slot = OS_TIMER_NONE;
+   OS_timer_wheel_armed--;
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelInsert
+ **
+ **  Purpose:  Put an unlinked timer in the slot of its expiration tick. A timer
+ **            that is already due goes in the slot of the current tick.
+ */
+static void OS_TimerWheelInsert(uint32 timer_id)
 {
-   uint32  timer_id;
+   uint64 expires = OS_timer_table[timer_id].expires;
+   uint64 delta;
+   uint32 level;
+
+   if ( expires < OS_timer_wheel_now )
+   {
+      expires = OS_timer_wheel_now;
+   }
+   delta = expires - OS_timer_wheel_now;
 
-   timer_id = OS_STARTING_SIGNAL - signum;
+   OS_timer_wheel_armed++;
 
-   if ( timer_id  < OS_MAX_TIMERS )
+   if ( delta < OS_WHEEL_L0_SIZE )
    {
-      if ( OS_timer_table[timer_id].free == FALSE )
+      OS_TimerWheelLink(timer_id, (uint32) (expires & OS_WHEEL_L0_MASK));
+      return;
+   }
+
+   for ( level = 1; level < OS_WHEEL_LEVELS - 1; level++ )
+   {
+      if ( delta < OS_WHEEL_SPAN(level) )
       {
-         (OS_timer_table[timer_id].callback_ptr)(timer_id);
+         break;
       }
    }
 
+   if ( delta >= OS_WHEEL_SPAN(level) )
+   {
+      expires = OS_timer_wheel_now + OS_WHEEL_SPAN(level) - 1;
+   }
+
+   OS_TimerWheelLink(timer_id, OS_WHEEL_L0_SIZE + (level - 1) * OS_WHEEL_LN_SIZE +
+                               (uint32) ((expires >> OS_WHEEL_SHIFT(level)) & OS_WHEEL_LN_MASK));
 }
- 
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelCascade
+ **
+ **  Purpose:  Move the timers of one slot of a higher level down the wheel.
+ **            Returns the index of the slot in its level.
+ */
+static uint32 OS_TimerWheelCascade(uint32 level)
+{
+   uint32 index;
+   uint32 slot;
+   uint32 timer_id;
+   uint32 next;
+
+   index = (uint32) ((OS_timer_wheel_now >> OS_WHEEL_SHIFT(level)) & OS_WHEEL_LN_MASK);
+   slot  = OS_WHEEL_L0_SIZE + (level - 1) * OS_WHEEL_LN_SIZE + index;
+
+   timer_id = OS_timer_wheel[slot];
+   OS_timer_wheel[slot] = OS_TIMER_NONE;
+
+   while ( timer_id != OS_TIMER_NONE )
+   {
+      next = OS_timer_table[timer_id].next;
+      OS_timer_table[timer_id].slot = OS_TIMER_NONE;
+      OS_timer_wheel_armed--;
+      OS_TimerWheelInsert(timer_id);
+      timer_id = next;
+   }
+
+   return(index);
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelNextTick
+ **
+ **  Purpose:  Returns the next tick the wheel has to process: the current one
+ **            if it starts a turn that was not cascaded yet, else the next
+ **            occupied level 0 slot of this turn, else the start of the next
+ **            turn.
+ */
+static uint64 OS_TimerWheelNextTick(void)
+{
+   uint64 now = OS_timer_wheel_now;
+   uint64 bits;
+   uint32 index;
+
+   if ( (now & OS_WHEEL_L0_MASK) == 0 && OS_timer_wheel_cascaded != now )
+   {
+      return(now);
+   }
+
+   for ( index = (uint32) (now & OS_WHEEL_L0_MASK); index < OS_WHEEL_L0_SIZE;
+         index = (index | 63) + 1 )
+   {
+      bits = OS_timer_wheel_bits[index / 64] >> (index % 64);
+      if ( bits != 0 )
+      {
+         return((now & ~(uint64) OS_WHEEL_L0_MASK) + index + __builtin_ctzll(bits));
+      }
+   }
+
+   return((now | OS_WHEEL_L0_MASK) + 1);
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelNextWake
+ **
+ **  Purpose:  Returns the CLOCK_MONOTONIC time the service has to wake at: the
+ **            earliest deadline in the next occupied slot, or the start of the
+ **            next turn. OS_TIMER_NEVER if no timer is armed.
+ */
+static uint64 OS_TimerWheelNextWake(void)
+{
+   uint64 tick;
+   uint64 wake;
+   uint32 timer_id;
+
+   if ( OS_timer_wheel_armed == 0 )
+   {
+      return(OS_TIMER_NEVER);
+   }
+
+   tick = OS_TimerWheelNextTick();
+   wake = OS_timer_wheel_base + tick * OS_timer_wheel_tick_ns;
+
+   if ( (tick & OS_WHEEL_L0_MASK) == 0 && OS_timer_wheel_cascaded != tick )
+   {
+      return(wake);
+   }
+
+   timer_id = OS_timer_wheel[tick & OS_WHEEL_L0_MASK];
+   if ( timer_id != OS_TIMER_NONE )
+   {
+      wake = OS_timer_table[timer_id].deadline;
+      for ( ; timer_id != OS_TIMER_NONE; timer_id = OS_timer_table[timer_id].next )
+      {
+         if ( OS_timer_table[timer_id].deadline < wake )
+         {
+            wake = OS_timer_table[timer_id].deadline;
+         }
+      }
+   }
+
+   return(wake);
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelArm
+ **
+ **  Purpose:  Arm a timer to expire at the CLOCK_MONOTONIC time deadline, and
+ **            wake the service task if it sleeps past it. The caller holds
+ **            OS_timer_wheel_mut.
+ */
+static void OS_TimerWheelArm(uint32 timer_id, uint64 deadline)
+{
+   OS_timer_record_t *timer = &OS_timer_table[timer_id];
+
+   OS_TimerWheelUnlink(timer_id);
+
+   /*
+   ** An empty wheel jumps to the current tick, rather than stepping
+   ** through the turns it was idle for
+   */
+   if ( OS_timer_wheel_armed == 0 && deadline > OS_timer_wheel_base )
+   {
+      OS_timer_wheel_now = (OS_MonotonicNow() - OS_timer_wheel_base) / OS_timer_wheel_tick_ns;
+      OS_timer_wheel_cascaded = OS_timer_wheel_now;
+   }
+
+   timer->deadline = deadline;
+   timer->expires  = 0;
+   if ( deadline > OS_timer_wheel_base )
+   {
+      timer->expires = (deadline - OS_timer_wheel_base) / OS_timer_wheel_tick_ns;
+   }
+   OS_TimerWheelInsert(timer_id);
+
+   if ( deadline < OS_timer_service_wake )
+   {
+      OS_timer_service_wake = 0;
+      OS_AtomicAdd(&OS_timer_service_seq, 1);
+      OS_FutexWake(&OS_timer_service_seq, 1);
+   }
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerDispatchQueue
+ **
+ **  Purpose:  Queue an expiration of a timer on its dispatch task. missed is
+ **            the number of expirations before it that the service skipped.
+ **            If the timer is still queued from an earlier expiration, the
+ **            two are merged and counted as overruns. The caller holds
+ **            OS_timer_wheel_mut.
+ */
+static void OS_TimerDispatchQueue(uint32 timer_id, uint64 deadline, uint32 missed)
+{
+   OS_timer_record_t   *timer      = &OS_timer_table[timer_id];
+   OS_timer_dispatch_t *dispatcher = &OS_timer_dispatch[timer->dispatcher];
+
+   timer->stats.expirations += missed + 1;
+   timer->fire_deadline      = deadline;
+
+   if ( timer->queued )
+   {
+      timer->overruns       += missed + 1;
+      timer->stats.overruns += missed + 1;
+      return;
+   }
+
+   timer->overruns        = missed;
+   timer->stats.overruns += missed;
+   timer->queued          = TRUE;
+   timer->dispatch_next   = OS_TIMER_NONE;
+
+   if ( dispatcher->tail == OS_TIMER_NONE )
+   {
+      dispatcher->head = timer_id;
+   }
+   else
+   {
+      OS_timer_table[dispatcher->tail].dispatch_next = timer_id;
+   }
+   dispatcher->tail = timer_id;
+
+   if ( dispatcher->sleeping )
+   {
+      dispatcher->sleeping = FALSE;
+      OS_AtomicAdd(&dispatcher->seq, 1);
+      OS_FutexWake(&dispatcher->seq, 1);
+   }
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerDispatchRemove
+ **
+ **  Purpose:  Take a timer that is being deleted off the queue of its dispatch
+ **            task. The caller holds OS_timer_wheel_mut.
+ */
+static void OS_TimerDispatchRemove(uint32 timer_id)
+{
+   OS_timer_dispatch_t *dispatcher = &OS_timer_dispatch[OS_timer_table[timer_id].dispatcher];
+   uint32               prev       = OS_TIMER_NONE;
+   uint32               id;
+
+   if ( !OS_timer_table[timer_id].queued )
+   {
+      return;
+   }
+
+   for ( id = dispatcher->head; id != timer_id; id = OS_timer_table[id].dispatch_next )
+   {
+      prev = id;
+   }
+
+   if ( prev == OS_TIMER_NONE )
+   {
+      dispatcher->head = OS_timer_table[timer_id].dispatch_next;
+   }
+   else
+   {
+      OS_timer_table[prev].dispatch_next = OS_timer_table[timer_id].dispatch_next;
+   }
+   if ( dispatcher->tail == timer_id )
+   {
+      dispatcher->tail = prev;
+   }
+
+   OS_timer_table[timer_id].queued = FALSE;
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerWheelExpire
+ **
+ **  Purpose:  Process the wheel up to the CLOCK_MONOTONIC time now_ns. The
+ **            timers that are due are queued on their dispatch tasks and put
+ **            in the fire list, and periodic ones armed again. Returns the
+ **            number of timers in the fire list.
+ */
+static uint32 OS_TimerWheelExpire(uint64 now_ns)
+{
+   OS_timer_record_t *timer;
+   uint64             cur_tick = 0;
+   uint64             tick;
+   uint64             fired;
+   uint64             missed;
+   uint32             count = 0;
+   uint32             level;
+   uint32             slot;
+   uint32             timer_id;
+   uint32             next;
+
+   if ( now_ns > OS_timer_wheel_base )
+   {
+      cur_tick = (now_ns - OS_timer_wheel_base) / OS_timer_wheel_tick_ns;
+   }
+
+   while ( OS_timer_wheel_armed != 0 )
+   {
+      tick = OS_TimerWheelNextTick();
+      if ( tick > cur_tick )
+      {
+         /* nothing until then, so no turn is skipped */
+         if ( cur_tick > OS_timer_wheel_now )
+         {
+            OS_timer_wheel_now = cur_tick;
+         }
+         break;
+      }
+
+      OS_timer_wheel_now = tick;
+
+      if ( (tick & OS_WHEEL_L0_MASK) == 0 && OS_timer_wheel_cascaded != tick )
+      {
+         OS_timer_wheel_cascaded = tick;
+         for ( level = 1; level < OS_WHEEL_LEVELS; level++ )
+         {
+            if ( OS_TimerWheelCascade(level) != 0 )
+            {
+               break;
+            }
+         }
+      }
+
+      /*
+      ** Fire what is due in the slot. A timer due later in this same tick
+      ** stays, and the service sleeps until its deadline.
+      */
+      slot = (uint32) (tick & OS_WHEEL_L0_MASK);
+      for ( timer_id = OS_timer_wheel[slot]; timer_id != OS_TIMER_NONE; timer_id = next )
+      {
+         timer = &OS_timer_table[timer_id];
+         next  = timer->next;
+
+         if ( timer->deadline > now_ns )
+         {
+            continue;
+         }
+
+         OS_TimerWheelUnlink(timer_id);
+         OS_timer_fire_id[count++] = timer_id;
+         fired  = timer->deadline;
+         missed = 0;
+
+         if ( timer->interval_ns != 0 )
+         {
+            /*
+            ** Expirations missed while the service was late are skipped and
+            ** counted as overruns, the timer keeps its phase
+            */
+            timer->deadline += timer->interval_ns;
+            if ( timer->deadline <= now_ns )
+            {
+               missed = (now_ns - timer->deadline) / timer->interval_ns + 1;
+               timer->deadline += missed * timer->interval_ns;
+               fired = timer->deadline - timer->interval_ns;
+            }
+            timer->expires = (timer->deadline - OS_timer_wheel_base) / OS_timer_wheel_tick_ns;
+            OS_TimerWheelInsert(timer_id);
+         }
+
+         OS_TimerDispatchQueue(timer_id, fired, (uint32) missed);
+      }
+
+      if ( OS_timer_wheel[slot] != OS_TIMER_NONE && OS_timer_wheel_now == tick &&
+           tick == cur_tick )
+      {
+         break;
+      }
+
+      OS_timer_wheel_now = tick + 1;
+   }
+
+   if ( OS_timer_wheel_armed == 0 && cur_tick > OS_timer_wheel_now )
+   {
+      OS_timer_wheel_now = cur_tick;
+   }
+
+   return(count);
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerServiceTask
+ **
+ **  Purpose:  The timer service task. It processes the wheel, wakes the
+ **            OS_WaitMultiple waiters of the timers that expired without
+ **            holding the wheel mutex, and sleeps until the next timer is due.
+ */
+static void OS_TimerServiceTask(void)
+{
+   OS_timer_record_t *timer;
+   struct timespec    deadline;
+   OS_futex_t         seq;
+   uint64             wake;
+   uint32             count;
+   uint32             i;
+
+   pthread_mutex_lock(&OS_timer_wheel_mut);
+
+   for ( ;; )
+   {
+      count = OS_TimerWheelExpire(OS_MonotonicNow());
+
+      if ( count != 0 )
+      {
+         pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+         for ( i = 0; i < count; i++ )
+         {
+            timer = &OS_timer_table[OS_timer_fire_id[i]];
+            OS_AtomicAdd(&timer->expirations, 1);
+            OS_WaitNotify(&timer->wait);
+         }
+
+         pthread_mutex_lock(&OS_timer_wheel_mut);
+         continue;
+      }
+
+      wake = OS_TimerWheelNextWake();
+      OS_timer_service_wake = wake;
+      seq = OS_AtomicLoad(&OS_timer_service_seq);
+
+      pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+      if ( wake == OS_TIMER_NEVER )
+      {
+         OS_FutexWait(&OS_timer_service_seq, seq, NULL);
+      }
+      else
+      {
+         deadline.tv_sec  = wake / 1000000000ULL;
+         deadline.tv_nsec = wake % 1000000000ULL;
+         OS_FutexWait(&OS_timer_service_seq, seq, &deadline);
+      }
+
+      pthread_mutex_lock(&OS_timer_wheel_mut);
+      OS_timer_service_wake = 0;
+   }
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerDispatchTask
+ **
+ **  Purpose:  A timer dispatch task. It runs the callbacks of the timers on
+ **            its queue in order, without holding the wheel mutex, and keeps
+ **            their latency and runtime statistics.
+ */
+static void OS_TimerDispatchTask(void)
+{
+   OS_timer_dispatch_t *dispatcher = NULL;
+   OS_timer_record_t   *timer;
+   OS_futex_t           seq;
+   uint64               deadline;
+   uint64               start;
+   uint64               latency;
+   uint64               runtime;
+   uint32               timer_id;
+   uint32               generation;
+   uint32               overruns;
+   uint32               self;
+   uint32               i;
+
+   /*
+   ** The creator fills in the task id before it lets go of the mutex
+   */
+   self = OS_TaskGetId();
+   pthread_mutex_lock(&OS_timer_wheel_mut);
+
+   for ( i = 0; i < OS_MAX_TIMER_DISPATCHERS; i++ )
+   {
+      if ( OS_timer_dispatch[i].started && OS_timer_dispatch[i].task_id == self )
+      {
+         dispatcher = &OS_timer_dispatch[i];
+      }
+   }
+   OS_timer_dispatch_self = dispatcher;
+
+   for ( ;; )
+   {
+      if ( dispatcher->head == OS_TIMER_NONE )
+      {
+         dispatcher->sleeping = TRUE;
+         seq = OS_AtomicLoad(&dispatcher->seq);
+         pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+         OS_FutexWait(&dispatcher->seq, seq, NULL);
+
+         pthread_mutex_lock(&OS_timer_wheel_mut);
+         continue;
+      }
+
+      timer_id = dispatcher->head;
+      timer    = &OS_timer_table[timer_id];
+
+      dispatcher->head = timer->dispatch_next;
+      if ( dispatcher->head == OS_TIMER_NONE )
+      {
+         dispatcher->tail = OS_TIMER_NONE;
+      }
+
+      timer->queued       = FALSE;
+      overruns            = timer->overruns;
+      deadline            = timer->fire_deadline;
+      generation          = timer->generation;
+      dispatcher->running = timer_id;
+
+      pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+      start = OS_MonotonicNow();
+      if ( timer->callback_ex != NULL )
+      {
+         (timer->callback_ex)(timer_id, overruns, timer->callback_arg);
+      }
+      else
+      {
+         (timer->callback_ptr)(timer_id);
+      }
+      runtime = OS_MonotonicNow() - start;
+      latency = start > deadline ? start - deadline : 0;
+
+      pthread_mutex_lock(&OS_timer_wheel_mut);
+      dispatcher->running = OS_TIMER_NONE;
+
+      OS_AtomicAdd(&dispatcher->done_seq, 1);
+      if ( dispatcher->deleters != 0 )
+      {
+         OS_FutexWake(&dispatcher->done_seq, INT_MAX);
+      }
+
+      if ( timer->generation == generation )
+      {
+         timer->stats.callbacks++;
+         timer->latency_total += latency;
+         timer->runtime_total += runtime;
+         if ( latency / 1000 > timer->stats.max_latency_usecs )
+         {
+            timer->stats.max_latency_usecs = (uint32) (latency / 1000);
+         }
+         if ( runtime / 1000 > timer->stats.max_runtime_usecs )
+         {
+            timer->stats.max_runtime_usecs = (uint32) (runtime / 1000);
+         }
+      }
+   }
+}
+
+/******************************************************************************
+ **  Function:  OS_TimerDispatchStart
+ **
+ **  Purpose:  Returns the dispatch task for the callbacks of a priority, and
+ **            starts it if there is none yet. The caller holds
+ **            OS_timer_wheel_mut.
+ */
+static int32 OS_TimerDispatchStart(uint32 priority, uint32 *dispatcher)
+{
+   char   name[OS_MAX_API_NAME];
+   uint32 i;
+   int32  status;
+
+   for ( i = 0; i < OS_MAX_TIMER_DISPATCHERS; i++ )
+   {
+      if ( OS_timer_dispatch[i].started && OS_timer_dispatch[i].priority == priority )
+      {
+         *dispatcher = i;
+         return(OS_SUCCESS);
+      }
+   }
+
+   for ( i = 0; i < OS_MAX_TIMER_DISPATCHERS; i++ )
+   {
+      if ( !OS_timer_dispatch[i].started )
+      {
+         break;
+      }
+   }
+   if ( i == OS_MAX_TIMER_DISPATCHERS )
+   {
+      return(OS_TIMER_ERR_UNAVAILABLE);
+   }
+
+   OS_timer_dispatch[i].priority = priority;
+   OS_timer_dispatch[i].head     = OS_TIMER_NONE;
+   OS_timer_dispatch[i].tail     = OS_TIMER_NONE;
+   OS_timer_dispatch[i].sleeping = FALSE;
+   OS_timer_dispatch[i].running  = OS_TIMER_NONE;
+   OS_timer_dispatch[i].deleters = 0;
+
+   sprintf(name, "OS_TimerDispatch%u", (unsigned int) i);
+   status = OS_TaskCreate(&OS_timer_dispatch[i].task_id, name, OS_TimerDispatchTask, NULL,
+                          OS_TIMER_DISPATCH_STACK_SIZE, priority, 0);
+   if ( status != OS_SUCCESS )
+   {
+      return(status == OS_ERR_INVALID_PRIORITY ? status : OS_TIMER_ERR_UNAVAILABLE);
+   }
+
+   OS_timer_dispatch[i].started = TRUE;
+   *dispatcher = i;
+
+   return(OS_SUCCESS);
+}
+
 /******************************************************************************
  **  Function:  OS_UsecToTimespec
  **
@@ -236,6 +1029,23 @@ void  OS_TimespecToUsec(struct timespec time_spec, uint32 *usecs)
    }
 }
 
+/******************************************************************************
+ **  Function:  OS_TimerNsToUsec
+ **
+ **  Purpose:  Convert nanoseconds to the 32 bit microseconds of
+ **            OS_timer_prop_t, which stop at about 71 minutes.
+ **
+ */
+static uint32 OS_TimerNsToUsec(uint64 nsecs)
+{
+   if ( nsecs > 0xFFFFFFFFULL * 1000 )
+   {
+      return(0xFFFFFFFF);
+   }
+
+   return((uint32) ((nsecs + 999) / 1000));
+}
+
 
 
 /****************************************************************************************
@@ -243,24 +1053,24 @@ void  OS_TimespecToUsec(struct timespec time_spec, uint32 *usecs)
 ****************************************************************************************/
 
 /******************************************************************************
-**  Function:  OS_TimerCreate
+**  Function:  OS_TimerCreateCommon
 **
-**  Purpose:  Create a new OSAL Timer
+**  Purpose:  Create a new OSAL Timer with either kind of callback, run by the
+**            dispatch task of priority. The first timer created starts the
+**            timer service task.
 **
 **  Arguments:
 **
 **  Return:
 */
-int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy, OS_TimerCallback_t  callback_ptr)
+static int32 OS_TimerCreateCommon(uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy,
+                                  OS_TimerCallback_t callback_ptr, OS_TimerCallbackEx_t callback_ex,
+                                  void *callback_arg, uint32 priority)
 {
    uint32             possible_tid;
-   int32              i;
-
-#ifndef _MAC_OS_
-   int                status;
-   struct  sigaction  sig_act;
-   struct  sigevent   evp;
-#endif
+   uint32             service_id;
+   uint32             dispatcher;
+   int32              return_code;
 
    if ( timer_id == NULL || timer_name == NULL)
    {
@@ -271,51 +1081,56 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name, uint32 *clock_acc
    ** we don't want to allow names too long
    ** if truncated, two names might be the same 
    */
-   if (strlen(timer_name) > OS_MAX_API_NAME)
+   if (strlen(timer_name) >= OS_MAX_API_NAME)
    {
       return OS_ERR_NAME_TOO_LONG;
    }
 
-   /* 
-   ** Check Parameters 
+   /*
+   ** Verify callback parameter
    */
-   pthread_mutex_lock(&OS_timer_table_mut); 
-    
-   for(possible_tid = 0; possible_tid < OS_MAX_TIMERS; possible_tid++)
+   if (callback_ptr == NULL && callback_ex == NULL) 
    {
-      if (OS_timer_table[possible_tid].free == TRUE)
-         break;
+      return OS_TIMER_ERR_INVALID_ARGS;
+   }    
+
+   /*
+   ** Start the service task and the dispatch task. They are never stopped,
+   ** and not started again if OS_API_Init is called again.
+   */
+   pthread_mutex_lock(&OS_timer_wheel_mut);
+   if ( !OS_timer_service_started )
+   {
+      if ( OS_TaskCreate(&service_id, "OS_TimerService", OS_TimerServiceTask, NULL,
+                         OS_TIMER_SERVICE_STACK_SIZE, OS_TIMER_SERVICE_PRIORITY, 0)
+           != OS_SUCCESS )
+      {
+         pthread_mutex_unlock(&OS_timer_wheel_mut);
+         return ( OS_TIMER_ERR_UNAVAILABLE);
+      }
+      OS_timer_service_started = TRUE;
    }
 
+   return_code = OS_TimerDispatchStart(priority, &dispatcher);
+   pthread_mutex_unlock(&OS_timer_wheel_mut);
 
-   if( possible_tid >= OS_MAX_TIMERS || OS_timer_table[possible_tid].free != TRUE)
+   if (return_code != OS_SUCCESS)
    {
-        pthread_mutex_unlock(&OS_timer_table_mut);
-        return OS_ERR_NO_FREE_IDS;
+      return return_code;
    }
 
    /* 
-   ** Check to see if the name is already taken 
+   ** Check Parameters 
    */
-   for (i = 0; i < OS_MAX_TIMERS; i++)
+   pthread_mutex_lock(&OS_timer_table_mut); 
+    
+   return_code = OS_RegistryAlloc(&OS_timer_registry, timer_name, &possible_tid);
+   if (return_code != OS_SUCCESS)
    {
-       if ((OS_timer_table[i].free == FALSE) &&
-            strcmp ((char*) timer_name, OS_timer_table[i].name) == 0)
-       {
-            pthread_mutex_unlock(&OS_timer_table_mut);
-            return OS_ERR_NAME_TAKEN;
-       }
+       pthread_mutex_unlock(&OS_timer_table_mut);
+       return return_code;
    }
 
-   /*
-   ** Verify callback parameter
-   */
-   if (callback_ptr == NULL ) 
-   {
-      pthread_mutex_unlock(&OS_timer_table_mut);
-      return OS_TIMER_ERR_INVALID_ARGS;
-   }    
-
    /* 
    ** Set the possible timer Id to not free so that
    ** no other task can try to use it 
@@ -323,47 +1138,24 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name, uint32 *clock_acc
    OS_timer_table[possible_tid].free = FALSE;
    pthread_mutex_unlock(&OS_timer_table_mut);
    OS_timer_table[possible_tid].creator = OS_FindCreator();
-
+   strncpy(OS_timer_table[possible_tid].name, timer_name, OS_MAX_API_NAME);
 
    OS_timer_table[possible_tid].start_time = 0;
    OS_timer_table[possible_tid].interval_time = 0;
+   OS_timer_table[possible_tid].start_ns = 0;
+   OS_timer_table[possible_tid].interval_ns = 0;
+   OS_timer_table[possible_tid].accuracy = os_clock_accuracy;
+   OS_timer_table[possible_tid].expirations = 0;
+   OS_timer_table[possible_tid].overruns = 0;
+   OS_timer_table[possible_tid].latency_total = 0;
+   OS_timer_table[possible_tid].runtime_total = 0;
+   memset(&OS_timer_table[possible_tid].stats, 0, sizeof(OS_timer_stats_t));
+   OS_timer_table[possible_tid].stats.dispatch_priority = priority;
     
    OS_timer_table[possible_tid].callback_ptr = callback_ptr;
-
-#ifndef _MAC_OS_  
-   /*
-   **  Initialize the sigaction and sigevent structures for the handler.
-   */
-   sigemptyset(&sig_act.sa_mask);
-   sig_act.sa_handler = OS_TimerSignalHandler;
-   sig_act.sa_flags = 0;
-
-   evp.sigev_notify = SIGEV_SIGNAL; 
-   evp.sigev_signo = OS_STARTING_SIGNAL - possible_tid;
-
-   /*
-   ** Create the timer
-   */
-   status = timer_create(CLOCK_REALTIME, &evp, (timer_t *)&(OS_timer_table[possible_tid].host_timerid));
-   if (status < 0) 
-   {
-      OS_timer_table[possible_tid].free = TRUE;
-      return ( OS_TIMER_ERR_UNAVAILABLE);
-   }
-   
-   /*
-   ** Set the signal action for the timer
-   */
-   sigaction(OS_STARTING_SIGNAL - possible_tid, &(sig_act), 0); 
-
-#else
-   /*
-   ** Create the timer
-   */
-   OS_printf("OSAL: Timer API is not implemented on OS X!\n");
-   OS_printf("OSAL: The Timers can be created, deleted, etc, but they will trigger or call the callbacks!\n");
-
-#endif
+   OS_timer_table[possible_tid].callback_ex = callback_ex;
+   OS_timer_table[possible_tid].callback_arg = callback_arg;
+   OS_timer_table[possible_tid].dispatcher = dispatcher;
 
    /*
    ** Return the clock accuracy to the user
@@ -379,22 +1171,66 @@ int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name, uint32 *clock_acc
 }
 
 /******************************************************************************
-**  Function:  OS_TimerSet
+**  Function:  OS_TimerCreate
 **
-**  Purpose:  
+**  Purpose:  Create a new OSAL Timer. Its callback runs in the dispatch task
+**            of priority OS_TIMER_DISPATCH_PRIORITY.
 **
 **  Arguments:
-**    (none)
 **
 **  Return:
+*/
+int32 OS_TimerCreate(uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy, OS_TimerCallback_t  callback_ptr)
+{
+   return OS_TimerCreateCommon(timer_id, timer_name, clock_accuracy, callback_ptr, NULL, NULL,
+                               OS_TIMER_DISPATCH_PRIORITY);
+}
+
+/******************************************************************************
+**  Function:  OS_TimerCreateEx
+**
+**  Purpose:  Create a new OSAL Timer whose callback runs in the dispatch task of
+**            the given OSAL priority, and is passed callback_arg and the
+**            number of overruns. The timers of one priority share a dispatch
+**            task, and at most OS_MAX_TIMER_DISPATCHERS priorities can be in
+**            use.
+**
+**  Arguments:
+**
+**  Return:
+**    OS_TIMER_ERR_UNAVAILABLE if there is no dispatch task for priority and
+**    no more can be started
+**    OS_ERR_INVALID_PRIORITY if priority is not a valid OSAL priority
+*/
+int32 OS_TimerCreateEx(uint32 *timer_id, const char *timer_name, uint32 *clock_accuracy,
+                       OS_TimerCallbackEx_t callback_ptr, void *callback_arg, uint32 priority)
+{
+   if (callback_ptr == NULL)
+   {
+      return OS_TIMER_ERR_INVALID_ARGS;
+   }
+
+   return OS_TimerCreateCommon(timer_id, timer_name, clock_accuracy, NULL, callback_ptr,
+                               callback_arg, priority);
+}
+
+/******************************************************************************
+**  Function:  OS_TimerSetNs
+**
+**  Purpose:  Arm a timer to expire start_nsecs nanoseconds from now, and then
+**            every interval_nsecs nanoseconds if that is not 0. A start_nsecs
+**            of 0 disarms the timer. Both times can be up to
+**            OS_TIMER_MAX_NSECS, more than a century.
+**
+**  Arguments:
 **    (none)
+**
+**  Return:
+**    OS_TIMER_ERR_INVALID_ARGS if a time is over OS_TIMER_MAX_NSECS
 */
-int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time)
+int32 OS_TimerSetNs(uint32 timer_id, uint64 start_nsecs, uint64 interval_nsecs)
 {
-#ifndef _MAC_OS_
-   int    status;
-   struct itimerspec timeout;
-#endif
+   OS_timer_record_t *timer;
 
    /* 
    ** Check to see if the timer_id given is valid 
@@ -404,55 +1240,77 @@ int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time)
       return OS_ERR_INVALID_ID;
    }
 
+   if (start_nsecs > OS_TIMER_MAX_NSECS || interval_nsecs > OS_TIMER_MAX_NSECS)
+   {
+      return OS_TIMER_ERR_INVALID_ARGS;
+   }
+
+   timer = &OS_timer_table[timer_id];
+
    /*
    ** Round up the accuracy of the start time and interval times 
    */
-   if (( start_time > 0 ) && ( start_time < os_clock_accuracy ))
+   if (( start_nsecs > 0 ) && ( start_nsecs < OS_timer_resolution_ns ))
    {
-      start_time = os_clock_accuracy;
+      start_nsecs = OS_timer_resolution_ns;
    }
  
-   if (( interval_time > 0) && ( interval_time < os_clock_accuracy ))
+   if (( interval_nsecs > 0) && ( interval_nsecs < OS_timer_resolution_ns ))
    {
-      interval_time = os_clock_accuracy;
+      interval_nsecs = OS_timer_resolution_ns;
    }
 
-   /*
-   ** Save the start and interval times 
-   */
-   OS_timer_table[timer_id].start_time = start_time;
-   OS_timer_table[timer_id].interval_time = interval_time;
+   pthread_mutex_lock(&OS_timer_wheel_mut);
 
-#ifndef _MAC_OS_
-   /*
-   ** Convert from Microseconds to timespec structures
-   */
-   OS_UsecToTimespec(start_time, &(timeout.it_value));
-   OS_UsecToTimespec(interval_time, &(timeout.it_interval));
-	
    /*
-   ** Program the real timer
+   ** Save the start and interval times, in microseconds as well for
+   ** OS_TimerGetInfo
    */
-   status = timer_settime((timer_t)(OS_timer_table[timer_id].host_timerid), 
-                             0,              /* Flags field can be zero */
-                             &timeout,       /* struct itimerspec */
-		             NULL);         /* Oldvalue */
-   if (status < 0) 
+   timer->start_ns      = start_nsecs;
+   timer->interval_ns   = interval_nsecs;
+   timer->start_time    = OS_TimerNsToUsec(start_nsecs);
+   timer->interval_time = OS_TimerNsToUsec(interval_nsecs);
+   OS_AtomicStore(&timer->expirations, 0);
+
+   if ( start_nsecs == 0 )
    {
-      return ( OS_TIMER_ERR_INTERNAL);
+      OS_TimerWheelUnlink(timer_id);
    }
-#else
-   OS_printf("OSAL: Timer API is not implemented on OS X!\n");
-#endif
+   else
+   {
+      OS_TimerWheelArm(timer_id, OS_MonotonicNow() + start_nsecs);
+   }
+
+   pthread_mutex_unlock(&OS_timer_wheel_mut);
 	
    return OS_SUCCESS;
 }
 
+/******************************************************************************
+**  Function:  OS_TimerSet
+**
+**  Purpose:  Arm a timer to expire start_time microseconds from now, and then
+**            every interval_time microseconds if that is not 0. A start_time
+**            of 0 disarms the timer.
+**
+**  Arguments:
+**    (none)
+**
+**  Return:
+**    (none)
+*/
+int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time)
+{
+   return OS_TimerSetNs(timer_id, (uint64) start_time * 1000, (uint64) interval_time * 1000);
+}
+
 
 /******************************************************************************
 **  Function:  OS_TimerDelete
 **
-**  Purpose: 
+**  Purpose:  Delete a timer. If its callback is running in a dispatch task,
+**            the delete returns once the callback has, unless it is called
+**            from that dispatch task.
 **
 **  Arguments:
 **    (none)
@@ -462,7 +1320,8 @@ int32 OS_TimerSet(uint32 timer_id, uint32 start_time, uint32 interval_time)
 */
 int32 OS_TimerDelete(uint32 timer_id)
 {
-   int status;
+   OS_timer_dispatch_t *dispatcher;
+   OS_futex_t           done;
 
    /* 
    ** Check to see if the timer_id given is valid 
@@ -473,19 +1332,44 @@ int32 OS_TimerDelete(uint32 timer_id)
    }
 
    /*
-   ** Delete the timer 
+   ** Take the timer off the wheel, and drop an expiration that is queued
+   ** for its callback but not delivered yet
    */
-#ifdef _MAC_OS_
-   status = 0;
-#else
-   status = timer_delete((timer_t)(OS_timer_table[timer_id].host_timerid));
-#endif
-   OS_timer_table[timer_id].free = TRUE;
-   if (status < 0)
+   pthread_mutex_lock(&OS_timer_wheel_mut);
+
+   OS_TimerWheelUnlink(timer_id);
+   OS_TimerDispatchRemove(timer_id);
+   OS_timer_table[timer_id].generation++;
+
+   /*
+   ** Sleep until the callback returns. done_seq is read under the mutex, so
+   ** the bump after the callback is not missed.
+   */
+   dispatcher = &OS_timer_dispatch[OS_timer_table[timer_id].dispatcher];
+   while ( dispatcher->running == timer_id && OS_timer_dispatch_self != dispatcher )
    {
-      return ( OS_TIMER_ERR_INTERNAL);
+      done = OS_AtomicLoad(&dispatcher->done_seq);
+      dispatcher->deleters++;
+      pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+      OS_FutexWait(&dispatcher->done_seq, done, NULL);
+
+      pthread_mutex_lock(&OS_timer_wheel_mut);
+      dispatcher->deleters--;
    }
-	
+
+   pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+   pthread_mutex_lock(&OS_timer_table_mut); 
+   OS_timer_table[timer_id].free = TRUE;
+   OS_RegistryFree(&OS_timer_registry, timer_id);
+   pthread_mutex_unlock(&OS_timer_table_mut);
+
+   /*
+   ** Tasks in OS_WaitMultiple on the timer see that it is gone
+   */
+   OS_WaitNotify(&OS_timer_table[timer_id].wait);
+
    return OS_SUCCESS;
 }
 
@@ -504,7 +1388,7 @@ int32 OS_TimerDelete(uint32 timer_id)
 */
 int32 OS_TimerGetIdByName (uint32 *timer_id, const char *timer_name)
 {
-    uint32 i;
+    int32 status;
 
     if (timer_id == NULL || timer_name == NULL)
     {
@@ -515,26 +1399,16 @@ int32 OS_TimerGetIdByName (uint32 *timer_id, const char *timer_name)
     ** a name too long wouldn't have been allowed in the first place
     ** so we definitely won't find a name too long
     */
-    if (strlen(timer_name) > OS_MAX_API_NAME)
+    if (strlen(timer_name) >= OS_MAX_API_NAME)
     {
         return OS_ERR_NAME_TOO_LONG;
     }
 
-    for (i = 0; i < OS_MAX_TIMERS; i++)
-    {
-        if (OS_timer_table[i].free != TRUE &&
-                (strcmp (OS_timer_table[i].name , (char*) timer_name) == 0))
-        {
-            *timer_id = i;
-            return OS_SUCCESS;
-        }
-    }
-   
-    /* 
-    ** The name was not found in the table,
-    **  or it was, and the sem_id isn't valid anymore 
-    */
-    return OS_ERR_NAME_NOT_FOUND;
+    pthread_mutex_lock(&OS_timer_table_mut); 
+    status = OS_RegistryFind(&OS_timer_registry, timer_name, timer_id);
+    pthread_mutex_unlock(&OS_timer_table_mut);
+
+    return status;
     
 }/* end OS_TimerGetIdByName */
 
@@ -573,6 +1447,8 @@ int32 OS_TimerGetInfo (uint32 timer_id, OS_timer_prop_t *timer_prop)
     timer_prop ->start_time    = OS_timer_table[timer_id].start_time;
     timer_prop ->interval_time = OS_timer_table[timer_id].interval_time;
     timer_prop ->accuracy      = OS_timer_table[timer_id].accuracy;
+    timer_prop ->start_nsecs    = OS_timer_table[timer_id].start_ns;
+    timer_prop ->interval_nsecs = OS_timer_table[timer_id].interval_ns;
     
     pthread_mutex_unlock(&OS_timer_table_mut);
 
@@ -580,3 +1456,83 @@ int32 OS_TimerGetInfo (uint32 timer_id, OS_timer_prop_t *timer_prop)
     
 } /* end OS_TimerGetInfo */
 
+/***************************************************************************************
+**    Name: OS_TimerGetStats
+**
+**    Purpose: This function will pass back the callback statistics of the
+**             specified timer, kept since it was created.
+**             
+**    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid timer 
+**             OS_INVALID_POINTER if the timer_stats pointer is null
+**             OS_SUCCESS if success
+*/
+int32 OS_TimerGetStats (uint32 timer_id, OS_timer_stats_t *timer_stats)
+{
+    OS_timer_record_t *timer;
+
+    if (timer_id >= OS_MAX_TIMERS || OS_timer_table[timer_id].free == TRUE)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    if (timer_stats == NULL)
+    {
+        return OS_INVALID_POINTER;
+    }
+
+    timer = &OS_timer_table[timer_id];
+
+    pthread_mutex_lock(&OS_timer_wheel_mut);
+
+    *timer_stats = timer->stats;
+    if (timer->stats.callbacks != 0)
+    {
+       timer_stats->avg_latency_usecs = (uint32) (timer->latency_total / timer->stats.callbacks / 1000);
+       timer_stats->avg_runtime_usecs = (uint32) (timer->runtime_total / timer->stats.callbacks / 1000);
+    }
+
+    pthread_mutex_unlock(&OS_timer_wheel_mut);
+
+    return OS_SUCCESS;
+
+} /* end OS_TimerGetStats */
+
+/***********************************************************************************
+**
+**    Name: OS_TimerWaitPoll
+**
+**    Purpose: Takes the expirations of a timer for OS_WaitMultiple without
+**             blocking. All the expirations since the last take are taken at
+**             once, and the number after the first is passed back in the
+**             result of the object as overruns, so a timer that is not waited
+**             on for a while does not leave a backlog of wakeups.
+**
+**    Returns: OS_ERR_INVALID_ID if the id passed in is not a valid timer
+**             OS_ERROR_TIMEOUT if the timer has not expired since the last one
+**             was taken, or since it was set
+**             OS_SUCCESS if expirations were taken
+*/
+int32 OS_TimerWaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
+{
+    OS_timer_record_t *timer;
+    OS_futex_t         expirations;
+
+    if (object->object_id >= OS_MAX_TIMERS || OS_timer_table[object->object_id].free == TRUE)
+    {
+       return OS_ERR_INVALID_ID;
+    }
+
+    timer   = &OS_timer_table[object->object_id];
+    *source = &timer->wait;
+
+    expirations = OS_AtomicExchange(&timer->expirations, 0);
+    if (expirations == 0)
+    {
+       return OS_ERROR_TIMEOUT;
+    }
+
+    object->result = expirations - 1;
+
+    return OS_SUCCESS;
+
+} /* end OS_TimerWaitPoll */
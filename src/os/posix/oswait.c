@@ -0,0 +1,381 @@
+/*
+** File   : oswait.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains OS_WaitMultiple, the wait on several queues,
+**          semaphores, event flag groups and timers at once, for POSIX systems.
+**
+**          A task that has to block takes a waiter from a fixed table and
+**          links one node of it into the wait source of each object. An event
+**          on an object sets the bit of every node linked to it in the ready
+**          words of the node's waiter and bumps the waiter's futex word. The
+**          waiter takes the ready words when it wakes and only polls the
+**          objects whose bits are set, however many objects it waits on.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+#include <string.h>
+#include <time.h>
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#define OS_WAIT_READY_BITS   32
+#define OS_WAIT_READY_WORDS  ((OS_MAX_WAIT_OBJECTS + OS_WAIT_READY_BITS - 1) / OS_WAIT_READY_BITS)
+
+/****************************************************************************************
+                                    LOCAL TYPEDEFS
+****************************************************************************************/
+
+/*
+** A task blocked in OS_WaitMultiple. nodes[i] and sources[i] belong to the
+** i-th object of the call, and bit i of the ready words is set when that
+** object has had an event since the waiter last looked.
+*/
+typedef struct
+{
+   volatile OS_futex_t in_use;
+   volatile OS_futex_t seq;
+   volatile OS_futex_t ready[OS_WAIT_READY_WORDS];
+   OS_wait_node_t      nodes[OS_MAX_WAIT_OBJECTS];
+   OS_wait_source_t   *sources[OS_MAX_WAIT_OBJECTS];
+
+} OS_waiter_t;
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+static OS_waiter_t OS_waiter_table[OS_MAX_WAITERS];
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitPoll
+
+   Purpose: Polls one object of OS_WaitMultiple with the poll call of its type
+
+   Returns: OS_ERROR if the object type is not valid, or the status of the poll
+---------------------------------------------------------------------------------------*/
+static int32 OS_WaitPoll (OS_wait_object_t *object, OS_wait_source_t **source)
+{
+   switch ( object->object_type )
+   {
+      case OS_WAIT_QUEUE:
+         return(OS_QueueWaitPoll(object, source));
+
+      case OS_WAIT_BINSEM:
+         return(OS_BinSemWaitPoll(object, source));
+
+      case OS_WAIT_COUNTSEM:
+         return(OS_CountSemWaitPoll(object, source));
+
+      case OS_WAIT_EVENTFLAGS:
+         return(OS_EventFlagsWaitPoll(object, source));
+
+      case OS_WAIT_TIMER:
+         return(OS_TimerWaitPoll(object, source));
+
+      default:
+         return(OS_ERROR);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitAllocWaiter
+
+   Purpose: Takes a free waiter from the table
+
+   Returns: the waiter, or NULL if they are all in use
+---------------------------------------------------------------------------------------*/
+static OS_waiter_t *OS_WaitAllocWaiter (void)
+{
+   OS_futex_t free_value;
+   uint32     i;
+
+   for ( i = 0; i < OS_MAX_WAITERS; i++ )
+   {
+      free_value = FALSE;
+      if ( OS_AtomicLoadRelaxed(&OS_waiter_table[i].in_use) == FALSE &&
+           OS_AtomicCas(&OS_waiter_table[i].in_use, &free_value, TRUE) )
+      {
+         return(&OS_waiter_table[i]);
+      }
+   }
+
+   return(NULL);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitLink
+
+   Purpose: Links node into the list of source
+---------------------------------------------------------------------------------------*/
+static void OS_WaitLink (OS_wait_source_t *source, OS_wait_node_t *node)
+{
+   OS_LwMutexLock(&source->lock);
+
+   node->prev = NULL;
+   node->next = source->head;
+   if ( source->head != NULL )
+   {
+      source->head->prev = node;
+   }
+   source->head = node;
+   OS_AtomicAdd(&source->watchers, 1);
+
+   OS_LwMutexUnlock(&source->lock);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitUnlink
+
+   Purpose: Takes node out of the list of source. Once it returns no notify
+            touches the node.
+---------------------------------------------------------------------------------------*/
+static void OS_WaitUnlink (OS_wait_source_t *source, OS_wait_node_t *node)
+{
+   OS_LwMutexLock(&source->lock);
+
+   if ( node->prev != NULL )
+   {
+      node->prev->next = node->next;
+   }
+   else
+   {
+      source->head = node->next;
+   }
+   if ( node->next != NULL )
+   {
+      node->next->prev = node->prev;
+   }
+   OS_AtomicSub(&source->watchers, 1);
+
+   OS_LwMutexUnlock(&source->lock);
+}
+
+/****************************************************************************************
+                                    WAIT SOURCES
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitSourceInit
+
+   Purpose: Sets up the wait source of an object table slot
+---------------------------------------------------------------------------------------*/
+void OS_WaitSourceInit (OS_wait_source_t *source)
+{
+   OS_LwMutexInit(&source->lock);
+   source->head = NULL;
+   OS_AtomicStore(&source->watchers, 0);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitNotifySource
+
+   Purpose: Marks the object of a source ready for every task waiting on it and
+            wakes them. It is only called through OS_WaitNotify, when there is a
+            watcher.
+---------------------------------------------------------------------------------------*/
+void OS_WaitNotifySource (OS_wait_source_t *source)
+{
+   OS_wait_node_t *node;
+
+   OS_LwMutexLock(&source->lock);
+
+   for ( node = source->head; node != NULL; node = node->next )
+   {
+      OS_AtomicOr(node->ready, node->bit);
+      OS_AtomicAdd(node->seq, 1);
+      OS_FutexWake(node->seq, 1);
+   }
+
+   OS_LwMutexUnlock(&source->lock);
+}
+
+/****************************************************************************************
+                                MULTIPLE OBJECT WAIT API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WaitMultiple
+
+   Purpose: Waits until one of count objects fires and takes its event: a message
+            from a queue, a token from a binary or counting semaphore, the flags
+            of an event flag group or the expirations of a timer. *fired is set
+            to the index of the object in objects. timeout is OS_PEND to wait
+            forever, OS_CHECK to only look, or a time in milliseconds.
+
+   Returns: OS_INVALID_POINTER if objects or fired is NULL
+            OS_ERROR if count is 0 or above OS_MAX_WAIT_OBJECTS
+            OS_ERR_INVALID_TIMEOUT if timeout is negative but not OS_CHECK
+            OS_ERR_NO_FREE_IDS if OS_MAX_WAITERS tasks are already blocked in it
+            OS_ERROR_TIMEOUT if no object fired in time
+            OS_SUCCESS if an object fired
+            Any other error is the error of object *fired: OS_ERR_INVALID_ID if
+            it is not valid or was deleted during the wait, OS_ERROR if its type,
+            event flags or options are not valid or it is a zero copy queue, or
+            an error of OS_QueueGet.
+
+   Notes: When several objects are ready at once the first one in objects is
+          taken. A binary semaphore flush does not end the wait.
+---------------------------------------------------------------------------------------*/
+int32 OS_WaitMultiple (OS_wait_object_t *objects, uint32 count, int32 timeout,
+                       uint32 *fired)
+{
+   OS_waiter_t      *waiter;
+   OS_wait_source_t *source;
+   struct timespec   deadline;
+   OS_futex_t        seq;
+   OS_futex_t        pending;
+   uint32            linked = 0;
+   uint32            i;
+   uint32            w;
+   int               timed_out = FALSE;
+   int32             status = OS_ERROR_TIMEOUT;
+
+   if ( objects == NULL || fired == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( count == 0 || count > OS_MAX_WAIT_OBJECTS )
+   {
+      return(OS_ERROR);
+   }
+
+   if ( timeout < 0 && timeout != OS_CHECK )
+   {
+      return(OS_ERR_INVALID_TIMEOUT);
+   }
+
+   if ( timeout > 0 )
+   {
+      OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+   }
+
+   /*
+   ** Look at every object once before blocking, keeping the sources of the
+   ** objects for the waiter
+   */
+   waiter = NULL;
+   if ( timeout != OS_CHECK )
+   {
+      waiter = OS_WaitAllocWaiter();
+      if ( waiter == NULL )
+      {
+         return(OS_ERR_NO_FREE_IDS);
+      }
+   }
+
+   for ( i = 0; i < count; i++ )
+   {
+      source = NULL;
+      status = OS_WaitPoll(&objects[i], &source);
+      if ( status != OS_ERROR_TIMEOUT )
+      {
+         *fired = i;
+         break;
+      }
+
+      if ( waiter != NULL )
+      {
+         waiter->sources[i] = source;
+      }
+   }
+
+   if ( waiter == NULL || i < count )
+   {
+      if ( waiter != NULL )
+      {
+         OS_AtomicStore(&waiter->in_use, FALSE);
+      }
+      return(status);
+   }
+
+   /* Link a node into every source */
+   for ( w = 0; w < OS_WAIT_READY_WORDS; w++ )
+   {
+      OS_AtomicStore(&waiter->ready[w], 0);
+   }
+
+   for ( linked = 0; linked < count; linked++ )
+   {
+      waiter->nodes[linked].seq   = &waiter->seq;
+      waiter->nodes[linked].ready = &waiter->ready[linked / OS_WAIT_READY_BITS];
+      waiter->nodes[linked].bit   = 1U << (linked % OS_WAIT_READY_BITS);
+      OS_WaitLink(waiter->sources[linked], &waiter->nodes[linked]);
+   }
+
+   /*
+   ** An event between the first look and the link was not notified, so every
+   ** object is polled once more before the first sleep
+   */
+   for ( i = 0; i < count; i++ )
+   {
+      OS_AtomicOr(&waiter->ready[i / OS_WAIT_READY_BITS], 1U << (i % OS_WAIT_READY_BITS));
+   }
+
+   status = OS_ERROR_TIMEOUT;
+   for ( ;; )
+   {
+      /* Read before the ready words, so a notify after them ends the sleep */
+      seq = OS_AtomicLoad(&waiter->seq);
+
+      for ( w = 0; w < OS_WAIT_READY_WORDS && status == OS_ERROR_TIMEOUT; w++ )
+      {
+         pending = OS_AtomicExchange(&waiter->ready[w], 0);
+         while ( pending != 0 )
+         {
+            i = (w * OS_WAIT_READY_BITS) + __builtin_ctz(pending);
+            pending &= pending - 1;
+
+            status = OS_WaitPoll(&objects[i], &source);
+            if ( status != OS_ERROR_TIMEOUT )
+            {
+               *fired = i;
+               break;
+            }
+         }
+      }
+
+      if ( status != OS_ERROR_TIMEOUT || timed_out )
+      {
+         break;
+      }
+
+      if ( OS_FutexWait(&waiter->seq, seq, (timeout == OS_PEND) ? NULL : &deadline)
+           == OS_ERROR_TIMEOUT )
+      {
+         /* Poll the objects that were notified one last time before giving up */
+         timed_out = TRUE;
+      }
+   }
+
+   for ( i = 0; i < linked; i++ )
+   {
+      OS_WaitUnlink(waiter->sources[i], &waiter->nodes[i]);
+   }
+
+   OS_AtomicStore(&waiter->in_use, FALSE);
+
+   return(status);
+
+}/* end OS_WaitMultiple */
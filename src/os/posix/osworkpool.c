@@ -0,0 +1,907 @@
+/*
+** File   : osworkpool.c
+**
+**      Copyright (c) 2004-2006, United States government as represented by the
+**      administrator of the National Aeronautics Space Administration.
+**      All rights reserved. This software was created at NASAs Goddard
+**      Space Flight Center pursuant to government contracts.
+**
+**      This is governed by the NASA Open Source Agreement and may be used,
+**      distributed and modified only pursuant to the terms of that agreement.
+**
+** Purpose: This file contains the OSAL Work Pool API for POSIX systems.
+**
+**          A pool is a fixed set of worker tasks created with OS_TaskCreate.
+**          Every worker owns a queue of jobs for each priority lane, guarded by
+**          a lightweight mutex. A worker runs the newest job of its own queue
+**          first, and when it has none it steals the oldest job of another
+**          worker's queue. Idle workers sleep on a futex word of the pool that
+**          every submit bumps.
+*/
+
+/****************************************************************************************
+                                    INCLUDE FILES
+****************************************************************************************/
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osprivate.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+
+/****************************************************************************************
+                                EXTERNAL FUNCTION PROTOTYPES
+****************************************************************************************/
+
+uint32 OS_FindCreator(void);
+
+/****************************************************************************************
+                                     DEFINES
+****************************************************************************************/
+
+#define OS_WORK_LANE_HIGH    0
+#define OS_WORK_LANE_NORMAL  1
+#define OS_WORK_LANES        2
+
+#define UNINITIALIZED 0
+
+/****************************************************************************************
+                                    LOCAL TYPEDEFS
+****************************************************************************************/
+
+typedef struct
+{
+   OS_WorkFunction_t   function;
+   void               *arg;
+   OS_work_group_t    *group;
+
+} OS_work_job_t;
+
+/*
+** The queue of one worker in one lane. head is the slot of the oldest job and
+** count the number of jobs, the newest job is in the slot before head + count.
+*/
+typedef struct
+{
+   OS_lwmutex_t        lock;
+   uint32              head;
+   uint32              count;
+   OS_work_job_t      *jobs;
+
+} OS_work_queue_t;
+
+typedef struct OS_work_pool_record_s OS_work_pool_record_t;
+
+typedef struct
+{
+   OS_work_pool_record_t *pool;
+   uint32                 index;
+   OS_work_queue_t        lane[OS_WORK_LANES];
+
+} OS_work_worker_t;
+
+/*
+** work_seq changes on every submit, idle workers sleep on it. users counts
+** the calls that are handed the pool ID and are still using the record, so
+** OS_WorkPoolDelete can wait them out. A call with a stale ID may still be
+** counted in when the slot is created again, so only the API init zeroes
+** it. exited counts the workers that left their loop once stopping was set.
+*/
+struct OS_work_pool_record_s
+{
+   uint32              free;
+   char                name[OS_MAX_API_NAME];
+   uint32              creator;
+   uint32              num_workers;
+   uint32              task_ids[OS_MAX_WORK_POOL_WORKERS];
+   OS_work_worker_t    workers[OS_MAX_WORK_POOL_WORKERS];
+   OS_work_job_t      *job_memory;
+
+   volatile OS_futex_t work_seq;
+   volatile OS_futex_t idle;
+   volatile OS_futex_t users;
+   volatile OS_futex_t exited;
+   volatile uint32     stopping;
+   volatile uint32     next_worker;
+   volatile uint32     queued;
+   volatile uint32     executed;
+   volatile uint32     stolen;
+};
+
+/****************************************************************************************
+                                   GLOBAL DATA
+****************************************************************************************/
+
+OS_work_pool_record_t OS_work_pool_table[OS_MAX_WORK_POOLS];
+
+/*
+** The Mutex for protecting the above table
+*/
+pthread_mutex_t    OS_work_pool_table_mut;
+
+/*
+** The registry that hands out work pool table slots and indexes the pool names
+*/
+static OS_registry_t OS_work_pool_registry;
+
+/*
+** Hands the worker record to a worker task while it starts. Both are only
+** used with OS_work_pool_table_mut held by the creating task.
+*/
+static OS_work_worker_t *OS_work_starting;
+static OS_sem_t          OS_work_started;
+
+/*
+** The worker record of the calling task, NULL if it is not a pool worker
+*/
+static __thread OS_work_worker_t *OS_work_self;
+
+/****************************************************************************************
+                                INTERNAL FUNCTIONS
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkQueuePush
+
+   Purpose: Adds a job after the newest job of a queue
+
+   Returns: TRUE if the job was added
+            FALSE if the queue is full
+---------------------------------------------------------------------------------------*/
+static int OS_WorkQueuePush (OS_work_queue_t *queue, const OS_work_job_t *job)
+{
+   int added = FALSE;
+
+   OS_LwMutexLock(&queue->lock);
+   if ( queue->count < OS_WORK_QUEUE_DEPTH )
+   {
+      queue->jobs[(queue->head + queue->count) % OS_WORK_QUEUE_DEPTH] = *job;
+      queue->count++;
+      added = TRUE;
+   }
+   OS_LwMutexUnlock(&queue->lock);
+
+   return(added);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkQueuePop
+
+   Purpose: Takes the newest job of a queue, used by the worker that owns it.
+            Its data is most likely still in the cache of that worker's core.
+
+   Returns: TRUE if a job was taken
+            FALSE if the queue is empty
+---------------------------------------------------------------------------------------*/
+static int OS_WorkQueuePop (OS_work_queue_t *queue, OS_work_job_t *job)
+{
+   int taken = FALSE;
+
+   if ( OS_AtomicLoadRelaxed(&queue->count) == 0 )
+   {
+      return(FALSE);
+   }
+
+   OS_LwMutexLock(&queue->lock);
+   if ( queue->count != 0 )
+   {
+      queue->count--;
+      *job = queue->jobs[(queue->head + queue->count) % OS_WORK_QUEUE_DEPTH];
+      taken = TRUE;
+   }
+   OS_LwMutexUnlock(&queue->lock);
+
+   return(taken);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkQueueSteal
+
+   Purpose: Takes the oldest job of a queue, used by the other workers. A queue
+            that another thief holds is skipped rather than waited for.
+
+   Returns: TRUE if a job was taken
+            FALSE if the queue is empty or busy
+---------------------------------------------------------------------------------------*/
+static int OS_WorkQueueSteal (OS_work_queue_t *queue, OS_work_job_t *job)
+{
+   int taken = FALSE;
+
+   if ( OS_AtomicLoadRelaxed(&queue->count) == 0 || !OS_LwMutexTryLock(&queue->lock) )
+   {
+      return(FALSE);
+   }
+
+   if ( queue->count != 0 )
+   {
+      *job = queue->jobs[queue->head];
+      queue->head = (queue->head + 1) % OS_WORK_QUEUE_DEPTH;
+      queue->count--;
+      taken = TRUE;
+   }
+   OS_LwMutexUnlock(&queue->lock);
+
+   return(taken);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkFind
+
+   Purpose: Finds the next job for a worker. Every queue of the high lane is
+            searched before the normal lane, the worker's own queue first and
+            then the others starting with its neighbour.
+
+   Returns: TRUE if a job was taken
+            FALSE if the pool has no job to run
+---------------------------------------------------------------------------------------*/
+static int OS_WorkFind (OS_work_worker_t *self, OS_work_job_t *job)
+{
+   OS_work_pool_record_t *pool = self->pool;
+   uint32                 lane;
+   uint32                 i;
+   uint32                 victim;
+
+   if ( OS_AtomicLoad(&pool->queued) == 0 )
+   {
+      return(FALSE);
+   }
+
+   for ( lane = 0; lane < OS_WORK_LANES; lane++ )
+   {
+      if ( OS_WorkQueuePop(&self->lane[lane], job) )
+      {
+         OS_AtomicSub(&pool->queued, 1);
+         return(TRUE);
+      }
+
+      for ( i = 1; i < pool->num_workers; i++ )
+      {
+         victim = (self->index + i) % pool->num_workers;
+         if ( OS_WorkQueueSteal(&pool->workers[victim].lane[lane], job) )
+         {
+            OS_AtomicSub(&pool->queued, 1);
+            OS_AtomicAdd(&pool->stolen, 1);
+            return(TRUE);
+         }
+      }
+   }
+
+   return(FALSE);
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkRun
+
+   Purpose: Runs a job and signals its wait group when it was the last job of it
+---------------------------------------------------------------------------------------*/
+static void OS_WorkRun (OS_work_pool_record_t *pool, const OS_work_job_t *job)
+{
+   job->function(job->arg);
+
+   OS_AtomicAdd(&pool->executed, 1);
+
+   if ( job->group != NULL && OS_AtomicSub(&job->group->pending, 1) == 0 )
+   {
+      OS_FutexWake(&job->group->pending, INT_MAX);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolWorker
+
+   Purpose: The entry point of every worker task. Runs jobs until the pool is
+            deleted, then waits for OS_WorkPoolDelete to delete the task, so
+            the task is gone from the task table when the delete returns.
+---------------------------------------------------------------------------------------*/
+static void OS_WorkPoolWorker (void)
+{
+   OS_work_worker_t      *self;
+   OS_work_pool_record_t *pool;
+   OS_work_job_t          job;
+   OS_futex_t             seq;
+
+   self = OS_work_starting;
+   OS_SemGive(&OS_work_started);
+
+   OS_work_self = self;
+   pool = self->pool;
+
+   for ( ;; )
+   {
+      if ( OS_WorkFind(self, &job) )
+      {
+         OS_WorkRun(pool, &job);
+         continue;
+      }
+
+      /*
+      ** The sequence is read before the worker counts itself idle and looks
+      ** again, so a submit that lands in between either finds it idle and
+      ** wakes it, or changes the sequence and the wait returns at once
+      */
+      seq = OS_AtomicLoad(&pool->work_seq);
+      OS_AtomicAdd(&pool->idle, 1);
+
+      if ( OS_WorkFind(self, &job) )
+      {
+         OS_AtomicSub(&pool->idle, 1);
+         OS_WorkRun(pool, &job);
+         continue;
+      }
+
+      if ( OS_AtomicLoad(&pool->stopping) )
+      {
+         OS_AtomicSub(&pool->idle, 1);
+         break;
+      }
+
+      OS_FutexWait(&pool->work_seq, seq, NULL);
+      OS_AtomicSub(&pool->idle, 1);
+   }
+
+   OS_work_self = NULL;
+   OS_AtomicAdd(&pool->exited, 1);
+   OS_FutexWake(&pool->exited, INT_MAX);
+
+   for ( ;; )
+   {
+      OS_TaskDelay(1000);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolStop
+
+   Purpose: Stops the first num_started workers of a pool once they have run
+            every queued job, deletes their tasks and frees the job memory
+---------------------------------------------------------------------------------------*/
+static void OS_WorkPoolStop (OS_work_pool_record_t *pool, uint32 num_started)
+{
+   OS_futex_t exited;
+   uint32     i;
+
+   OS_AtomicStore(&pool->stopping, TRUE);
+   OS_AtomicAdd(&pool->work_seq, 1);
+   OS_FutexWake(&pool->work_seq, INT_MAX);
+
+   while ( (exited = OS_AtomicLoad(&pool->exited)) < num_started )
+   {
+      OS_FutexWait(&pool->exited, exited, NULL);
+   }
+
+   for ( i = 0; i < num_started; i++ )
+   {
+      OS_TaskDelete(pool->task_ids[i]);
+      pool->task_ids[i] = UNINITIALIZED;
+   }
+
+   free(pool->job_memory);
+   pool->job_memory = NULL;
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolLeave
+
+   Purpose: Ends a use of the pool started by OS_WorkPoolEnter, waking a delete
+            that waits for the last user to leave
+---------------------------------------------------------------------------------------*/
+static void OS_WorkPoolLeave (OS_work_pool_record_t *pool)
+{
+   if ( OS_AtomicSub(&pool->users, 1) == 0 )
+   {
+      OS_FutexWake(&pool->users, INT_MAX);
+   }
+}
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolEnter
+
+   Purpose: Validates a pool ID and counts the caller as a user of the pool, so
+            the pool is not torn down under it. OS_WorkPoolLeave ends the use.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid work pool
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+static int32 OS_WorkPoolEnter (uint32 pool_id, OS_work_pool_record_t **pool)
+{
+   uint32 local_id;
+
+   if ( OS_RegistryCheckId(&OS_work_pool_registry, pool_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   OS_AtomicAdd(&OS_work_pool_table[local_id].users, 1);
+
+   /*
+   ** A delete that retired the ID before the count went up does not wait
+   ** for this call, so check the ID again now that it is counted
+   */
+   if ( OS_RegistryCheckId(&OS_work_pool_registry, pool_id, &local_id) != OS_SUCCESS )
+   {
+      OS_WorkPoolLeave(&OS_work_pool_table[local_id]);
+      return(OS_ERR_INVALID_ID);
+   }
+
+   *pool = &OS_work_pool_table[local_id];
+   return(OS_SUCCESS);
+}
+
+/****************************************************************************************
+                                INITIALIZATION FUNCTION
+****************************************************************************************/
+int32 OS_WorkPoolAPIInit (void)
+{
+   int i;
+
+   for ( i = 0; i < OS_MAX_WORK_POOLS; i++ )
+   {
+      OS_work_pool_table[i].free       = TRUE;
+      OS_work_pool_table[i].creator    = UNINITIALIZED;
+      OS_work_pool_table[i].job_memory = NULL;
+      OS_work_pool_table[i].users      = 0;
+      strcpy(OS_work_pool_table[i].name, "");
+   }
+
+   if ( OS_RegistryInit(&OS_work_pool_registry, OS_OBJECT_TYPE_WORKPOOL,
+                        OS_MAX_WORK_POOLS, OS_MAX_API_NAME) != OS_SUCCESS )
+   {
+      OS_printf("OS_WorkPoolAPIInit: Error allocating the work pool registry\n");
+      return(OS_ERROR);
+   }
+
+   if ( pthread_mutex_init(&OS_work_pool_table_mut, NULL) != 0 )
+   {
+      OS_printf("OS_WorkPoolAPIInit: Error creating the work pool table mutex\n");
+      return(OS_ERROR);
+   }
+
+   OS_SemInit(&OS_work_started, 0, 1);
+
+   return(OS_SUCCESS);
+}
+
+/****************************************************************************************
+                                    WORK POOL API
+****************************************************************************************/
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolCreate
+
+   Purpose: Creates a pool of num_workers worker tasks. The workers are named
+            after the pool, the first worker of pool "DECODE" is "DECODE.0".
+            stack_size, priority and flags are passed to OS_TaskCreate for each
+            worker, so the flags select the scheduling policy and the cores of
+            the workers like they do for any task.
+
+   Returns: OS_INVALID_POINTER if pool_id or pool_name are NULL
+            OS_ERR_NAME_TOO_LONG if the name given, with the worker number
+            added, is too long
+            OS_ERR_NO_FREE_IDS if all of the pool ids are taken
+            OS_ERR_NAME_TAKEN if this is already the name of a pool
+            OS_ERROR if num_workers is 0 or more than OS_MAX_WORK_POOL_WORKERS,
+            or the job queues could not be allocated
+            any error of OS_TaskCreate if a worker could not be created
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkPoolCreate (uint32 *pool_id, const char *pool_name, uint32 num_workers,
+                         uint32 stack_size, uint32 priority, uint32 flags)
+{
+   OS_work_pool_record_t *pool;
+   OS_work_worker_t      *worker;
+   uint32                 possible_poolid;
+   uint32                 i;
+   uint32                 lane;
+   char                   worker_name[OS_MAX_API_NAME];
+   int32                  status;
+
+   if ( pool_id == NULL || pool_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   /* The name needs room for the "." and the worker number of the task names */
+   if ( strlen(pool_name) + 3 >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   if ( num_workers == 0 || num_workers > OS_MAX_WORK_POOL_WORKERS )
+   {
+      return(OS_ERROR);
+   }
+
+   pthread_mutex_lock(&OS_work_pool_table_mut);
+
+   status = OS_RegistryAlloc(&OS_work_pool_registry, pool_name, &possible_poolid);
+   if ( status != OS_SUCCESS )
+   {
+      pthread_mutex_unlock(&OS_work_pool_table_mut);
+      return(status);
+   }
+
+   pool = &OS_work_pool_table[possible_poolid];
+
+   pool->job_memory = malloc(sizeof(OS_work_job_t) * OS_WORK_LANES *
+                             OS_WORK_QUEUE_DEPTH * num_workers);
+   if ( pool->job_memory == NULL )
+   {
+      OS_RegistryFree(&OS_work_pool_registry, possible_poolid);
+      pthread_mutex_unlock(&OS_work_pool_table_mut);
+      return(OS_ERROR);
+   }
+
+   pool->free        = FALSE;
+   pool->num_workers = num_workers;
+   pool->work_seq    = 0;
+   pool->idle        = 0;
+   pool->exited      = 0;
+   pool->stopping    = FALSE;
+   pool->next_worker = 0;
+   pool->queued      = 0;
+   pool->executed    = 0;
+   pool->stolen      = 0;
+
+   for ( i = 0; i < num_workers; i++ )
+   {
+      worker = &pool->workers[i];
+      worker->pool  = pool;
+      worker->index = i;
+
+      for ( lane = 0; lane < OS_WORK_LANES; lane++ )
+      {
+         OS_LwMutexInit(&worker->lane[lane].lock);
+         worker->lane[lane].head  = 0;
+         worker->lane[lane].count = 0;
+         worker->lane[lane].jobs  = &pool->job_memory[((i * OS_WORK_LANES) + lane) *
+                                                      OS_WORK_QUEUE_DEPTH];
+      }
+   }
+
+   for ( i = 0; i < num_workers; i++ )
+   {
+      sprintf(worker_name, "%s.%d", pool_name, (int)i);
+
+      OS_work_starting = &pool->workers[i];
+      status = OS_TaskCreate(&pool->task_ids[i], worker_name, OS_WorkPoolWorker, NULL,
+                             stack_size, priority, flags);
+      if ( status != OS_SUCCESS )
+      {
+         OS_WorkPoolStop(pool, i);
+         pool->free = TRUE;
+         OS_RegistryFree(&OS_work_pool_registry, possible_poolid);
+         pthread_mutex_unlock(&OS_work_pool_table_mut);
+         return(status);
+      }
+
+      /* Wait for the worker to pick up its record before the next one starts */
+      OS_SemTake(&OS_work_started, NULL);
+   }
+
+   strcpy(pool->name, pool_name);
+   pool->creator = OS_FindCreator();
+
+   OS_RegistryPublish(&OS_work_pool_registry, possible_poolid);
+   *pool_id = OS_RegistryGetId(&OS_work_pool_registry, possible_poolid);
+
+   pthread_mutex_unlock(&OS_work_pool_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_WorkPoolCreate */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolDelete
+
+   Purpose: Deletes a pool. The jobs already queued are run first, then the
+            worker tasks are deleted.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid work pool
+            OS_ERROR if called by one of the workers of the pool
+            OS_SUCCESS if success
+
+   Notes: Jobs that submit more jobs to the pool while it is being deleted get
+          OS_ERR_INVALID_ID back.
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkPoolDelete (uint32 pool_id)
+{
+   OS_work_pool_record_t *pool;
+   uint32                 local_id;
+   OS_futex_t             users;
+
+   if ( OS_RegistryCheckId(&OS_work_pool_registry, pool_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   pool = &OS_work_pool_table[local_id];
+
+   /* A worker cannot wait for itself to stop */
+   if ( OS_work_self != NULL && OS_work_self->pool == pool )
+   {
+      return(OS_ERROR);
+   }
+
+   /* Retire the ID so no new job can be submitted while the pool is deleted */
+   if ( OS_RegistryRetire(&OS_work_pool_registry, pool_id, &local_id) != OS_SUCCESS )
+   {
+      return(OS_ERR_INVALID_ID);
+   }
+
+   while ( (users = OS_AtomicLoad(&pool->users)) != 0 )
+   {
+      OS_FutexWait(&pool->users, users, NULL);
+   }
+
+   OS_WorkPoolStop(pool, pool->num_workers);
+
+   pthread_mutex_lock(&OS_work_pool_table_mut);
+
+   pool->free = TRUE;
+   OS_RegistryFree(&OS_work_pool_registry, local_id);
+   strcpy(pool->name, "");
+   pool->creator     = UNINITIALIZED;
+   pool->num_workers = 0;
+
+   pthread_mutex_unlock(&OS_work_pool_table_mut);
+
+   return(OS_SUCCESS);
+
+}/* end OS_WorkPoolDelete */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkSubmit
+
+   Purpose: Queues a job that calls function(arg) on one of the workers of the
+            pool. When group is not NULL the job is counted in it until it has
+            run. flags can be OS_WORK_HIGH_PRIORITY to put the job in the high
+            lane, which every worker empties before it runs a normal job.
+
+   Returns: OS_ERR_INVALID_ID if the id passed in is not a valid work pool
+            OS_INVALID_POINTER if function is NULL
+            OS_QUEUE_FULL if the queues of all of the workers are full
+            OS_SUCCESS if success
+
+   Notes: A job submitted by a worker of the pool goes to the queue of that
+          worker, other jobs are spread over the workers in turn.
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkSubmit (uint32 pool_id, OS_WorkFunction_t function, void *arg,
+                     OS_work_group_t *group, uint32 flags)
+{
+   OS_work_pool_record_t *pool;
+   OS_work_job_t          job;
+   uint32                 lane;
+   uint32                 first;
+   uint32                 i;
+   int32                  status;
+
+   if ( function == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   status = OS_WorkPoolEnter(pool_id, &pool);
+   if ( status != OS_SUCCESS )
+   {
+      return(status);
+   }
+
+   job.function = function;
+   job.arg      = arg;
+   job.group    = group;
+
+   lane = (flags & OS_WORK_HIGH_PRIORITY) ? OS_WORK_LANE_HIGH : OS_WORK_LANE_NORMAL;
+
+   if ( OS_work_self != NULL && OS_work_self->pool == pool )
+   {
+      first = OS_work_self->index;
+   }
+   else
+   {
+      first = OS_AtomicAdd(&pool->next_worker, 1) % pool->num_workers;
+   }
+
+   /* Count the job in its group before a worker can run it */
+   if ( group != NULL )
+   {
+      OS_AtomicAdd(&group->pending, 1);
+   }
+
+   status = OS_QUEUE_FULL;
+   for ( i = 0; i < pool->num_workers; i++ )
+   {
+      if ( OS_WorkQueuePush(&pool->workers[(first + i) % pool->num_workers].lane[lane], &job) )
+      {
+         status = OS_SUCCESS;
+         break;
+      }
+   }
+
+   if ( status == OS_SUCCESS )
+   {
+      OS_AtomicAdd(&pool->queued, 1);
+      OS_AtomicAdd(&pool->work_seq, 1);
+
+      if ( OS_AtomicLoad(&pool->idle) != 0 )
+      {
+         OS_FutexWake(&pool->work_seq, 1);
+      }
+   }
+   else if ( group != NULL && OS_AtomicSub(&group->pending, 1) == 0 )
+   {
+      OS_FutexWake(&group->pending, INT_MAX);
+   }
+
+   OS_WorkPoolLeave(pool);
+
+   return(status);
+
+}/* end OS_WorkSubmit */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkGroupInit
+
+   Purpose: Sets up an empty wait group
+
+   Returns: OS_INVALID_POINTER if group is NULL
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkGroupInit (OS_work_group_t *group)
+{
+   if ( group == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   OS_AtomicStore(&group->pending, 0);
+
+   return(OS_SUCCESS);
+
+}/* end OS_WorkGroupInit */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkGroupWait
+
+   Purpose: Waits until every job submitted with the group has run. timeout is
+            OS_PEND to wait forever, OS_CHECK to only look, or a time in
+            milliseconds.
+
+   Returns: OS_INVALID_POINTER if group is NULL
+            OS_ERR_INVALID_TIMEOUT if timeout is negative and not OS_CHECK
+            OS_ERROR_TIMEOUT if jobs of the group are left when the time is up
+            OS_SUCCESS if success
+
+   Notes: A worker that waits runs jobs of its pool meanwhile, so a job can
+          split its work into more jobs and wait for them without tying up
+          its worker.
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkGroupWait (OS_work_group_t *group, int32 timeout)
+{
+   OS_work_worker_t *self = OS_work_self;
+   OS_work_job_t     job;
+   OS_futex_t        pending;
+   struct timespec   deadline;
+
+   if ( group == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( timeout < 0 && timeout != OS_CHECK )
+   {
+      return(OS_ERR_INVALID_TIMEOUT);
+   }
+
+   if ( timeout > 0 )
+   {
+      OS_CompMonotonicDeadline((uint32) timeout, &deadline);
+   }
+
+   while ( (pending = OS_AtomicLoad(&group->pending)) != 0 )
+   {
+      if ( self != NULL && OS_WorkFind(self, &job) )
+      {
+         OS_WorkRun(self->pool, &job);
+         continue;
+      }
+
+      if ( timeout == OS_CHECK )
+      {
+         return(OS_ERROR_TIMEOUT);
+      }
+
+      if ( OS_FutexWait(&group->pending, pending,
+                        timeout == OS_PEND ? NULL : &deadline) == OS_ERROR_TIMEOUT )
+      {
+         return(OS_AtomicLoad(&group->pending) == 0 ? OS_SUCCESS : OS_ERROR_TIMEOUT);
+      }
+   }
+
+   return(OS_SUCCESS);
+
+}/* end OS_WorkGroupWait */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolGetIdByName
+
+   Purpose: This function tries to find a work pool Id given the name of the pool
+
+   Returns: OS_INVALID_POINTER if pool_id or pool_name are NULL
+            OS_ERR_NAME_TOO_LONG if the name to found is too long to begin with
+            OS_ERR_NAME_NOT_FOUND if the name was not found in the table
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkPoolGetIdByName (uint32 *pool_id, const char *pool_name)
+{
+   int32 status;
+
+   if ( pool_id == NULL || pool_name == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   if ( strlen(pool_name) >= OS_MAX_API_NAME )
+   {
+      return(OS_ERR_NAME_TOO_LONG);
+   }
+
+   pthread_mutex_lock(&OS_work_pool_table_mut);
+   status = OS_RegistryFindId(&OS_work_pool_registry, pool_name, pool_id);
+   pthread_mutex_unlock(&OS_work_pool_table_mut);
+
+   return(status);
+
+}/* end OS_WorkPoolGetIdByName */
+
+/*---------------------------------------------------------------------------------------
+   Name: OS_WorkPoolGetInfo
+
+   Purpose: This function will pass back a structure that contains the name,
+            creator, worker task IDs and job counts of the specified pool.
+
+   Returns: OS_INVALID_POINTER if pool_prop is NULL
+            OS_ERR_INVALID_ID if the id passed in is not a valid work pool
+            OS_SUCCESS if success
+---------------------------------------------------------------------------------------*/
+int32 OS_WorkPoolGetInfo (uint32 pool_id, OS_work_pool_prop_t *pool_prop)
+{
+   OS_work_pool_record_t *pool;
+   uint32                 i;
+   int32                  status;
+
+   if ( pool_prop == NULL )
+   {
+      return(OS_INVALID_POINTER);
+   }
+
+   status = OS_WorkPoolEnter(pool_id, &pool);
+   if ( status != OS_SUCCESS )
+   {
+      return(status);
+   }
+
+   memset(pool_prop, 0, sizeof(OS_work_pool_prop_t));
+
+   strcpy(pool_prop->name, pool->name);
+   pool_prop->creator     = pool->creator;
+   pool_prop->num_workers = pool->num_workers;
+
+   for ( i = 0; i < pool->num_workers; i++ )
+   {
+      pool_prop->worker_ids[i] = pool->task_ids[i];
+   }
+
+   pool_prop->queued   = OS_AtomicLoadRelaxed(&pool->queued);
+   pool_prop->executed = OS_AtomicLoadRelaxed(&pool->executed);
+   pool_prop->stolen   = OS_AtomicLoadRelaxed(&pool->stolen);
+
+   OS_WorkPoolLeave(pool);
+
+   return(OS_SUCCESS);
+
+}/* end OS_WorkPoolGetInfo */